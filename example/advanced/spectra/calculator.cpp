@@ -39,6 +39,12 @@ SpectraGetDefaultCPUFourierTransf(
 	std::size_t spectrum_size
 );
 
+extern std::shared_ptr<SpectraCalculator>
+SpectraGetFFTFourierTransf(
+	SpectraSharedObjects&,
+	std::size_t spectrum_size
+);
+
 extern std::shared_ptr<SpectraCalculator>
 SpectraGetDefaultGPUFourierTransf(
 	SpectraSharedObjects&,
@@ -52,6 +58,15 @@ SpectraGetDefaultSignalTransform(
 	std::size_t spectrum_size
 )
 {
+	// the FFT needs power-of-two sized frames, other sizes use
+	// the (quadratic) matrix transforms
+	if((spectrum_size & (spectrum_size-1)) == 0)
+	{
+		return SpectraGetFFTFourierTransf(
+			shared_objects,
+			spectrum_size
+		);
+	}
 	try
 	{
 		return SpectraGetDefaultGPUFourierTransf(
@@ -9,11 +9,25 @@
  *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
  */
 
+#include <oglplus/gl.hpp>
+#include <oglplus/config.hpp>
+#include <oglplus/math.hpp>
+
 #include "calculator.hpp"
 
 #include <vector>
+#include <string>
+#include <deque>
+#include <algorithm>
+#include <cmath>
 #include <cassert>
 
+#if !OGLPLUS_NO_THREADS
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
 // SpectraNoOpValueTransform
 struct SpectraNoOpValueTransform
 {
@@ -191,6 +205,535 @@ FinishTransform(
 	assert(tid == 0);
 }
 
+// SpectraWindowFunction
+enum class SpectraWindowFunction
+{
+	Rectangular,
+	Hann,
+	Blackman
+};
+
+// SpectraRealFFT
+// Real-input FFT of a power-of-two sized frame computed by a half-size
+// complex Stockham FFT (radix-4 stages and one radix-2 stage if needed)
+// on split real and imaginary arrays, so that the inner loops can be
+// vectorized by the compiler.
+class SpectraRealFFT
+{
+public:
+	// working buffers, one set for every concurrently running transform
+	struct Scratch
+	{
+		std::vector<float> re, im, tmp_re, tmp_im;
+	};
+private:
+	// a single pass of the complex FFT
+	struct Stage
+	{
+		std::size_t n, s;
+		bool radix4;
+		// w1, w2 and w3 twiddles (re, im) for each p in radix-4
+		// stages and w1 for each p in radix-2 stages
+		std::vector<float> w;
+	};
+
+	std::size_t frame_size, half_size;
+	std::vector<float> window;
+	float scale;
+	std::vector<Stage> stages;
+	// the twiddles for splitting the complex spectrum into the real one
+	std::vector<float> split_re, split_im;
+
+	static void Radix4(
+		const Stage& stage,
+		const float* x_re, const float* x_im,
+		float* y_re, float* y_im
+	);
+
+	static void Radix2(
+		const Stage& stage,
+		const float* x_re, const float* x_im,
+		float* y_re, float* y_im
+	);
+public:
+	SpectraRealFFT(std::size_t size, SpectraWindowFunction window_fn);
+
+	std::size_t FrameSize(void) const
+	{
+		return frame_size;
+	}
+
+	void InitScratch(Scratch& scratch) const;
+
+	// calculates the magnitudes of the first out_size bins
+	void operator()(
+		const float* input,
+		float* output,
+		std::size_t out_size,
+		Scratch& scratch
+	) const;
+};
+
+SpectraRealFFT::SpectraRealFFT(
+	std::size_t size,
+	SpectraWindowFunction window_fn
+): frame_size(size)
+ , half_size(size/2)
+ , window(size)
+ , split_re(half_size+1)
+ , split_im(half_size+1)
+{
+	assert(frame_size >= 4);
+	assert((frame_size & (frame_size-1)) == 0);
+
+	const double twopi = oglplus::math::TwoPi();
+
+	double sum_sq = 0.0;
+	for(std::size_t i=0; i!=frame_size; ++i)
+	{
+		double t = twopi*double(i)/double(frame_size);
+		double w = 1.0;
+		switch(window_fn)
+		{
+			case SpectraWindowFunction::Rectangular:
+				break;
+			case SpectraWindowFunction::Hann:
+				w = 0.5-0.5*std::cos(t);
+				break;
+			case SpectraWindowFunction::Blackman:
+				w = 0.42-0.5*std::cos(t)+0.08*std::cos(2.0*t);
+				break;
+		}
+		window[i] = float(w);
+		sum_sq += w*w;
+	}
+	// keeps the energy of the spectrum independent of the window,
+	// for the rectangular window this is the 1/sqrt(N) normalization
+	scale = float(1.0/std::sqrt(sum_sq));
+
+	std::size_t n = half_size, s = 1;
+	while(n > 1)
+	{
+		Stage stage;
+		stage.n = n;
+		stage.s = s;
+		stage.radix4 = (n % 4 == 0);
+		std::size_t radix = stage.radix4?4:2;
+		for(std::size_t p=0; p!=n/radix; ++p)
+		{
+			double a = -twopi*double(p)/double(n);
+			for(std::size_t k=1; k!=(stage.radix4?4:2); ++k)
+			{
+				stage.w.push_back(float(std::cos(a*k)));
+				stage.w.push_back(float(std::sin(a*k)));
+			}
+		}
+		stages.push_back(stage);
+		n /= radix;
+		s *= radix;
+	}
+
+	for(std::size_t k=0; k<=half_size; ++k)
+	{
+		double a = -twopi*double(k)/double(frame_size);
+		split_re[k] = float(std::cos(a));
+		split_im[k] = float(std::sin(a));
+	}
+}
+
+void SpectraRealFFT::InitScratch(Scratch& scratch) const
+{
+	scratch.re.resize(half_size);
+	scratch.im.resize(half_size);
+	scratch.tmp_re.resize(half_size);
+	scratch.tmp_im.resize(half_size);
+}
+
+void SpectraRealFFT::Radix4(
+	const Stage& stage,
+	const float* x_re, const float* x_im,
+	float* y_re, float* y_im
+)
+{
+	const std::size_t n1 = stage.n/4, s = stage.s;
+	const float* w = stage.w.data();
+	for(std::size_t p=0; p!=n1; ++p, w += 6)
+	{
+		const float w1r = w[0], w1i = w[1];
+		const float w2r = w[2], w2i = w[3];
+		const float w3r = w[4], w3i = w[5];
+
+		const float* ar = x_re+s*p;
+		const float* ai = x_im+s*p;
+		const float* br = ar+s*n1;
+		const float* bi = ai+s*n1;
+		const float* cr = br+s*n1;
+		const float* ci = bi+s*n1;
+		const float* dr = cr+s*n1;
+		const float* di = ci+s*n1;
+		float* y0r = y_re+s*(4*p);
+		float* y0i = y_im+s*(4*p);
+		float* y1r = y0r+s;
+		float* y1i = y0i+s;
+		float* y2r = y1r+s;
+		float* y2i = y1i+s;
+		float* y3r = y2r+s;
+		float* y3i = y2i+s;
+
+		for(std::size_t q=0; q!=s; ++q)
+		{
+			const float apc_r = ar[q]+cr[q], apc_i = ai[q]+ci[q];
+			const float amc_r = ar[q]-cr[q], amc_i = ai[q]-ci[q];
+			const float bpd_r = br[q]+dr[q], bpd_i = bi[q]+di[q];
+			// -j*(b-d)
+			const float jbmd_r = bi[q]-di[q], jbmd_i = dr[q]-br[q];
+
+			y0r[q] = apc_r+bpd_r;
+			y0i[q] = apc_i+bpd_i;
+
+			const float t1r = amc_r+jbmd_r, t1i = amc_i+jbmd_i;
+			y1r[q] = w1r*t1r-w1i*t1i;
+			y1i[q] = w1r*t1i+w1i*t1r;
+
+			const float t2r = apc_r-bpd_r, t2i = apc_i-bpd_i;
+			y2r[q] = w2r*t2r-w2i*t2i;
+			y2i[q] = w2r*t2i+w2i*t2r;
+
+			const float t3r = amc_r-jbmd_r, t3i = amc_i-jbmd_i;
+			y3r[q] = w3r*t3r-w3i*t3i;
+			y3i[q] = w3r*t3i+w3i*t3r;
+		}
+	}
+}
+
+void SpectraRealFFT::Radix2(
+	const Stage& stage,
+	const float* x_re, const float* x_im,
+	float* y_re, float* y_im
+)
+{
+	const std::size_t m = stage.n/2, s = stage.s;
+	const float* w = stage.w.data();
+	for(std::size_t p=0; p!=m; ++p, w += 2)
+	{
+		const float wr = w[0], wi = w[1];
+
+		const float* ar = x_re+s*p;
+		const float* ai = x_im+s*p;
+		const float* br = ar+s*m;
+		const float* bi = ai+s*m;
+		float* y0r = y_re+s*(2*p);
+		float* y0i = y_im+s*(2*p);
+		float* y1r = y0r+s;
+		float* y1i = y0i+s;
+
+		for(std::size_t q=0; q!=s; ++q)
+		{
+			const float tr = ar[q]-br[q], ti = ai[q]-bi[q];
+			y0r[q] = ar[q]+br[q];
+			y0i[q] = ai[q]+bi[q];
+			y1r[q] = wr*tr-wi*ti;
+			y1i[q] = wr*ti+wi*tr;
+		}
+	}
+}
+
+void SpectraRealFFT::operator()(
+	const float* input,
+	float* output,
+	std::size_t out_size,
+	Scratch& scratch
+) const
+{
+	assert(out_size <= half_size+1);
+
+	// pack the even and odd windowed samples into a complex sequence
+	float* x_re = scratch.re.data();
+	float* x_im = scratch.im.data();
+	float* y_re = scratch.tmp_re.data();
+	float* y_im = scratch.tmp_im.data();
+	const float* w = window.data();
+	for(std::size_t i=0; i!=half_size; ++i)
+	{
+		x_re[i] = input[2*i+0]*w[2*i+0];
+		x_im[i] = input[2*i+1]*w[2*i+1];
+	}
+
+	// the Stockham stages produce the spectrum in the natural order
+	for(auto i=stages.begin(), e=stages.end(); i!=e; ++i)
+	{
+		if(i->radix4) Radix4(*i, x_re, x_im, y_re, y_im);
+		else Radix2(*i, x_re, x_im, y_re, y_im);
+		std::swap(x_re, y_re);
+		std::swap(x_im, y_im);
+	}
+
+	// split the spectrum of the complex sequence into the spectrum
+	// of the real input:
+	// X[k] = (Z[k]+Z*[M-k])/2 - j*W^k*(Z[k]-Z*[M-k])/2
+	for(std::size_t k=0; k!=out_size; ++k)
+	{
+		const std::size_t k0 = (k == half_size)?0:k;
+		const std::size_t k1 = (k == 0)?0:half_size-k;
+		const float zr = x_re[k0], zi = x_im[k0];
+		const float cr = x_re[k1], ci = -x_im[k1];
+
+		const float er = 0.5f*(zr+cr), ei = 0.5f*(zi+ci);
+		const float dr = 0.5f*(zr-cr), di = 0.5f*(zi-ci);
+		// -j*(d)
+		const float or_ = di, oi = -dr;
+		const float wr = split_re[k], wi = split_im[k];
+
+		const float xr = er+wr*or_-wi*oi;
+		const float xi = ei+wr*oi+wi*or_;
+		output[k] = std::sqrt(xr*xr+xi*xi)*scale;
+	}
+}
+
+// SpectraFFTTransf
+// Calculates the spectra with the SpectraRealFFT. The transforms started
+// by BeginTransform are executed by a pool of worker threads and
+// FinishTransform waits until the specified transform is done.
+class SpectraFFTTransf
+ : public SpectraCalculator
+{
+private:
+	SpectraRealFFT fft;
+	const std::size_t out_size;
+	std::string name;
+
+	struct Transform
+	{
+		std::vector<float> input;
+		float* output;
+		SpectraRealFFT::Scratch scratch;
+		bool pending;
+	};
+	std::vector<Transform> transforms;
+	unsigned next_transform;
+
+#if !OGLPLUS_NO_THREADS
+	std::vector<std::thread> workers;
+	std::mutex mutex;
+	std::condition_variable work_cond, done_cond;
+	std::deque<unsigned> queue;
+	bool quit;
+
+	struct Worker
+	{
+		SpectraFFTTransf* parent;
+
+		void operator()(void) const
+		{
+			parent->Work();
+		}
+	};
+
+	void Work(void);
+#endif
+public:
+	SpectraFFTTransf(
+		std::size_t frame_size,
+		std::size_t spectrum_size,
+		SpectraWindowFunction window_fn,
+		const std::string& transf_name
+	);
+
+	~SpectraFFTTransf(void);
+
+	std::size_t InputSize(void) const;
+
+	std::size_t OutputSize(void) const;
+
+	const char* Name(void) const;
+
+	unsigned MaxConcurrentTransforms(void) const;
+
+	void BeginBatch(void);
+
+	void FinishBatch(void);
+
+	unsigned BeginTransform(
+		const float* input,
+		std::size_t inbufsize,
+		float* output,
+		std::size_t outbufsize
+	);
+
+	void FinishTransform(
+		unsigned tid,
+		float* output,
+		std::size_t outbufsize
+	);
+};
+
+SpectraFFTTransf::SpectraFFTTransf(
+	std::size_t frame_size,
+	std::size_t spectrum_size,
+	SpectraWindowFunction window_fn,
+	const std::string& transf_name
+): fft(frame_size, window_fn)
+ , out_size(spectrum_size)
+ , name(transf_name)
+ , next_transform(0)
+#if !OGLPLUS_NO_THREADS
+ , quit(false)
+#endif
+{
+	unsigned thread_count = 1;
+#if !OGLPLUS_NO_THREADS
+	thread_count = std::thread::hardware_concurrency();
+	if(thread_count == 0) thread_count = 1;
+#endif
+	// several transforms per thread keep the workers busy while
+	// the caller is finishing the previous ones
+	transforms.resize(thread_count*4);
+	for(auto i=transforms.begin(), e=transforms.end(); i!=e; ++i)
+	{
+		i->input.resize(fft.FrameSize());
+		i->output = nullptr;
+		i->pending = false;
+		fft.InitScratch(i->scratch);
+	}
+#if !OGLPLUS_NO_THREADS
+	Worker worker = { this };
+	for(unsigned t=0; t!=thread_count; ++t)
+		workers.push_back(std::thread(worker));
+#endif
+}
+
+SpectraFFTTransf::~SpectraFFTTransf(void)
+{
+#if !OGLPLUS_NO_THREADS
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		quit = true;
+	}
+	work_cond.notify_all();
+	for(auto i=workers.begin(), e=workers.end(); i!=e; ++i)
+		i->join();
+#endif
+}
+
+#if !OGLPLUS_NO_THREADS
+void SpectraFFTTransf::Work(void)
+{
+	std::unique_lock<std::mutex> lock(mutex);
+	while(true)
+	{
+		while(queue.empty() && !quit)
+			work_cond.wait(lock);
+		if(quit) break;
+
+		unsigned tid = queue.front();
+		queue.pop_front();
+		Transform& transform = transforms[tid];
+
+		lock.unlock();
+		fft(
+			transform.input.data(),
+			transform.output,
+			out_size,
+			transform.scratch
+		);
+		lock.lock();
+
+		transform.pending = false;
+		done_cond.notify_all();
+	}
+}
+#endif
+
+std::size_t SpectraFFTTransf::InputSize(void) const
+{
+	return fft.FrameSize();
+}
+
+std::size_t SpectraFFTTransf::OutputSize(void) const
+{
+	return out_size;
+}
+
+const char* SpectraFFTTransf::Name(void) const
+{
+	return name.c_str();
+}
+
+unsigned SpectraFFTTransf::MaxConcurrentTransforms(void) const
+{
+	return unsigned(transforms.size());
+}
+
+void SpectraFFTTransf::BeginBatch(void)
+{
+}
+
+void SpectraFFTTransf::FinishBatch(void)
+{
+#if !OGLPLUS_NO_THREADS
+	std::unique_lock<std::mutex> lock(mutex);
+	for(auto i=transforms.begin(), e=transforms.end(); i!=e; ++i)
+	{
+		while(i->pending)
+			done_cond.wait(lock);
+	}
+#endif
+}
+
+unsigned SpectraFFTTransf::BeginTransform(
+	const float* input,
+	std::size_t inbufsize,
+	float* output,
+	std::size_t outbufsize
+)
+{
+	assert(inbufsize >= fft.FrameSize());
+	assert(outbufsize >= out_size);
+
+	unsigned tid = next_transform;
+	if(++next_transform == transforms.size())
+		next_transform = 0;
+	Transform& transform = transforms[tid];
+
+#if !OGLPLUS_NO_THREADS
+	std::unique_lock<std::mutex> lock(mutex);
+	// wait for the previous transform using the same slot
+	while(transform.pending)
+		done_cond.wait(lock);
+#endif
+	transform.input.assign(input, input+fft.FrameSize());
+	transform.output = output;
+#if !OGLPLUS_NO_THREADS
+	transform.pending = true;
+	queue.push_back(tid);
+	lock.unlock();
+	work_cond.notify_one();
+#else
+	fft(input, output, out_size, transform.scratch);
+#endif
+	return tid;
+}
+
+void SpectraFFTTransf::FinishTransform(
+	unsigned tid,
+	float* output,
+	std::size_t outbufsize
+)
+{
+	assert(tid < transforms.size());
+	assert(outbufsize >= out_size);
+	Transform& transform = transforms[tid];
+#if !OGLPLUS_NO_THREADS
+	std::unique_lock<std::mutex> lock(mutex);
+	while(transform.pending)
+		done_cond.wait(lock);
+#endif
+	if(output != transform.output)
+	{
+		std::copy(transform.output, transform.output+out_size, output);
+	}
+}
+
 std::shared_ptr<SpectraCalculator>
 SpectraGetDefaultCPUFourierTransf(
 	SpectraSharedObjects&,
@@ -212,3 +755,19 @@ SpectraGetDefaultCPUFourierTransf(
 	);
 }
 
+
+std::shared_ptr<SpectraCalculator>
+SpectraGetFFTFourierTransf(
+	SpectraSharedObjects&,
+	std::size_t spectrum_size
+)
+{
+	assert(spectrum_size > 2);
+	assert((spectrum_size & (spectrum_size-1)) == 0);
+	return std::make_shared<SpectraFFTTransf>(
+		spectrum_size*2,
+		spectrum_size,
+		SpectraWindowFunction::Hann,
+		"Fast Fourier Transform (CPU)"
+	);
+}
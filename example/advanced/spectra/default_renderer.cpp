@@ -32,7 +32,7 @@ private:
 	oglplus::OptionalUniform<oglplus::Mat4f> doc_vis_transf_matrix;
 	oglplus::OptionalUniform<GLint> doc_vis_spectrum_tex;
 	oglplus::OptionalUniform<GLint> doc_vis_spectrum_size;
-	oglplus::OptionalUniform<GLint> doc_vis_samples_per_unit;
+	oglplus::OptionalUniform<GLfloat> doc_vis_rows_per_unit;
 	oglplus::OptionalUniform<GLfloat> doc_vis_selected_time;
 	oglplus::OptionalUniform<GLfloat> doc_vis_selection_begin;
 	oglplus::OptionalUniform<GLfloat> doc_vis_selection_end;
@@ -96,7 +96,7 @@ SpectraDefaultRenderer::SpectraDefaultRenderer(
  , doc_vis_transf_matrix(doc_vis_prog, "TransfMatrix")
  , doc_vis_spectrum_tex(doc_vis_prog, "SpectrumTex")
  , doc_vis_spectrum_size(doc_vis_prog, "SpectrumSize")
- , doc_vis_samples_per_unit(doc_vis_prog, "SamplesPerUnit")
+ , doc_vis_rows_per_unit(doc_vis_prog, "RowsPerUnit")
  , doc_vis_selected_time(doc_vis_prog, "SelectedTime")
  , doc_vis_selection_begin(doc_vis_prog, "SelectionBegin")
  , doc_vis_selection_end(doc_vis_prog, "SelectionEnd")
@@ -146,7 +146,7 @@ void SpectraDefaultRenderer::RenderSpectrum(SpectraDocumentView& view)
 	DocVis().SpectrumTex().Bind(oglplus::Texture::Target::Buffer);
 	doc_vis_spectrum_tex.TrySet(0);
 	doc_vis_spectrum_size.TrySet(DocVis().SignalSpectrumSize());
-	doc_vis_samples_per_unit.TrySet(DocVis().SignalSamplesPerGrid());
+	doc_vis_rows_per_unit.TrySet(DocVis().SpectrumRowsPerGrid());
 	doc_vis_selected_time.TrySet(DocVis().SelectedTime());
 	doc_vis_selection_begin.TrySet(DocVis().SelectionBegin());
 	doc_vis_selection_end.TrySet(DocVis().SelectionEnd());
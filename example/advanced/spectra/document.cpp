@@ -10,6 +10,7 @@
  */
 
 #include "openal_document.hpp"
+#include "wav_document.hpp"
 #include "calculator.hpp"
 
 #include <wx/utils.h>
@@ -153,6 +154,9 @@ std::shared_ptr<SpectraDocument> SpectraLoadDocFromFile(
 	const wxString& file_path
 )
 {
+	// WAV files are mapped and converted on demand
+	if(SpectraIsWAVFile(file_path))
+		return SpectraOpenWAVDoc(file_path);
 	return SpectraOpenOpenALDoc(file_path);
 }
 
@@ -7,11 +7,11 @@
 
 uniform samplerBuffer SpectrumTex;
 uniform int SpectrumSize;
-uniform int SamplesPerUnit;
+uniform float RowsPerUnit;
 
 float SpectrumValue(vec3 coord)
 {
-	int row = int(SamplesPerUnit*(coord.z+coord.y));
+	int row = int(RowsPerUnit*(coord.z+coord.y));
 	int col = int((SpectrumSize-1)*coord.x);
 
 	return texelFetch(SpectrumTex, int(row*SpectrumSize+col)).r;
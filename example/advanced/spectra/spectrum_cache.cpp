@@ -0,0 +1,312 @@
+/*
+ *  .file advanced/spectra/spectrum_cache.cpp
+ *  .brief Implements a multi-resolution cache of computed spectrum rows.
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2012-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include "spectrum_cache.hpp"
+
+#include <algorithm>
+#include <cassert>
+
+bool operator < (
+	const SpectraSpectrumTileKey& a,
+	const SpectraSpectrumTileKey& b
+)
+{
+	if(a.first_row != b.first_row) return a.first_row < b.first_row;
+	if(a.row_stride != b.row_stride) return a.row_stride < b.row_stride;
+	if(a.bin_count != b.bin_count) return a.bin_count < b.bin_count;
+	return a.window < b.window;
+}
+
+SpectraSpectrumCache::SpectraSpectrumCache(
+	const std::shared_ptr<SpectraDocument>& doc,
+	const std::shared_ptr<SpectraCalculator>& calc,
+	std::size_t b_stride,
+	std::size_t t_rows,
+	std::size_t max_sz
+): document(doc)
+ , calculator(calc)
+ , window(std::string(calc->Name())+":"+std::to_string(calc->InputSize()))
+ , bin_count(calc->OutputSize())
+ , base_stride(b_stride?b_stride:1)
+ , tile_rows(t_rows?t_rows:1)
+ , level_count(1)
+ , cache_size(0)
+ , max_size(max_sz)
+ , hits(0)
+ , misses(0)
+ , decimations(0)
+{
+	assert(document);
+	assert(calculator);
+	assert(calculator->MaxConcurrentTransforms() > 0);
+
+	transform_ids.resize(calculator->MaxConcurrentTransforms());
+
+	while(RowCount(level_count-1) > tile_rows)
+		++level_count;
+}
+
+const SpectraDocument& SpectraSpectrumCache::Document(void) const
+{
+	return *document;
+}
+
+std::size_t SpectraSpectrumCache::BinCount(void) const
+{
+	return bin_count;
+}
+
+unsigned SpectraSpectrumCache::LevelCount(void) const
+{
+	return level_count;
+}
+
+std::size_t SpectraSpectrumCache::RowStride(unsigned level) const
+{
+	return base_stride << level;
+}
+
+std::size_t SpectraSpectrumCache::RowCount(unsigned level) const
+{
+	std::size_t samples = document->SignalSampleCount();
+	if(samples < bin_count) return 0;
+	samples -= bin_count;
+	std::size_t stride = RowStride(level);
+	return (samples+stride-1)/stride;
+}
+
+std::size_t SpectraSpectrumCache::TileRows(void) const
+{
+	return tile_rows;
+}
+
+std::size_t SpectraSpectrumCache::TileCount(unsigned level) const
+{
+	return (RowCount(level)+tile_rows-1)/tile_rows;
+}
+
+std::size_t SpectraSpectrumCache::TileRowCount(
+	unsigned level,
+	std::size_t tile
+) const
+{
+	std::size_t first = tile*tile_rows;
+	std::size_t count = RowCount(level);
+	if(first >= count) return 0;
+	return std::min(tile_rows, count-first);
+}
+
+SpectraSpectrumTileKey SpectraSpectrumCache::MakeKey(
+	unsigned level,
+	std::size_t tile
+) const
+{
+	TileKey key;
+	key.window = window;
+	key.bin_count = bin_count;
+	key.row_stride = RowStride(level);
+	key.first_row = tile*tile_rows;
+	return key;
+}
+
+bool SpectraSpectrumCache::HasTile(unsigned level, std::size_t tile) const
+{
+	return tiles.find(MakeKey(level, tile)) != tiles.end();
+}
+
+const std::vector<float>* SpectraSpectrumCache::Find(
+	unsigned level,
+	std::size_t tile
+)
+{
+	auto pos = tiles.find(MakeKey(level, tile));
+	if(pos == tiles.end()) return nullptr;
+	lru.splice(lru.begin(), lru, pos->second.lru_pos);
+	return &pos->second.values;
+}
+
+bool SpectraSpectrumCache::Decimate(
+	unsigned level,
+	std::size_t tile,
+	std::vector<float>& values
+)
+{
+	assert(level > 0);
+	// the r-th row of this tile is the 2r-th row of the two tiles
+	// at the finer level, i.e. the row computed from the same window
+	// of the signal, the second tile may be past the end
+	const std::vector<float>* finer[2] = {
+		Find(level-1, 2*tile+0),
+		Find(level-1, 2*tile+1)
+	};
+	const std::size_t n = TileRowCount(level, tile);
+
+	if(!finer[0]) return false;
+	if(!finer[1] && (n > 0) && (2*(n-1) >= tile_rows)) return false;
+
+	values.resize(n*bin_count);
+	for(std::size_t r=0; r!=n; ++r)
+	{
+		const std::size_t k = 2*r;
+		const float* a = finer[k/tile_rows]->data()+
+			(k%tile_rows)*bin_count;
+		std::copy(a, a+bin_count, values.data()+r*bin_count);
+	}
+	++decimations;
+	return true;
+}
+
+void SpectraSpectrumCache::Compute(
+	unsigned level,
+	std::size_t tile,
+	std::vector<float>& values
+)
+{
+	const std::size_t n = TileRowCount(level, tile);
+	const std::size_t stride = RowStride(level);
+	const std::size_t first = tile*tile_rows*stride;
+	const std::size_t in = calculator->InputSize();
+	const std::size_t m = transform_ids.size();
+
+	values.resize(n*bin_count);
+	if(n == 0) return;
+
+	// if the windows of the rows overlap the signal is queried at once,
+	// otherwise only the windows are queried without the gaps between
+	const std::size_t span = (n-1)*stride+in;
+	const bool contiguous = span <= n*in;
+	const std::size_t step = contiguous?stride:in;
+
+	signal.assign(contiguous?span:n*in, 0.0f);
+	if(contiguous)
+	{
+		document->QuerySignalSamples(
+			signal.data(),
+			signal.size(),
+			first,
+			first+span
+		);
+	}
+	else
+	{
+		for(std::size_t r=0; r!=n; ++r)
+		{
+			document->QuerySignalSamples(
+				signal.data()+r*in,
+				in,
+				first+r*stride,
+				first+r*stride+in
+			);
+		}
+	}
+
+	calculator->BeginBatch();
+	for(std::size_t i=0; (i!=m) && (i!=n); ++i)
+	{
+		transform_ids[i] = calculator->BeginTransform(
+			signal.data()+i*step,
+			in,
+			values.data()+i*bin_count,
+			bin_count
+		);
+	}
+	for(std::size_t i=0; i!=n; ++i)
+	{
+		calculator->FinishTransform(
+			transform_ids[i%m],
+			values.data()+i*bin_count,
+			bin_count
+		);
+		std::size_t j=i+m;
+		if(j<n)
+		{
+			transform_ids[i%m] = calculator->BeginTransform(
+				signal.data()+j*step,
+				in,
+				values.data()+j*bin_count,
+				bin_count
+			);
+		}
+	}
+	calculator->FinishBatch();
+}
+
+void SpectraSpectrumCache::Evict(void)
+{
+	// the most recently used tile is always kept
+	while((cache_size > max_size) && (lru.size() > 1))
+	{
+		auto pos = tiles.find(lru.back());
+		assert(pos != tiles.end());
+		cache_size -= pos->second.values.size()*sizeof(float);
+		tiles.erase(pos);
+		lru.pop_back();
+	}
+}
+
+const std::vector<float>& SpectraSpectrumCache::Tile(
+	unsigned level,
+	std::size_t tile
+)
+{
+	assert(level < level_count);
+	TileKey key = MakeKey(level, tile);
+	auto pos = tiles.find(key);
+	if(pos != tiles.end())
+	{
+		++hits;
+		lru.splice(lru.begin(), lru, pos->second.lru_pos);
+		return pos->second.values;
+	}
+	++misses;
+
+	TileData data;
+	if(!((level > 0) && Decimate(level, tile, data.values)))
+		Compute(level, tile, data.values);
+
+	cache_size += data.values.size()*sizeof(float);
+	lru.push_front(key);
+	data.lru_pos = lru.begin();
+	pos = tiles.insert(std::make_pair(key, std::move(data))).first;
+	Evict();
+	return pos->second.values;
+}
+
+std::size_t SpectraSpectrumCache::Size(void) const
+{
+	return cache_size;
+}
+
+std::size_t SpectraSpectrumCache::MaxSize(void) const
+{
+	return max_size;
+}
+
+void SpectraSpectrumCache::SetMaxSize(std::size_t size)
+{
+	max_size = size;
+	Evict();
+}
+
+std::size_t SpectraSpectrumCache::Hits(void) const
+{
+	return hits;
+}
+
+std::size_t SpectraSpectrumCache::Misses(void) const
+{
+	return misses;
+}
+
+std::size_t SpectraSpectrumCache::Decimations(void) const
+{
+	return decimations;
+}
@@ -0,0 +1,132 @@
+/*
+ *  .file advanced/spectra/spectrum_cache.hpp
+ *  .brief Declares a multi-resolution cache of computed spectrum rows.
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2012-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef OGLPLUS_EXAMPLE_SPECTRA_SPECTRUM_CACHE_HPP
+#define OGLPLUS_EXAMPLE_SPECTRA_SPECTRUM_CACHE_HPP
+
+#include "document.hpp"
+#include "calculator.hpp"
+
+#include <memory>
+#include <vector>
+#include <string>
+#include <list>
+#include <map>
+#include <cstddef>
+
+// Identifies a tile of spectrum rows. The rows of a tile start at
+// the signal sample first_row*row_stride and are row_stride samples
+// apart, the window is identified by the name and the input size
+// of the calculator.
+struct SpectraSpectrumTileKey
+{
+	std::string window;
+	std::size_t bin_count;
+	std::size_t row_stride;
+	std::size_t first_row;
+
+	friend bool operator < (
+		const SpectraSpectrumTileKey& a,
+		const SpectraSpectrumTileKey& b
+	);
+};
+
+// A pyramid of tiles of spectrum rows of a document. The rows at
+// level 0 are base_stride signal samples apart, at every following
+// level the stride doubles. The tiles of the coarser levels are made
+// by decimating (taking every other row of) the two tiles at the finer
+// level if both are cached and computed by the calculator otherwise.
+// Both ways give the same rows, so the adjacent tiles match.
+// The least recently used tiles are evicted when the size of the cache
+// exceeds the memory budget.
+class SpectraSpectrumCache
+{
+private:
+	std::shared_ptr<SpectraDocument> document;
+	std::shared_ptr<SpectraCalculator> calculator;
+
+	const std::string window;
+	const std::size_t bin_count;
+	const std::size_t base_stride;
+	const std::size_t tile_rows;
+	unsigned level_count;
+
+	typedef SpectraSpectrumTileKey TileKey;
+
+	struct TileData
+	{
+		std::vector<float> values;
+		std::list<TileKey>::iterator lru_pos;
+	};
+
+	std::map<TileKey, TileData> tiles;
+	std::list<TileKey> lru;
+
+	std::size_t cache_size, max_size;
+	std::size_t hits, misses, decimations;
+
+	std::vector<unsigned> transform_ids;
+	std::vector<float> signal;
+
+	TileKey MakeKey(unsigned level, std::size_t tile) const;
+
+	const std::vector<float>* Find(unsigned level, std::size_t tile);
+
+	bool Decimate(unsigned level, std::size_t tile, std::vector<float>& values);
+
+	void Compute(unsigned level, std::size_t tile, std::vector<float>& values);
+
+	void Evict(void);
+public:
+	SpectraSpectrumCache(
+		const std::shared_ptr<SpectraDocument>& doc,
+		const std::shared_ptr<SpectraCalculator>& calc,
+		std::size_t base_stride,
+		std::size_t tile_rows,
+		std::size_t max_size
+	);
+
+	const SpectraDocument& Document(void) const;
+
+	std::size_t BinCount(void) const;
+
+	unsigned LevelCount(void) const;
+
+	std::size_t RowStride(unsigned level) const;
+
+	std::size_t RowCount(unsigned level) const;
+
+	std::size_t TileRows(void) const;
+
+	std::size_t TileCount(unsigned level) const;
+
+	std::size_t TileRowCount(unsigned level, std::size_t tile) const;
+
+	bool HasTile(unsigned level, std::size_t tile) const;
+
+	// Returns the values of the rows of the specified tile, computing
+	// it if necessary. The values are valid until the next call.
+	const std::vector<float>& Tile(unsigned level, std::size_t tile);
+
+	std::size_t Size(void) const;
+
+	std::size_t MaxSize(void) const;
+
+	void SetMaxSize(std::size_t size);
+
+	std::size_t Hits(void) const;
+
+	std::size_t Misses(void) const;
+
+	std::size_t Decimations(void) const;
+};
+
+#endif // include guard
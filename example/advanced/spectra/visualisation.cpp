@@ -15,6 +15,8 @@
 #include "visualisation.hpp"
 #include "coroutine.hpp"
 
+#include <algorithm>
+
 // SpectraVisDataUploader
 class SpectraVisDataUploader
  : public SpectraCoroutine
@@ -25,35 +27,44 @@ private:
 
 	bool SetCurrent(void);
 
-	std::shared_ptr<SpectraCalculator> spectra_calc;
-	std::vector<unsigned> transform_ids;
+	std::shared_ptr<SpectraSpectrumCache> spectrum_cache;
 
-	std::shared_ptr<SpectraDocument> document;
+	// the level of the cache stored in the spectrum data buffer
+	const unsigned buffer_level;
+	// the coarser level uploaded first as a preview of the whole signal
+	unsigned preview_level;
+	std::size_t preview_tile;
 
 	std::size_t spectrum_size;
-	std::size_t current_row;
-	std::size_t row_count;
-	std::size_t rows_per_load;
+	std::size_t tile_count;
+	std::size_t tiles_done;
+	std::vector<bool> tile_done;
+	bool canceled;
+
+	// the tiles are uploaded starting from the one with the selected time
+	std::size_t focus_tile;
+	std::size_t next_after, next_before;
 
 	oglplus::Buffer& spectrum_data;
 
 	std::vector<GLfloat> data_buf;
 
-	std::size_t QuerySpectrumValues(
-		float* buffer,
-		std::size_t bufsize,
-		std::size_t start_row,
-		std::size_t end_row
-	);
+	bool NextTile(std::size_t& tile);
+
+	void UploadPreviewTile(void);
+
+	void UploadTile(std::size_t tile);
 public:
 	SpectraVisDataUploader(
 		wxGLContext* context,
 		const std::shared_ptr<std::set<wxGLCanvas*>>& canvases,
-		const std::shared_ptr<SpectraCalculator>& calc,
-		const std::shared_ptr<SpectraDocument>& doc,
+		const std::shared_ptr<SpectraSpectrumCache>& cache,
+		unsigned level,
 		oglplus::Buffer& spect_data
 	);
 
+	void Focus(float time);
+
 	wxString Description(void) const;
 
 	void Cancel(void);
@@ -66,91 +77,128 @@ public:
 SpectraVisDataUploader::SpectraVisDataUploader(
 	wxGLContext* context,
 	const std::shared_ptr<std::set<wxGLCanvas*>>& canvases,
-	const std::shared_ptr<SpectraCalculator>& calc,
-	const std::shared_ptr<SpectraDocument>& doc,
+	const std::shared_ptr<SpectraSpectrumCache>& cache,
+	unsigned level,
 	oglplus::Buffer& spect_data
 ): gl_context(context)
  , gl_canvases(canvases)
- , spectra_calc(calc)
- , document(doc)
- , current_row(0)
+ , spectrum_cache(cache)
+ , buffer_level(level)
+ , preview_level(level)
+ , preview_tile(0)
+ , tiles_done(0)
+ , canceled(false)
+ , focus_tile(0)
+ , next_after(0)
+ , next_before(0)
  , spectrum_data(spect_data)
 {
 	assert(gl_context);
 	assert(gl_canvases);
-	assert(document);
-	assert(spectra_calc);
-	assert(spectra_calc->MaxConcurrentTransforms() > 0);
-
-	transform_ids.resize(spectra_calc->MaxConcurrentTransforms());
-	spectrum_size = spectra_calc->OutputSize();
-	row_count = document->SignalSampleCount();
-	rows_per_load = 256*spectra_calc->MaxConcurrentTransforms();
-
-	if(row_count < spectrum_size)
-		row_count = 0;
-	else row_count -= spectrum_size;
-
-	data_buf.resize(spectrum_size*rows_per_load);
+	assert(spectrum_cache);
+	assert(buffer_level < spectrum_cache->LevelCount());
+
+	spectrum_size = spectrum_cache->BinCount();
+	tile_count = spectrum_cache->TileCount(buffer_level);
+	tile_done.resize(tile_count, false);
+
+	// the preview should take just a couple of tiles
+	const std::size_t max_preview_tiles = 16;
+	while(
+		(preview_level+1 < spectrum_cache->LevelCount()) &&
+		(spectrum_cache->TileCount(preview_level) > max_preview_tiles)
+	) ++preview_level;
+	if(preview_level == buffer_level)
+		preview_tile = spectrum_cache->TileCount(preview_level);
 
 	if(SetCurrent())
 	{
-		std::vector<GLfloat> init_data(spectrum_size*row_count, 0.0f);
+		std::vector<GLfloat> init_data(
+			spectrum_size*spectrum_cache->RowCount(buffer_level),
+			0.0f
+		);
 		spectrum_data.Bind(oglplus::Buffer::Target::Texture);
 		oglplus::Buffer::Data(oglplus::Buffer::Target::Texture, init_data);
 	}
 }
 
-std::size_t SpectraVisDataUploader::QuerySpectrumValues(
-	float* buffer,
-	std::size_t bufsize,
-	std::size_t start_row,
-	std::size_t end_row
-)
+void SpectraVisDataUploader::Focus(float time)
 {
-	std::size_t n = end_row-start_row;
-	std::size_t m = transform_ids.size();
-	assert(bufsize >= n*spectrum_size);
-
-	std::vector<float> signal(spectra_calc->InputSize()+n-1);
-
-	document->QuerySignalSamples(
-		signal.data(),
-		signal.size(),
-		start_row,
-		end_row+spectra_calc->InputSize()-1
+	const std::size_t row = std::size_t(
+		time*spectrum_cache->Document().SamplesPerSecond()/
+		spectrum_cache->RowStride(buffer_level)
 	);
-	spectra_calc->BeginBatch();
-	for(std::size_t i=0; i!=m; ++i)
+	focus_tile = row/spectrum_cache->TileRows();
+	if(focus_tile >= tile_count)
+		focus_tile = tile_count?tile_count-1:0;
+	next_after = focus_tile;
+	next_before = focus_tile;
+}
+
+bool SpectraVisDataUploader::NextTile(std::size_t& tile)
+{
+	while((next_after < tile_count) && tile_done[next_after])
+		++next_after;
+	while((next_before > 0) && tile_done[next_before-1])
+		--next_before;
+
+	bool after = next_after < tile_count;
+	bool before = next_before > 0;
+	if(after && before)
 	{
-		transform_ids[i] = spectra_calc->BeginTransform(
-			signal.data()+i,
-			spectra_calc->InputSize(),
-			buffer+i*spectrum_size,
-			spectrum_size
-		);
+		after = (next_after-focus_tile) <= (focus_tile-next_before+1);
+		before = !after;
 	}
+	if(after) tile = next_after;
+	else if(before) tile = next_before-1;
+	return after || before;
+}
 
-	for(std::size_t i=0; i!=n; ++i)
+void SpectraVisDataUploader::UploadPreviewTile(void)
+{
+	const std::vector<float>& values =
+		spectrum_cache->Tile(preview_level, preview_tile);
+
+	// every row of the preview is repeated in place of the rows
+	// of the finer level, which are not computed yet
+	const std::size_t rep = 1 << (preview_level - buffer_level);
+	const std::size_t first = preview_tile*spectrum_cache->TileRows()*rep;
+	const std::size_t buffer_rows = spectrum_cache->RowCount(buffer_level);
+	std::size_t n = values.size()/spectrum_size*rep;
+	if(first+n > buffer_rows)
+		n = buffer_rows-first;
+
+	data_buf.resize(n*spectrum_size);
+	for(std::size_t r=0; r!=n; ++r)
 	{
-		spectra_calc->FinishTransform(
-			transform_ids[i%m],
-			buffer+i*spectrum_size,
-			spectrum_size
+		std::copy(
+			values.begin()+(r/rep)*spectrum_size,
+			values.begin()+(r/rep+1)*spectrum_size,
+			data_buf.begin()+r*spectrum_size
 		);
-		std::size_t j=i+m;
-		if(j<n)
-		{
-			transform_ids[i%m] = spectra_calc->BeginTransform(
-				signal.data()+j,
-				spectra_calc->InputSize(),
-				buffer+j*spectrum_size,
-				spectrum_size
-			);
-		}
 	}
-	spectra_calc->FinishBatch();
-	return n;
+	oglplus::Buffer::SubData(
+		oglplus::Buffer::Target::Texture,
+		spectrum_size*first,
+		data_buf.size(),
+		data_buf.data()
+	);
+	++preview_tile;
+}
+
+void SpectraVisDataUploader::UploadTile(std::size_t tile)
+{
+	const std::vector<float>& values =
+		spectrum_cache->Tile(buffer_level, tile);
+
+	oglplus::Buffer::SubData(
+		oglplus::Buffer::Target::Texture,
+		spectrum_size*tile*spectrum_cache->TileRows(),
+		values.size(),
+		values.data()
+	);
+	tile_done[tile] = true;
+	++tiles_done;
 }
 
 bool SpectraVisDataUploader::SetCurrent(void)
@@ -170,35 +218,20 @@ wxString SpectraVisDataUploader::Description(void) const
 
 void SpectraVisDataUploader::Cancel(void)
 {
-	current_row = row_count;
+	canceled = true;
 }
 
 bool SpectraVisDataUploader::DoWork(void)
 {
-	if((current_row < row_count) && SetCurrent())
+	if(!canceled && (tiles_done < tile_count) && SetCurrent())
 	{
 		spectrum_data.Bind(oglplus::Buffer::Target::Texture);
-		std::size_t n = rows_per_load;
-
-		if(current_row+n > row_count)
-			n = row_count - current_row;
-
-		this->QuerySpectrumValues(
-			data_buf.data(),
-			data_buf.size(),
-			current_row,
-			current_row+n
-		);
-
-		spectrum_data.Bind(oglplus::Buffer::Target::Texture);
-		oglplus::Buffer::SubData(
-			oglplus::Buffer::Target::Texture,
-			spectrum_size*current_row,
-			spectrum_size*n,
-			data_buf.data()
-		);
 
-		current_row += n;
+		std::size_t tile = 0;
+		if(preview_tile < spectrum_cache->TileCount(preview_level))
+			UploadPreviewTile();
+		else if(NextTile(tile))
+			UploadTile(tile);
 		return false;
 	}
 	return true;
@@ -206,7 +239,7 @@ bool SpectraVisDataUploader::DoWork(void)
 
 int SpectraVisDataUploader::PercentDone(void) const
 {
-	return int((current_row*100)/row_count);
+	return tile_count?int((tiles_done*100)/tile_count):100;
 }
 
 
@@ -234,6 +267,7 @@ SpectraVisualisation::SpectraVisualisation(
  , gl_canvases(std::make_shared<std::set<wxGLCanvas*>>())
  , document(doc)
  , signal_samples_per_grid(1)
+ , buffer_level(0)
 {
 	assert(document);
 	assert(calculator);
@@ -249,6 +283,23 @@ SpectraVisualisation::SpectraVisualisation(
 			signal_samples_per_grid += 2;
 	}
 
+	spectrum_cache = std::make_shared<SpectraSpectrumCache>(
+		document,
+		calculator,
+		signal_samples_per_grid,
+		256,
+		64*1024*1024
+	);
+	// the spectra are stored in the buffer at the finest level
+	// of the cache which fits into the budget, the renderers
+	// fetch only rows which are signal_samples_per_grid apart anyway
+	const std::size_t max_buffer_size = 256*1024*1024;
+	while(
+		(buffer_level+1 < spectrum_cache->LevelCount()) &&
+		(spectrum_cache->RowCount(buffer_level)*
+		spectrum_size*sizeof(GLfloat) > max_buffer_size)
+	) ++buffer_level;
+
 	assert(gl_canvases);
 	gl_canvases->insert(canvas);
 
@@ -256,8 +307,8 @@ SpectraVisualisation::SpectraVisualisation(
 		std::make_shared<SpectraVisDataUploader>(
 			&gl_context,
 			gl_canvases,
-			calculator,
-			document,
+			spectrum_cache,
+			buffer_level,
 			spectrum_data
 		)
 	);
@@ -329,6 +380,12 @@ std::size_t SpectraVisualisation::SignalSamplesPerGrid(void) const
 	return Document().SamplesPerSecond();
 }
 
+float SpectraVisualisation::SpectrumRowsPerGrid(void) const
+{
+	return float(Document().SamplesPerSecond())/
+		float(spectrum_cache->RowStride(buffer_level));
+}
+
 std::size_t SpectraVisualisation::SignalSamplesPerGridPatch(void) const
 {
 	return signal_samples_per_grid;
@@ -339,9 +396,18 @@ std::size_t SpectraVisualisation::GridSamples(void) const
 	return SignalSamplesPerGrid() / SignalSamplesPerGridPatch();
 }
 
+void SpectraVisualisation::FocusUploader(float time)
+{
+	std::shared_ptr<SpectraVisDataUploader> data_uploader(
+		uploader_ref.lock()
+	);
+	if(data_uploader) data_uploader->Focus(time);
+}
+
 void SpectraVisualisation::SelectedTime(float time)
 {
 	selected_time = time;
+	FocusUploader(time);
 }
 
 float SpectraVisualisation::SelectedTime(void) const
@@ -371,6 +437,7 @@ void SpectraVisualisation::DragSelection(float time, float delta)
 		selection_begin = 0.0f;
 	if(selection_end > Document().MaxTime())
 		selection_end = Document().MaxTime();
+	FocusUploader(selection_begin);
 }
 
 float SpectraVisualisation::SelectionBegin(void) const
@@ -19,6 +19,7 @@
 #include "spectra_app.hpp"
 #include "document.hpp"
 #include "calculator.hpp"
+#include "spectrum_cache.hpp"
 
 #include <wx/wx.h>
 #include <wx/glcanvas.h>
@@ -57,7 +58,12 @@ private:
 	std::size_t spectrum_size;
 	std::size_t signal_samples_per_grid;
 
+	std::shared_ptr<SpectraSpectrumCache> spectrum_cache;
+	unsigned buffer_level;
+
 	std::weak_ptr<SpectraVisDataUploader> uploader_ref;
+
+	void FocusUploader(float time);
 public:
 	SpectraVisualisation(
 		SpectraMainFrame* frame,
@@ -87,6 +93,8 @@ public:
 
 	std::size_t SignalSamplesPerGrid(void) const;
 
+	float SpectrumRowsPerGrid(void) const;
+
 	std::size_t SignalSamplesPerGridPatch(void) const;
 
 	std::size_t GridSamples(void) const;
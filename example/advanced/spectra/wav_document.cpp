@@ -0,0 +1,494 @@
+/*
+ *  .file advanced/spectra/wav_document.cpp
+ *  .brief Implements a document class streaming from memory-mapped WAV files
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2012-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#include <oalplus/al.hpp>
+#include <oalplus/device.hpp>
+#include <oalplus/context.hpp>
+#include <oalplus/listener.hpp>
+#include <oalplus/source.hpp>
+#include <oalplus/buffer.hpp>
+#include <oalplus/data_format.hpp>
+
+#include <oglplus/auxiliary/mapped_file.hpp>
+
+#include "wav_document.hpp"
+
+#include <vector>
+#include <string>
+#include <limits>
+#include <stdexcept>
+#include <algorithm>
+#include <cstring>
+#include <cassert>
+
+#if OGLPLUS_OPENAL_FOUND
+
+// The sample encodings supported by the WAV document.
+// The samples are always little-endian and are assembled from
+// individual bytes, so the conversions work on any host; the loops
+// below have a fixed stride and no branches so that the compiler
+// can vectorize them.
+struct SpectraPCMUInt8
+{
+	enum { Size = 1 };
+
+	static float Get(const unsigned char* p)
+	{
+		return (float(p[0])-128.0f)*(1.0f/128.0f);
+	}
+};
+
+struct SpectraPCMInt16
+{
+	enum { Size = 2 };
+
+	static float Get(const unsigned char* p)
+	{
+		return float(short(p[0] | (p[1] << 8)))*(1.0f/32768.0f);
+	}
+};
+
+struct SpectraPCMInt24
+{
+	enum { Size = 3 };
+
+	static float Get(const unsigned char* p)
+	{
+		int v = int(
+			(unsigned(p[0]) <<  8)|
+			(unsigned(p[1]) << 16)|
+			(unsigned(p[2]) << 24)
+		);
+		return float(v)*(1.0f/2147483648.0f);
+	}
+};
+
+struct SpectraPCMInt32
+{
+	enum { Size = 4 };
+
+	static float Get(const unsigned char* p)
+	{
+		int v = int(
+			(unsigned(p[0]) <<  0)|
+			(unsigned(p[1]) <<  8)|
+			(unsigned(p[2]) << 16)|
+			(unsigned(p[3]) << 24)
+		);
+		return float(v)*(1.0f/2147483648.0f);
+	}
+};
+
+struct SpectraPCMFloat32
+{
+	enum { Size = 4 };
+
+	static float Get(const unsigned char* p)
+	{
+		unsigned bits =
+			(unsigned(p[0]) <<  0)|
+			(unsigned(p[1]) <<  8)|
+			(unsigned(p[2]) << 16)|
+			(unsigned(p[3]) << 24);
+		float v;
+		std::memcpy(&v, &bits, sizeof(v));
+		return v;
+	}
+};
+
+// Converts count frames of interleaved samples into mono floats
+template <typename Sample>
+static void SpectraConvertPCM(
+	const unsigned char* src,
+	unsigned channels,
+	float* dst,
+	std::size_t count
+)
+{
+	const std::size_t s = Sample::Size;
+	if(channels == 1)
+	{
+		for(std::size_t i=0; i!=count; ++i)
+			dst[i] = Sample::Get(src+i*s);
+	}
+	else if(channels == 2)
+	{
+		for(std::size_t i=0; i!=count; ++i)
+		{
+			dst[i] = 0.5f*(
+				Sample::Get(src+i*2*s)+
+				Sample::Get(src+i*2*s+s)
+			);
+		}
+	}
+	else
+	{
+		const float norm = 1.0f/channels;
+		const std::size_t fs = s*channels;
+		for(std::size_t i=0; i!=count; ++i)
+		{
+			float sum = 0.0f;
+			for(unsigned c=0; c!=channels; ++c)
+				sum += Sample::Get(src+i*fs+c*s);
+			dst[i] = sum*norm;
+		}
+	}
+}
+
+class SpectraWAVDocument
+ : public SpectraDocument
+{
+private:
+	const wxString file_path;
+	// the whole file is mapped, the OS pages in only the parts
+	// of it which are actually read and can drop them at any time
+	oglplus::aux::MappedFile wav_file;
+
+	enum class Encoding { UInt8, Int16, Int24, Int32, Float32 };
+	Encoding encoding;
+	unsigned channels;
+	std::size_t frame_size;
+	std::size_t frequency;
+
+	const unsigned char* pcm_data;
+	std::size_t frame_count;
+
+	oalplus::Device device;
+	oalplus::CurrentContext context;
+	oalplus::Listener listener;
+	oalplus::Buffer sound_buf;
+	oalplus::Source sound_src;
+	// used only if the samples cannot be played directly
+	std::vector<short> play_buf;
+
+	static unsigned Read16(const unsigned char* p)
+	{
+		return unsigned(p[0]) | (unsigned(p[1]) << 8);
+	}
+
+	static std::size_t Read32(const unsigned char* p)
+	{
+		return	(std::size_t(p[0]) <<  0)|
+			(std::size_t(p[1]) <<  8)|
+			(std::size_t(p[2]) << 16)|
+			(std::size_t(p[3]) << 24);
+	}
+
+	void ParseHeader(void);
+
+	void ConvertFrames(float* dst, std::size_t start, std::size_t count) const;
+public:
+	SpectraWAVDocument(const wxString& path);
+
+	bool FinishLoading(void);
+
+	int PercentLoaded(void) const;
+
+	std::size_t SamplesPerSecond(void) const;
+
+	std::size_t SignalSampleCount(void) const;
+
+	float MaxTime(void) const;
+
+	wxString Name(void) const;
+
+	std::size_t QuerySignalSamples(
+		float* buffer,
+		std::size_t bufsize,
+		std::size_t start,
+		std::size_t end
+	);
+
+	bool CanPlay(void) const;
+
+	void Play(float from, float to);
+};
+
+SpectraWAVDocument::SpectraWAVDocument(const wxString& path)
+ : file_path(path)
+ , wav_file(std::string((const char*)path.mb_str(wxConvUTF8)))
+ , encoding(Encoding::Int16)
+ , channels(1)
+ , frame_size(2)
+ , frequency(0)
+ , pcm_data(nullptr)
+ , frame_count(0)
+ , device()
+ , context(device)
+{
+	ParseHeader();
+
+	listener.Position(0.0f, 0.0f, 0.0f);
+	listener.Velocity(0.0f, 0.0f, 0.0f);
+	listener.Orientation(0.0f, 0.0f,-1.0f, 0.0f, 1.0f, 0.0f);
+
+	sound_src.Position(0.0f, 0.0f,-1.0f);
+}
+
+void SpectraWAVDocument::ParseHeader(void)
+{
+	const unsigned char* data = wav_file.Data();
+	const std::size_t size = wav_file.Size();
+
+	if(
+		(size < 12) ||
+		(std::memcmp(data+0, "RIFF", 4) != 0) ||
+		(std::memcmp(data+8, "WAVE", 4) != 0)
+	) throw std::runtime_error("Not a RIFF/WAVE file");
+
+	unsigned format_tag = 0;
+	unsigned bits = 0;
+	std::size_t block_align = 0;
+	std::size_t data_size = 0;
+
+	std::size_t offset = 12;
+	while(offset+8 <= size)
+	{
+		const unsigned char* chunk = data+offset;
+		std::size_t chunk_size = Read32(chunk+4);
+		offset += 8;
+
+		// captures which were not finished properly may have
+		// a wrong size of the chunk, use what is in the file
+		if(chunk_size > size-offset)
+			chunk_size = size-offset;
+
+		if(std::memcmp(chunk, "fmt ", 4) == 0)
+		{
+			if(chunk_size < 16)
+				throw std::runtime_error("Invalid WAV format chunk");
+			const unsigned char* fmt = data+offset;
+			format_tag = Read16(fmt+0);
+			channels = Read16(fmt+2);
+			frequency = Read32(fmt+4);
+			block_align = Read16(fmt+12);
+			bits = Read16(fmt+14);
+			// WAVE_FORMAT_EXTENSIBLE has the real format
+			// in the first two bytes of the sub-format GUID
+			if((format_tag == 0xFFFE) && (chunk_size >= 40))
+				format_tag = Read16(fmt+24);
+		}
+		else if(std::memcmp(chunk, "data", 4) == 0)
+		{
+			pcm_data = data+offset;
+			data_size = chunk_size;
+		}
+		offset += chunk_size + (chunk_size & 1);
+	}
+
+	if(!pcm_data || (format_tag == 0))
+		throw std::runtime_error("Missing WAV format or data chunk");
+	if((channels == 0) || (frequency == 0) || (block_align % channels))
+		throw std::runtime_error("Invalid WAV format");
+
+	frame_size = block_align;
+	const std::size_t sample_size = block_align / channels;
+
+	if((format_tag == 1) && (sample_size == 1))
+		encoding = Encoding::UInt8;
+	else if((format_tag == 1) && (sample_size == 2))
+		encoding = Encoding::Int16;
+	else if((format_tag == 1) && (sample_size == 3))
+		encoding = Encoding::Int24;
+	else if((format_tag == 1) && (sample_size == 4))
+		encoding = Encoding::Int32;
+	else if((format_tag == 3) && (sample_size == 4) && (bits == 32))
+		encoding = Encoding::Float32;
+	else throw std::runtime_error("Unsupported WAV sample encoding");
+
+	frame_count = data_size / frame_size;
+}
+
+void SpectraWAVDocument::ConvertFrames(
+	float* dst,
+	std::size_t start,
+	std::size_t count
+) const
+{
+	const unsigned char* src = pcm_data+start*frame_size;
+	switch(encoding)
+	{
+		case Encoding::UInt8:
+			SpectraConvertPCM<SpectraPCMUInt8>(src, channels, dst, count);
+			break;
+		case Encoding::Int16:
+			SpectraConvertPCM<SpectraPCMInt16>(src, channels, dst, count);
+			break;
+		case Encoding::Int24:
+			SpectraConvertPCM<SpectraPCMInt24>(src, channels, dst, count);
+			break;
+		case Encoding::Int32:
+			SpectraConvertPCM<SpectraPCMInt32>(src, channels, dst, count);
+			break;
+		case Encoding::Float32:
+			SpectraConvertPCM<SpectraPCMFloat32>(src, channels, dst, count);
+			break;
+	}
+}
+
+bool SpectraWAVDocument::FinishLoading(void)
+{
+	// there is nothing more to load, the samples are converted
+	// from the mapped file when they are queried, so the spectra
+	// start appearing without waiting for the whole file
+	return true;
+}
+
+int SpectraWAVDocument::PercentLoaded(void) const
+{
+	return 100;
+}
+
+std::size_t SpectraWAVDocument::SamplesPerSecond(void) const
+{
+	return frequency;
+}
+
+std::size_t SpectraWAVDocument::SignalSampleCount(void) const
+{
+	return frame_count;
+}
+
+float SpectraWAVDocument::MaxTime(void) const
+{
+	return float(frame_count)/float(frequency);
+}
+
+wxString SpectraWAVDocument::Name(void) const
+{
+	return file_path;
+}
+
+std::size_t SpectraWAVDocument::QuerySignalSamples(
+	float* buffer,
+	std::size_t bufsize,
+	std::size_t start,
+	std::size_t end
+)
+{
+	assert(bufsize >= end-start);
+
+	std::size_t n = end;
+	if(n > frame_count)
+		n = frame_count;
+	if(n < start)
+		n = 0;
+	else n -= start;
+
+	ConvertFrames(buffer, start, n);
+	std::fill(buffer+n, buffer+(end-start), 0.0f);
+	return n;
+}
+
+bool SpectraWAVDocument::CanPlay(void) const
+{
+	return true;
+}
+
+void SpectraWAVDocument::Play(float from, float to)
+{
+	if(from < 0.0f) from = 0.0f;
+	if(from >= to) return;
+
+	std::size_t begin = std::size_t(frequency*from);
+	std::size_t end = std::size_t(frequency*to);
+	if(end > frame_count)
+		end = frame_count;
+
+	// OpenAL takes the size of the data as ALsizei
+	const std::size_t max_frames =
+		std::size_t(std::numeric_limits<ALsizei>::max())/
+		(frame_size > 2?frame_size:2);
+	if(end-begin > max_frames)
+		end = begin+max_frames;
+	if(begin >= end) return;
+
+	context.MakeCurrent();
+	sound_src.DetachBuffers();
+
+	// 8 and 16-bit mono and stereo samples are played directly
+	// from the mapped file, the rest is converted to 16-bit mono
+	bool direct = (channels <= 2) && (
+		(encoding == Encoding::UInt8) ||
+		(encoding == Encoding::Int16)
+	);
+	if(direct)
+	{
+		oalplus::DataFormat format = (encoding == Encoding::UInt8)?
+			((channels == 1)?
+				oalplus::DataFormat::Mono8:
+				oalplus::DataFormat::Stereo8
+			):
+			((channels == 1)?
+				oalplus::DataFormat::Mono16:
+				oalplus::DataFormat::Stereo16
+			);
+		sound_buf.Data(
+			format,
+			pcm_data+begin*frame_size,
+			ALsizei((end-begin)*frame_size),
+			ALsizei(frequency)
+		);
+	}
+	else
+	{
+		const std::size_t block = 4096;
+		std::vector<float> tmp(block);
+		play_buf.resize(end-begin);
+		for(std::size_t b=begin; b<end; b+=block)
+		{
+			std::size_t n = std::min(block, end-b);
+			ConvertFrames(tmp.data(), b, n);
+			short* dst = play_buf.data()+(b-begin);
+			for(std::size_t i=0; i!=n; ++i)
+			{
+				float v = std::min(std::max(tmp[i], -1.0f), 1.0f);
+				dst[i] = short(v*32767.0f);
+			}
+		}
+		sound_buf.Data(
+			oalplus::DataFormat::Mono16,
+			play_buf.data(),
+			ALsizei(play_buf.size()*sizeof(short)),
+			ALsizei(frequency)
+		);
+	}
+	sound_src.Buffer(sound_buf);
+	sound_src.Play();
+}
+
+bool SpectraIsWAVFile(const wxString& file_path)
+{
+	return file_path.Lower().EndsWith(wxT(".wav"));
+}
+
+std::shared_ptr<SpectraDocument> SpectraOpenWAVDoc(
+	const wxString& file_path
+)
+{
+	return std::make_shared<SpectraWAVDocument>(file_path);
+}
+
+#else
+
+bool SpectraIsWAVFile(const wxString& /*file_path*/)
+{
+	return false;
+}
+
+std::shared_ptr<SpectraDocument> SpectraOpenWAVDoc(
+	const wxString& /*file_path*/
+)
+{
+	throw std::runtime_error("WAV documents not supported");
+	return std::shared_ptr<SpectraDocument>();
+}
+
+#endif
@@ -0,0 +1,28 @@
+/*
+ *  .file advanced/spectra/wav_document.hpp
+ *  .brief Declares a document class streaming from memory-mapped WAV files
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2012-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#ifndef OGLPLUS_EXAMPLE_SPECTRA_WAV_DOCUMENT_HPP
+#define OGLPLUS_EXAMPLE_SPECTRA_WAV_DOCUMENT_HPP
+
+#include "document.hpp"
+
+#include <wx/string.h>
+
+#include <memory>
+#include <cstddef>
+
+extern bool SpectraIsWAVFile(const wxString& file_path);
+
+extern std::shared_ptr<SpectraDocument> SpectraOpenWAVDoc(
+	const wxString& file_path
+);
+
+#endif // include guard
@@ -32,7 +32,7 @@ private:
 	oglplus::OptionalUniform<oglplus::Mat4f> xsection_transf_matrix;
 	oglplus::OptionalUniform<GLint> xsection_spectrum_tex;
 	oglplus::OptionalUniform<GLint> xsection_spectrum_size;
-	oglplus::OptionalUniform<GLint> xsection_samples_per_unit;
+	oglplus::OptionalUniform<GLfloat> xsection_rows_per_unit;
 	oglplus::OptionalUniform<GLfloat> xsection_selected_time;
 
 	const oglplus::shapes::ShapeWrapper& spectrum_plane_wrap;
@@ -83,7 +83,7 @@ SpectraXSectionRenderer::SpectraXSectionRenderer(
  , xsection_transf_matrix(xsection_prog, "TransfMatrix")
  , xsection_spectrum_tex(xsection_prog, "SpectrumTex")
  , xsection_spectrum_size(xsection_prog, "SpectrumSize")
- , xsection_samples_per_unit(xsection_prog, "SamplesPerUnit")
+ , xsection_rows_per_unit(xsection_prog, "RowsPerUnit")
  , xsection_selected_time(xsection_prog, "SelectedTime")
  , spectrum_plane_wrap(
 	Common().SpectrumPlane(
@@ -133,7 +133,7 @@ void SpectraXSectionRenderer::RenderSpectrum(SpectraDocumentView& view)
 	DocVis().SpectrumTex().Bind(oglplus::Texture::Target::Buffer);
 	xsection_spectrum_tex.TrySet(0);
 	xsection_spectrum_size.TrySet(DocVis().SignalSpectrumSize());
-	xsection_samples_per_unit.TrySet(DocVis().SignalSamplesPerGrid());
+	xsection_rows_per_unit.TrySet(DocVis().SpectrumRowsPerGrid());
 	xsection_selected_time.TrySet(DocVis().SelectedTime());
 
 
@@ -0,0 +1,96 @@
+/**
+ *  @example oalplus/003_streaming.cpp
+ *  @brief Shows how to play a long sound with a StreamingSource
+ *
+ *  Copyright 2008-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ *
+ *  @oalplus_example_uses_cxx11{THREADS}
+ *  @oalplus_example_uses_cxx11{CHRONO}
+ */
+
+#include <oalplus/al.hpp>
+#include <oalplus/all.hpp>
+#include <oalplus/streaming_source.hpp>
+
+#include <iostream>
+#include <chrono>
+#include <thread>
+#include <cmath>
+
+// synthesizes a slowly sweeping tone, sample by sample
+class SweepDecoder
+ : public oalplus::StreamingSourceDecoder
+{
+private:
+	const ALsizei _frequency;
+	const std::size_t _sample_count;
+	std::size_t _position;
+	double _phase;
+public:
+	SweepDecoder(ALsizei frequency, double seconds)
+	 : _frequency(frequency)
+	 , _sample_count(std::size_t(frequency*seconds))
+	 , _position(0)
+	 , _phase(0.0)
+	{ }
+
+	oalplus::DataFormat Format(void) const
+	{
+		return oalplus::DataFormat::Mono16;
+	}
+
+	ALsizei Frequency(void) const
+	{
+		return _frequency;
+	}
+
+	std::size_t Decode(ALubyte* buffer, std::size_t size)
+	{
+		const double pi = 3.14159265358979;
+		std::size_t n = size / 2;
+		if(n > _sample_count - _position)
+			n = _sample_count - _position;
+		for(std::size_t i=0; i!=n; ++i, ++_position)
+		{
+			double t = double(_position)/_frequency;
+			_phase += 2.0*pi*(220.0+110.0*std::sin(t))/_frequency;
+			ALshort s = ALshort(std::sin(_phase)*8000.0);
+			buffer[i*2+0] = ALubyte(s & 0xFF);
+			buffer[i*2+1] = ALubyte((s >> 8) & 0xFF);
+		}
+		return n*2;
+	}
+};
+
+int main(void)
+{
+	// open the default device
+	oalplus::Device device;
+	// create a context using the device and make it current
+	oalplus::CurrentContext context(device);
+	// create a listener and set its position, velocity and orientation
+	oalplus::Listener listener;
+	listener.Position(0.0f, 0.0f, 0.0f);
+	listener.Velocity(0.0f, 0.0f, 0.0f);
+	listener.Orientation(0.0f, 0.0f,-1.0f, 0.0f, 1.0f, 0.0f);
+	// a minute of sound played through four 8KB buffers
+	oalplus::StreamingSource stream(
+		std::unique_ptr<oalplus::StreamingSourceDecoder>(
+			new SweepDecoder(22050, 60.0)
+		), 4, 8*1024
+	);
+	stream.Source().Position(0.0f, 0.0f,-1.0f);
+	stream.Play();
+	// keep refilling the buffers until the whole sound is played
+	while(!stream.Finished())
+	{
+		stream.Update();
+		std::chrono::milliseconds duration(20);
+		std::this_thread::sleep_for(duration);
+	}
+	std::cout << "Underruns: " << stream.Underruns() << std::endl;
+	//
+	return 0;
+}
@@ -14,6 +14,7 @@
 #include <oglplus/gl.hpp>
 #include <oglplus/all.hpp>
 #include <oglplus/opt/list_init.hpp>
+#include <oglplus/depth_sort.hpp>
 
 #include <vector>
 #include <algorithm>
@@ -167,6 +168,9 @@ private:
 
 	std::vector<Vec3f> positions;
 	std::vector<float> ages;
+
+	// Sorts the particles back to front
+	DepthSorter depth_sorter;
 public:
 	SmokeExample(void)
 	 : emitters()
@@ -341,24 +345,9 @@ public:
 			Degrees(SineWave(clock.Now().Seconds() / 20.0) * 60)
 		);
 
-		std::vector<float> depths(positions.size());
-		std::vector<GLuint> indices(positions.size());
-		// calculate the depths of the particles
-		for(GLuint i=0, n=positions.size(); i!=n; ++i)
-		{
-			depths[i] = (cameraMatrix * Vec4f(positions[i], 1.0)).z();
-			indices[i] = i;
-		}
-
-		// sort the indices by the depths
-		std::sort(
-			indices.begin(),
-			indices.end(),
-			[&depths](GLuint i, GLuint j)
-			{
-				return depths[i] < depths[j];
-			}
-		);
+		// sort the indices of the particles by the depths
+		const std::vector<GLuint>& indices =
+			depth_sorter.SortPoints(cameraMatrix, positions);
 
 		// upload the particle positions
 		pos_buf.Bind(Buffer::Target::Array);
@@ -27,6 +27,7 @@
 
 #include <oglplus/config.hpp>
 #include <oglplus/curve.hpp>
+#include <oglplus/cpu_trace.hpp>
 
 #include <eglplus/all.hpp>
 
@@ -37,6 +38,7 @@
 #include <iostream>
 #include <iomanip>
 #include <cstring>
+#include <cstdlib>
 #include <cassert>
 
 #include <thread>
@@ -45,6 +47,8 @@
 
 #include "example.hpp"
 #include "example_main.hpp"
+#include "example_capture.hpp"
+#include "example_benchmark.hpp"
 
 namespace oglplus {
 
@@ -243,8 +247,12 @@ void run_framedump_loop(
 
 	double t = 0.0;
 	double period = 1.0 / 25.0;
-	GLuint frame_no = 0;
-	std::vector<char> pixels(width * height * 4);
+
+	FrameCapture capture(
+		width,
+		height,
+		ExampleFramedumpWriter(framedump_prefix)
+	);
 
 	GLuint border = 32;
 
@@ -289,39 +297,10 @@ void run_framedump_loop(
 		clock.Update(t);
 		if(!example->Continue(clock)) break;
 		example->Render(clock);
-		glFinish();
-		glReadPixels(
-			0, 0,
-			width,
-			height,
-			GL_RGBA,
-			GL_UNSIGNED_BYTE,
-			pixels.data()
-		);
-		glFinish();
+		if(!capture.Capture()) break;
 		surface.SwapBuffers();
-		std::stringstream filename;
-		filename <<
-			framedump_prefix <<
-			std::setfill('0') << std::setw(6) <<
-			frame_no << ".rgba";
-		{
-			std::ofstream file(filename.str());
-			file.write(pixels.data(), pixels.size());
-			file.flush();
-		}
-		std::cout << filename.str() << std::endl;
-		++frame_no;
-
-		txtbuf.resize(filename.str().size()+1);
-		std::cin.getline(txtbuf.data(), txtbuf.size());
-
-		if(std::strncmp(
-			filename.str().c_str(),
-			txtbuf.data(),
-			txtbuf.size()
-		) != 0) break;
 	}
+	capture.Finish();
 }
 
 void make_screenshot(
@@ -348,27 +327,90 @@ void make_screenshot(
 		if(s < t) surface.SwapBuffers();
 		else break;
 	}
-	glFinish();
 	//save it to a file
-	std::vector<char> pixels(width * height * 3);
-	glReadPixels(
-		0, 0,
+	FrameCapture capture(
 		width,
 		height,
-		GL_RGB,
-		GL_UNSIGNED_BYTE,
-		pixels.data()
+		ExampleScreenshotWriter(screenshot_path),
+		PixelDataFormat::RGB,
+		1
 	);
-	std::ofstream output(screenshot_path);
-	output.write(pixels.data(), pixels.size());
+	capture.Capture();
+	capture.Finish();
 	surface.SwapBuffers();
 }
 
 
+void run_benchmark_loop(
+	eglplus::Surface& surface,
+	std::unique_ptr<Example>& example,
+	ExampleClock& clock,
+	GLuint width,
+	GLuint height,
+	const char* example_name,
+	const char* benchmark_path,
+	GLuint frame_count
+)
+{
+	const double dt = example->FrameTime();
+
+	clock.Update(0.0);
+
+	// heat-up, not measured
+	for(GLuint f=0; f!=example->HeatUpFrames(); ++f)
+	{
+		clock.Advance(dt);
+		if(!example->Continue(clock)) break;
+		example->Render(clock);
+		surface.SwapBuffers();
+	}
+
+	ExampleBenchmark benchmark;
+	for(GLuint f=0; f!=frame_count; ++f)
+	{
+		clock.Advance(dt);
+		if(!example->Continue(clock)) break;
+		benchmark.BeginFrame();
+		example->Render(clock);
+		benchmark.EndRender();
+		surface.SwapBuffers();
+		benchmark.EndFrame();
+	}
+	benchmark.Finish();
+
+	const char* base_name = std::strrchr(example_name, '/');
+	std::ofstream output(benchmark_path);
+	benchmark.WriteJSON(
+		output,
+		base_name?base_name+1:example_name,
+		width,
+		height,
+		dt
+	);
+	if(!output.good())
+	{
+		throw std::runtime_error(
+			std::string("Failed to write '")+
+			benchmark_path+
+			std::string("'")
+		);
+	}
+#if OGLPLUS_CPU_TRACING
+	// the CPU trace of the whole run, including the example setup
+	std::ofstream trace_output(
+		std::string(benchmark_path)+
+		std::string(".cpu_trace.json")
+	);
+	CPUTrace::WriteChromeTrace(trace_output);
+#endif
+}
+
 void run_example(
 	const eglplus::Display& display,
 	const char* screenshot_path,
 	const char* framedump_prefix,
+	const char* benchmark_path,
+	GLuint benchmark_frames,
 	int argc,
 	char ** argv
 )
@@ -544,6 +586,19 @@ void run_example(
 				framedump_prefix
 			);
 		}
+		else if(benchmark_path)
+		{
+			run_benchmark_loop(
+				surface,
+				example,
+				clock,
+				width,
+				height,
+				argv[0],
+				benchmark_path,
+				benchmark_frames
+			);
+		}
 		else assert(!"Never should get here!");
 
 		example_thread_common_data.done = true;
@@ -583,21 +638,35 @@ int egl_example_main(int argc, char ** argv)
 {
 	const char* screenshot_path = nullptr;
 	const char* framedump_prefix = nullptr;
+	const char* benchmark_path = nullptr;
+	GLuint benchmark_frames = 500;
 	if((argc == 3) && (std::strcmp(argv[1], "--screenshot") == 0))
 		screenshot_path = argv[2];
 	if((argc == 3) && (std::strcmp(argv[1], "--frame-dump") == 0))
 		framedump_prefix = argv[2];
+	if((argc >= 3) && (std::strcmp(argv[1], "--benchmark") == 0))
+		benchmark_path = argv[2];
 
-	if(screenshot_path || framedump_prefix)
+	if(screenshot_path || framedump_prefix || benchmark_path)
 	{
-		for(int a=3; a<argc; ++a)
-			argv[a-2] = argv[a];
-		argc -= 2;
+		int skip = 2;
+		if(
+			benchmark_path &&
+			(argc >= 5) &&
+			(std::strcmp(argv[3], "--frames") == 0)
+		)
+		{
+			benchmark_frames = GLuint(std::atoi(argv[4]));
+			skip += 2;
+		}
+		for(int a=1+skip; a<argc; ++a)
+			argv[a-skip] = argv[a];
+		argc -= skip;
 	}
 	else
 	{
 		std::cout <<
-			"--screenshot or --framedump option "
+			"--screenshot, --frame-dump or --benchmark option "
 			"must be specified" <<
 			std::endl;
 		return 1;
@@ -610,6 +679,8 @@ int egl_example_main(int argc, char ** argv)
 		display,
 		screenshot_path,
 		framedump_prefix,
+		benchmark_path,
+		benchmark_frames,
 		argc,
 		argv
 	);
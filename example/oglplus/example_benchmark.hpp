@@ -0,0 +1,255 @@
+/**
+ *  @file oglplus/example_benchmark.hpp
+ *  @brief Implements the frame statistics recorded by the example benchmarks
+ *
+ *  Copyright 2008-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#ifndef __OGLPLUS_EXAMPLE_EXAMPLE_BENCHMARK_1311221000_HPP__
+#define __OGLPLUS_EXAMPLE_EXAMPLE_BENCHMARK_1311221000_HPP__
+
+#include <oglplus/config.hpp>
+#include <oglplus/glfunc.hpp>
+#include <oglplus/query.hpp>
+#include <oglplus/context.hpp>
+#include <oglplus/extension.hpp>
+#include <oglplus/auxiliary/json.hpp>
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <ostream>
+#include <iomanip>
+#include <chrono>
+
+namespace oglplus {
+
+// A series of per-frame measurements and its summary
+class ExampleBenchmarkSeries
+{
+private:
+	std::vector<double> _values;
+public:
+	void Add(double value)
+	{
+		_values.push_back(value);
+	}
+
+	bool Empty(void) const
+	{
+		return _values.empty();
+	}
+
+	// Writes the count, minimum, mean, maximum and the percentiles
+	// (by the nearest-rank method) of the values as a JSON object
+	void WriteJSON(std::ostream& output) const
+	{
+		if(_values.empty())
+		{
+			output << "null";
+			return;
+		}
+		std::vector<double> sorted(_values);
+		std::sort(sorted.begin(), sorted.end());
+
+		double sum = std::accumulate(sorted.begin(), sorted.end(), 0.0);
+
+		struct { const char* name; double rank; } percentiles[] = {
+			{"p50", 0.50},
+			{"p90", 0.90},
+			{"p95", 0.95},
+			{"p99", 0.99}
+		};
+
+		output << "{";
+		output << "\"count\": " << sorted.size() << ", ";
+		output << "\"min\": " << sorted.front() << ", ";
+		output << "\"mean\": " << sum/sorted.size() << ", ";
+		for(auto& p: percentiles)
+		{
+			std::size_t i = std::size_t(std::ceil(p.rank*sorted.size()));
+			if(i > 0) --i;
+			output << "\"" << p.name << "\": " << sorted[i] << ", ";
+		}
+		output << "\"max\": " << sorted.back();
+		output << "}";
+	}
+};
+
+// Records the CPU time, the whole frame time, the number of GL calls
+// and the GPU time (using timer queries if available) of benchmark frames
+class ExampleBenchmark
+{
+private:
+	typedef std::chrono::steady_clock _clock;
+
+	_clock::time_point _frame_start, _render_end;
+	unsigned long _frame_calls;
+
+	ExampleBenchmarkSeries _cpu_ms, _frame_ms, _gpu_ms, _gl_calls;
+
+#if GL_VERSION_3_3 || GL_ARB_timer_query
+	// a ring of queries so that the results are read a couple
+	// of frames later, without waiting for the GPU
+	std::vector<std::unique_ptr<Query>> _queries;
+	std::vector<bool> _pending;
+	std::size_t _current;
+	bool _timer_queries;
+
+	static bool _has_timer_queries(void)
+	{
+		GLint major = context::StringQueries::MajorVersion();
+		GLint minor = context::StringQueries::MinorVersion();
+		if((major > 3) || ((major == 3) && (minor >= 3)))
+			return true;
+		return OGLPLUS_HAS_GL_EXT(ARB, timer_query);
+	}
+
+	void _read_query(std::size_t i)
+	{
+		if(_pending[i])
+		{
+			GLuint64 ns = 0;
+			_queries[i]->WaitForResult(ns);
+			_gpu_ms.Add(double(ns)*1.0e-6);
+			_pending[i] = false;
+		}
+	}
+#endif
+
+	static double _ms(_clock::duration d)
+	{
+		return std::chrono::duration<double, std::milli>(d).count();
+	}
+
+	static unsigned long _calls(void)
+	{
+#if OGLPLUS_COUNT_GLFUNC_CALLS
+		return GLFuncCallCount();
+#else
+		return 0;
+#endif
+	}
+public:
+	ExampleBenchmark(void)
+	 : _frame_calls(0)
+#if GL_VERSION_3_3 || GL_ARB_timer_query
+	 , _queries(4)
+	 , _pending(4, false)
+	 , _current(0)
+	 , _timer_queries(_has_timer_queries())
+#endif
+	{
+#if GL_VERSION_3_3 || GL_ARB_timer_query
+		if(_timer_queries)
+		{
+			for(auto& query: _queries)
+				query.reset(new Query());
+		}
+#endif
+	}
+
+	// Called before the example renders the frame
+	void BeginFrame(void)
+	{
+#if GL_VERSION_3_3 || GL_ARB_timer_query
+		if(_timer_queries)
+		{
+			_read_query(_current);
+			_queries[_current]->Begin(Query::Target::TimeElapsed);
+		}
+#endif
+		_frame_calls = _calls();
+		_frame_start = _clock::now();
+	}
+
+	// Called after the example has rendered the frame
+	void EndRender(void)
+	{
+		_render_end = _clock::now();
+		_gl_calls.Add(double(_calls()-_frame_calls));
+#if GL_VERSION_3_3 || GL_ARB_timer_query
+		if(_timer_queries)
+		{
+			_queries[_current]->End(Query::Target::TimeElapsed);
+			_pending[_current] = true;
+			_current = (_current+1) % _queries.size();
+		}
+#endif
+	}
+
+	// Called after the buffers were swapped
+	void EndFrame(void)
+	{
+		_clock::time_point frame_end = _clock::now();
+		_cpu_ms.Add(_ms(_render_end-_frame_start));
+		_frame_ms.Add(_ms(frame_end-_frame_start));
+	}
+
+	// Collects the results of the remaining queries
+	void Finish(void)
+	{
+#if GL_VERSION_3_3 || GL_ARB_timer_query
+		for(std::size_t i=0; i!=_queries.size(); ++i)
+			_read_query((_current+i) % _queries.size());
+#endif
+	}
+
+	void WriteJSON(
+		std::ostream& output,
+		const std::string& example_name,
+		GLuint width,
+		GLuint height,
+		double frame_time
+	) const
+	{
+		Context gl;
+		output << std::setprecision(6);
+		output << "{" << std::endl;
+		output << "\t\"example\": ";
+		aux::WriteJSONString(output, example_name);
+		output << "," << std::endl;
+		output << "\t\"renderer\": ";
+		aux::WriteJSONString(output, gl.Renderer());
+		output << "," << std::endl;
+		output << "\t\"version\": ";
+		aux::WriteJSONString(output, gl.Version());
+		output << "," << std::endl;
+		output << "\t\"width\": " << width << "," << std::endl;
+		output << "\t\"height\": " << height << "," << std::endl;
+		output << "\t\"frame_time_s\": " << frame_time << "," << std::endl;
+		output << "\t\"cpu_ms\": ";
+		_cpu_ms.WriteJSON(output);
+		output << "," << std::endl;
+		output << "\t\"frame_ms\": ";
+		_frame_ms.WriteJSON(output);
+		output << "," << std::endl;
+		output << "\t\"gpu_ms\": ";
+		_gpu_ms.WriteJSON(output);
+		output << "," << std::endl;
+		output << "\t\"gl_calls\": ";
+		if(OGLPLUS_COUNT_GLFUNC_CALLS) _gl_calls.WriteJSON(output);
+		else output << "null";
+		if(OGLPLUS_COUNT_GLFUNC_CALLS && !GLFuncCallsCountedByLibrary())
+		{
+			// the calls made inside of the separately built library
+			// are missing from the counts
+			output << "," << std::endl;
+			output << "\t\"gl_calls_warning\": ";
+			aux::WriteJSONString(
+				output,
+				"the OGLplus library was built without "
+				"OGLPLUS_COUNT_GLFUNC_CALLS, gl_calls are incomplete"
+			);
+		}
+		output << std::endl << "}" << std::endl;
+	}
+};
+
+} // namespace oglplus
+
+#endif // include guard
@@ -0,0 +1,87 @@
+/**
+ *  @file oglplus/example_capture.hpp
+ *  @brief Implements the frame writers used by the framedump and screenshot
+ *
+ *  Copyright 2008-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#ifndef __OGLPLUS_EXAMPLE_EXAMPLE_CAPTURE_1311211100_HPP__
+#define __OGLPLUS_EXAMPLE_EXAMPLE_CAPTURE_1311211100_HPP__
+
+#include <oglplus/frame_capture.hpp>
+
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <cstring>
+
+namespace oglplus {
+
+// Saves the frames into numbered raw files and passes their names
+// through stdout to the process making the video, which echoes the name
+// back on stdin when it is done with the file
+class ExampleFramedumpWriter
+{
+private:
+	std::string _prefix;
+public:
+	ExampleFramedumpWriter(const char* prefix)
+	 : _prefix(prefix)
+	{ }
+
+	bool operator()(const FrameCapture::Frame& frame) const
+	{
+		std::stringstream filename;
+		filename <<
+			_prefix <<
+			std::setfill('0') << std::setw(6) <<
+			frame.Number() << ".rgba";
+		{
+			std::ofstream file(filename.str());
+			file.write(
+				reinterpret_cast<const char*>(frame.Pixels().data()),
+				std::streamsize(frame.Pixels().size())
+			);
+			file.flush();
+		}
+		std::cout << filename.str() << std::endl;
+
+		std::vector<char> txtbuf(filename.str().size()+1);
+		std::cin.getline(txtbuf.data(), txtbuf.size());
+
+		return std::strncmp(
+			filename.str().c_str(),
+			txtbuf.data(),
+			txtbuf.size()
+		) == 0;
+	}
+};
+
+// Saves a single frame into a raw file
+class ExampleScreenshotWriter
+{
+private:
+	std::string _path;
+public:
+	ExampleScreenshotWriter(const char* path)
+	 : _path(path)
+	{ }
+
+	bool operator()(const FrameCapture::Frame& frame) const
+	{
+		std::ofstream output(_path);
+		output.write(
+			reinterpret_cast<const char*>(frame.Pixels().data()),
+			std::streamsize(frame.Pixels().size())
+		);
+		return true;
+	}
+};
+
+} // namespace oglplus
+
+#endif // include guard
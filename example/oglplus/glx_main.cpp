@@ -45,6 +45,7 @@
 
 #include "example.hpp"
 #include "example_main.hpp"
+#include "example_capture.hpp"
 
 namespace oglplus {
 
@@ -365,8 +366,12 @@ void run_framedump_loop(
 
 	double t = 0.0;
 	double period = 1.0 / 25.0;
-	GLuint frame_no = 0;
-	std::vector<char> pixels(width * height * 4);
+
+	FrameCapture capture(
+		width,
+		height,
+		ExampleFramedumpWriter(framedump_prefix)
+	);
 
 	GLuint border = 32;
 
@@ -415,39 +420,10 @@ void run_framedump_loop(
 		clock.Update(t);
 		if(!example->Continue(clock)) break;
 		example->Render(clock);
-		glFinish();
-		glReadPixels(
-			0, 0,
-			width,
-			height,
-			GL_RGBA,
-			GL_UNSIGNED_BYTE,
-			pixels.data()
-		);
-		glFinish();
+		if(!capture.Capture()) break;
 		ctx.SwapBuffers(win);
-		std::stringstream filename;
-		filename <<
-			framedump_prefix <<
-			std::setfill('0') << std::setw(6) <<
-			frame_no << ".rgba";
-		{
-			std::ofstream file(filename.str());
-			file.write(pixels.data(), pixels.size());
-			file.flush();
-		}
-		std::cout << filename.str() << std::endl;
-		++frame_no;
-
-		txtbuf.resize(filename.str().size()+1);
-		std::cin.getline(txtbuf.data(), txtbuf.size());
-
-		if(std::strncmp(
-			filename.str().c_str(),
-			txtbuf.data(),
-			txtbuf.size()
-		) != 0) break;
 	}
+	capture.Finish();
 	while(display.NextEvent(event));
 }
 
@@ -481,19 +457,16 @@ void make_screenshot(
 		else break;
 	}
 	while(display.NextEvent(event));
-	glFinish();
 	//save it to a file
-	std::vector<char> pixels(width * height * 3);
-	glReadPixels(
-		0, 0,
+	FrameCapture capture(
 		width,
 		height,
-		GL_RGB,
-		GL_UNSIGNED_BYTE,
-		pixels.data()
+		ExampleScreenshotWriter(screenshot_path),
+		PixelDataFormat::RGB,
+		1
 	);
-	std::ofstream output(screenshot_path);
-	output.write(pixels.data(), pixels.size());
+	capture.Capture();
+	capture.Finish();
 	ctx.SwapBuffers(win);
 }
 
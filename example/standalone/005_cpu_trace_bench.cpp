@@ -0,0 +1,148 @@
+/**
+ *  @example standalone/005_cpu_trace_bench.cpp
+ *  @brief Measures the overhead of the CPUTrace scope instrumentation
+ *
+ *  Measures the time per traced scope when the recording is enabled
+ *  and disabled, the time of a single read of the CPUTrace timestamp,
+ *  the throughput of several threads recording concurrently and
+ *  the time it takes to write a full ring buffer as a Chrome trace:
+ *  @code
+ *  ./005_cpu_trace_bench [iterations [threads]]
+ *  @endcode
+ *
+ *  Copyright 2008-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+#ifndef OGLPLUS_CPU_TRACING
+#define OGLPLUS_CPU_TRACING 1
+#endif
+
+#include <oglplus/cpu_trace.hpp>
+
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <cstdlib>
+
+typedef std::chrono::high_resolution_clock bench_clock;
+
+double nanoseconds_since(bench_clock::time_point start)
+{
+	return std::chrono::duration<double, std::nano>(
+		bench_clock::now()-start
+	).count();
+}
+
+// the calls are not inlined so that the loops are not optimized away
+// and the overhead of the scope is the only difference between them
+#if defined(__GNUC__)
+#define BENCH_NOINLINE __attribute__((noinline))
+#elif defined(_MSC_VER)
+#define BENCH_NOINLINE __declspec(noinline)
+#else
+#define BENCH_NOINLINE
+#endif
+
+BENCH_NOINLINE void plain_call(volatile unsigned& sink, unsigned i)
+{
+	sink += i;
+}
+
+BENCH_NOINLINE void traced_call(volatile unsigned& sink, unsigned i)
+{
+	OGLPLUS_CPU_TRACE_SCOPE("Bench::TracedCall");
+	sink += i;
+}
+
+double plain_calls(unsigned iterations)
+{
+	volatile unsigned sink = 0;
+	auto start = bench_clock::now();
+	for(unsigned i=0; i!=iterations; ++i)
+		plain_call(sink, i);
+	return nanoseconds_since(start)/iterations;
+}
+
+double traced_calls(unsigned iterations)
+{
+	volatile unsigned sink = 0;
+	auto start = bench_clock::now();
+	for(unsigned i=0; i!=iterations; ++i)
+		traced_call(sink, i);
+	return nanoseconds_since(start)/iterations;
+}
+
+double timestamp_reads(unsigned iterations)
+{
+	volatile oglplus::CPUTrace::Ticks sink = 0;
+	auto start = bench_clock::now();
+	for(unsigned i=0; i!=iterations; ++i)
+		sink += oglplus::CPUTrace::Now();
+	return nanoseconds_since(start)/iterations;
+}
+
+void report(const char* name, double ns, double base_ns)
+{
+	std::cout
+		<< name << ": "
+		<< ns << " ns/call ("
+		<< ns-base_ns << " ns over a plain call)"
+		<< std::endl;
+}
+
+int main(int argc, const char** argv)
+{
+	using namespace oglplus;
+
+	unsigned iterations = (argc > 1)?unsigned(std::atoi(argv[1])):20000000;
+	unsigned thread_count = (argc > 2)?unsigned(std::atoi(argv[2])):4;
+
+	// the first scope of the thread allocates its ring buffer
+	{
+		volatile unsigned sink = 0;
+		traced_call(sink, 0);
+	}
+
+	double base = plain_calls(iterations);
+	std::cout << "Plain call: " << base << " ns/call" << std::endl;
+
+	std::cout << "Timestamp read: "
+		<< timestamp_reads(iterations) << " ns/read"
+		<< std::endl;
+
+	report("Traced scope, enabled", traced_calls(iterations), base);
+
+	CPUTrace::Enable(false);
+	report("Traced scope, disabled", traced_calls(iterations), base);
+	CPUTrace::Enable(true);
+
+	std::vector<std::thread> threads;
+	auto start = bench_clock::now();
+	for(unsigned t=0; t!=thread_count; ++t)
+		threads.push_back(std::thread(traced_calls, iterations));
+	for(unsigned t=0; t!=thread_count; ++t)
+		threads[t].join();
+	std::cout
+		<< "Traced scopes in " << thread_count << " threads: "
+		<< double(thread_count)*iterations/
+			nanoseconds_since(start)*1.0e3
+		<< " M scopes/s"
+		<< std::endl;
+
+	// the ring buffers of all threads are full at this point
+	// unless the number of iterations is very small
+	std::ostringstream output;
+	start = bench_clock::now();
+	CPUTrace::WriteChromeTrace(output);
+	std::cout
+		<< "Wrote the trace of " << thread_count+1 << " threads ("
+		<< output.str().size()/1024 << " KiB) in "
+		<< nanoseconds_since(start)*1.0e-6 << " ms"
+		<< std::endl;
+
+	return 0;
+}
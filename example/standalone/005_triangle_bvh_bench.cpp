@@ -0,0 +1,180 @@
+/**
+ *  @example standalone/005_triangle_bvh_bench.cpp
+ *  @brief Measures the ray casting throughput of shapes::TriangleBVH
+ *
+ *  Builds a bounding volume hierarchy over a height-field mesh with
+ *  (by default) about one million triangles and measures the number
+ *  of rays per second for coherent (camera) and incoherent (random)
+ *  rays, with single-ray queries, batches of single rays and batches
+ *  traversed in packets:
+ *  @code
+ *  ./005_triangle_bvh_bench [grid-size [image-size]]
+ *  @endcode
+ *
+ *  Copyright 2008-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ *
+ */
+#include <oglplus/gl.hpp>
+#include <oglplus/shapes/triangle_bvh.hpp>
+#include <oglplus/matrix.hpp>
+#include <oglplus/angle.hpp>
+
+#include <iostream>
+#include <vector>
+#include <chrono>
+#include <cstdlib>
+#include <cmath>
+
+typedef std::chrono::high_resolution_clock bench_clock;
+
+double seconds_since(bench_clock::time_point start)
+{
+	return std::chrono::duration<double>(bench_clock::now()-start).count();
+}
+
+// makes a (size+1)x(size+1) height-field with 2*size*size triangles
+void make_terrain(
+	GLuint size,
+	std::vector<GLfloat>& positions,
+	std::vector<GLuint>& triangles
+)
+{
+	positions.clear();
+	triangles.clear();
+	for(GLuint j=0; j<=size; ++j)
+	{
+		for(GLuint i=0; i<=size; ++i)
+		{
+			GLfloat x = GLfloat(i)/GLfloat(size)*2.0f-1.0f;
+			GLfloat z = GLfloat(j)/GLfloat(size)*2.0f-1.0f;
+			GLfloat y =
+				0.10f*std::sin(x*7.0f)*std::cos(z*5.0f)+
+				0.02f*std::sin(x*41.0f+z*37.0f);
+			positions.push_back(x);
+			positions.push_back(y);
+			positions.push_back(z);
+		}
+	}
+	for(GLuint j=0; j!=size; ++j)
+	{
+		for(GLuint i=0; i!=size; ++i)
+		{
+			GLuint a = j*(size+1)+i, b = a+1;
+			GLuint c = a+size+1, d = c+1;
+			GLuint quad[6] = {a, c, b, b, c, d};
+			triangles.insert(triangles.end(), quad, quad+6);
+		}
+	}
+}
+
+void report(const char* name, std::size_t rays, std::size_t hits, double time)
+{
+	std::cout
+		<< name << ": "
+		<< GLuint(double(rays)/time/1.0e3) << " Krays/s ("
+		<< hits << " of " << rays << " hit)"
+		<< std::endl;
+}
+
+int main(int argc, const char** argv)
+{
+	using namespace oglplus;
+
+	GLuint grid_size = (argc > 1)?GLuint(std::atoi(argv[1])):708;
+	GLuint image_size = (argc > 2)?GLuint(std::atoi(argv[2])):1024;
+
+	std::vector<GLfloat> positions;
+	std::vector<GLuint> triangles;
+	make_terrain(grid_size, positions, triangles);
+
+	auto start = bench_clock::now();
+	shapes::TriangleBVH bvh(positions, 3, triangles);
+	std::cout
+		<< "Built the BVH for " << bvh.TriangleCount() << " triangles ("
+		<< bvh.Nodes().size() << " nodes) in "
+		<< seconds_since(start) << " s"
+		<< std::endl;
+
+	// coherent rays from a camera looking at the terrain
+	Mat4f camera =
+		CamMatrixf::PerspectiveX(Degrees(60), 1.0f, 0.1f, 10.0f)*
+		CamMatrixf::LookingAt(Vec3f(0.0f, 1.0f, 1.5f), Vec3f());
+	std::vector<shapes::TriangleBVHRay> camera_rays;
+	camera_rays.reserve(image_size*image_size);
+	for(GLuint y=0; y!=image_size; ++y)
+	{
+		for(GLuint x=0; x!=image_size; ++x)
+		{
+			camera_rays.push_back(bvh.PickRay(
+				camera,
+				(GLfloat(x)+0.5f)/GLfloat(image_size)*2.0f-1.0f,
+				(GLfloat(y)+0.5f)/GLfloat(image_size)*2.0f-1.0f
+			));
+		}
+	}
+
+	// incoherent line-of-sight segments between random points
+	std::vector<shapes::TriangleBVHRay> random_rays;
+	random_rays.reserve(camera_rays.size());
+	std::srand(1234);
+	for(std::size_t r=0; r!=camera_rays.size(); ++r)
+	{
+		GLfloat v[6];
+		for(GLuint c=0; c!=6; ++c)
+			v[c] = GLfloat(std::rand())/GLfloat(RAND_MAX)*2.0f-1.0f;
+		random_rays.push_back(bvh.Segment(
+			Vec3f(v[0], v[1]*0.2f, v[2]),
+			Vec3f(v[3], v[4]*0.2f, v[5])
+		));
+	}
+
+	std::vector<shapes::TriangleBVHHit> hits(camera_rays.size());
+
+	std::size_t hit_count = 0;
+	start = bench_clock::now();
+	for(std::size_t r=0; r!=camera_rays.size(); ++r)
+		if(bvh.Intersect(camera_rays[r], hits[r])) ++hit_count;
+	report("Camera rays, single", camera_rays.size(), hit_count, seconds_since(start));
+
+	start = bench_clock::now();
+	hit_count = bvh.Intersect(camera_rays.data(), camera_rays.size(), hits.data());
+	report("Camera rays, batch", camera_rays.size(), hit_count, seconds_since(start));
+
+	start = bench_clock::now();
+	hit_count = bvh.Intersect(camera_rays.data(), camera_rays.size(), hits.data(), true);
+	report("Camera rays, packets", camera_rays.size(), hit_count, seconds_since(start));
+
+	hit_count = 0;
+	start = bench_clock::now();
+	for(std::size_t r=0; r!=random_rays.size(); ++r)
+		if(bvh.Intersect(random_rays[r], hits[r])) ++hit_count;
+	report("Random segments, single", random_rays.size(), hit_count, seconds_since(start));
+
+	start = bench_clock::now();
+	hit_count = bvh.Intersect(random_rays.data(), random_rays.size(), hits.data());
+	report("Random segments, batch", random_rays.size(), hit_count, seconds_since(start));
+
+	start = bench_clock::now();
+	hit_count = bvh.Intersect(random_rays.data(), random_rays.size(), hits.data(), true);
+	report("Random segments, packets", random_rays.size(), hit_count, seconds_since(start));
+
+	hit_count = 0;
+	start = bench_clock::now();
+	for(std::size_t r=0; r!=random_rays.size(); ++r)
+		if(bvh.Occluded(random_rays[r])) ++hit_count;
+	report("Line of sight, single", random_rays.size(), hit_count, seconds_since(start));
+
+	bool* flags = new bool[random_rays.size()];
+	start = bench_clock::now();
+	hit_count = bvh.Occluded(random_rays.data(), random_rays.size(), flags);
+	report("Line of sight, batch", random_rays.size(), hit_count, seconds_since(start));
+
+	start = bench_clock::now();
+	hit_count = bvh.Occluded(random_rays.data(), random_rays.size(), flags, true);
+	report("Line of sight, packets", random_rays.size(), hit_count, seconds_since(start));
+	delete[] flags;
+
+	return 0;
+}
@@ -24,13 +24,17 @@ String GetInfoLog(
 )
 {
 	int length = 0;
-	GetObjectiv(object_name, GL_INFO_LOG_LENGTH, &length);
+	OGLPLUS_GLFUNC_PTR(GetObjectiv)(
+		object_name,
+		GL_INFO_LOG_LENGTH,
+		&length
+	);
 	OGLPLUS_CHECK(OGLPLUS_ERROR_INFO_STR(name_GetObjectiv));
 	if(length > 0)
 	{
 		GLsizei real_length = 0;
 		std::vector<GLchar> buffer(length);
-		GetObjectInfoLog(
+		OGLPLUS_GLFUNC_PTR(GetObjectInfoLog)(
 			object_name,
 			buffer.size(),
 			&real_length,
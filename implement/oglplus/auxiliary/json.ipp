@@ -0,0 +1,49 @@
+/**
+ *  @file oglplus/auxiliary/json.ipp
+ *  @brief Implementation of the JSON output helpers
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+namespace oglplus {
+namespace aux {
+
+OGLPLUS_LIB_FUNC
+void WriteJSONString(std::ostream& output, const char* str, std::size_t size)
+{
+	static const char hex[] = "0123456789abcdef";
+	output << '"';
+	for(std::size_t i=0; i!=size; ++i)
+	{
+		const unsigned char c = (unsigned char)(str[i]);
+		switch(c)
+		{
+			case '"': output << "\\\""; break;
+			case '\\': output << "\\\\"; break;
+			case '\b': output << "\\b"; break;
+			case '\f': output << "\\f"; break;
+			case '\n': output << "\\n"; break;
+			case '\r': output << "\\r"; break;
+			case '\t': output << "\\t"; break;
+			default:
+			{
+				// the other control characters have no short form
+				if(c < 0x20)
+				{
+					output	<< "\\u00"
+						<< hex[c >> 4]
+						<< hex[c & 0x0F];
+				}
+				else output << char(c);
+			}
+		}
+	}
+	output << '"';
+}
+
+} // namespace aux
+} // namespace oglplus
@@ -0,0 +1,119 @@
+/**
+ *  @file oglplus/auxiliary/mapped_file.ipp
+ *  @brief Implementation of MappedFile
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#if !(defined(WIN32) || defined(_WIN32) || defined(WIN64) || defined(_WIN64))
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
+#include <unistd.h>
+#define OGLPLUS_AUX_MAPPED_FILE_POSIX 1
+#else
+#define OGLPLUS_AUX_MAPPED_FILE_POSIX 0
+#endif
+
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+
+namespace oglplus {
+namespace aux {
+
+OGLPLUS_LIB_FUNC
+void MappedFile::_map(const std::string& path)
+{
+#if OGLPLUS_AUX_MAPPED_FILE_POSIX
+	int fd = ::open(path.c_str(), O_RDONLY);
+	if(fd < 0) return;
+
+	struct stat st;
+	if((::fstat(fd, &st) == 0) && (st.st_size > 0))
+	{
+		void* addr = ::mmap(
+			nullptr,
+			std::size_t(st.st_size),
+			PROT_READ,
+			MAP_PRIVATE,
+			fd,
+			0
+		);
+		if(addr != MAP_FAILED)
+		{
+			_data = static_cast<const unsigned char*>(addr);
+			_size = std::size_t(st.st_size);
+			_mapped = true;
+		}
+	}
+	::close(fd);
+#else
+	OGLPLUS_FAKE_USE(path);
+#endif
+}
+
+OGLPLUS_LIB_FUNC
+void MappedFile::_read(const std::string& path)
+{
+	std::ifstream input(path.c_str(), std::ios::binary);
+	if(!input.good())
+	{
+		throw std::runtime_error(
+			"Unable to open file '"+path+"'"
+		);
+	}
+	_buffer.assign(
+		std::istreambuf_iterator<char>(input),
+		std::istreambuf_iterator<char>()
+	);
+	_data = _buffer.data();
+	_size = _buffer.size();
+}
+
+OGLPLUS_LIB_FUNC
+void MappedFile::_unmap(void)
+{
+#if OGLPLUS_AUX_MAPPED_FILE_POSIX
+	if(_mapped)
+	{
+		::munmap(const_cast<unsigned char*>(_data), _size);
+	}
+#endif
+	_data = nullptr;
+	_size = 0;
+	_mapped = false;
+}
+
+OGLPLUS_LIB_FUNC
+MappedFile::MappedFile(const std::string& path)
+ : _data(nullptr)
+ , _size(0)
+ , _mapped(false)
+{
+	_map(path);
+	if(!_mapped) _read(path);
+}
+
+OGLPLUS_LIB_FUNC
+MappedFile::MappedFile(MappedFile&& tmp)
+ : _data(tmp._data)
+ , _size(tmp._size)
+ , _mapped(tmp._mapped)
+ , _buffer(std::move(tmp._buffer))
+{
+	if(!_mapped) _data = _buffer.data();
+	tmp._data = nullptr;
+	tmp._size = 0;
+	tmp._mapped = false;
+}
+
+} // namespace aux
+} // namespace oglplus
+
+#undef OGLPLUS_AUX_MAPPED_FILE_POSIX
@@ -0,0 +1,139 @@
+/**
+ *  @file oglplus/cpu_trace.ipp
+ *  @brief Implementation of CPUTrace
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <iomanip>
+
+namespace oglplus {
+
+OGLPLUS_LIB_FUNC
+CPUTrace::_buffer* CPUTrace::_new_buffer(void)
+{
+	_registry& state = _state();
+	std::unique_ptr<_buffer> buffer(new _buffer());
+	buffer->events.reset(new _event[BufferCapacity]);
+	buffer->tail = 0;
+#if !OGLPLUS_NO_THREADS
+	std::lock_guard<std::mutex> lock(state.mutex);
+#endif
+	buffer->thread_index = unsigned(state.buffers.size()+1);
+	state.buffers.push_back(std::move(buffer));
+	return state.buffers.back().get();
+}
+
+OGLPLUS_LIB_FUNC
+void CPUTrace::Enable(bool enable)
+{
+	_state().enabled.Set(enable);
+}
+
+OGLPLUS_LIB_FUNC
+void CPUTrace::Clear(void)
+{
+	_registry& state = _state();
+#if !OGLPLUS_NO_THREADS
+	std::lock_guard<std::mutex> lock(state.mutex);
+#endif
+	for(auto i=state.buffers.begin(), e=state.buffers.end(); i!=e; ++i)
+	{
+		(*i)->tail = (*i)->head.Acquire();
+	}
+}
+
+OGLPLUS_LIB_FUNC
+double CPUTrace::_microseconds_per_tick(void)
+{
+#if OGLPLUS_CPU_TRACE_USE_TSC
+	// calibrate the timestamp counter against the steady clock
+	// over the whole time since the first use of the tracer
+	_registry& state = _state();
+	Ticks ticks = Now() - state.origin_ticks;
+	double us = std::chrono::duration<double, std::micro>(
+		std::chrono::steady_clock::now() - state.origin_time
+	).count();
+	if((ticks > 0) && (us > 0.0)) return us/double(ticks);
+#endif
+	return 1.0e-3;
+}
+
+OGLPLUS_LIB_FUNC
+void CPUTrace::WriteChromeTrace(std::ostream& output)
+{
+	_registry& state = _state();
+	const double us_per_tick = _microseconds_per_tick();
+
+	struct _copy
+	{
+		const char* name;
+		Ticks begin;
+		Ticks end;
+	};
+	std::vector<_copy> events;
+
+#if !OGLPLUS_NO_THREADS
+	std::lock_guard<std::mutex> lock(state.mutex);
+#endif
+	output << std::fixed << std::setprecision(3);
+	output << "{\"traceEvents\":[" << std::endl;
+	bool first = true;
+	for(auto i=state.buffers.begin(), e=state.buffers.end(); i!=e; ++i)
+	{
+		_buffer& buffer = **i;
+
+		std::size_t head = buffer.head.Acquire();
+		std::size_t begin = buffer.tail;
+		if(head-begin > BufferCapacity) begin = head-BufferCapacity;
+
+		events.clear();
+		for(std::size_t n=begin; n!=head; ++n)
+		{
+			const _event& event = buffer.events[n % BufferCapacity];
+			_copy copy = {
+				event.name.Get(),
+				event.begin.Get(),
+				event.end.Get()
+			};
+			events.push_back(copy);
+		}
+		// skip the scopes that the thread has overwritten meanwhile
+		std::size_t newest = buffer.head.Acquire();
+		std::size_t skip = 0;
+		if(newest-begin > BufferCapacity)
+		{
+			skip = newest-begin-BufferCapacity;
+			if(skip > events.size()) skip = events.size();
+		}
+
+		if(!first) output << "," << std::endl;
+		first = false;
+		output	<< "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,"
+			<< "\"tid\":" << buffer.thread_index << ","
+			<< "\"args\":{\"name\":\"Thread "
+			<< buffer.thread_index << "\"}}";
+
+		for(auto j=events.begin()+skip, f=events.end(); j!=f; ++j)
+		{
+			output << "," << std::endl;
+			output << "{\"name\":";
+			aux::WriteJSONString(output, j->name);
+			output	<< ",\"cat\":\"oglplus\",\"ph\":\"X\""
+				<< ",\"ts\":"
+				<< double(j->begin-state.origin_ticks)*us_per_tick
+				<< ",\"dur\":"
+				<< double(j->end-j->begin)*us_per_tick
+				<< ",\"pid\":1"
+				<< ",\"tid\":" << buffer.thread_index
+				<< "}";
+		}
+	}
+	output << std::endl << "],\"displayTimeUnit\":\"ms\"}" << std::endl;
+}
+
+} // namespace oglplus
@@ -0,0 +1,274 @@
+/**
+ *  @file oglplus/depth_sort.ipp
+ *  @brief Implementation of DepthSorter
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <cstring>
+
+namespace oglplus {
+
+// converts the floating-point depths into unsigned integer keys
+// having the same ordering
+struct DepthSorterKey
+{
+	static GLuint Make(GLfloat depth)
+	{
+		GLuint bits;
+		std::memcpy(&bits, &depth, sizeof(bits));
+		GLuint mask = GLuint(-GLint(bits >> 31)) | 0x80000000;
+		return bits ^ mask;
+	}
+};
+
+// a single counting or scattering phase of a radix sort pass
+// working on one of several parts of the sorted keys
+struct DepthSorterPass
+{
+	enum { Radix = 256 };
+
+	const GLuint* keys;
+	const GLuint* order;
+	GLuint* out_keys;
+	GLuint* out_order;
+	std::size_t count;
+	std::size_t* counts;
+	unsigned shift;
+	unsigned parts;
+	bool scatter;
+
+	void operator()(unsigned part) const
+	{
+		std::size_t begin = count*part/parts;
+		std::size_t end = count*(part+1)/parts;
+		std::size_t* c = counts+part*Radix;
+
+		if(scatter)
+		{
+			for(std::size_t i=begin; i!=end; ++i)
+			{
+				std::size_t pos = c[(keys[i] >> shift) & 0xFF]++;
+				out_keys[pos] = keys[i];
+				out_order[pos] = order[i];
+			}
+		}
+		else
+		{
+			for(unsigned d=0; d!=Radix; ++d)
+				c[d] = 0;
+			for(std::size_t i=begin; i!=end; ++i)
+				++c[(keys[i] >> shift) & 0xFF];
+		}
+	}
+
+	void Run(void) const
+	{
+#if !OGLPLUS_NO_THREADS
+		std::vector<std::thread> workers;
+		for(unsigned p=1; p<parts; ++p)
+			workers.push_back(std::thread(*this, p));
+		(*this)(0);
+		for(std::size_t w=0; w!=workers.size(); ++w)
+			workers[w].join();
+#else
+		for(unsigned p=0; p!=parts; ++p)
+			(*this)(p);
+#endif
+	}
+};
+
+OGLPLUS_LIB_FUNC
+void DepthSorter::_make_keys(
+	const Matrix<GLfloat, 4, 4>& camera,
+	const GLfloat* data,
+	std::size_t count,
+	std::size_t stride,
+	bool spheres
+)
+{
+	// only the third row of the matrix is needed for the depth
+	const GLfloat m0 = camera.At(2, 0);
+	const GLfloat m1 = camera.At(2, 1);
+	const GLfloat m2 = camera.At(2, 2);
+	const GLfloat m3 = camera.At(2, 3);
+	const GLuint flip = _back_to_front?0:~GLuint(0);
+
+	_keys.resize(count);
+	GLuint* keys = _keys.data();
+	if(spheres)
+	{
+		for(std::size_t i=0; i!=count; ++i, data += stride)
+		{
+			GLfloat depth = m0*data[0]+m1*data[1]+m2*data[2]+m3;
+			keys[i] = DepthSorterKey::Make(depth+data[3]) ^ flip;
+		}
+	}
+	else
+	{
+		for(std::size_t i=0; i!=count; ++i, data += stride)
+		{
+			GLfloat depth = m0*data[0]+m1*data[1]+m2*data[2]+m3;
+			keys[i] = DepthSorterKey::Make(depth) ^ flip;
+		}
+	}
+}
+
+OGLPLUS_LIB_FUNC
+const std::vector<GLuint>& DepthSorter::SortDepths(
+	const GLfloat* depths,
+	std::size_t count
+)
+{
+	const GLuint flip = _back_to_front?0:~GLuint(0);
+	_keys.resize(count);
+	for(std::size_t i=0; i!=count; ++i)
+		_keys[i] = DepthSorterKey::Make(depths[i]) ^ flip;
+	_sort();
+	return _order;
+}
+
+OGLPLUS_LIB_FUNC
+bool DepthSorter::_resort(void)
+{
+	const std::size_t n = _sorted_keys.size();
+	GLuint* keys = _sorted_keys.data();
+	GLuint* order = _order.data();
+
+	// don't even try if too many elements are out of order
+	std::size_t descents = 0;
+	for(std::size_t j=1; j<n; ++j)
+		descents += (keys[j-1] > keys[j])?1:0;
+	if(descents > n/32+16) return false;
+
+	// give up if fixing the order would take more moves
+	// than a couple of radix sort passes
+	const std::size_t max_moves = n+16;
+	std::size_t moves = 0;
+	for(std::size_t j=1; j<n; ++j)
+	{
+		if(keys[j-1] <= keys[j]) continue;
+		GLuint key = keys[j];
+		GLuint index = order[j];
+		std::size_t i = j;
+		while((i != 0) && (keys[i-1] > key))
+		{
+			keys[i] = keys[i-1];
+			order[i] = order[i-1];
+			--i;
+		}
+		keys[i] = key;
+		order[i] = index;
+		moves += j-i;
+		if(moves > max_moves) return false;
+	}
+	return true;
+}
+
+OGLPLUS_LIB_FUNC
+void DepthSorter::_radix_sort(void)
+{
+	const std::size_t n = _sorted_keys.size();
+	const unsigned R = DepthSorterPass::Radix;
+
+	// the passes in which all keys have the same digit are skipped,
+	// the digit histograms do not depend on the order of the keys
+	std::size_t totals[4][R] = { {0} };
+	for(std::size_t i=0; i!=n; ++i)
+	{
+		GLuint key = _sorted_keys[i];
+		++totals[0][(key >>  0) & 0xFF];
+		++totals[1][(key >>  8) & 0xFF];
+		++totals[2][(key >> 16) & 0xFF];
+		++totals[3][(key >> 24) & 0xFF];
+	}
+
+	// use threads only if each of them has enough work
+	const std::size_t min_part = 1 << 16;
+	unsigned parts = _threads;
+	if(parts > n / min_part)
+		parts = unsigned(n / min_part);
+	if(parts == 0)
+		parts = 1;
+
+	std::vector<std::size_t> counts(parts*R);
+	_tmp_keys.resize(n);
+	_tmp_order.resize(n);
+
+	DepthSorterPass pass;
+	pass.count = n;
+	pass.counts = counts.data();
+	pass.parts = parts;
+
+	for(unsigned p=0; p!=4; ++p)
+	{
+		if(totals[p][(_sorted_keys[0] >> (p*8)) & 0xFF] == n)
+			continue;
+
+		pass.keys = _sorted_keys.data();
+		pass.order = _order.data();
+		pass.out_keys = _tmp_keys.data();
+		pass.out_order = _tmp_order.data();
+		pass.shift = p*8;
+
+		// count the digits in every part
+		pass.scatter = false;
+		if(parts > 1) pass.Run();
+		else pass(0);
+
+		// turn the counts into the starting positions, the
+		// elements from the preceding parts go first to keep
+		// the sort stable
+		std::size_t sum = 0;
+		for(unsigned d=0; d!=R; ++d)
+		{
+			for(unsigned t=0; t!=parts; ++t)
+			{
+				std::size_t c = counts[t*R+d];
+				counts[t*R+d] = sum;
+				sum += c;
+			}
+		}
+
+		// scatter the elements to their positions
+		pass.scatter = true;
+		if(parts > 1) pass.Run();
+		else pass(0);
+
+		_sorted_keys.swap(_tmp_keys);
+		_order.swap(_tmp_order);
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void DepthSorter::_sort(void)
+{
+	const std::size_t n = _keys.size();
+	_sorted_keys.resize(n);
+
+	// start from the previous order if it is usable
+	_incremental = (_order.size() == n) && (n != 0);
+	if(_incremental)
+	{
+		for(std::size_t i=0; i!=n; ++i)
+			_sorted_keys[i] = _keys[_order[i]];
+		_incremental = _resort();
+	}
+	else
+	{
+		_order.resize(n);
+		for(std::size_t i=0; i!=n; ++i)
+		{
+			_order[i] = GLuint(i);
+			_sorted_keys[i] = _keys[i];
+		}
+	}
+	if(!_incremental && (n != 0))
+		_radix_sort();
+}
+
+} // namespace oglplus
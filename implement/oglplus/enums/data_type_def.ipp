@@ -173,6 +173,38 @@
 #  define OGLPLUS_LIST_NEEDS_COMMA 1
 # endif
 #endif
+#if defined GL_INT_2_10_10_10_REV
+# if OGLPLUS_LIST_NEEDS_COMMA
+   OGLPLUS_ENUM_CLASS_COMMA
+# endif
+# if defined Int2_10_10_10_Rev
+#  pragma push_macro("Int2_10_10_10_Rev")
+#  undef Int2_10_10_10_Rev
+   OGLPLUS_ENUM_CLASS_VALUE(Int2_10_10_10_Rev, GL_INT_2_10_10_10_REV)
+#  pragma pop_macro("Int2_10_10_10_Rev")
+# else
+   OGLPLUS_ENUM_CLASS_VALUE(Int2_10_10_10_Rev, GL_INT_2_10_10_10_REV)
+# endif
+# ifndef OGLPLUS_LIST_NEEDS_COMMA
+#  define OGLPLUS_LIST_NEEDS_COMMA 1
+# endif
+#endif
+#if defined GL_UNSIGNED_INT_2_10_10_10_REV
+# if OGLPLUS_LIST_NEEDS_COMMA
+   OGLPLUS_ENUM_CLASS_COMMA
+# endif
+# if defined UnsignedInt2_10_10_10_Rev
+#  pragma push_macro("UnsignedInt2_10_10_10_Rev")
+#  undef UnsignedInt2_10_10_10_Rev
+   OGLPLUS_ENUM_CLASS_VALUE(UnsignedInt2_10_10_10_Rev, GL_UNSIGNED_INT_2_10_10_10_REV)
+#  pragma pop_macro("UnsignedInt2_10_10_10_Rev")
+# else
+   OGLPLUS_ENUM_CLASS_VALUE(UnsignedInt2_10_10_10_Rev, GL_UNSIGNED_INT_2_10_10_10_REV)
+# endif
+# ifndef OGLPLUS_LIST_NEEDS_COMMA
+#  define OGLPLUS_LIST_NEEDS_COMMA 1
+# endif
+#endif
 #ifdef OGLPLUS_LIST_NEEDS_COMMA
 # undef OGLPLUS_LIST_NEEDS_COMMA
 #endif
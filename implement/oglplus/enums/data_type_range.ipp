@@ -49,6 +49,12 @@ GL_UNSIGNED_SHORT,
 #if defined GL_UNSIGNED_INT
 GL_UNSIGNED_INT,
 #endif
+#if defined GL_INT_2_10_10_10_REV
+GL_INT_2_10_10_10_REV,
+#endif
+#if defined GL_UNSIGNED_INT_2_10_10_10_REV
+GL_UNSIGNED_INT_2_10_10_10_REV,
+#endif
 0
 };
 return aux::CastIterRange<
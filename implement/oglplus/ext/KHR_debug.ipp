@@ -9,6 +9,11 @@
  *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
  */
 
+#if !OGLPLUS_NO_THREADS
+#include <cstring>
+#include <cstdio>
+#endif
+
 namespace oglplus {
 
 #if GL_KHR_debug
@@ -107,6 +112,266 @@ Call(const KHR_debug::CallbackData& data)
 	dbgout << "</entry>" << std::endl;
 }
 
+#if !OGLPLUS_NO_THREADS
+
+OGLPLUS_LIB_FUNC
+std::size_t KHR_debug_AsyncEssence::_pow2(std::size_t n)
+{
+	std::size_t result = 1;
+	while(result < n) result <<= 1;
+	return result;
+}
+
+OGLPLUS_LIB_FUNC
+std::uint64_t KHR_debug_AsyncEssence::_hash(
+	const KHR_debug::CallbackData& data,
+	std::size_t length
+)
+{
+	// FNV-1a
+	std::uint64_t hash = 14695981039346656037ULL;
+	auto add = [&hash](const void* ptr, std::size_t size)
+	{
+		const unsigned char* bytes = (const unsigned char*)ptr;
+		for(std::size_t i=0; i!=size; ++i)
+		{
+			hash ^= bytes[i];
+			hash *= 1099511628211ULL;
+		}
+	};
+	GLenum source = GLenum(data.source);
+	GLenum type = GLenum(data.type);
+	GLenum severity = GLenum(data.severity);
+	add(&source, sizeof(source));
+	add(&type, sizeof(type));
+	add(&data.id, sizeof(data.id));
+	add(&severity, sizeof(severity));
+	add(data.message, length);
+	// zero marks the empty entries in the set
+	return hash | 1;
+}
+
+OGLPLUS_LIB_FUNC
+KHR_debug_AsyncEssence::KHR_debug_AsyncEssence(
+	const Callback& callback,
+	std::size_t ring_size,
+	std::size_t max_length,
+	std::size_t dedup_size,
+	unsigned max_per_second
+): _callback(callback)
+ , _mask(_pow2(ring_size > 2 ? ring_size : 2)-1)
+ , _max_length(max_length)
+ , _slots(new _slot[_mask+1])
+ , _text((_mask+1)*(_max_length+1), GLchar(0))
+ , _enqueue_pos(0)
+ , _dequeue_pos(0)
+ , _seen_mask(dedup_size ? _pow2(dedup_size)-1 : 0)
+ , _seen(dedup_size ? new std::atomic<std::uint64_t>[_seen_mask+1] : nullptr)
+ , _max_per_second(max_per_second)
+ , _window_start(std::chrono::steady_clock::now())
+ , _window_count(0)
+ , _window_limited(0)
+ , _received(0)
+ , _repeated(0)
+ , _dropped(0)
+ , _limited(0)
+ , _stop(false)
+{
+	assert(bool(_callback));
+	for(std::size_t i=0; i<=_mask; ++i)
+		_slots[i].seq.store(i, std::memory_order_relaxed);
+	if(_seen)
+	{
+		for(std::size_t i=0; i<=_seen_mask; ++i)
+			_seen[i].store(0, std::memory_order_relaxed);
+	}
+	_thread = std::thread(&KHR_debug_AsyncEssence::_run, this);
+}
+
+OGLPLUS_LIB_FUNC
+KHR_debug_AsyncEssence::~KHR_debug_AsyncEssence(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+		_cv.notify_all();
+	}
+	_thread.join();
+}
+
+OGLPLUS_LIB_FUNC
+bool KHR_debug_AsyncEssence::_first_time(std::uint64_t hash)
+{
+	if(!_seen) return true;
+	std::size_t index = std::size_t(hash) & _seen_mask;
+	for(unsigned probe=0; probe!=16; ++probe)
+	{
+		std::uint64_t value = _seen[index].load(std::memory_order_relaxed);
+		if(value == hash) return false;
+		if(value == 0)
+		{
+			if(_seen[index].compare_exchange_strong(
+				value,
+				hash,
+				std::memory_order_relaxed
+			)) return true;
+			if(value == hash) return false;
+		}
+		index = (index+1) & _seen_mask;
+	}
+	// the set is too full, let the message through
+	return true;
+}
+
+OGLPLUS_LIB_FUNC
+bool KHR_debug_AsyncEssence::_push(
+	const KHR_debug::CallbackData& data,
+	std::size_t length
+)
+{
+	_slot* slot = nullptr;
+	std::size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+	while(true)
+	{
+		slot = &_slots[pos & _mask];
+		std::size_t seq = slot->seq.load(std::memory_order_acquire);
+		std::ptrdiff_t diff = std::ptrdiff_t(seq) - std::ptrdiff_t(pos);
+		if(diff == 0)
+		{
+			if(_enqueue_pos.compare_exchange_weak(
+				pos,
+				pos+1,
+				std::memory_order_relaxed
+			)) break;
+		}
+		else if(diff < 0) return false;
+		else pos = _enqueue_pos.load(std::memory_order_relaxed);
+	}
+	if(length > _max_length) length = _max_length;
+
+	GLchar* text = _text.data()+(pos & _mask)*(_max_length+1);
+	std::memcpy(text, data.message, length);
+	text[length] = GLchar(0);
+
+	slot->source = data.source;
+	slot->type = data.type;
+	slot->id = data.id;
+	slot->severity = data.severity;
+	slot->length = GLsizei(length);
+	slot->seq.store(pos+1, std::memory_order_release);
+	return true;
+}
+
+OGLPLUS_LIB_FUNC
+void KHR_debug_AsyncEssence::Call(const KHR_debug::CallbackData& data)
+{
+	// called by the GL, possibly from several threads;
+	// must not block nor allocate memory
+	_received.fetch_add(1, std::memory_order_relaxed);
+
+	std::size_t length = (data.length < 0)?
+		std::strlen(data.message):
+		std::size_t(data.length);
+
+	if(!_first_time(_hash(data, length)))
+		_repeated.fetch_add(1, std::memory_order_relaxed);
+	else if(!_push(data, length))
+		_dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+OGLPLUS_LIB_FUNC
+void KHR_debug_AsyncEssence::_report_limited(void)
+{
+	if(_window_limited == 0) return;
+
+	GLchar message[96];
+	int length = std::snprintf(
+		message,
+		sizeof(message),
+		"%lu debug message(s) discarded by the rate limit",
+		_window_limited
+	);
+	_window_limited = 0;
+
+	KHR_debug::CallbackData data;
+	data.source = DebugSource::ThirdParty;
+	data.type = DebugType::Other;
+	data.id = 0;
+	data.severity = DebugSeverity::Notification;
+	data.length = GLsizei(length);
+	data.message = message;
+	_callback(data);
+}
+
+OGLPLUS_LIB_FUNC
+void KHR_debug_AsyncEssence::_forward(const KHR_debug::CallbackData& data)
+{
+	if(_max_per_second != 0)
+	{
+		if(_window_count >= _max_per_second)
+		{
+			++_window_limited;
+			_limited.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		++_window_count;
+	}
+	_callback(data);
+}
+
+OGLPLUS_LIB_FUNC
+void KHR_debug_AsyncEssence::_drain(void)
+{
+	auto now = std::chrono::steady_clock::now();
+	if(now - _window_start >= std::chrono::seconds(1))
+	{
+		try { _report_limited(); }
+		catch(...) { }
+		_window_start = now;
+		_window_count = 0;
+	}
+
+	while(true)
+	{
+		_slot& slot = _slots[_dequeue_pos & _mask];
+		std::size_t seq = slot.seq.load(std::memory_order_acquire);
+		if(seq != _dequeue_pos+1) break;
+
+		KHR_debug::CallbackData data;
+		data.source = slot.source;
+		data.type = slot.type;
+		data.id = slot.id;
+		data.severity = slot.severity;
+		data.length = slot.length;
+		data.message = _text.data()+(_dequeue_pos & _mask)*(_max_length+1);
+		try { _forward(data); }
+		catch(...) { }
+
+		// the slot is released only after the message was passed on
+		slot.seq.store(_dequeue_pos+_mask+1, std::memory_order_release);
+		++_dequeue_pos;
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void KHR_debug_AsyncEssence::_run(void)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	while(!_stop)
+	{
+		lock.unlock();
+		_drain();
+		lock.lock();
+		if(!_stop) _cv.wait_for(lock, std::chrono::milliseconds(50));
+	}
+	lock.unlock();
+	_drain();
+	try { _report_limited(); }
+	catch(...) { }
+}
+
+#endif // !OGLPLUS_NO_THREADS
+
 #endif // KHR_debug
 
 } // namespace oglplus
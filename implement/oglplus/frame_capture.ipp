@@ -0,0 +1,352 @@
+/**
+ *  @file oglplus/frame_capture.ipp
+ *  @brief Implementation of FrameCapture
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#if !OGLPLUS_NO_CHRONO
+#include <chrono>
+#else
+#include <ctime>
+#endif
+
+#include <utility>
+#include <cstring>
+
+namespace oglplus {
+
+#if GL_VERSION_3_2 || GL_ARB_sync
+
+OGLPLUS_LIB_FUNC
+GLuint FrameCapture::_channel_count(PixelDataFormat format)
+{
+	switch(format)
+	{
+		case PixelDataFormat::RGBA:
+		case PixelDataFormat::BGRA:
+			return 4;
+		case PixelDataFormat::RGB:
+		case PixelDataFormat::BGR:
+			return 3;
+		case PixelDataFormat::RG:
+			return 2;
+		default:;
+	}
+	return 1;
+}
+
+OGLPLUS_LIB_FUNC
+double FrameCapture::_time(void)
+{
+#if !OGLPLUS_NO_CHRONO
+	return std::chrono::duration<double>(
+		std::chrono::steady_clock::now().time_since_epoch()
+	).count();
+#else
+	return double(std::clock())/double(CLOCKS_PER_SEC);
+#endif
+}
+
+OGLPLUS_LIB_FUNC
+FrameCapture::FrameCapture(
+	GLsizei width,
+	GLsizei height,
+	Writer writer,
+	PixelDataFormat format,
+	GLuint ring_size,
+	GLuint writer_threads
+): _width(width)
+ , _height(height)
+ , _format(format)
+ , _channels(_channel_count(format))
+ , _frame_size(GLsizeiptr(width)*GLsizeiptr(height)*_channels)
+ , _ring_size(ring_size)
+ , _writer(std::move(writer))
+ , _fences(ring_size)
+ , _numbers(ring_size, 0)
+ , _head(0)
+ , _pending(0)
+ , _captured(0)
+ , _writing(0)
+ , _stopped(false)
+ , _total_wait(0.0)
+ , _stall_count(0)
+#if !OGLPLUS_NO_THREADS
+ , _quit(false)
+#endif
+{
+	assert(_frame_size > 0);
+	assert(_ring_size > 0);
+	assert(writer_threads > 0);
+	assert(bool(_writer));
+
+	_buffer.Bind(BufferTarget::PixelPack);
+	OGLPLUS_GLFUNC(BufferData)(
+		GL_PIXEL_PACK_BUFFER,
+		_frame_size * _ring_size,
+		nullptr,
+		GL_STREAM_READ
+	);
+	OGLPLUS_CHECK(OGLPLUS_ERROR_INFO(BufferData));
+	Buffer::Unbind(BufferTarget::PixelPack);
+
+#if !OGLPLUS_NO_THREADS
+	// every writer can hold one frame while a whole ring is queued
+	GLuint frame_count = _ring_size + writer_threads;
+#else
+	GLuint frame_count = 1;
+#endif
+	for(GLuint i=0; i!=frame_count; ++i)
+	{
+		std::unique_ptr<Frame> frame(new Frame());
+		frame->_number = 0;
+		frame->_width = _width;
+		frame->_height = _height;
+		frame->_format = _format;
+		frame->_channels = _channels;
+		frame->_pixels.resize(std::size_t(_frame_size));
+		_free.push_back(frame.get());
+		_frames.push_back(std::move(frame));
+	}
+
+#if !OGLPLUS_NO_THREADS
+	for(GLuint i=0; i!=writer_threads; ++i)
+	{
+		_threads.push_back(std::thread(
+			&FrameCapture::_write_loop,
+			this
+		));
+	}
+#endif
+}
+
+OGLPLUS_LIB_FUNC
+FrameCapture::~FrameCapture(void)
+{
+#if !OGLPLUS_NO_THREADS
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_quit = true;
+		_cv.notify_all();
+	}
+	for(auto i=_threads.begin(), e=_threads.end(); i!=e; ++i)
+		i->join();
+#endif
+}
+
+OGLPLUS_LIB_FUNC
+bool FrameCapture::_write(const Frame& frame, std::exception_ptr& error)
+{
+	try { return _writer(frame); }
+	catch(...) { error = std::current_exception(); }
+	return false;
+}
+
+#if !OGLPLUS_NO_THREADS
+OGLPLUS_LIB_FUNC
+void FrameCapture::_write_loop(void)
+{
+	std::unique_lock<std::mutex> lock(_mutex);
+	while(true)
+	{
+		while(_queued.empty() && !_quit) _cv.wait(lock);
+		// the queued frames are written before quitting
+		if(_queued.empty()) break;
+
+		Frame* frame = _queued.front();
+		_queued.pop_front();
+		if(!_stopped)
+		{
+			++_writing;
+			lock.unlock();
+			std::exception_ptr error;
+			bool ok = _write(*frame, error);
+			lock.lock();
+			--_writing;
+			if(!ok)
+			{
+				_stopped = true;
+				if(error && !_error) _error = error;
+			}
+		}
+		_free.push_back(frame);
+		_cv.notify_all();
+	}
+}
+#endif
+
+OGLPLUS_LIB_FUNC
+void FrameCapture::_submit(Frame* frame)
+{
+#if !OGLPLUS_NO_THREADS
+	std::lock_guard<std::mutex> lock(_mutex);
+	if(_stopped) _free.push_back(frame);
+	else _queued.push_back(frame);
+	_cv.notify_all();
+#else
+	if(!_stopped)
+	{
+		if(!_write(*frame, _error)) _stopped = true;
+	}
+	_free.push_back(frame);
+#endif
+}
+
+OGLPLUS_LIB_FUNC
+FrameCapture::Frame* FrameCapture::_acquire_frame(void)
+{
+#if !OGLPLUS_NO_THREADS
+	std::unique_lock<std::mutex> lock(_mutex);
+	if(_free.empty())
+	{
+		// the writers are behind by a whole ring
+		double start = _time();
+		while(_free.empty()) _cv.wait(lock);
+		_total_wait += _time() - start;
+		++_stall_count;
+	}
+#endif
+	assert(!_free.empty());
+	Frame* frame = _free.front();
+	_free.pop_front();
+	return frame;
+}
+
+OGLPLUS_LIB_FUNC
+void FrameCapture::_wait_for_oldest(void)
+{
+	assert(_pending > 0);
+	std::unique_ptr<Sync>& fence = _fences[_head];
+	assert(fence);
+
+	SyncWaitResult result = fence->ClientWait(0);
+	if(result == SyncWaitResult::TimeoutExpired)
+	{
+		double start = _time();
+		// make sure that the fence gets to the GPU
+		OGLPLUS_GLFUNC(Flush)();
+		do { result = fence->ClientWait(1000000); }
+		while(result == SyncWaitResult::TimeoutExpired);
+		_total_wait += _time() - start;
+		++_stall_count;
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void FrameCapture::_retrieve_oldest(void)
+{
+	assert(_pending > 0);
+
+	_buffer.Bind(BufferTarget::PixelPack);
+	const GLvoid* ptr = OGLPLUS_GLFUNC(MapBufferRange)(
+		GL_PIXEL_PACK_BUFFER,
+		GLintptr(_head * _frame_size),
+		_frame_size,
+		GL_MAP_READ_BIT
+	);
+	OGLPLUS_CHECK(OGLPLUS_ERROR_INFO(MapBufferRange));
+
+	Frame* frame = _acquire_frame();
+	std::memcpy(frame->_pixels.data(), ptr, std::size_t(_frame_size));
+	frame->_number = _numbers[_head];
+
+	OGLPLUS_GLFUNC(UnmapBuffer)(GL_PIXEL_PACK_BUFFER);
+	OGLPLUS_VERIFY(OGLPLUS_ERROR_INFO(UnmapBuffer));
+	Buffer::Unbind(BufferTarget::PixelPack);
+
+	_fences[_head].reset();
+	_head = (_head + 1) % _ring_size;
+	--_pending;
+
+	_submit(frame);
+}
+
+OGLPLUS_LIB_FUNC
+void FrameCapture::_wait_for_writers(void)
+{
+#if !OGLPLUS_NO_THREADS
+	std::unique_lock<std::mutex> lock(_mutex);
+	while(!_queued.empty() || (_writing > 0)) _cv.wait(lock);
+#endif
+}
+
+OGLPLUS_LIB_FUNC
+bool FrameCapture::Stopped(void) const
+{
+#if !OGLPLUS_NO_THREADS
+	std::lock_guard<std::mutex> lock(_mutex);
+#endif
+	return _stopped;
+}
+
+OGLPLUS_LIB_FUNC
+bool FrameCapture::Capture(void)
+{
+	if(Stopped()) return false;
+
+	// hand over the frames which the GPU has already finished
+	while(_pending > 0)
+	{
+		SyncWaitResult result = _fences[_head]->ClientWait(0);
+		if(result == SyncWaitResult::TimeoutExpired) break;
+		_retrieve_oldest();
+	}
+	if(_pending == _ring_size)
+	{
+		_wait_for_oldest();
+		_retrieve_oldest();
+	}
+
+	GLuint region = (_head + _pending) % _ring_size;
+
+	_buffer.Bind(BufferTarget::PixelPack);
+	GLint alignment = 4;
+	OGLPLUS_GLFUNC(GetIntegerv)(GL_PACK_ALIGNMENT, &alignment);
+	OGLPLUS_GLFUNC(PixelStorei)(GL_PACK_ALIGNMENT, 1);
+	OGLPLUS_GLFUNC(ReadPixels)(
+		0, 0,
+		_width,
+		_height,
+		GLenum(_format),
+		GL_UNSIGNED_BYTE,
+		reinterpret_cast<GLvoid*>(GLintptr(region * _frame_size))
+	);
+	OGLPLUS_GLFUNC(PixelStorei)(GL_PACK_ALIGNMENT, alignment);
+	OGLPLUS_CHECK(OGLPLUS_ERROR_INFO(ReadPixels));
+	Buffer::Unbind(BufferTarget::PixelPack);
+
+	_fences[region].reset(new Sync());
+	_numbers[region] = _captured++;
+	++_pending;
+
+	return !Stopped();
+}
+
+OGLPLUS_LIB_FUNC
+void FrameCapture::Finish(void)
+{
+	while(_pending > 0)
+	{
+		_wait_for_oldest();
+		_retrieve_oldest();
+	}
+	_wait_for_writers();
+
+	std::exception_ptr error;
+	{
+#if !OGLPLUS_NO_THREADS
+		std::lock_guard<std::mutex> lock(_mutex);
+#endif
+		std::swap(error, _error);
+	}
+	if(error) std::rethrow_exception(error);
+}
+
+#endif // sync
+
+} // namespace oglplus
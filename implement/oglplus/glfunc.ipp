@@ -0,0 +1,24 @@
+/**
+ *  @file oglplus/glfunc.ipp
+ *  @brief Implementation of the GL function call counting helpers
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+namespace oglplus {
+
+OGLPLUS_LIB_FUNC
+bool GLFuncCallsCountedByLibrary(void)
+{
+#if OGLPLUS_COUNT_GLFUNC_CALLS
+	return true;
+#else
+	return false;
+#endif
+}
+
+} // namespace oglplus
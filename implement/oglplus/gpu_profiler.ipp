@@ -0,0 +1,372 @@
+/**
+ *  @file oglplus/gpu_profiler.ipp
+ *  @brief Implementation of GPUProfiler
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <algorithm>
+#include <iomanip>
+#include <cstring>
+
+namespace oglplus {
+
+#if GL_VERSION_3_3 || GL_ARB_timer_query
+
+OGLPLUS_LIB_FUNC
+bool GPUProfiler::_debug_groups_available(void)
+{
+#if GL_KHR_debug
+	GLint major = context::StringQueries::MajorVersion();
+	GLint minor = context::StringQueries::MinorVersion();
+	if((major > 4) || ((major == 4) && (minor >= 3)))
+		return true;
+	return OGLPLUS_HAS_GL_EXT(KHR, debug);
+#else
+	return false;
+#endif
+}
+
+OGLPLUS_LIB_FUNC
+GPUProfiler::GPUProfiler(
+	GLuint latency,
+	std::size_t max_events,
+	bool debug_groups
+): _latency(latency)
+ , _max_events(max_events)
+ , _debug_groups(debug_groups && _debug_groups_available())
+ , _in_frame(false)
+ , _frame_number(0)
+ , _trace_origin(0)
+ , _has_origin(false)
+ , _harvested(0)
+ , _dropped(0)
+{
+	assert(_latency > 0);
+
+	ScopeStats frame;
+	frame.name = "Frame";
+	frame.path = frame.name;
+	frame.parent = 0;
+	frame.depth = 0;
+	_scopes.push_back(frame);
+	_children.push_back(std::vector<GLuint>());
+	ResetStats();
+}
+
+OGLPLUS_LIB_FUNC
+GPUProfiler::~GPUProfiler(void)
+{
+	if(!_all_queries.empty())
+	{
+		OGLPLUS_GLFUNC(DeleteQueries)(
+			GLsizei(_all_queries.size()),
+			_all_queries.data()
+		);
+		OGLPLUS_VERIFY(OGLPLUS_ERROR_INFO(DeleteQueries));
+	}
+}
+
+OGLPLUS_LIB_FUNC
+GLuint GPUProfiler::_find_scope(GLuint parent, const char* name)
+{
+	assert(parent < _children.size());
+	// there are usually just a few children, so the linear search
+	// is cheaper than hashing the name
+	const std::vector<GLuint>& children = _children[parent];
+	for(auto i=children.begin(), e=children.end(); i!=e; ++i)
+	{
+		if(_scopes[*i].name == name) return *i;
+	}
+
+	GLuint scope = GLuint(_scopes.size());
+	ScopeStats stats;
+	stats.name = name;
+	stats.path = _scopes[parent].path+"/"+stats.name;
+	stats.parent = parent;
+	stats.depth = _scopes[parent].depth+1;
+	stats.count = 0;
+	stats.total_ms = 0.0;
+	stats.min_ms = 0.0;
+	stats.max_ms = 0.0;
+	stats.last_ms = 0.0;
+	_scopes.push_back(stats);
+	_children.push_back(std::vector<GLuint>());
+	_children[parent].push_back(scope);
+	return scope;
+}
+
+OGLPLUS_LIB_FUNC
+GLuint GPUProfiler::_acquire_query(void)
+{
+	if(_free_queries.empty())
+	{
+		const std::size_t batch = 64;
+		std::size_t offs = _all_queries.size();
+		_all_queries.resize(offs+batch);
+		OGLPLUS_GLFUNC(GenQueries)(
+			GLsizei(batch),
+			_all_queries.data()+offs
+		);
+		OGLPLUS_CHECK(OGLPLUS_ERROR_INFO(GenQueries));
+		_free_queries.insert(
+			_free_queries.end(),
+			_all_queries.begin()+offs,
+			_all_queries.end()
+		);
+	}
+	GLuint query = _free_queries.back();
+	_free_queries.pop_back();
+	return query;
+}
+
+OGLPLUS_LIB_FUNC
+void GPUProfiler::_release_queries(_frame& frame)
+{
+	for(auto i=frame.records.begin(), e=frame.records.end(); i!=e; ++i)
+	{
+		_free_queries.push_back(i->begin_query);
+		if(i->end_query) _free_queries.push_back(i->end_query);
+	}
+	frame.records.clear();
+}
+
+OGLPLUS_LIB_FUNC
+void GPUProfiler::_begin(GLuint scope, const char* name)
+{
+	assert(_in_frame);
+	assert(!_frames.empty());
+
+	_record record;
+	record.scope = scope;
+	record.begin_query = _acquire_query();
+	record.end_query = 0;
+
+	OGLPLUS_GLFUNC(QueryCounter)(record.begin_query, GL_TIMESTAMP);
+	OGLPLUS_CHECK(OGLPLUS_ERROR_INFO(QueryCounter));
+
+	_frame& frame = _frames.back();
+	_open.push_back(frame.records.size());
+	frame.records.push_back(record);
+
+#if GL_KHR_debug
+	if(_debug_groups)
+	{
+		KHR_debug::PushGroup(
+			DebugSource::Application,
+			scope,
+			GLsizei(std::strlen(name)),
+			name
+		);
+	}
+#else
+	OGLPLUS_FAKE_USE(name);
+#endif
+}
+
+OGLPLUS_LIB_FUNC
+void GPUProfiler::_end(void)
+{
+	assert(_in_frame);
+	assert(!_open.empty());
+
+	_record& record = _frames.back().records[_open.back()];
+	_open.pop_back();
+	record.end_query = _acquire_query();
+
+	OGLPLUS_GLFUNC(QueryCounter)(record.end_query, GL_TIMESTAMP);
+	OGLPLUS_CHECK(OGLPLUS_ERROR_INFO(QueryCounter));
+
+#if GL_KHR_debug
+	if(_debug_groups) KHR_debug::PopGroup();
+#endif
+}
+
+OGLPLUS_LIB_FUNC
+void GPUProfiler::_collect(_frame& frame)
+{
+	for(auto i=frame.records.begin(), e=frame.records.end(); i!=e; ++i)
+	{
+		// a scope which was not ended
+		if(!i->end_query) continue;
+
+		_event event;
+		event.scope = i->scope;
+		event.frame = frame.number;
+		Managed<QueryOps>(i->begin_query).Result(event.begin);
+		Managed<QueryOps>(i->end_query).Result(event.end);
+		if(event.end < event.begin) event.end = event.begin;
+
+		ScopeStats& stats = _scopes[i->scope];
+		double ms = double(event.end-event.begin)*1.0e-6;
+		if((stats.count == 0) || (stats.min_ms > ms)) stats.min_ms = ms;
+		if((stats.count == 0) || (stats.max_ms < ms)) stats.max_ms = ms;
+		stats.last_ms = ms;
+		stats.total_ms += ms;
+		++stats.count;
+
+		if(_max_events > 0)
+		{
+			if(!_has_origin)
+			{
+				_trace_origin = event.begin;
+				_has_origin = true;
+			}
+			if(_events.size() == _max_events) _events.pop_front();
+			_events.push_back(event);
+		}
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void GPUProfiler::_harvest(void)
+{
+	assert(!_in_frame);
+	// the GPU should not be more than a couple of frames behind,
+	// the frames over this limit are dropped to bound the memory
+	const std::size_t max_pending = 2*_latency+2;
+
+	while(!_frames.empty())
+	{
+		_frame& frame = _frames.front();
+		assert(!frame.records.empty());
+		// the end of the frame is the last query issued in it,
+		// when it is available then so are all the others
+		GLuint last = frame.records.front().end_query;
+
+		if(_frame_number - frame.number < _latency) break;
+		if(Managed<QueryOps>(last).ResultAvailable())
+		{
+			_collect(frame);
+			++_harvested;
+		}
+		else if(_frames.size() > max_pending) ++_dropped;
+		else break;
+
+		_release_queries(frame);
+		_frames.pop_front();
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void GPUProfiler::BeginFrame(void)
+{
+	assert(!_in_frame);
+	_harvest();
+
+	_frames.push_back(_frame());
+	_frames.back().number = _frame_number++;
+	_in_frame = true;
+	_begin(0, _scopes[0].name.c_str());
+}
+
+OGLPLUS_LIB_FUNC
+void GPUProfiler::EndFrame(void)
+{
+	assert(_in_frame);
+	assert(!_open.empty());
+	// end the scopes which were left open
+	while(_open.size() > 1) _end();
+	_end();
+	_in_frame = false;
+}
+
+OGLPLUS_LIB_FUNC
+void GPUProfiler::BeginScope(const char* name)
+{
+	assert(_in_frame);
+	assert(!_open.empty());
+	assert(name != nullptr);
+	GLuint parent = _frames.back().records[_open.back()].scope;
+	_begin(_find_scope(parent, name), name);
+}
+
+OGLPLUS_LIB_FUNC
+void GPUProfiler::EndScope(void)
+{
+	// the frame itself is ended by EndFrame
+	assert(_in_frame);
+	assert(_open.size() > 1);
+	_end();
+}
+
+OGLPLUS_LIB_FUNC
+void GPUProfiler::_end_scope(GLuint frame, std::size_t record)
+{
+	// the record zero is the frame itself
+	assert(record > 0);
+	// the frame of the scope has already ended and the scope with it
+	if(!_in_frame || (frame != _frame_number-1)) return;
+	// the indices of the open records are increasing
+	auto pos = std::lower_bound(_open.begin(), _open.end(), record);
+	// the scope has already been ended
+	if((pos == _open.end()) || (*pos != record)) return;
+	// end also the scopes nested in it which were left open
+	while(_open.back() >= record) _end();
+}
+
+OGLPLUS_LIB_FUNC
+void GPUProfiler::ResetStats(void)
+{
+	for(auto i=_scopes.begin(), e=_scopes.end(); i!=e; ++i)
+	{
+		i->count = 0;
+		i->total_ms = 0.0;
+		i->min_ms = 0.0;
+		i->max_ms = 0.0;
+		i->last_ms = 0.0;
+	}
+	_events.clear();
+	_has_origin = false;
+}
+
+OGLPLUS_LIB_FUNC
+void GPUProfiler::WriteStats(std::ostream& output) const
+{
+	output << std::setprecision(6);
+	output << "[" << std::endl;
+	for(auto i=_scopes.begin(), e=_scopes.end(); i!=e; ++i)
+	{
+		if(i != _scopes.begin()) output << "," << std::endl;
+		output << "\t{\"path\": ";
+		aux::WriteJSONString(output, i->path);
+		output << ", \"depth\": " << i->depth;
+		output << ", \"count\": " << i->count;
+		output << ", \"total_ms\": " << i->total_ms;
+		output << ", \"mean_ms\": " << i->MeanMs();
+		output << ", \"min_ms\": " << i->min_ms;
+		output << ", \"max_ms\": " << i->max_ms;
+		output << ", \"last_ms\": " << i->last_ms;
+		output << "}";
+	}
+	output << std::endl << "]" << std::endl;
+}
+
+OGLPLUS_LIB_FUNC
+void GPUProfiler::WriteChromeTrace(std::ostream& output) const
+{
+	// the timestamps are in nanoseconds, the trace uses microseconds
+	output << std::fixed << std::setprecision(3);
+	output << "{\"traceEvents\": [" << std::endl;
+	for(auto i=_events.begin(), e=_events.end(); i!=e; ++i)
+	{
+		if(i != _events.begin()) output << "," << std::endl;
+		output << "\t{\"name\": ";
+		aux::WriteJSONString(output, _scopes[i->scope].name);
+		output << ", \"cat\": \"gpu\", \"ph\": \"X\"";
+		output << ", \"ts\": " << double(i->begin-_trace_origin)*1.0e-3;
+		output << ", \"dur\": " << double(i->end-i->begin)*1.0e-3;
+		output << ", \"pid\": 0, \"tid\": 0";
+		output << ", \"args\": {\"frame\": " << i->frame << "}}";
+	}
+	output << std::endl << "], \"displayTimeUnit\": \"ms\"}" << std::endl;
+	output.unsetf(std::ios_base::floatfield);
+}
+
+#endif // timer query
+
+} // namespace oglplus
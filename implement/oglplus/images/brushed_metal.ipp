@@ -117,6 +117,7 @@ BrushedMetalUByte::BrushedMetalUByte(
 	int t_disp_max
 ): Image(width, height, 1, 3, (GLubyte*)0)
 {
+	OGLPLUS_CPU_TRACE_SCOPE("images::BrushedMetal");
 	GLubyte *p = this->_begin_ub(), *e = this->_end_ub();
 	while(n_scratches--)
 	{
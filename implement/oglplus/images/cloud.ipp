@@ -139,6 +139,7 @@ Cloud::Cloud(
  , _sub_variance(sub_variance)
  , _min_radius(min_radius)
 {
+	OGLPLUS_CPU_TRACE_SCOPE("images::Cloud");
 	std::fill(this->_begin_ub(), this->_end_ub(), GLubyte(0));
 	_make_spheres(origin, init_radius);
 }
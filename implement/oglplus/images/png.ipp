@@ -199,6 +199,7 @@ PNGLoader::PNGLoader(
  , _validate_header(_input)
  , _png(*this)
 {
+	OGLPLUS_CPU_TRACE_SCOPE("images::PNG::Decode");
 	const size_t sig_size = 8;
 	::png_set_sig_bytes(_png._read, sig_size);
 	::png_read_info(_png._read, _png._info);
@@ -19,6 +19,7 @@ OGLPLUS_LIB_FUNC
 RandomRedUByte::RandomRedUByte(GLsizei width, GLsizei height, GLsizei depth)
  : Image(width, height, depth, 1, (GLubyte*)0)
 {
+	OGLPLUS_CPU_TRACE_SCOPE("images::RandomRed");
 	auto p = this->_begin_ub(), e = this->_end_ub();
 	for(GLsizei k=0; k!=depth; ++k)
 	for(GLsizei j=0; j!=height; ++j)
@@ -36,6 +37,7 @@ OGLPLUS_LIB_FUNC
 RandomRGBUByte::RandomRGBUByte(GLsizei width, GLsizei height, GLsizei depth)
  : Image(width, height, depth, 3, (GLubyte*)0)
 {
+	OGLPLUS_CPU_TRACE_SCOPE("images::RandomRGB");
 	auto p = this->_begin_ub(), e = this->_end_ub();
 	for(GLsizei k=0; k!=depth; ++k)
 	for(GLsizei j=0; j!=height; ++j)
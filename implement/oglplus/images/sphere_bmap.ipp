@@ -32,6 +32,7 @@ SphereBumpMap::SphereBumpMap(
 	PixelDataInternalFormat::RGBA16F
 )
 {
+	OGLPLUS_CPU_TRACE_SCOPE("images::SphereBumpMap");
 	assert(width != 0 && height != 0);
 	assert(xrep != 0 && yrep != 0);
 
@@ -24,6 +24,7 @@ Squares::Squares(
 	GLsizei yrep
 ): Image(width, height, 1, 1, (GLubyte*)0)
 {
+	OGLPLUS_CPU_TRACE_SCOPE("images::Squares");
 	assert(width != 0 && height != 0);
 	assert(ratio > 0.0f && ratio <= 1.0f);
 	assert(xrep != 0 && yrep != 0);
@@ -19,6 +19,7 @@ BlendFile::BlendFile(std::istream& input)
  , _info(_reader)
  , _glob_block_index(std::size_t(-1))
 {
+	OGLPLUS_CPU_TRACE_SCOPE("BlendFile::Parse");
 	std::size_t block_idx = 0;
 	while(!_eof(_reader))
 	{
@@ -61,6 +61,28 @@ std::size_t FindResourceFile(
 	return nexts;
 }
 
+OGLPLUS_LIB_FUNC
+std::string FindResourcePath(
+	const std::string& category,
+	const std::string& name,
+	const char* ext
+)
+{
+	const std::string dirsep = aux::FilesysPathSep();
+	const std::string pardir(aux::FilesysPathParDir() + dirsep);
+	const std::string path = category+dirsep+name+ext;
+	const std::string apppath = Application::RelativePath();
+	std::string prefix;
+
+	for(std::size_t i=0; i!=5; ++i)
+	{
+		std::ifstream file((apppath+prefix+path).c_str());
+		if(file.good()) return apppath+prefix+path;
+		prefix = pardir + prefix;
+	}
+	return std::string();
+}
+
 OGLPLUS_LIB_FUNC
 ResourceFile::ResourceFile(
 	const std::string& category,
@@ -0,0 +1,239 @@
+/**
+ *  @file oglplus/resource_loader.ipp
+ *  @brief Implementation of ResourceLoader
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+namespace oglplus {
+
+#if !OGLPLUS_NO_THREADS && (GL_VERSION_3_2 || GL_ARB_sync)
+
+OGLPLUS_LIB_FUNC
+ResourceLoader::ResourceLoader(
+	const ContextMaker& maker,
+	GLuint worker_count
+): _make_context(maker)
+ , _started(0)
+ , _quit(false)
+ , _completed(nullptr)
+ , _pending(0)
+{
+	assert(bool(_make_context));
+	assert(worker_count > 0);
+
+	for(GLuint i=0; i!=worker_count; ++i)
+	{
+		_workers.push_back(std::thread(&ResourceLoader::_work, this, i));
+	}
+
+	std::exception_ptr error;
+	{
+		std::unique_lock<std::mutex> lock(_mutex);
+		while(_started != worker_count) _cv.wait(lock);
+		error = _start_error;
+	}
+	if(error)
+	{
+		_stop();
+		std::rethrow_exception(error);
+	}
+}
+
+OGLPLUS_LIB_FUNC
+ResourceLoader::~ResourceLoader(void)
+{
+	_stop();
+
+	// the remaining jobs are deleted with their promises
+	// so the futures get broken_promise errors
+	for(auto i=_queued.begin(), e=_queued.end(); i!=e; ++i)
+		delete *i;
+	_collect();
+	for(auto i=_fenced.begin(), e=_fenced.end(); i!=e; ++i)
+		delete *i;
+}
+
+OGLPLUS_LIB_FUNC
+void ResourceLoader::_stop(void)
+{
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_quit = true;
+		_cv.notify_all();
+	}
+	for(auto i=_workers.begin(), e=_workers.end(); i!=e; ++i)
+		i->join();
+	_workers.clear();
+}
+
+OGLPLUS_LIB_FUNC
+void ResourceLoader::_work(GLuint index)
+{
+	std::shared_ptr<void> context;
+	std::exception_ptr error;
+	try { context = _make_context(index); }
+	catch(...) { error = std::current_exception(); }
+
+	std::unique_lock<std::mutex> lock(_mutex);
+	if(error && !_start_error) _start_error = error;
+	++_started;
+	_cv.notify_all();
+	if(error) return;
+
+	while(true)
+	{
+		while(_queued.empty() && !_quit) _cv.wait(lock);
+		if(_quit) break;
+
+		_task* task = _queued.front();
+		_queued.pop_front();
+		lock.unlock();
+
+		if(task->Run())
+		{
+			try { task->fence.reset(new Sync()); }
+			catch(...) { }
+			// make sure that the fence (or at least the commands
+			// of the job) gets to the GPU
+			if(task->fence) OGLPLUS_GLFUNC(Flush)();
+			else OGLPLUS_GLFUNC(Finish)();
+		}
+		_complete(task);
+
+		lock.lock();
+	}
+	lock.unlock();
+	// the context is released in the thread which made it current
+	context.reset();
+}
+
+OGLPLUS_LIB_FUNC
+void ResourceLoader::_submit(_task* task)
+{
+	std::lock_guard<std::mutex> lock(_mutex);
+	_queued.push_back(task);
+	++_pending;
+	_cv.notify_one();
+}
+
+OGLPLUS_LIB_FUNC
+void ResourceLoader::_complete(_task* task)
+{
+	_task* head = _completed.load(std::memory_order_relaxed);
+	do { task->next = head; }
+	while(!_completed.compare_exchange_weak(
+		head,
+		task,
+		std::memory_order_release,
+		std::memory_order_relaxed
+	));
+}
+
+OGLPLUS_LIB_FUNC
+void ResourceLoader::_collect(void)
+{
+	_task* head = _completed.exchange(nullptr, std::memory_order_acquire);
+	// the list is in the reverse order of completion
+	std::size_t count = 0;
+	for(_task* t=head; t; t=t->next) ++count;
+	_fenced.resize(_fenced.size()+count);
+	auto pos = _fenced.end();
+	for(_task* t=head; t; t=t->next) *(--pos) = t;
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t ResourceLoader::Publish(void)
+{
+	_collect();
+
+	std::size_t published = 0;
+	auto i = _fenced.begin();
+	while(i != _fenced.end())
+	{
+		_task* task = *i;
+		if(task->fence)
+		{
+			SyncWaitResult result = task->fence->ClientWait(0);
+			if(result == SyncWaitResult::TimeoutExpired)
+			{
+				++i;
+				continue;
+			}
+		}
+		i = _fenced.erase(i);
+		--_pending;
+		std::unique_ptr<_task> done(task);
+		done->Publish();
+		++published;
+	}
+	return published;
+}
+
+OGLPLUS_LIB_FUNC
+void ResourceLoader::Finish(void)
+{
+	while(true)
+	{
+		Publish();
+		if(_pending.load() == 0) break;
+		if(!_fenced.empty() && _fenced.front()->fence)
+		{
+			_fenced.front()->fence->ClientWait(1000000);
+		}
+		else std::this_thread::yield();
+	}
+}
+
+OGLPLUS_LIB_FUNC
+std::future<Texture> ResourceLoader::LoadTexture(
+	TextureTarget target,
+	images::Image image,
+	bool mipmap
+)
+{
+	// the image is shared, not copied, by the copies of the job
+	auto shared_image = std::make_shared<images::Image>(std::move(image));
+	return Load([target, shared_image, mipmap](void) -> Texture
+	{
+		Texture texture;
+		texture.Bind(target);
+		Texture::Image2D(target, *shared_image);
+		if(mipmap) Texture::GenerateMipmap(target);
+		else Texture::MinFilter(target, TextureMinFilter::Linear);
+		return texture;
+	});
+}
+
+OGLPLUS_LIB_FUNC
+std::future<Program> ResourceLoader::BuildProgram(
+	std::vector<std::pair<ShaderType, String>> sources
+)
+{
+	typedef std::vector<std::pair<ShaderType, String>> Sources;
+	auto shared_sources = std::make_shared<Sources>(std::move(sources));
+	return Load([shared_sources](void) -> Program
+	{
+		Program program;
+		std::vector<Shader> shaders;
+		shaders.reserve(shared_sources->size());
+		auto i = shared_sources->begin(), e = shared_sources->end();
+		while(i != e)
+		{
+			shaders.push_back(Shader(i->first));
+			shaders.back().Source(i->second).Compile();
+			program.AttachShader(shaders.back());
+			++i;
+		}
+		program.Link();
+		return program;
+	});
+}
+
+#endif // threads and sync
+
+} // namespace oglplus
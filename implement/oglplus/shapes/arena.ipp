@@ -0,0 +1,495 @@
+/**
+ *  @file oglplus/shapes/arena.ipp
+ *  @brief Implementation of shapes::GeometryArena
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <algorithm>
+
+namespace oglplus {
+namespace shapes {
+
+#if GL_VERSION_3_2 || (GL_ARB_draw_elements_base_vertex && GL_ARB_copy_buffer)
+
+OGLPLUS_LIB_FUNC
+GeometryArena::GeometryArena(
+	const std::vector<String>& names,
+	const std::vector<GLuint>& values_per_vertex,
+	GLuint vertex_capacity,
+	GLuint index_capacity,
+	BufferUsage usage
+): _names(names)
+ , _npvs(values_per_vertex)
+ , _attr_offsets(names.size(), 0)
+ , _stride(0)
+ , _usage(usage)
+ , _vertex_alloc(vertex_capacity)
+ , _index_alloc(index_capacity)
+ , _locations(names.size(), -1)
+{
+	assert(_names.size() == _npvs.size());
+	for(std::size_t i=0, n=_names.size(); i!=n; ++i)
+	{
+		_attr_offsets[i] = _stride;
+		_stride += _npvs[i];
+	}
+	assert(_stride > 0);
+
+	_vbo.Bind(Buffer::Target::CopyWrite);
+	Buffer::Data(
+		Buffer::Target::CopyWrite,
+		GLsizei(vertex_capacity*_stride),
+		(GLfloat*)nullptr,
+		_usage
+	);
+	_ibo.Bind(Buffer::Target::CopyWrite);
+	Buffer::Data(
+		Buffer::Target::CopyWrite,
+		GLsizei(index_capacity),
+		(GLuint*)nullptr,
+		_usage
+	);
+}
+
+OGLPLUS_LIB_FUNC
+void GeometryArena::_reallocate(
+	Buffer& buffer,
+	GLsizeiptr old_size,
+	GLsizeiptr new_size,
+	BufferUsage usage
+)
+{
+	Buffer temp;
+	temp.Bind(Buffer::Target::CopyWrite);
+	Buffer::Data(
+		Buffer::Target::CopyWrite,
+		GLsizei(new_size),
+		(GLubyte*)nullptr,
+		usage
+	);
+	if(old_size > 0)
+	{
+		buffer.Bind(Buffer::Target::CopyRead);
+		Buffer::CopySubData(
+			Buffer::Target::CopyRead,
+			Buffer::Target::CopyWrite,
+			0, 0,
+			old_size
+		);
+	}
+	buffer = std::move(temp);
+}
+
+OGLPLUS_LIB_FUNC
+void GeometryArena::_grow_vertices(GLuint needed)
+{
+	const std::size_t old_cap = _vertex_alloc.Capacity();
+	const std::size_t new_cap = std::max(2*old_cap, old_cap+needed);
+	_reallocate(
+		_vbo,
+		GLsizeiptr(old_cap*_stride*sizeof(GLfloat)),
+		GLsizeiptr(new_cap*_stride*sizeof(GLfloat)),
+		_usage
+	);
+	_vertex_alloc.Grow(new_cap);
+	if(_vao.IsInitialized()) _setup_vao();
+}
+
+OGLPLUS_LIB_FUNC
+void GeometryArena::_grow_indices(GLuint needed)
+{
+	const std::size_t old_cap = _index_alloc.Capacity();
+	const std::size_t new_cap = std::max(2*old_cap, old_cap+needed);
+	_reallocate(
+		_ibo,
+		GLsizeiptr(old_cap*sizeof(GLuint)),
+		GLsizeiptr(new_cap*sizeof(GLuint)),
+		_usage
+	);
+	_index_alloc.Grow(new_cap);
+	if(_vao.IsInitialized()) _setup_vao();
+}
+
+OGLPLUS_LIB_FUNC
+void GeometryArena::_setup_vao(void)
+{
+	assert(_vao.IsInitialized());
+	_vao.Bind();
+	_vbo.Bind(Buffer::Target::Array);
+	for(std::size_t i=0, n=_names.size(); i!=n; ++i)
+	{
+		if(_locations[i] < 0) continue;
+		VertexAttribArray attr((VertexAttribSlot(GLuint(_locations[i]))));
+		attr.Pointer(
+			GLint(_npvs[i]),
+			DataType::Float,
+			false,
+			GLsizei(_stride*sizeof(GLfloat)),
+			(const GLvoid*)(_attr_offsets[i]*sizeof(GLfloat))
+		);
+		attr.Enable();
+	}
+	_ibo.Bind(Buffer::Target::ElementArray);
+	VertexArray::Unbind();
+}
+
+OGLPLUS_LIB_FUNC
+void GeometryArena::UseInProgram(const ProgramOps& prog)
+{
+	for(std::size_t i=0, n=_names.size(); i!=n; ++i)
+	{
+		VertexAttribSlot location(0);
+		if(VertexAttribOps::QueryLocation(prog, _names[i], location))
+		{
+			_locations[i] = GLint(location);
+		}
+		else _locations[i] = -1;
+	}
+	if(!_vao.IsInitialized())
+	{
+		_vao.Assign(VertexArray());
+	}
+	_setup_vao();
+}
+
+OGLPLUS_LIB_FUNC
+GeometryArena::ShapeHandle GeometryArena::_load(
+	const std::vector<std::vector<GLfloat>>& data,
+	const std::vector<GLuint>& npvs,
+	std::vector<GLuint>& indices,
+	const DrawingInstructions& instr,
+	FaceOrientation face_winding,
+	const Vector<GLfloat, 4>& bounding_sphere
+)
+{
+	const std::size_t n = _names.size();
+	assert(data.size() == n);
+	assert(npvs.size() == n);
+
+	std::size_t vertex_count = 0;
+	for(std::size_t i=0; i!=n; ++i)
+	{
+		if(npvs[i] == 0) continue;
+		std::size_t count = data[i].size()/npvs[i];
+		if(vertex_count < count) vertex_count = count;
+	}
+
+	// interleave the vertex attributes, the missing
+	// components get the default values (0, 0, 0, 1)
+	std::vector<GLfloat> vertices(vertex_count*_stride, 0.0f);
+	for(std::size_t i=0; i!=n; ++i)
+	{
+		for(GLuint c=3; c<_npvs[i]; c+=4)
+		{
+			for(std::size_t v=0; v!=vertex_count; ++v)
+			{
+				vertices[v*_stride+_attr_offsets[i]+c] = 1.0f;
+			}
+		}
+		if(npvs[i] == 0) continue;
+		const GLuint m = std::min(npvs[i], _npvs[i]);
+		const std::size_t count = data[i].size()/npvs[i];
+		for(std::size_t v=0; v!=count; ++v)
+		{
+			std::copy(
+				data[i].begin()+v*npvs[i],
+				data[i].begin()+v*npvs[i]+m,
+				vertices.begin()+v*_stride+_attr_offsets[i]
+			);
+		}
+	}
+
+	_shape_entry shape;
+	shape.loaded = true;
+	shape.face_winding = face_winding;
+	shape.vertex_offset = 0;
+	shape.vertex_count = GLuint(vertex_count);
+	shape.index_offset = 0;
+	shape.index_count = GLuint(indices.size());
+	shape.ops = instr.Operations();
+	shape.bounding_sphere = bounding_sphere;
+
+	VertexArray::Unbind();
+	std::size_t offset = 0;
+	if(shape.vertex_count > 0)
+	{
+		if(!_vertex_alloc.Allocate(shape.vertex_count, offset))
+		{
+			_grow_vertices(shape.vertex_count);
+			bool allocated =
+				_vertex_alloc.Allocate(shape.vertex_count, offset);
+			assert(allocated);
+			OGLPLUS_FAKE_USE(allocated);
+		}
+		shape.vertex_offset = GLuint(offset);
+		_vbo.Bind(Buffer::Target::CopyWrite);
+		Buffer::SubData(
+			Buffer::Target::CopyWrite,
+			GLintptr(shape.vertex_offset*_stride),
+			vertices
+		);
+	}
+	if(shape.index_count > 0)
+	{
+		if(!_index_alloc.Allocate(shape.index_count, offset))
+		{
+			_grow_indices(shape.index_count);
+			bool allocated =
+				_index_alloc.Allocate(shape.index_count, offset);
+			assert(allocated);
+			OGLPLUS_FAKE_USE(allocated);
+		}
+		shape.index_offset = GLuint(offset);
+	}
+
+	// rewrite the drawing instructions and the restart indices
+	for(auto i=shape.ops.begin(), e=shape.ops.end(); i!=e; ++i)
+	{
+		if(i->method == DrawOperation::Method::DrawArrays)
+		{
+			i->first += shape.vertex_offset;
+			continue;
+		}
+		assert(i->first + i->count <= shape.index_count);
+		if(i->restart_index != DrawOperation::NoRestartIndex())
+		{
+			std::replace(
+				indices.begin()+i->first,
+				indices.begin()+i->first+i->count,
+				i->restart_index,
+				RestartIndex()
+			);
+			i->restart_index = RestartIndex();
+		}
+		i->first += shape.index_offset;
+	}
+	if(shape.index_count > 0)
+	{
+		_ibo.Bind(Buffer::Target::CopyWrite);
+		Buffer::SubData(
+			Buffer::Target::CopyWrite,
+			GLintptr(shape.index_offset),
+			indices
+		);
+	}
+
+	ShapeHandle handle;
+	if(_free_handles.empty())
+	{
+		handle = ShapeHandle(_shapes.size());
+		_shapes.push_back(std::move(shape));
+	}
+	else
+	{
+		handle = _free_handles.back();
+		_free_handles.pop_back();
+		_shapes[handle] = std::move(shape);
+	}
+	return handle;
+}
+
+OGLPLUS_LIB_FUNC
+void GeometryArena::Unload(ShapeHandle handle)
+{
+	assert(Loaded(handle));
+	_shape_entry& shape = _shapes[handle];
+	if(shape.vertex_count > 0)
+	{
+		_vertex_alloc.Deallocate(shape.vertex_offset, shape.vertex_count);
+	}
+	if(shape.index_count > 0)
+	{
+		_index_alloc.Deallocate(shape.index_offset, shape.index_count);
+	}
+	shape.loaded = false;
+	shape.ops.clear();
+	_free_handles.push_back(handle);
+}
+
+OGLPLUS_LIB_FUNC
+void GeometryArena::_setup_restart(bool restart, bool& enabled)
+{
+	if(restart && !enabled)
+	{
+		OGLPLUS_GLFUNC(Enable)(GL_PRIMITIVE_RESTART);
+		OGLPLUS_VERIFY(OGLPLUS_ERROR_INFO(Enable));
+		OGLPLUS_GLFUNC(PrimitiveRestartIndex)(RestartIndex());
+		OGLPLUS_VERIFY(OGLPLUS_ERROR_INFO(PrimitiveRestartIndex));
+		enabled = true;
+	}
+	else if(!restart && enabled)
+	{
+		OGLPLUS_GLFUNC(Disable)(GL_PRIMITIVE_RESTART);
+		OGLPLUS_VERIFY(OGLPLUS_ERROR_INFO(Disable));
+		enabled = false;
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void GeometryArena::Draw(ShapeHandle handle, GLuint inst_count) const
+{
+	const _shape_entry& shape = _shape(handle);
+	_gl.FrontFace(shape.face_winding);
+
+	bool restart_enabled = false;
+	for(auto i=shape.ops.begin(), e=shape.ops.end(); i!=e; ++i)
+	{
+		if(i->method == DrawOperation::Method::DrawArrays)
+		{
+			OGLPLUS_GLFUNC(DrawArraysInstanced)(
+				GLenum(i->mode),
+				GLint(i->first),
+				GLsizei(i->count),
+				GLsizei(inst_count)
+			);
+			OGLPLUS_CHECK(OGLPLUS_ERROR_INFO(DrawArraysInstanced));
+		}
+		else
+		{
+			_setup_restart(
+				i->restart_index != DrawOperation::NoRestartIndex(),
+				restart_enabled
+			);
+			OGLPLUS_GLFUNC(DrawElementsInstancedBaseVertex)(
+				GLenum(i->mode),
+				GLsizei(i->count),
+				GL_UNSIGNED_INT,
+				(const GLvoid*)(i->first*sizeof(GLuint)),
+				GLsizei(inst_count),
+				GLint(shape.vertex_offset)
+			);
+			OGLPLUS_CHECK(OGLPLUS_ERROR_INFO(
+				DrawElementsInstancedBaseVertex
+			));
+		}
+	}
+	_setup_restart(false, restart_enabled);
+}
+
+OGLPLUS_LIB_FUNC
+GeometryArena::_batch& GeometryArena::_find_batch(
+	FaceOrientation face_winding,
+	const DrawOperation& op
+) const
+{
+	const bool restart =
+		(op.method == DrawOperation::Method::DrawElements) &&
+		(op.restart_index != DrawOperation::NoRestartIndex());
+
+	for(auto i=_batches.begin(), e=_batches.end(); i!=e; ++i)
+	{
+		if(	(i->face_winding == face_winding) &&
+			(i->method == op.method) &&
+			(i->mode == op.mode) &&
+			(i->restart == restart)
+		) return *i;
+	}
+	_batch batch;
+	batch.face_winding = face_winding;
+	batch.method = op.method;
+	batch.mode = op.mode;
+	batch.restart = restart;
+	_batches.push_back(std::move(batch));
+	return _batches.back();
+}
+
+OGLPLUS_LIB_FUNC
+void GeometryArena::Draw(const std::vector<ShapeHandle>& handles) const
+{
+	// keep the storage of the batches allocated between the calls
+	for(auto i=_batches.begin(), e=_batches.end(); i!=e; ++i)
+	{
+		i->firsts.clear();
+		i->counts.clear();
+		i->offsets.clear();
+		i->base_vertices.clear();
+	}
+
+	for(auto h=handles.begin(), he=handles.end(); h!=he; ++h)
+	{
+		const _shape_entry& shape = _shape(*h);
+		auto i = shape.ops.begin(), e = shape.ops.end();
+		for(; i!=e; ++i)
+		{
+			_batch& batch = _find_batch(shape.face_winding, *i);
+			batch.firsts.push_back(GLint(i->first));
+			batch.counts.push_back(GLsizei(i->count));
+			batch.offsets.push_back(
+				(const GLvoid*)(i->first*sizeof(GLuint))
+			);
+			batch.base_vertices.push_back(GLint(shape.vertex_offset));
+		}
+	}
+
+	bool restart_enabled = false;
+	for(auto i=_batches.begin(), e=_batches.end(); i!=e; ++i)
+	{
+		if(i->counts.empty()) continue;
+		_gl.FrontFace(i->face_winding);
+		if(i->method == DrawOperation::Method::DrawArrays)
+		{
+			OGLPLUS_GLFUNC(MultiDrawArrays)(
+				GLenum(i->mode),
+				i->firsts.data(),
+				i->counts.data(),
+				GLsizei(i->counts.size())
+			);
+			OGLPLUS_CHECK(OGLPLUS_ERROR_INFO(MultiDrawArrays));
+		}
+		else
+		{
+			_setup_restart(i->restart, restart_enabled);
+			OGLPLUS_GLFUNC(MultiDrawElementsBaseVertex)(
+				GLenum(i->mode),
+				i->counts.data(),
+				GL_UNSIGNED_INT,
+				i->offsets.data(),
+				GLsizei(i->counts.size()),
+				i->base_vertices.data()
+			);
+			OGLPLUS_CHECK(OGLPLUS_ERROR_INFO(
+				MultiDrawElementsBaseVertex
+			));
+		}
+	}
+	_setup_restart(false, restart_enabled);
+}
+
+OGLPLUS_LIB_FUNC
+std::vector<GLuint> GeometryArena::IndirectCommands(
+	const std::vector<ShapeHandle>& handles,
+	PrimitiveType mode,
+	GLuint inst_count,
+	GLuint base_inst
+) const
+{
+	std::vector<GLuint> result;
+	for(auto h=handles.begin(), he=handles.end(); h!=he; ++h)
+	{
+		const _shape_entry& shape = _shape(*h);
+		auto i = shape.ops.begin(), e = shape.ops.end();
+		for(; i!=e; ++i)
+		{
+			if(i->method != DrawOperation::Method::DrawElements)
+				continue;
+			if(i->mode != mode) continue;
+			result.push_back(i->count);
+			result.push_back(inst_count);
+			result.push_back(i->first);
+			result.push_back(shape.vertex_offset);
+			result.push_back(base_inst);
+		}
+	}
+	return result;
+}
+
+#endif // GL_VERSION_3_2 || ARB_draw_elements_base_vertex
+
+} // shapes
+} // oglplus
+
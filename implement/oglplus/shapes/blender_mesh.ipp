@@ -633,6 +633,7 @@ void BlenderMesh::_call_load_meshes(
 	_loading_options opts
 )
 {
+	OGLPLUS_CPU_TRACE_SCOPE("BlenderMesh::Load");
 	opts.scene_name = scene_name;
 	opts.load_tangents |= opts.load_bitangents;
 	opts.load_bitangents |= opts.load_tangents;
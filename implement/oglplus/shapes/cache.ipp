@@ -0,0 +1,181 @@
+/**
+ *  @file oglplus/shapes/cache.ipp
+ *  @brief Implementation of ShapeCache
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+namespace oglplus {
+namespace shapes {
+
+OGLPLUS_LIB_FUNC
+std::size_t CachedShapeData::ByteSize(void) const
+{
+	std::size_t result = sizeof(*this);
+	for(unsigned a=0; a!=BuilderAttribs::Count; ++a)
+		result += _attribs[a].size()*sizeof(GLfloat);
+	result += _indices.size()*sizeof(GLuint);
+	result += _instructions.Operations().size()*sizeof(DrawOperation);
+	return result;
+}
+
+OGLPLUS_LIB_FUNC
+const GLfloat* CachedShape::AttribValues(
+	const String& name,
+	GLuint& values_per_vertex,
+	GLuint& value_count
+) const
+{
+	for(unsigned a=0; a!=BuilderAttribs::Count; ++a)
+	{
+		if(name == BuilderAttribs::Name(a))
+		{
+			const std::vector<GLfloat>& values = _data->_attribs[a];
+			if(values.empty()) break;
+			values_per_vertex = _data->_npvs[a];
+			value_count = GLuint(values.size());
+			return values.data();
+		}
+	}
+	values_per_vertex = 0;
+	value_count = 0;
+	return nullptr;
+}
+
+OGLPLUS_LIB_FUNC
+ShapeCache& ShapeCache::Default(void)
+{
+	static ShapeCache cache;
+	return cache;
+}
+
+OGLPLUS_LIB_FUNC
+ShapeCache::_data_ptr ShapeCache::_find(const std::string& key)
+{
+#if !OGLPLUS_NO_THREADS
+	std::lock_guard<std::mutex> lock(_mutex);
+#endif
+	auto pos = _entries.find(key);
+	if(pos == _entries.end())
+	{
+		++_misses;
+		return _data_ptr();
+	}
+	++_hits;
+	// move the entry to the front of the LRU list
+	_lru.splice(_lru.begin(), _lru, pos->second.lru);
+	return pos->second.data;
+}
+
+OGLPLUS_LIB_FUNC
+ShapeCache::_data_ptr ShapeCache::_insert(
+	const std::string& key,
+	const _data_ptr& data
+)
+{
+#if !OGLPLUS_NO_THREADS
+	std::lock_guard<std::mutex> lock(_mutex);
+#endif
+	// another thread may have made the same shape meanwhile
+	auto pos = _entries.find(key);
+	if(pos != _entries.end())
+		return pos->second.data;
+
+	_entry entry;
+	entry.data = data;
+	entry.size = data->ByteSize()+key.size();
+	_lru.push_front(key);
+	entry.lru = _lru.begin();
+	_entries.insert(_entry_map::value_type(key, entry));
+	_size += entry.size;
+	_evict();
+	return data;
+}
+
+OGLPLUS_LIB_FUNC
+void ShapeCache::_evict(void)
+{
+	// the most recently used entry is always kept
+	while((_size > _max_size) && (_lru.size() > 1))
+	{
+		auto pos = _entries.find(_lru.back());
+		assert(pos != _entries.end());
+		assert(_size >= pos->second.size);
+		_size -= pos->second.size;
+		_entries.erase(pos);
+		_lru.pop_back();
+	}
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t ShapeCache::Size(void) const
+{
+#if !OGLPLUS_NO_THREADS
+	std::lock_guard<std::mutex> lock(_mutex);
+#endif
+	return _size;
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t ShapeCache::MaxSize(void) const
+{
+#if !OGLPLUS_NO_THREADS
+	std::lock_guard<std::mutex> lock(_mutex);
+#endif
+	return _max_size;
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t ShapeCache::EntryCount(void) const
+{
+#if !OGLPLUS_NO_THREADS
+	std::lock_guard<std::mutex> lock(_mutex);
+#endif
+	return _entries.size();
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t ShapeCache::Hits(void) const
+{
+#if !OGLPLUS_NO_THREADS
+	std::lock_guard<std::mutex> lock(_mutex);
+#endif
+	return _hits;
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t ShapeCache::Misses(void) const
+{
+#if !OGLPLUS_NO_THREADS
+	std::lock_guard<std::mutex> lock(_mutex);
+#endif
+	return _misses;
+}
+
+OGLPLUS_LIB_FUNC
+void ShapeCache::SetMaxSize(std::size_t max_size)
+{
+#if !OGLPLUS_NO_THREADS
+	std::lock_guard<std::mutex> lock(_mutex);
+#endif
+	_max_size = max_size;
+	_evict();
+}
+
+OGLPLUS_LIB_FUNC
+void ShapeCache::Clear(void)
+{
+#if !OGLPLUS_NO_THREADS
+	std::lock_guard<std::mutex> lock(_mutex);
+#endif
+	_entries.clear();
+	_lru.clear();
+	_size = 0;
+}
+
+} // shapes
+} // oglplus
@@ -131,6 +131,18 @@ void DrawOperation::_DrawElements(
 ) const
 {
 	_SetupPrimitiveRestart();
+	_DrawElementsNoRestart(indices, index_data_type, inst_count, base_inst);
+	_CleanupPrimitiveRestart();
+}
+
+OGLPLUS_LIB_FUNC
+void DrawOperation::_DrawElementsNoRestart(
+	void* indices,
+	DataType index_data_type,
+	GLuint inst_count,
+	GLuint base_inst
+) const
+{
 	if(inst_count == 1)
 	{
 		OGLPLUS_GLFUNC(DrawElements)(
@@ -182,9 +194,367 @@ void DrawOperation::_DrawElements(
 		);
 #endif
 	}
-	_CleanupPrimitiveRestart();
+}
+
+OGLPLUS_LIB_FUNC
+void _MakeTriangleListRun(
+	PrimitiveType mode,
+	const std::vector<GLuint>& run,
+	std::vector<GLuint>& triangles
+)
+{
+	const std::size_t n = run.size();
+	for(std::size_t i=2; i<n; ++i)
+	{
+		GLuint a, b, c;
+		if(mode == PrimitiveType::Triangles)
+		{
+			if(i % 3 != 2) continue;
+			a = run[i-2]; b = run[i-1]; c = run[i];
+		}
+		else if(mode == PrimitiveType::TriangleStrip)
+		{
+			if(i % 2 == 0)
+			{
+				a = run[i-2]; b = run[i-1]; c = run[i];
+			}
+			else
+			{
+				a = run[i-1]; b = run[i-2]; c = run[i];
+			}
+		}
+		else
+		{
+			assert(mode == PrimitiveType::TriangleFan);
+			a = run[0]; b = run[i-1]; c = run[i];
+		}
+		// skip the degenerate triangles (for example in joined strips)
+		if((a == b) || (b == c) || (a == c)) continue;
+		triangles.push_back(a);
+		triangles.push_back(b);
+		triangles.push_back(c);
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void MakeTriangleList(
+	const DrawingInstructions& instructions,
+	const std::vector<GLuint>& indices,
+	std::vector<GLuint>& triangles
+)
+{
+	const std::vector<DrawOperation>& ops = instructions.Operations();
+	std::vector<GLuint> run;
+	for(auto i=ops.begin(), e=ops.end(); i!=e; ++i)
+	{
+		// only the triangle primitives are converted
+		if(	(i->mode != PrimitiveType::Triangles) &&
+			(i->mode != PrimitiveType::TriangleStrip) &&
+			(i->mode != PrimitiveType::TriangleFan)
+		) continue;
+
+		const bool elements =
+			(i->method == DrawOperation::Method::DrawElements);
+		const bool restart = elements &&
+			(i->restart_index != DrawOperation::NoRestartIndex());
+
+		run.clear();
+		for(GLuint k=0; k!=i->count; ++k)
+		{
+			GLuint index = elements?indices[i->first+k]:i->first+k;
+			if(restart && (index == i->restart_index))
+			{
+				_MakeTriangleListRun(i->mode, run, triangles);
+				run.clear();
+			}
+			else run.push_back(index);
+		}
+		_MakeTriangleListRun(i->mode, run, triangles);
+	}
+}
+
+OGLPLUS_LIB_FUNC
+const GLchar* BuilderAttribs::Name(unsigned index)
+{
+	static const GLchar* names[Count] = {
+		"Position",
+		"Normal",
+		"Tangent",
+		"Bitangent",
+		"TexCoord",
+		"Material"
+	};
+	assert(index < Count);
+	return names[index];
+}
+
+OGLPLUS_LIB_FUNC
+bool CompiledDrawingInstructions::_independent(PrimitiveType mode)
+{
+	return	(mode == PrimitiveType::Points) ||
+		(mode == PrimitiveType::Lines) ||
+		(mode == PrimitiveType::Triangles) ||
+		(mode == PrimitiveType::LinesAdjacency) ||
+		(mode == PrimitiveType::TrianglesAdjacency);
+}
+
+OGLPLUS_LIB_FUNC
+bool CompiledDrawingInstructions::_can_merge(
+	const Batch& batch,
+	const DrawOperation& op
+) const
+{
+	return	(batch.method == op.method) &&
+		(batch.mode == op.mode) &&
+		(batch.phase == op.phase) &&
+		(
+			(batch.method == DrawOperation::Method::DrawArrays) ||
+			(batch.restart_index == op.restart_index)
+		);
+}
+
+OGLPLUS_LIB_FUNC
+void CompiledDrawingInstructions::_add_op(const DrawOperation& op)
+{
+	assert(!_batches.empty());
+	Batch& batch = _batches.back();
+	if(batch.draw_count > 0 && _independent(op.mode))
+	{
+		// coalesce with the previous range if they are adjacent
+		GLint& prev_first = _firsts.back();
+		GLsizei& prev_count = _counts.back();
+		if(GLuint(prev_first) + GLuint(prev_count) == op.first)
+		{
+			prev_count += GLsizei(op.count);
+			return;
+		}
+	}
+	_firsts.push_back(GLint(op.first));
+	_counts.push_back(GLsizei(op.count));
+	_offsets.push_back((const GLvoid*)(op.first*_index_size));
+	++batch.draw_count;
+}
+
+OGLPLUS_LIB_FUNC
+void CompiledDrawingInstructions::_compile(
+	const std::vector<DrawOperation>& ops
+)
+{
+	_batches.reserve(ops.size());
+	_firsts.reserve(ops.size());
+	_counts.reserve(ops.size());
+	_offsets.reserve(ops.size());
+
+	for(auto i=ops.begin(), e=ops.end(); i!=e; ++i)
+	{
+		if(i->count == 0) continue;
+		if(_batches.empty() || !_can_merge(_batches.back(), *i))
+		{
+			Batch batch;
+			batch.method = i->method;
+			batch.mode = i->mode;
+			batch.restart_index = i->restart_index;
+			batch.phase = i->phase;
+			batch.offset = GLuint(_counts.size());
+			batch.draw_count = 0;
+			batch.indirect_offset = 0;
+			_batches.push_back(batch);
+		}
+		_add_op(*i);
+	}
+
+	// the offsets of the batches in the indirect command buffer
+	GLintptr indirect_offset = 0;
+	for(auto i=_batches.begin(), e=_batches.end(); i!=e; ++i)
+	{
+		i->indirect_offset = indirect_offset;
+		GLuint cmd_size =
+			(i->method == DrawOperation::Method::DrawArrays)?4:5;
+		indirect_offset += i->draw_count*cmd_size*sizeof(GLuint);
+	}
+}
+
+OGLPLUS_LIB_FUNC
+std::vector<GLuint> CompiledDrawingInstructions::IndirectCommands(
+	GLuint inst_count,
+	GLuint base_inst
+) const
+{
+	std::vector<GLuint> result;
+	result.reserve(_counts.size()*5);
+	for(auto i=_batches.begin(), e=_batches.end(); i!=e; ++i)
+	{
+		assert(result.size()*sizeof(GLuint) == GLuint(i->indirect_offset));
+		for(GLsizei c=0; c!=i->draw_count; ++c)
+		{
+			const GLuint cmd = i->offset+c;
+			// count, instance count, first
+			result.push_back(GLuint(_counts[cmd]));
+			result.push_back(inst_count);
+			result.push_back(GLuint(_firsts[cmd]));
+			// base vertex (for elements only)
+			if(i->method == DrawOperation::Method::DrawElements)
+			{
+				result.push_back(0);
+			}
+			result.push_back(base_inst);
+		}
+	}
+	return result;
+}
+
+OGLPLUS_LIB_FUNC
+void CompiledDrawingInstructions::_setup_restart(
+	const Batch& batch,
+	bool& enabled,
+	GLuint& index,
+	bool force
+) const
+{
+#if GL_VERSION_3_1
+	if(batch.restart_index == DrawOperation::NoRestartIndex())
+	{
+		if(enabled || force)
+		{
+			OGLPLUS_GLFUNC(Disable)(GL_PRIMITIVE_RESTART);
+			OGLPLUS_VERIFY(OGLPLUS_ERROR_INFO(Disable));
+			enabled = false;
+		}
+	}
+	else
+	{
+		if(!enabled || force)
+		{
+			OGLPLUS_GLFUNC(Enable)(GL_PRIMITIVE_RESTART);
+			OGLPLUS_VERIFY(OGLPLUS_ERROR_INFO(Enable));
+			enabled = true;
+		}
+		if((index != batch.restart_index) || force)
+		{
+			OGLPLUS_GLFUNC(PrimitiveRestartIndex)(
+				batch.restart_index
+			);
+			OGLPLUS_VERIFY(OGLPLUS_ERROR_INFO(
+				PrimitiveRestartIndex
+			));
+			index = batch.restart_index;
+		}
+	}
+#else
+	OGLPLUS_FAKE_USE(enabled);
+	OGLPLUS_FAKE_USE(index);
+	OGLPLUS_FAKE_USE(force);
+	assert(!
+		"Primitive restarting required, "
+		"but not supported by the used version of OpenGL!"
+	);
+#endif
+}
+
+OGLPLUS_LIB_FUNC
+void CompiledDrawingInstructions::_cleanup_restart(bool enabled) const
+{
+	if(enabled)
+	{
+		OGLPLUS_GLFUNC(Disable)(GL_PRIMITIVE_RESTART);
+		OGLPLUS_VERIFY(OGLPLUS_ERROR_INFO(Disable));
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void CompiledDrawingInstructions::_draw_batch(
+	const Batch& batch,
+	GLuint inst_count,
+	GLuint base_inst
+) const
+{
+	const bool elements =
+		(batch.method == DrawOperation::Method::DrawElements);
+
+	if((inst_count == 1) && (base_inst == 0))
+	{
+		if(elements)
+		{
+			OGLPLUS_GLFUNC(MultiDrawElements)(
+				GLenum(batch.mode),
+				_counts.data()+batch.offset,
+				GLenum(_index_type),
+				_offsets.data()+batch.offset,
+				batch.draw_count
+			);
+			OGLPLUS_CHECK(OGLPLUS_ERROR_INFO(MultiDrawElements));
+		}
+		else
+		{
+			OGLPLUS_GLFUNC(MultiDrawArrays)(
+				GLenum(batch.mode),
+				_firsts.data()+batch.offset,
+				_counts.data()+batch.offset,
+				batch.draw_count
+			);
+			OGLPLUS_CHECK(OGLPLUS_ERROR_INFO(MultiDrawArrays));
+		}
+		return;
+	}
+	// instanced drawing, the restart state is already set up
+	DrawOperation op;
+	op.method = batch.method;
+	op.mode = batch.mode;
+	op.restart_index = batch.restart_index;
+	op.phase = batch.phase;
+	for(GLsizei c=0; c!=batch.draw_count; ++c)
+	{
+		const GLuint cmd = batch.offset+c;
+		op.first = GLuint(_firsts[cmd]);
+		op.count = GLuint(_counts[cmd]);
+		if(elements)
+		{
+			op._DrawElementsNoRestart(
+				const_cast<GLvoid*>(_offsets[cmd]),
+				_index_type,
+				inst_count,
+				base_inst
+			);
+		}
+		else op._DrawArrays(inst_count, base_inst);
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void CompiledDrawingInstructions::_draw_batch_indirect(
+	const Batch& batch
+) const
+{
+#if GL_VERSION_4_3 || GL_ARB_multi_draw_indirect
+	if(batch.method == DrawOperation::Method::DrawElements)
+	{
+		OGLPLUS_GLFUNC(MultiDrawElementsIndirect)(
+			GLenum(batch.mode),
+			GLenum(_index_type),
+			(const GLvoid*)batch.indirect_offset,
+			batch.draw_count,
+			0
+		);
+		OGLPLUS_CHECK(OGLPLUS_ERROR_INFO(MultiDrawElementsIndirect));
+	}
+	else
+	{
+		OGLPLUS_GLFUNC(MultiDrawArraysIndirect)(
+			GLenum(batch.mode),
+			(const GLvoid*)batch.indirect_offset,
+			batch.draw_count,
+			0
+		);
+		OGLPLUS_CHECK(OGLPLUS_ERROR_INFO(MultiDrawArraysIndirect));
+	}
+#else
+	OGLPLUS_FAKE_USE(batch);
+	assert(!
+		"MultiDrawIndirect required, "
+		"but not supported by the used version of OpenGL!"
+	);
+#endif
 }
 
 } // shapes
 } // oglplus
-
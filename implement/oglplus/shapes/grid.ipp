@@ -15,32 +15,8 @@ namespace shapes {
 OGLPLUS_LIB_FUNC
 Grid::IndexArray Grid::Indices(void) const
 {
-	unsigned k = 0;
-
-	IndexArray indices((_udiv+1)*2 + (_vdiv+1)*2);
-
-	for(unsigned i=0; i!=(_udiv+1); ++i)
-	{
-		indices[k++] = i*2;
-		indices[k++] = i*2+1;
-	}
-
-	unsigned leap = (_udiv+1)*2;
-
-	indices[k++] = 0;
-	indices[k++] = leap-2;
-
-	for(unsigned j=0; j!=(_vdiv-1); ++j)
-	{
-		indices[k++] = leap+j*2;
-		indices[k++] = leap+j*2+1;
-	}
-
-	indices[k++] = 1;
-	indices[k++] = leap-1;
-
-	assert(k == indices.size());
-
+	IndexArray indices(IndexCount());
+	Indices(indices.begin());
 	return indices;
 }
 
@@ -53,7 +29,7 @@ DrawingInstructions Grid::Instructions(void) const
 	operation.method = DrawOperation::Method::DrawElements;
 	operation.mode = PrimitiveType::Lines;
 	operation.first = GLuint(0);
-	operation.count = GLuint((_udiv+1)*2+(_vdiv+1)*2);
+	operation.count = IndexCount();
 	operation.restart_index = DrawOperation::NoRestartIndex();
 	operation.phase = 0;
 	this->AddInstruction(instructions, operation);
@@ -0,0 +1,420 @@
+/**
+ *  @file oglplus/shapes/mesh_file.ipp
+ *  @brief Implementation of shapes::MeshFile
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+
+namespace oglplus {
+namespace shapes {
+
+OGLPLUS_LIB_FUNC
+MeshFile::HashValue MeshFile::Hash(
+	const void* data,
+	std::size_t size,
+	HashValue hash
+)
+{
+	const GLubyte* bytes = static_cast<const GLubyte*>(data);
+	for(std::size_t i=0; i!=size; ++i)
+	{
+		hash ^= bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+OGLPLUS_LIB_FUNC
+MeshFile::HashValue MeshFile::Hash(std::istream& input)
+{
+	HashValue hash = InitialHash();
+	char buffer[4096];
+	while(input.read(buffer, sizeof(buffer)) || input.gcount())
+	{
+		hash = Hash(buffer, std::size_t(input.gcount()), hash);
+	}
+	return hash;
+}
+
+OGLPLUS_LIB_FUNC
+MeshFile::HashValue MeshFile::HashFile(const std::string& path)
+{
+	aux::MappedFile file(path);
+	return Hash(file.Data(), file.Size());
+}
+
+OGLPLUS_LIB_FUNC
+const MeshFileHeader& MeshFile::_check(void) const
+{
+	if(_file.Size() < sizeof(MeshFileHeader))
+		throw std::runtime_error("Truncated .omc file");
+
+	const MeshFileHeader& header =
+		*reinterpret_cast<const MeshFileHeader*>(_file.Data());
+	if(std::memcmp(header.magic, "OGLpMSH", 8) != 0)
+		throw std::runtime_error("Not a .omc file");
+	if(header.byte_order != 0x01020304)
+		throw std::runtime_error("Wrong byte order of .omc file");
+	if(header.version != 1)
+		throw std::runtime_error("Unsupported .omc file version");
+
+	// the sizes are computed in 64 bits so that the values
+	// from a corrupted header cannot make them overflow
+	const std::uint64_t size = _file.Size();
+	const std::uint64_t attrib_end = std::uint64_t(header.attrib_offset)+
+		std::uint64_t(header.attrib_count)*sizeof(MeshFileAttrib);
+	const std::uint64_t index_end = std::uint64_t(header.index_offset)+
+		std::uint64_t(header.index_count)*sizeof(GLuint);
+	const std::uint64_t operation_end =
+		std::uint64_t(header.operation_offset)+
+		std::uint64_t(header.operation_count)*sizeof(MeshFileOperation);
+	const std::uint64_t name_end = std::uint64_t(header.name_offset)+
+		std::uint64_t(header.name_size);
+	if(	(attrib_end > size) ||
+		(index_end > size) ||
+		(operation_end > size) ||
+		(name_end > size)
+	) throw std::runtime_error("Truncated .omc file");
+	if(	(header.attrib_offset % 16 != 0) ||
+		(header.index_offset % 16 != 0) ||
+		(header.operation_offset % 16 != 0)
+	) throw std::runtime_error("Misaligned .omc file block");
+
+	const MeshFileAttrib* attribs =
+		reinterpret_cast<const MeshFileAttrib*>(
+			_file.Data()+header.attrib_offset
+		);
+	// the number of vertices for which all non-empty attributes
+	// have values (some builders provide empty attributes)
+	std::uint64_t vertex_count = 0;
+	bool has_values = false;
+	for(GLuint a=0; a!=header.attrib_count; ++a)
+	{
+		const MeshFileAttrib& attrib = attribs[a];
+		if(attrib.name[sizeof(attrib.name)-1] != '\0')
+			throw std::runtime_error("Invalid .omc attribute name");
+		if(attrib.values_per_vertex == 0)
+			throw std::runtime_error("Invalid .omc attribute");
+		if(attrib.offset % 16 != 0)
+			throw std::runtime_error("Misaligned .omc file block");
+		const std::uint64_t values_end = std::uint64_t(attrib.offset)+
+			std::uint64_t(attrib.value_count)*sizeof(GLfloat);
+		if(values_end > size)
+			throw std::runtime_error("Truncated .omc file");
+		if(attrib.value_count == 0) continue;
+		const std::uint64_t attrib_vertices =
+			attrib.value_count/attrib.values_per_vertex;
+		if(!has_values || (vertex_count > attrib_vertices))
+			vertex_count = attrib_vertices;
+		has_values = true;
+	}
+
+	// the operations must not draw past the indices or the vertices
+	const MeshFileOperation* ops =
+		reinterpret_cast<const MeshFileOperation*>(
+			_file.Data()+header.operation_offset
+		);
+	for(GLuint o=0; o!=header.operation_count; ++o)
+	{
+		std::uint64_t limit = 0;
+		switch(ops[o].method)
+		{
+			case GLuint(DrawOperation::Method::DrawArrays):
+				limit = vertex_count;
+				break;
+			case GLuint(DrawOperation::Method::DrawElements):
+				limit = header.index_count;
+				break;
+			default:
+				throw std::runtime_error(
+					"Invalid .omc drawing operation"
+				);
+		}
+		const std::uint64_t op_end = std::uint64_t(ops[o].first)+
+			std::uint64_t(ops[o].count);
+		if(op_end > limit)
+			throw std::runtime_error("Invalid .omc drawing operation");
+	}
+
+	// each of the names must be terminated inside of the name block
+	const char* name = reinterpret_cast<const char*>(
+		_file.Data()+header.name_offset
+	);
+	const char* names_end = name+header.name_size;
+	for(GLuint n=0; n!=header.name_count; ++n)
+	{
+		const void* term = std::memchr(name, '\0', names_end-name);
+		if(term == nullptr)
+			throw std::runtime_error("Invalid .omc mesh names");
+		name = static_cast<const char*>(term)+1;
+	}
+	return header;
+}
+
+OGLPLUS_LIB_FUNC
+MeshFile::MeshFile(const std::string& path)
+ : _file(path)
+ , _header(&_check())
+{ }
+
+OGLPLUS_LIB_FUNC
+bool MeshFile::UpToDate(
+	const std::string& path,
+	HashValue source_hash,
+	HashValue options_hash
+)
+{
+	try { return MeshFile(path).Matches(source_hash, options_hash); }
+	catch(std::runtime_error&) { return false; }
+}
+
+OGLPLUS_LIB_FUNC
+const GLfloat* MeshFile::AttribValues(
+	const String& name,
+	GLuint& values_per_vertex,
+	GLuint& value_count
+) const
+{
+	const MeshFileAttrib* attribs =
+		reinterpret_cast<const MeshFileAttrib*>(
+			_file.Data()+_header->attrib_offset
+		);
+	for(GLuint a=0; a!=_header->attrib_count; ++a)
+	{
+		if(name == attribs[a].name)
+		{
+			values_per_vertex = attribs[a].values_per_vertex;
+			value_count = attribs[a].value_count;
+			return reinterpret_cast<const GLfloat*>(
+				_file.Data()+attribs[a].offset
+			);
+		}
+	}
+	values_per_vertex = 0;
+	value_count = 0;
+	return nullptr;
+}
+
+OGLPLUS_LIB_FUNC
+DrawingInstructions MeshFile::Instructions(void) const
+{
+	const MeshFileOperation* ops =
+		reinterpret_cast<const MeshFileOperation*>(
+			_file.Data()+_header->operation_offset
+		);
+	auto instructions = this->MakeInstructions();
+	for(GLuint o=0; o!=_header->operation_count; ++o)
+	{
+		DrawOperation operation;
+		operation.method = DrawOperation::Method(ops[o].method);
+		operation.mode = PrimitiveType(ops[o].mode);
+		operation.first = ops[o].first;
+		operation.count = ops[o].count;
+		operation.restart_index = ops[o].restart_index;
+		operation.phase = ops[o].phase;
+		this->AddInstruction(instructions, operation);
+	}
+	return std::move(instructions);
+}
+
+OGLPLUS_LIB_FUNC
+std::vector<std::string> MeshFile::MeshNames(void) const
+{
+	std::vector<std::string> result;
+	result.reserve(_header->name_count);
+	const char* name = reinterpret_cast<const char*>(
+		_file.Data()+_header->name_offset
+	);
+	for(GLuint n=0; n!=_header->name_count; ++n)
+	{
+		result.push_back(std::string(name));
+		name += result.back().size()+1;
+	}
+	return std::move(result);
+}
+
+OGLPLUS_LIB_FUNC
+bool MeshFile::QueryMeshIndex(const std::string& name, GLuint& index) const
+{
+	const char* mesh_name = reinterpret_cast<const char*>(
+		_file.Data()+_header->name_offset
+	);
+	for(GLuint n=0; n!=_header->name_count; ++n)
+	{
+		if(name == mesh_name)
+		{
+			index = n;
+			return true;
+		}
+		mesh_name += std::strlen(mesh_name)+1;
+	}
+	return false;
+}
+
+OGLPLUS_LIB_FUNC
+GLuint MeshFile::GetMeshIndex(const std::string& name) const
+{
+	GLuint result = 0;
+	if(!QueryMeshIndex(name, result))
+	{
+		throw std::runtime_error(
+			"MeshFile: Unable to find index of mesh '"+
+			name +
+			"'"
+		);
+	}
+	return result;
+}
+
+// helper functor writing blocks of data and counting the written bytes
+struct MeshFileBlockWriter
+{
+	std::ostream& _output;
+	std::size_t& _written;
+
+	MeshFileBlockWriter(std::ostream& output, std::size_t& written)
+	 : _output(output)
+	 , _written(written)
+	{ }
+
+	void operator()(const void* data, std::size_t size) const
+	{
+		_output.write(static_cast<const char*>(data), size);
+		_written += size;
+	}
+};
+
+OGLPLUS_LIB_FUNC
+void MeshFile::_write(
+	std::ostream& output,
+	FaceOrientation face_winding,
+	const Vector<GLfloat, 4>& bounding_sphere,
+	const std::vector<std::vector<GLfloat> >& attrib_values,
+	const std::vector<GLuint>& attrib_npvs,
+	const std::vector<GLuint>& indices,
+	const DrawingInstructions& instructions,
+	const std::vector<std::string>& mesh_names,
+	HashValue source_hash,
+	HashValue options_hash
+)
+{
+	assert(attrib_values.size() == attrib_npvs.size());
+
+	MeshFileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, "OGLpMSH", 8);
+	header.byte_order = 0x01020304;
+	header.version = 1;
+	header.source_hash[0] = GLuint(source_hash);
+	header.source_hash[1] = GLuint(source_hash >> 32);
+	header.options_hash[0] = GLuint(options_hash);
+	header.options_hash[1] = GLuint(options_hash >> 32);
+	header.face_winding = GLenum(face_winding);
+	for(GLuint c=0; c!=4; ++c)
+		header.bounding_sphere[c] = bounding_sphere.At(c);
+
+	// the attributes which are not provided by the builder are skipped
+	std::vector<MeshFileAttrib> attribs;
+	std::vector<const std::vector<GLfloat>*> streams;
+	for(std::size_t a=0, n=attrib_values.size(); a!=n; ++a)
+	{
+		if(attrib_npvs[a] == 0) continue;
+		MeshFileAttrib attrib;
+		std::memset(&attrib, 0, sizeof(attrib));
+		std::strncpy(
+			attrib.name,
+			BuilderAttribs::Name(unsigned(a)),
+			sizeof(attrib.name)-1
+		);
+		attrib.values_per_vertex = attrib_npvs[a];
+		attrib.value_count = GLuint(attrib_values[a].size());
+		attribs.push_back(attrib);
+		streams.push_back(&attrib_values[a]);
+	}
+	header.attrib_count = GLuint(attribs.size());
+	header.attrib_offset = _align(GLuint(sizeof(header)));
+
+	GLuint offset = _align(
+		header.attrib_offset+
+		header.attrib_count*sizeof(MeshFileAttrib)
+	);
+	for(auto i=attribs.begin(), e=attribs.end(); i!=e; ++i)
+	{
+		i->offset = offset;
+		offset = _align(offset+i->value_count*sizeof(GLfloat));
+	}
+
+	header.index_count = GLuint(indices.size());
+	header.index_offset = offset;
+	offset = _align(offset+header.index_count*sizeof(GLuint));
+
+	const std::vector<DrawOperation>& operations =
+		instructions.Operations();
+	std::vector<MeshFileOperation> ops(operations.size());
+	for(std::size_t o=0, n=operations.size(); o!=n; ++o)
+	{
+		ops[o].method = GLuint(operations[o].method);
+		ops[o].mode = GLuint(operations[o].mode);
+		ops[o].first = operations[o].first;
+		ops[o].count = operations[o].count;
+		ops[o].restart_index = operations[o].restart_index;
+		ops[o].phase = operations[o].phase;
+	}
+	header.operation_count = GLuint(ops.size());
+	header.operation_offset = offset;
+	offset = _align(offset+header.operation_count*sizeof(MeshFileOperation));
+
+	std::vector<char> names;
+	for(auto i=mesh_names.begin(), e=mesh_names.end(); i!=e; ++i)
+	{
+		names.insert(names.end(), i->begin(), i->end());
+		names.push_back('\0');
+	}
+	header.name_count = GLuint(mesh_names.size());
+	header.name_offset = offset;
+	header.name_size = GLuint(names.size());
+
+	const char padding[16] = {0};
+	std::size_t written = 0;
+	MeshFileBlockWriter write(output, written);
+
+	write(&header, sizeof(header));
+	write(padding, header.attrib_offset-written);
+	if(!attribs.empty())
+		write(attribs.data(), attribs.size()*sizeof(MeshFileAttrib));
+	for(std::size_t a=0, n=attribs.size(); a!=n; ++a)
+	{
+		write(padding, attribs[a].offset-written);
+		if(!streams[a]->empty())
+		{
+			write(
+				streams[a]->data(),
+				streams[a]->size()*sizeof(GLfloat)
+			);
+		}
+	}
+	write(padding, header.index_offset-written);
+	if(!indices.empty())
+		write(indices.data(), indices.size()*sizeof(GLuint));
+	write(padding, header.operation_offset-written);
+	if(!ops.empty())
+		write(ops.data(), ops.size()*sizeof(MeshFileOperation));
+	write(padding, header.name_offset-written);
+	if(!names.empty())
+		write(names.data(), names.size());
+
+	if(!output.good())
+		throw std::runtime_error("Error writing .omc file");
+}
+
+} // shapes
+} // oglplus
@@ -0,0 +1,536 @@
+/**
+ *  @file oglplus/shapes/meshlets.ipp
+ *  @brief Implementation of shapes::Meshlets
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <algorithm>
+#include <utility>
+#include <limits>
+#include <cmath>
+
+namespace oglplus {
+namespace shapes {
+
+// Calculates the 30-bit Morton (Z-order) code of a point in a unit cube
+struct MeshletsMortonCode
+{
+	// inserts two zero bits between each of the low 10 bits of x
+	static GLuint _spread(GLuint x)
+	{
+		x &= 0x000003FF;
+		x = (x | (x << 16)) & 0x030000FF;
+		x = (x | (x <<  8)) & 0x0300F00F;
+		x = (x | (x <<  4)) & 0x030C30C3;
+		x = (x | (x <<  2)) & 0x09249249;
+		return x;
+	}
+
+	static GLuint _quantize(GLfloat v)
+	{
+		if(v <= 0.0f) return 0;
+		if(v >= 1.0f) return 1023;
+		return GLuint(v*1023.0f);
+	}
+
+	GLuint operator()(GLfloat x, GLfloat y, GLfloat z) const
+	{
+		return	(_spread(_quantize(x)) << 2)|
+			(_spread(_quantize(y)) << 1)|
+			(_spread(_quantize(z)) << 0);
+	}
+};
+
+OGLPLUS_LIB_FUNC
+void Meshlets::_build(
+	const std::vector<GLfloat>& positions,
+	GLuint npv,
+	const std::vector<GLuint>& triangles,
+	GLuint max_vertices,
+	GLuint max_triangles
+)
+{
+	assert(npv >= 3);
+	assert((max_vertices >= 3) && (max_vertices <= 256));
+	assert(max_triangles > 0);
+	assert(triangles.size() % 3 == 0);
+
+	const GLuint tri_count = GLuint(triangles.size()/3);
+	const GLuint vertex_count = GLuint(positions.size()/npv);
+	if(tri_count == 0) return;
+
+	// the triangles adjacent to each vertex
+	std::vector<GLuint> adj_offs(vertex_count+1, 0);
+	for(GLuint i=0; i!=tri_count*3; ++i)
+	{
+		assert(triangles[i] < vertex_count);
+		++adj_offs[triangles[i]+1];
+	}
+	for(GLuint v=0; v!=vertex_count; ++v)
+		adj_offs[v+1] += adj_offs[v];
+	std::vector<GLuint> adj(tri_count*3);
+	{
+		std::vector<GLuint> pos(adj_offs.begin(), adj_offs.end()-1);
+		for(GLuint i=0; i!=tri_count*3; ++i)
+			adj[pos[triangles[i]]++] = i/3;
+	}
+
+	// the centroids of the triangles and their bounding box
+	std::vector<GLfloat> centroids(tri_count*3);
+	GLfloat bmin[3], bmax[3];
+	for(GLuint c=0; c!=3; ++c)
+	{
+		bmin[c] = std::numeric_limits<GLfloat>::max();
+		bmax[c] =-std::numeric_limits<GLfloat>::max();
+	}
+	for(GLuint t=0; t!=tri_count; ++t)
+	{
+		for(GLuint c=0; c!=3; ++c)
+		{
+			GLfloat sum = 0.0f;
+			for(GLuint k=0; k!=3; ++k)
+				sum += positions[triangles[t*3+k]*npv+c];
+			sum /= 3.0f;
+			centroids[t*3+c] = sum;
+			if(bmin[c] > sum) bmin[c] = sum;
+			if(bmax[c] < sum) bmax[c] = sum;
+		}
+	}
+
+	// the seed triangles ordered along the Z-order curve
+	std::vector<std::pair<GLuint, GLuint> > order(tri_count);
+	{
+		GLfloat extent = 0.0f;
+		for(GLuint c=0; c!=3; ++c)
+			extent = std::max(extent, bmax[c]-bmin[c]);
+		const GLfloat scale = (extent > 0.0f)?1.0f/extent:0.0f;
+
+		MeshletsMortonCode morton;
+		for(GLuint t=0; t!=tri_count; ++t)
+		{
+			order[t].first = morton(
+				(centroids[t*3+0]-bmin[0])*scale,
+				(centroids[t*3+1]-bmin[1])*scale,
+				(centroids[t*3+2]-bmin[2])*scale
+			);
+			order[t].second = t;
+		}
+		std::sort(order.begin(), order.end());
+	}
+
+	const GLuint none = ~GLuint(0);
+	std::vector<bool> used(tri_count, false);
+	std::vector<GLuint> listed(tri_count, none);
+	std::vector<GLint> local(vertex_count, -1);
+	// the number of not yet used triangles adjacent to each vertex
+	std::vector<GLuint> live(vertex_count);
+	for(GLuint v=0; v!=vertex_count; ++v)
+		live[v] = adj_offs[v+1]-adj_offs[v];
+	std::vector<GLuint> candidates;
+
+	_indices.reserve(triangles.size());
+	_triangles.reserve(triangles.size());
+
+	GLuint seed_pos = 0;
+	while(true)
+	{
+		while((seed_pos != tri_count) && used[order[seed_pos].second])
+			++seed_pos;
+		if(seed_pos == tri_count) break;
+
+		const GLuint id = GLuint(_meshlets.size());
+		Meshlet meshlet;
+		meshlet.vertex_offset = GLuint(_vertices.size());
+		meshlet.vertex_count = 0;
+		meshlet.triangle_offset = GLuint(_triangles.size()/3);
+		meshlet.triangle_count = 0;
+
+		GLfloat sum[3] = {0.0f, 0.0f, 0.0f};
+		GLfloat cmin[3], cmax[3];
+		for(GLuint c=0; c!=3; ++c)
+		{
+			cmin[c] = std::numeric_limits<GLfloat>::max();
+			cmax[c] =-std::numeric_limits<GLfloat>::max();
+		}
+		candidates.clear();
+
+		GLuint next = order[seed_pos].second;
+		while(true)
+		{
+			// add the next triangle to the meshlet
+			used[next] = true;
+			for(GLuint k=0; k!=3; ++k)
+			{
+				const GLuint v = triangles[next*3+k];
+				--live[v];
+				if(local[v] < 0)
+				{
+					local[v] = GLint(meshlet.vertex_count++);
+					_vertices.push_back(v);
+					for(GLuint c=0; c!=3; ++c)
+					{
+						const GLfloat p = positions[v*npv+c];
+						if(cmin[c] > p) cmin[c] = p;
+						if(cmax[c] < p) cmax[c] = p;
+					}
+				}
+				_triangles.push_back(GLubyte(local[v]));
+				_indices.push_back(v);
+			}
+			for(GLuint c=0; c!=3; ++c)
+				sum[c] += centroids[next*3+c];
+			if(++meshlet.triangle_count == max_triangles) break;
+
+			// update the list of adjacent candidate triangles
+			for(GLuint k=0; k!=3; ++k)
+			{
+				const GLuint v = triangles[next*3+k];
+				for(GLuint a=adj_offs[v]; a!=adj_offs[v+1]; ++a)
+				{
+					const GLuint t = adj[a];
+					if(!used[t] && (listed[t] != id))
+					{
+						listed[t] = id;
+						candidates.push_back(t);
+					}
+				}
+			}
+
+			// pick the candidate adding the least new vertices,
+			// then the one whose vertices have the least remaining
+			// triangles (to avoid leaving small isolated fragments)
+			// and then the closest to the center of the meshlet
+			const GLfloat inv_count = 1.0f/meshlet.triangle_count;
+			next = none;
+			GLuint best_new = 4;
+			GLuint best_live = 0;
+			GLfloat best_dist = 0.0f;
+			std::size_t i = 0;
+			while(i != candidates.size())
+			{
+				const GLuint t = candidates[i];
+				if(used[t])
+				{
+					candidates[i] = candidates.back();
+					candidates.pop_back();
+					continue;
+				}
+				++i;
+				GLuint new_verts = 0, live_tris = 0;
+				for(GLuint k=0; k!=3; ++k)
+				{
+					const GLuint v = triangles[t*3+k];
+					if(local[v] < 0) ++new_verts;
+					live_tris += live[v];
+				}
+				if(meshlet.vertex_count+new_verts > max_vertices)
+					continue;
+				if(new_verts > best_new) continue;
+				if((new_verts == best_new) && (live_tris > best_live))
+					continue;
+
+				GLfloat dist = 0.0f;
+				for(GLuint c=0; c!=3; ++c)
+				{
+					GLfloat d = centroids[t*3+c]-sum[c]*inv_count;
+					dist += d*d;
+				}
+				if(	(new_verts < best_new) ||
+					(live_tris < best_live) ||
+					(dist < best_dist)
+				)
+				{
+					next = t;
+					best_new = new_verts;
+					best_live = live_tris;
+					best_dist = dist;
+				}
+			}
+
+			// if the meshlet has no more neighbours (for example
+			// if the mesh consists of many small disconnected parts)
+			// try to continue with the next triangle along the curve
+			// if it is close enough to the meshlet
+			if((next == none) && candidates.empty())
+			{
+				while(	(seed_pos != tri_count) &&
+					used[order[seed_pos].second]
+				) ++seed_pos;
+				if(seed_pos == tri_count) break;
+
+				const GLuint t = order[seed_pos].second;
+				bool fits =
+					(meshlet.vertex_count+3 <= max_vertices);
+				for(GLuint c=0; c!=3; ++c)
+				{
+					GLfloat slack = (cmax[c]-cmin[c])*0.5f;
+					GLfloat p = centroids[t*3+c];
+					if(	(p < cmin[c]-slack) ||
+						(p > cmax[c]+slack)
+					) fits = false;
+				}
+				if(fits) next = t;
+			}
+			if(next == none) break;
+		}
+
+		for(GLuint v=0; v!=meshlet.vertex_count; ++v)
+			local[_vertices[meshlet.vertex_offset+v]] = -1;
+
+		_bounds(meshlet, positions, npv);
+		_meshlets.push_back(meshlet);
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void Meshlets::_bounds(
+	Meshlet& meshlet,
+	const std::vector<GLfloat>& positions,
+	GLuint npv
+) const
+{
+	assert(meshlet.vertex_count > 0);
+	const GLuint* verts = _vertices.data()+meshlet.vertex_offset;
+
+	// the bounding sphere (Ritter's algorithm)
+	typedef Vector<GLfloat, 3> Vec3;
+	const GLfloat* pos = positions.data();
+	const Vec3 first(pos+verts[0]*npv, 3);
+	Vec3 a = first;
+	GLfloat max_dist = 0.0f;
+	for(GLuint v=0; v!=meshlet.vertex_count; ++v)
+	{
+		Vec3 p(pos+verts[v]*npv, 3);
+		GLfloat d = Distance(p, first);
+		if(max_dist < d) { max_dist = d; a = p; }
+	}
+	Vec3 b = a;
+	max_dist = 0.0f;
+	for(GLuint v=0; v!=meshlet.vertex_count; ++v)
+	{
+		Vec3 p(pos+verts[v]*npv, 3);
+		GLfloat d = Distance(p, a);
+		if(max_dist < d) { max_dist = d; b = p; }
+	}
+	Vec3 center = (a+b)*0.5f;
+	GLfloat radius = max_dist*0.5f;
+	for(GLuint v=0; v!=meshlet.vertex_count; ++v)
+	{
+		Vec3 p(pos+verts[v]*npv, 3);
+		GLfloat d = Distance(p, center);
+		if(d > radius)
+		{
+			GLfloat new_radius = (radius+d)*0.5f;
+			center = center+(p-center)*((new_radius-radius)/d);
+			radius = new_radius;
+		}
+	}
+	for(GLuint c=0; c!=3; ++c)
+		meshlet.center[c] = center.At(c);
+	meshlet.radius = radius;
+
+	// the normal cone
+	const GLfloat sign = (_face_winding == FaceOrientation::CW)?-1.0f:1.0f;
+	// the (nearly) degenerate triangles, for example at the poles
+	// of parametric shapes, have arbitrary normals and are skipped
+	const GLfloat min_area = radius*radius*1e-6f;
+	std::vector<Vec3> normals;
+	normals.reserve(meshlet.triangle_count);
+	Vec3 axis(0.0f, 0.0f, 0.0f);
+	for(GLuint t=0; t!=meshlet.triangle_count; ++t)
+	{
+		const GLubyte* tri = _triangles.data()+
+			(meshlet.triangle_offset+t)*3;
+		Vec3 p0(pos+verts[tri[0]]*npv, 3);
+		Vec3 p1(pos+verts[tri[1]]*npv, 3);
+		Vec3 p2(pos+verts[tri[2]]*npv, 3);
+		Vec3 n = Cross(p1-p0, p2-p0);
+		GLfloat l = Length(n);
+		if(l > min_area)
+		{
+			n = n*(sign/l);
+			normals.push_back(n);
+			axis = axis+n;
+		}
+	}
+	GLfloat axis_len = Length(axis);
+	GLfloat min_dot = -1.0f;
+	if(axis_len > std::numeric_limits<GLfloat>::epsilon())
+	{
+		axis = axis*(1.0f/axis_len);
+		min_dot = 1.0f;
+		for(auto i=normals.begin(), e=normals.end(); i!=e; ++i)
+		{
+			GLfloat d = Dot(*i, axis);
+			if(min_dot > d) min_dot = d;
+		}
+	}
+	else axis = Vec3(0.0f, 0.0f, 1.0f);
+
+	for(GLuint c=0; c!=3; ++c)
+		meshlet.cone_axis[c] = axis.At(c);
+	meshlet.cone_cutoff = (min_dot <= 0.0f)?
+		1.0f:
+		std::sqrt(1.0f-min_dot*min_dot);
+}
+
+OGLPLUS_LIB_FUNC
+void Meshlets::_ranges(
+	const std::vector<GLuint>& meshlets,
+	std::vector<GLuint>& ranges
+) const
+{
+	for(auto i=meshlets.begin(), e=meshlets.end(); i!=e; ++i)
+	{
+		assert(*i < _meshlets.size());
+		const Meshlet& meshlet = _meshlets[*i];
+		const GLuint first = meshlet.triangle_offset*3;
+		const GLuint count = meshlet.triangle_count*3;
+		const std::size_t n = ranges.size();
+		if((n != 0) && (ranges[n-2]+ranges[n-1] == first))
+		{
+			ranges.back() += count;
+		}
+		else
+		{
+			ranges.push_back(first);
+			ranges.push_back(count);
+		}
+	}
+}
+
+OGLPLUS_LIB_FUNC
+DrawingInstructions Meshlets::Instructions(void) const
+{
+	DrawOperation operation;
+	operation.method = DrawOperation::Method::DrawElements;
+	operation.mode = PrimitiveType::Triangles;
+	operation.first = 0;
+	operation.count = GLuint(_indices.size());
+	operation.restart_index = DrawOperation::NoRestartIndex();
+	operation.phase = 0;
+
+	return this->MakeInstructions(operation);
+}
+
+OGLPLUS_LIB_FUNC
+DrawingInstructions Meshlets::Instructions(
+	const std::vector<GLuint>& meshlets
+) const
+{
+	std::vector<GLuint> ranges;
+	_ranges(meshlets, ranges);
+
+	auto instructions = this->MakeInstructions();
+	for(std::size_t i=0, n=ranges.size(); i!=n; i+=2)
+	{
+		DrawOperation operation;
+		operation.method = DrawOperation::Method::DrawElements;
+		operation.mode = PrimitiveType::Triangles;
+		operation.first = ranges[i+0];
+		operation.count = ranges[i+1];
+		operation.restart_index = DrawOperation::NoRestartIndex();
+		operation.phase = 0;
+		this->AddInstruction(instructions, operation);
+	}
+	return std::move(instructions);
+}
+
+OGLPLUS_LIB_FUNC
+std::vector<GLuint> Meshlets::IndirectCommands(
+	const std::vector<GLuint>& meshlets,
+	GLuint inst_count,
+	GLuint base_inst
+) const
+{
+	std::vector<GLuint> ranges;
+	_ranges(meshlets, ranges);
+
+	std::vector<GLuint> commands;
+	commands.reserve(ranges.size()/2*5);
+	for(std::size_t i=0, n=ranges.size(); i!=n; i+=2)
+	{
+		commands.push_back(ranges[i+1]);
+		commands.push_back(inst_count);
+		commands.push_back(ranges[i+0]);
+		commands.push_back(0);
+		commands.push_back(base_inst);
+	}
+	return std::move(commands);
+}
+
+OGLPLUS_LIB_FUNC
+GLuint Meshlets::Cull(
+	const Matrix<GLfloat, 4, 4>& m,
+	const Vector<GLfloat, 3>& camera_position,
+	std::vector<GLuint>& visible
+) const
+{
+	// the view frustum planes (Gribb and Hartmann)
+	GLfloat planes[6][4];
+	for(GLuint p=0; p!=6; ++p)
+	{
+		const std::size_t row = p/2;
+		const GLfloat sign = (p%2 == 0)?1.0f:-1.0f;
+		GLfloat len = 0.0f;
+		for(std::size_t c=0; c!=4; ++c)
+		{
+			planes[p][c] = m.At(3, c)+sign*m.At(row, c);
+			if(c < 3) len += planes[p][c]*planes[p][c];
+		}
+		len = std::sqrt(len);
+		if(len > 0.0f)
+		{
+			for(std::size_t c=0; c!=4; ++c)
+				planes[p][c] /= len;
+		}
+	}
+
+	GLuint count = 0;
+	for(GLuint i=0, n=GLuint(_meshlets.size()); i!=n; ++i)
+	{
+		const Meshlet& meshlet = _meshlets[i];
+		const GLfloat* c = meshlet.center;
+
+		bool inside = true;
+		for(GLuint p=0; p!=6; ++p)
+		{
+			GLfloat d =
+				planes[p][0]*c[0]+
+				planes[p][1]*c[1]+
+				planes[p][2]*c[2]+
+				planes[p][3];
+			if(d < -meshlet.radius)
+			{
+				inside = false;
+				break;
+			}
+		}
+		if(!inside) continue;
+
+		if(meshlet.cone_cutoff < 1.0f)
+		{
+			GLfloat v[3], vlen = 0.0f, vdot = 0.0f;
+			for(GLuint k=0; k!=3; ++k)
+			{
+				v[k] = c[k]-camera_position.At(k);
+				vlen += v[k]*v[k];
+				vdot += v[k]*meshlet.cone_axis[k];
+			}
+			vlen = std::sqrt(vlen);
+			if(vdot >= meshlet.cone_cutoff*vlen+meshlet.radius)
+				continue;
+		}
+		visible.push_back(i);
+		++count;
+	}
+	return count;
+}
+
+} // shapes
+} // oglplus
@@ -383,6 +383,7 @@ void ObjMesh::_call_load_meshes(
 	_loading_options opts
 )
 {
+	OGLPLUS_CPU_TRACE_SCOPE("ObjMesh::Load");
 	opts.load_tangents |= opts.load_bitangents;
 	opts.load_bitangents |= opts.load_tangents;
 	opts.load_texcoords |= opts.load_tangents;
@@ -0,0 +1,587 @@
+/**
+ *  @file oglplus/shapes/simplify.ipp
+ *  @brief Implementation of shapes::Simplify
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+#include <cmath>
+
+namespace oglplus {
+namespace shapes {
+
+// Orders vertices lexicographically by the values of their attributes
+struct SimplifyVertexLess
+{
+	const std::vector<GLfloat>* _attribs;
+	const GLuint* _npvs;
+	unsigned _count;
+
+	bool operator()(GLuint a, GLuint b) const
+	{
+		for(unsigned i=0; i!=_count; ++i)
+		{
+			const GLuint n = _npvs[i];
+			const GLfloat* pa = _attribs[i].data()+a*n;
+			const GLfloat* pb = _attribs[i].data()+b*n;
+			for(GLuint c=0; c!=n; ++c)
+			{
+				if(pa[c] < pb[c]) return true;
+				if(pa[c] > pb[c]) return false;
+			}
+		}
+		return false;
+	}
+};
+
+// Orders the unique vertices by the index of their first use
+struct SimplifyFirstUseLess
+{
+	const GLuint* _first_use;
+
+	bool operator()(GLuint a, GLuint b) const
+	{
+		return _first_use[a] < _first_use[b];
+	}
+};
+
+OGLPLUS_LIB_FUNC
+void Simplify::_weld(std::vector<GLuint>& triangles)
+{
+	if(_npvs[BuilderAttribs::Position] == 0) return;
+	const std::size_t vertex_count =
+		_attribs[BuilderAttribs::Position].size()/_npvs[BuilderAttribs::Position];
+
+	// the attributes which do not have values for all vertices
+	// (usually the attributes not provided by the builder) are dropped
+	for(unsigned a=0; a!=BuilderAttribs::Count; ++a)
+	{
+		if(_attribs[a].size() != vertex_count*_npvs[a])
+		{
+			_attribs[a].clear();
+			_npvs[a] = 0;
+		}
+	}
+
+	SimplifyVertexLess less = { _attribs, _npvs, BuilderAttribs::Count };
+	std::vector<GLuint> order(vertex_count);
+	for(std::size_t v=0; v!=vertex_count; ++v)
+		order[v] = GLuint(v);
+	std::sort(order.begin(), order.end(), less);
+
+	// assign the new indices to the unique vertices
+	std::vector<GLuint> remap(vertex_count);
+	std::vector<GLuint> unique;
+	unique.reserve(vertex_count);
+	for(std::size_t i=0; i!=vertex_count; ++i)
+	{
+		if(unique.empty() || less(unique.back(), order[i]))
+		{
+			unique.push_back(order[i]);
+		}
+		remap[order[i]] = GLuint(unique.size()-1);
+	}
+
+	// keep the original order of the unique vertices
+	std::vector<GLuint> first_use(unique.size(), GLuint(vertex_count));
+	for(std::size_t v=0; v!=vertex_count; ++v)
+	{
+		GLuint& f = first_use[remap[v]];
+		if(f > v) f = GLuint(v);
+	}
+	std::vector<GLuint> by_first(unique.size());
+	for(std::size_t u=0; u!=unique.size(); ++u)
+		by_first[u] = GLuint(u);
+	SimplifyFirstUseLess first_less = { first_use.data() };
+	std::sort(by_first.begin(), by_first.end(), first_less);
+	std::vector<GLuint> new_index(unique.size());
+	for(std::size_t u=0; u!=unique.size(); ++u)
+		new_index[by_first[u]] = GLuint(u);
+
+	for(unsigned a=0; a!=BuilderAttribs::Count; ++a)
+	{
+		const GLuint n = _npvs[a];
+		if(n == 0) continue;
+		std::vector<GLfloat> welded(unique.size()*n);
+		for(std::size_t u=0; u!=unique.size(); ++u)
+		{
+			std::copy(
+				_attribs[a].begin()+first_use[u]*n,
+				_attribs[a].begin()+first_use[u]*n+n,
+				welded.begin()+new_index[u]*n
+			);
+		}
+		_attribs[a].swap(welded);
+	}
+
+	for(auto i=triangles.begin(), e=triangles.end(); i!=e; ++i)
+	{
+		assert(*i < vertex_count);
+		*i = new_index[remap[*i]];
+	}
+}
+
+// A candidate edge collapse
+struct SimplifyCollapse
+{
+	double cost;
+	GLuint from, to;
+	GLuint from_version, to_version;
+
+	bool operator > (const SimplifyCollapse& that) const
+	{
+		return cost > that.cost;
+	}
+};
+
+// Helper class doing the edge collapses
+class SimplifyMesh
+{
+private:
+	const GLfloat* _pos;
+	std::vector<GLuint>& _tris;
+
+	std::vector<GLuint> _group;
+	std::vector<GLuint> _group_size;
+	std::vector<double> _quadric;
+	std::vector<double> _plane_count;
+	std::vector<bool> _locked;
+	std::vector<bool> _alive;
+	std::vector<bool> _tri_alive;
+	std::vector<GLuint> _version;
+	std::vector<std::vector<GLuint>> _vert_tris;
+
+	std::priority_queue<
+		SimplifyCollapse,
+		std::vector<SimplifyCollapse>,
+		std::greater<SimplifyCollapse>
+	> _queue;
+
+	std::vector<GLuint> _tmp_a, _tmp_b;
+
+	GLuint _live_tris;
+
+	static void _cross(
+		const GLfloat* p0,
+		const GLfloat* p1,
+		const GLfloat* p2,
+		double* n
+	)
+	{
+		const double u[3] = {p1[0]-p0[0], p1[1]-p0[1], p1[2]-p0[2]};
+		const double v[3] = {p2[0]-p0[0], p2[1]-p0[1], p2[2]-p0[2]};
+		n[0] = u[1]*v[2]-u[2]*v[1];
+		n[1] = u[2]*v[0]-u[0]*v[2];
+		n[2] = u[0]*v[1]-u[1]*v[0];
+	}
+
+	const GLfloat* _p(GLuint v) const
+	{
+		return _pos+v*3;
+	}
+
+	double _cost(GLuint from, GLuint to) const
+	{
+		const double* qa = _quadric.data()+_group[from]*10;
+		const double* qb = _quadric.data()+_group[to]*10;
+		double q[10];
+		for(unsigned i=0; i!=10; ++i) q[i] = qa[i]+qb[i];
+		const GLfloat* p = _p(to);
+		const double x = p[0], y = p[1], z = p[2];
+		const double sum =
+			q[0]*x*x + 2*q[1]*x*y + 2*q[2]*x*z + 2*q[3]*x +
+			q[4]*y*y + 2*q[5]*y*z + 2*q[6]*y +
+			q[7]*z*z + 2*q[8]*z +
+			q[9];
+		// the mean squared distance from the planes
+		const double count =
+			_plane_count[_group[from]]+
+			_plane_count[_group[to]];
+		return (count > 0.0)?sum/count:0.0;
+	}
+
+	void _push(GLuint from, GLuint to)
+	{
+		if(_locked[from]) return;
+		if(_group[from] == _group[to]) return;
+		SimplifyCollapse c = {
+			_cost(from, to),
+			from, to,
+			_version[from], _version[to]
+		};
+		_queue.push(c);
+	}
+
+	void _neighbours(GLuint v, std::vector<GLuint>& result) const
+	{
+		result.clear();
+		const std::vector<GLuint>& vt = _vert_tris[v];
+		for(auto t=vt.begin(), e=vt.end(); t!=e; ++t)
+		{
+			if(!_tri_alive[*t]) continue;
+			for(unsigned k=0; k!=3; ++k)
+			{
+				GLuint w = _tris[*t*3+k];
+				if(w != v) result.push_back(_group[w]);
+			}
+		}
+		std::sort(result.begin(), result.end());
+		result.erase(
+			std::unique(result.begin(), result.end()),
+			result.end()
+		);
+	}
+
+	bool _can_collapse(GLuint from, GLuint to)
+	{
+		const GLuint to_group = _group[to];
+		GLuint shared_tris = 0;
+		const std::vector<GLuint>& vt = _vert_tris[from];
+		for(auto t=vt.begin(), e=vt.end(); t!=e; ++t)
+		{
+			if(!_tri_alive[*t]) continue;
+			const GLuint* tri = _tris.data()+*t*3;
+			bool shared = false;
+			for(unsigned k=0; k!=3; ++k)
+			{
+				if(_group[tri[k]] == to_group)
+				{
+					// the edge must be shared with the same
+					// vertex, not with a vertex on a seam
+					if(tri[k] != to) return false;
+					shared = true;
+				}
+			}
+			if(shared)
+			{
+				++shared_tris;
+				continue;
+			}
+			// check if the triangle does not flip or degenerate
+			const GLfloat* p[3];
+			for(unsigned k=0; k!=3; ++k) p[k] = _p(tri[k]);
+			double n0[3], n1[3];
+			_cross(p[0], p[1], p[2], n0);
+			for(unsigned k=0; k!=3; ++k)
+			{
+				if(tri[k] == from) p[k] = _p(to);
+			}
+			_cross(p[0], p[1], p[2], n1);
+			const double d = n0[0]*n1[0]+n0[1]*n1[1]+n0[2]*n1[2];
+			const double l0 = n0[0]*n0[0]+n0[1]*n0[1]+n0[2]*n0[2];
+			const double l1 = n1[0]*n1[0]+n1[1]*n1[1]+n1[2]*n1[2];
+			if(d <= 0.2*std::sqrt(l0*l1)) return false;
+		}
+		if(shared_tris == 0) return false;
+
+		// the link condition, the vertices adjacent to both
+		// must be only those opposite to the collapsed edge
+		_neighbours(from, _tmp_a);
+		_neighbours(to, _tmp_b);
+		GLuint common = 0;
+		auto ia = _tmp_a.begin(), ea = _tmp_a.end();
+		auto ib = _tmp_b.begin(), eb = _tmp_b.end();
+		while((ia != ea) && (ib != eb))
+		{
+			if(*ia < *ib) ++ia;
+			else if(*ib < *ia) ++ib;
+			else
+			{
+				++common;
+				++ia;
+				++ib;
+			}
+		}
+		return common <= shared_tris;
+	}
+
+	void _collapse(GLuint from, GLuint to)
+	{
+		std::vector<GLuint>& vt = _vert_tris[from];
+		for(auto t=vt.begin(), e=vt.end(); t!=e; ++t)
+		{
+			if(!_tri_alive[*t]) continue;
+			GLuint* tri = _tris.data()+*t*3;
+			if((tri[0] == to) || (tri[1] == to) || (tri[2] == to))
+			{
+				_tri_alive[*t] = false;
+				--_live_tris;
+				continue;
+			}
+			for(unsigned k=0; k!=3; ++k)
+			{
+				if(tri[k] == from) tri[k] = to;
+			}
+			_vert_tris[to].push_back(*t);
+		}
+		vt.clear();
+		_alive[from] = false;
+
+		double* qa = _quadric.data()+_group[from]*10;
+		double* qb = _quadric.data()+_group[to]*10;
+		for(unsigned i=0; i!=10; ++i) qb[i] += qa[i];
+		_plane_count[_group[to]] += _plane_count[_group[from]];
+		++_version[to];
+
+		// update the costs of the edges incident to the target vertex
+		const std::vector<GLuint>& tvt = _vert_tris[to];
+		for(auto t=tvt.begin(), e=tvt.end(); t!=e; ++t)
+		{
+			if(!_tri_alive[*t]) continue;
+			for(unsigned k=0; k!=3; ++k)
+			{
+				GLuint w = _tris[*t*3+k];
+				if(w == to) continue;
+				_push(w, to);
+				_push(to, w);
+			}
+		}
+	}
+
+	void _init_groups(void);
+	void _init_quadrics(void);
+	void _init_locks(void);
+public:
+	SimplifyMesh(
+		const std::vector<GLfloat>& positions,
+		std::vector<GLuint>& triangles
+	): _pos(positions.data())
+	 , _tris(triangles)
+	 , _live_tris(GLuint(triangles.size()/3))
+	{
+		const std::size_t vertex_count = positions.size()/3;
+		const std::size_t tri_count = triangles.size()/3;
+
+		_alive.assign(vertex_count, true);
+		_tri_alive.assign(tri_count, true);
+		_version.assign(vertex_count, 0);
+		_vert_tris.resize(vertex_count);
+		for(std::size_t t=0; t!=tri_count; ++t)
+		{
+			for(unsigned k=0; k!=3; ++k)
+			{
+				_vert_tris[_tris[t*3+k]].push_back(GLuint(t));
+			}
+		}
+		_init_groups();
+		_init_quadrics();
+		_init_locks();
+
+		for(std::size_t t=0; t!=tri_count; ++t)
+		{
+			for(unsigned k=0; k!=3; ++k)
+			{
+				_push(_tris[t*3+k], _tris[t*3+(k+1)%3]);
+				_push(_tris[t*3+(k+1)%3], _tris[t*3+k]);
+			}
+		}
+	}
+
+	GLuint LiveTriangles(void) const
+	{
+		return _live_tris;
+	}
+
+	// Collapses edges until there are less than target triangles
+	// returns the maximum error of the collapsed edges
+	double Reduce(GLuint target)
+	{
+		double error = 0.0;
+		while((_live_tris > target) && !_queue.empty())
+		{
+			SimplifyCollapse c = _queue.top();
+			_queue.pop();
+			if(!_alive[c.from] || !_alive[c.to]) continue;
+			if(_version[c.from] != c.from_version) continue;
+			if(_version[c.to] != c.to_version) continue;
+			if(!_can_collapse(c.from, c.to)) continue;
+
+			_collapse(c.from, c.to);
+			if(error < c.cost) error = c.cost;
+		}
+		return std::sqrt(error);
+	}
+
+	void Emit(std::vector<GLuint>& indices) const
+	{
+		const std::size_t tri_count = _tri_alive.size();
+		for(std::size_t t=0; t!=tri_count; ++t)
+		{
+			if(!_tri_alive[t]) continue;
+			indices.insert(
+				indices.end(),
+				_tris.begin()+t*3,
+				_tris.begin()+t*3+3
+			);
+		}
+	}
+};
+
+// Orders vertices by their positions
+struct SimplifyPositionLess
+{
+	const GLfloat* _pos;
+
+	bool operator()(GLuint a, GLuint b) const
+	{
+		return std::lexicographical_compare(
+			_pos+a*3, _pos+a*3+3,
+			_pos+b*3, _pos+b*3+3
+		);
+	}
+};
+
+OGLPLUS_LIB_FUNC
+void SimplifyMesh::_init_groups(void)
+{
+	const std::size_t vertex_count = _alive.size();
+	SimplifyPositionLess less = { _pos };
+	std::vector<GLuint> order(vertex_count);
+	for(std::size_t v=0; v!=vertex_count; ++v)
+		order[v] = GLuint(v);
+	std::sort(order.begin(), order.end(), less);
+
+	_group.resize(vertex_count);
+	_group_size.clear();
+	for(std::size_t i=0; i!=vertex_count; ++i)
+	{
+		if((i == 0) || less(order[i-1], order[i]))
+		{
+			_group_size.push_back(0);
+		}
+		_group[order[i]] = GLuint(_group_size.size()-1);
+		++_group_size.back();
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void SimplifyMesh::_init_quadrics(void)
+{
+	_quadric.assign(_group_size.size()*10, 0.0);
+	_plane_count.assign(_group_size.size(), 0.0);
+	const std::size_t tri_count = _tri_alive.size();
+	for(std::size_t t=0; t!=tri_count; ++t)
+	{
+		const GLuint* tri = _tris.data()+t*3;
+		double n[3];
+		_cross(_p(tri[0]), _p(tri[1]), _p(tri[2]), n);
+		const double l = std::sqrt(n[0]*n[0]+n[1]*n[1]+n[2]*n[2]);
+		if(l <= 0.0) continue;
+		const double a = n[0]/l, b = n[1]/l, c = n[2]/l;
+		const GLfloat* p = _p(tri[0]);
+		const double d = -(a*p[0]+b*p[1]+c*p[2]);
+		const double q[10] = {
+			a*a, a*b, a*c, a*d,
+			b*b, b*c, b*d,
+			c*c, c*d,
+			d*d
+		};
+		for(unsigned k=0; k!=3; ++k)
+		{
+			double* dst = _quadric.data()+_group[tri[k]]*10;
+			for(unsigned i=0; i!=10; ++i) dst[i] += q[i];
+			_plane_count[_group[tri[k]]] += 1.0;
+		}
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void SimplifyMesh::_init_locks(void)
+{
+	const std::size_t vertex_count = _alive.size();
+	const std::size_t group_count = _group_size.size();
+	std::vector<bool> group_locked(group_count, false);
+
+	// the edges (by position) used by a single triangle are borders
+	std::vector<std::pair<GLuint, GLuint>> edges;
+	const std::size_t tri_count = _tri_alive.size();
+	edges.reserve(tri_count*3);
+	for(std::size_t t=0; t!=tri_count; ++t)
+	{
+		for(unsigned k=0; k!=3; ++k)
+		{
+			GLuint a = _group[_tris[t*3+k]];
+			GLuint b = _group[_tris[t*3+(k+1)%3]];
+			if(a > b) std::swap(a, b);
+			edges.push_back(std::make_pair(a, b));
+		}
+	}
+	std::sort(edges.begin(), edges.end());
+	for(std::size_t i=0, n=edges.size(); i!=n; )
+	{
+		std::size_t j = i+1;
+		while((j != n) && (edges[j] == edges[i])) ++j;
+		if(j - i == 1)
+		{
+			group_locked[edges[i].first] = true;
+			group_locked[edges[i].second] = true;
+		}
+		i = j;
+	}
+
+	// the vertices sharing their position with other vertices are seams
+	_locked.resize(vertex_count);
+	for(std::size_t v=0; v!=vertex_count; ++v)
+	{
+		_locked[v] =
+			group_locked[_group[v]] ||
+			(_group_size[_group[v]] > 1);
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void Simplify::_simplify(
+	std::vector<GLuint>& triangles,
+	GLuint level_count,
+	GLfloat reduction
+)
+{
+	_indices = triangles;
+	_level_offsets.push_back(0);
+	_level_offsets.push_back(GLuint(_indices.size()));
+	_level_errors.push_back(0.0f);
+
+	if((_npvs[BuilderAttribs::Position] != 3) || triangles.empty()) return;
+
+	SimplifyMesh mesh(_attribs[BuilderAttribs::Position], triangles);
+	GLfloat error = 0.0f;
+	for(GLuint level=1; level<level_count; ++level)
+	{
+		const GLuint before = mesh.LiveTriangles();
+		const GLuint target = GLuint(before*reduction);
+		GLfloat level_error = GLfloat(mesh.Reduce(target));
+		// stop if the mesh cannot be simplified any further
+		if(mesh.LiveTriangles() == before) break;
+		if(error < level_error) error = level_error;
+
+		mesh.Emit(_indices);
+		_level_offsets.push_back(GLuint(_indices.size()));
+		_level_errors.push_back(error);
+	}
+}
+
+OGLPLUS_LIB_FUNC
+DrawingInstructions Simplify::Instructions(GLuint level) const
+{
+	assert(level < LevelCount());
+	DrawOperation operation;
+	operation.method = DrawOperation::Method::DrawElements;
+	operation.mode = PrimitiveType::Triangles;
+	operation.first = _level_offsets[level];
+	operation.count = _level_offsets[level+1]-_level_offsets[level];
+	operation.restart_index = DrawOperation::NoRestartIndex();
+	operation.phase = 0;
+
+	return this->MakeInstructions(operation);
+}
+
+} // shapes
+} // oglplus
+
@@ -15,27 +15,11 @@ namespace shapes {
 OGLPLUS_LIB_FUNC
 Sphere::IndexArray Sphere::Indices(void) const
 {
-	assert((1<<(sizeof(GLushort)*8))-1>=((_rings+2)*(_sections+1)));
+	// the primitive restart index must also fit into the index type
+	assert((1<<(sizeof(GLushort)*8))-1>=IndexCount());
 	//
-	const unsigned n = (_rings + 1)*(2 * (_sections + 1) + 1);
-	//
-	IndexArray indices(n);
-	unsigned k = 0;
-	unsigned offs = 0;
-	// the triangle strips
-	for(unsigned r=0; r!=(_rings+1); ++r)
-	{
-		for(unsigned s=0; s!=(_sections+1); ++s)
-		{
-			indices[k++] = offs + s;
-			indices[k++] = offs + s + (_sections+1);
-		}
-		indices[k++] = n;
-		offs += _sections + 1;
-	}
-	assert(k == indices.size());
-	//
-	// return the indices
+	IndexArray indices(IndexCount());
+	Indices(indices.begin());
 	return std::move(indices);
 }
 
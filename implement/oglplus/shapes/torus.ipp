@@ -15,26 +15,10 @@ namespace shapes {
 OGLPLUS_LIB_FUNC
 Torus::IndexArray Torus::Indices(void) const
 {
-	const unsigned n = _rings * (2 * (_sections + 1) + 1);
-	assert((1<<(sizeof(GLushort)*8)) - 1 >= n);
-	//
-	IndexArray indices(n);
-	unsigned k = 0;
-	unsigned offs = 0;
-	// the triangle strips
-	for(unsigned r=0; r!=(_rings); ++r)
-	{
-		for(unsigned s=0; s!=(_sections+1); ++s)
-		{
-			indices[k++] = offs + s;
-			indices[k++] = offs + s + (_sections+1);
-		}
-		indices[k++] = n;
-		offs += _sections + 1;
-	}
-	assert(k == indices.size());
+	assert((1<<(sizeof(GLushort)*8)) - 1 >= IndexCount());
 	//
-	// return the indices
+	IndexArray indices(IndexCount());
+	Indices(indices.begin());
 	return indices;
 }
 
@@ -0,0 +1,817 @@
+/**
+ *  @file oglplus/shapes/triangle_bvh.ipp
+ *  @brief Implementation of shapes::TriangleBVH
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace oglplus {
+namespace shapes {
+
+// Axis-aligned bounding box used while building the hierarchy
+struct TriangleBVHBox
+{
+	GLfloat min[3];
+	GLfloat max[3];
+
+	TriangleBVHBox(void)
+	{
+		for(GLuint c=0; c!=3; ++c)
+		{
+			min[c] = std::numeric_limits<GLfloat>::max();
+			max[c] = -std::numeric_limits<GLfloat>::max();
+		}
+	}
+
+	void Add(const GLfloat* point)
+	{
+		for(GLuint c=0; c!=3; ++c)
+		{
+			if(min[c] > point[c]) min[c] = point[c];
+			if(max[c] < point[c]) max[c] = point[c];
+		}
+	}
+
+	void Add(const TriangleBVHBox& box)
+	{
+		for(GLuint c=0; c!=3; ++c)
+		{
+			if(min[c] > box.min[c]) min[c] = box.min[c];
+			if(max[c] < box.max[c]) max[c] = box.max[c];
+		}
+	}
+
+	// half of the surface area of the box
+	GLfloat Area(void) const
+	{
+		if(min[0] > max[0]) return 0.0f;
+		GLfloat dx = max[0]-min[0];
+		GLfloat dy = max[1]-min[1];
+		GLfloat dz = max[2]-min[2];
+		return dx*dy + dy*dz + dz*dx;
+	}
+};
+
+// A bin of triangles used for the evaluation of the split costs
+struct TriangleBVHBin
+{
+	TriangleBVHBox box;
+	GLuint count;
+
+	TriangleBVHBin(void)
+	 : count(0)
+	{ }
+};
+
+// Assigns triangles to bins along an axis by their centroids
+struct TriangleBVHBinning
+{
+	const std::vector<GLfloat>& _centroids;
+	GLuint _axis;
+	GLfloat _min;
+	GLfloat _scale;
+	GLuint _split;
+
+	enum { BinCount = 16 };
+
+	TriangleBVHBinning(
+		const std::vector<GLfloat>& centroids,
+		GLuint axis,
+		GLfloat min,
+		GLfloat max,
+		GLuint split = 0
+	): _centroids(centroids)
+	 , _axis(axis)
+	 , _min(min)
+	 , _scale(GLfloat(BinCount)*(1.0f-1e-5f)/(max-min))
+	 , _split(split)
+	{ }
+
+	GLuint Bin(GLuint triangle) const
+	{
+		GLfloat c = _centroids[triangle*3+_axis];
+		GLint bin = GLint((c-_min)*_scale);
+		if(bin < 0) return 0;
+		if(bin >= GLint(BinCount)) return BinCount-1;
+		return GLuint(bin);
+	}
+
+	// used as a predicate for partitioning of the triangles
+	bool operator()(GLuint triangle) const
+	{
+		return Bin(triangle) <= _split;
+	}
+};
+
+// Makes the node for the range of triangle references [begin, end)
+struct TriangleBVHBuildTask
+{
+	GLuint begin, end;
+	GLuint depth;
+	// the node whose offset should point to the new node
+	GLuint parent;
+};
+
+OGLPLUS_LIB_FUNC
+void TriangleBVH::_build(
+	const std::vector<GLfloat>& positions,
+	GLuint npv,
+	const std::vector<GLuint>& triangles,
+	GLuint max_leaf_size
+)
+{
+	assert(npv >= 3);
+	assert(max_leaf_size > 0);
+	assert(triangles.size() % 3 == 0);
+
+	const GLuint tri_count = GLuint(triangles.size()/3);
+
+	// the bounding boxes and the centroids of the triangles
+	std::vector<TriangleBVHBox> boxes(tri_count);
+	std::vector<GLfloat> centroids(tri_count*3);
+	for(GLuint t=0; t!=tri_count; ++t)
+	{
+		for(GLuint k=0; k!=3; ++k)
+		{
+			GLuint v = triangles[t*3+k];
+			assert((v+1)*npv <= positions.size());
+			boxes[t].Add(positions.data()+v*npv);
+		}
+		for(GLuint c=0; c!=3; ++c)
+		{
+			centroids[t*3+c] =
+				(boxes[t].min[c]+boxes[t].max[c])*0.5f;
+		}
+	}
+
+	std::vector<GLuint> refs(tri_count);
+	for(GLuint t=0; t!=tri_count; ++t) refs[t] = t;
+
+	_nodes.clear();
+	_nodes.reserve(tri_count > 0?(2*tri_count)/max_leaf_size+1:1);
+
+	// the nodes are built depth-first with an explicit stack of tasks
+	typedef TriangleBVHBuildTask task;
+	const GLuint no_parent = ~GLuint(0);
+	// the traversal stack in the queries is bounded by the depth
+	const GLuint max_depth = 60;
+	std::vector<task> tasks;
+	task root = {0, tri_count, 0, no_parent};
+	tasks.push_back(root);
+
+	const GLuint bin_count = TriangleBVHBinning::BinCount;
+	TriangleBVHBin bins[bin_count];
+	GLfloat right_areas[bin_count];
+	GLuint right_counts[bin_count];
+
+	while(!tasks.empty())
+	{
+		task current = tasks.back();
+		tasks.pop_back();
+
+		const GLuint index = GLuint(_nodes.size());
+		if(current.parent != no_parent)
+			_nodes[current.parent].offset = index;
+
+		TriangleBVHBox box, centroid_box;
+		for(GLuint r=current.begin; r!=current.end; ++r)
+		{
+			box.Add(boxes[refs[r]]);
+			centroid_box.Add(centroids.data()+refs[r]*3);
+		}
+
+		TriangleBVHNode node;
+		for(GLuint c=0; c!=3; ++c)
+		{
+			node.min[c] = box.min[c];
+			node.max[c] = box.max[c];
+		}
+		node.offset = current.begin;
+		node.count = current.end-current.begin;
+		_nodes.push_back(node);
+
+		const GLuint count = current.end-current.begin;
+		if((count <= 1) || (current.depth >= max_depth)) continue;
+
+		// find the cheapest split by the surface area heuristic
+		const GLfloat leaf_cost = GLfloat(count);
+		GLfloat best_cost = std::numeric_limits<GLfloat>::max();
+		GLuint best_axis = 0, best_split = 0;
+		for(GLuint axis=0; axis!=3; ++axis)
+		{
+			const GLfloat cmin = centroid_box.min[axis];
+			const GLfloat cmax = centroid_box.max[axis];
+			if(!(cmax > cmin)) continue;
+
+			TriangleBVHBinning binning(centroids, axis, cmin, cmax);
+			for(GLuint b=0; b!=bin_count; ++b)
+				bins[b] = TriangleBVHBin();
+			for(GLuint r=current.begin; r!=current.end; ++r)
+			{
+				TriangleBVHBin& bin = bins[binning.Bin(refs[r])];
+				bin.box.Add(boxes[refs[r]]);
+				++bin.count;
+			}
+
+			TriangleBVHBox right;
+			GLuint right_count = 0;
+			for(GLuint b=bin_count-1; b!=0; --b)
+			{
+				right.Add(bins[b].box);
+				right_count += bins[b].count;
+				right_areas[b] = right.Area();
+				right_counts[b] = right_count;
+			}
+
+			TriangleBVHBox left;
+			GLuint left_count = 0;
+			for(GLuint b=0; b+1!=bin_count; ++b)
+			{
+				left.Add(bins[b].box);
+				left_count += bins[b].count;
+				if((left_count == 0) || (right_counts[b+1] == 0))
+					continue;
+				GLfloat cost =
+					left.Area()*GLfloat(left_count)+
+					right_areas[b+1]*GLfloat(right_counts[b+1]);
+				if(best_cost > cost)
+				{
+					best_cost = cost;
+					best_axis = axis;
+					best_split = b;
+				}
+			}
+		}
+
+		// the relative cost of traversing the node and of its children
+		const GLfloat area = box.Area();
+		const GLfloat split_cost = (area > 0.0f)?
+			1.0f+best_cost/area:
+			leaf_cost;
+
+		GLuint middle;
+		if(best_cost == std::numeric_limits<GLfloat>::max())
+		{
+			// the centroids are all in the same place
+			if(count <= max_leaf_size) continue;
+			middle = current.begin+count/2;
+		}
+		else
+		{
+			if((count <= max_leaf_size) && (split_cost >= leaf_cost))
+				continue;
+			TriangleBVHBinning binning(
+				centroids,
+				best_axis,
+				centroid_box.min[best_axis],
+				centroid_box.max[best_axis],
+				best_split
+			);
+			middle = GLuint(std::partition(
+				refs.begin()+current.begin,
+				refs.begin()+current.end,
+				binning
+			)-refs.begin());
+			if((middle == current.begin) || (middle == current.end))
+				middle = current.begin+count/2;
+		}
+
+		// this is an inner node, its offset is set by the second child
+		_nodes.back().count = 0;
+
+		// the first child is built first so it follows the parent
+		task second = {middle, current.end, current.depth+1, index};
+		task first = {current.begin, middle, current.depth+1, no_parent};
+		tasks.push_back(second);
+		tasks.push_back(first);
+	}
+
+	// store the triangles in the order in which they are referenced
+	_triangles.resize(tri_count);
+	for(GLuint r=0; r!=tri_count; ++r)
+	{
+		const GLuint t = refs[r];
+		const GLfloat* a = positions.data()+triangles[t*3+0]*npv;
+		const GLfloat* b = positions.data()+triangles[t*3+1]*npv;
+		const GLfloat* c = positions.data()+triangles[t*3+2]*npv;
+		TriangleBVHTriangle& tri = _triangles[r];
+		for(GLuint k=0; k!=3; ++k)
+		{
+			tri.v0[k] = a[k];
+			tri.e1[k] = b[k]-a[k];
+			tri.e2[k] = c[k]-a[k];
+		}
+		tri.face = t;
+	}
+}
+
+OGLPLUS_LIB_FUNC
+TriangleBVHRay TriangleBVH::Ray(
+	const Vector<GLfloat, 3>& origin,
+	const Vector<GLfloat, 3>& direction,
+	GLfloat max_distance
+)
+{
+	TriangleBVHRay ray;
+	for(GLuint c=0; c!=3; ++c)
+	{
+		ray.origin[c] = origin.At(c);
+		ray.direction[c] = direction.At(c);
+	}
+	ray.min_distance = 0.0f;
+	ray.max_distance = max_distance;
+	return ray;
+}
+
+OGLPLUS_LIB_FUNC
+TriangleBVHRay TriangleBVH::Segment(
+	const Vector<GLfloat, 3>& from,
+	const Vector<GLfloat, 3>& to
+)
+{
+	return Ray(from, to-from, 1.0f);
+}
+
+OGLPLUS_LIB_FUNC
+TriangleBVHRay TriangleBVH::PickRay(
+	const Matrix<GLfloat, 4, 4>& projection_x_camera,
+	GLfloat x,
+	GLfloat y
+)
+{
+	Matrix<GLfloat, 4, 4> inv = Inverse(projection_x_camera);
+	Vector<GLfloat, 4> from = inv*Vector<GLfloat, 4>(x, y,-1.0f, 1.0f);
+	Vector<GLfloat, 4> to = inv*Vector<GLfloat, 4>(x, y, 1.0f, 1.0f);
+	return Segment(
+		Vector<GLfloat, 3>(from.Data(), 3)/from.w(),
+		Vector<GLfloat, 3>(to.Data(), 3)/to.w()
+	);
+}
+
+// Intersection tests used by the ray queries
+struct TriangleBVHTest
+{
+	// returns true if the ray hits the box of the node in [tmin, tmax]
+	// and the parameter of the entry point in entry
+	static bool Box(
+		const TriangleBVHNode& node,
+		const GLfloat* origin,
+		const GLfloat* inv_dir,
+		GLfloat tmin,
+		GLfloat tmax,
+		GLfloat& entry
+	)
+	{
+		for(GLuint c=0; c!=3; ++c)
+		{
+			GLfloat t0 = (node.min[c]-origin[c])*inv_dir[c];
+			GLfloat t1 = (node.max[c]-origin[c])*inv_dir[c];
+			if(t0 > t1) std::swap(t0, t1);
+			// written so that NaNs do not change the range
+			tmin = (t0 > tmin)?t0:tmin;
+			tmax = (t1 < tmax)?t1:tmax;
+		}
+		entry = tmin;
+		return tmin <= tmax;
+	}
+
+	// checks if the directions of the rays have the same signs,
+	// packets of rays going in different directions visit many
+	// nodes missed by most of their rays so it is better to trace
+	// them one by one
+	static bool Coherent(const TriangleBVHRay* rays, unsigned count)
+	{
+		for(unsigned l=1; l<count; ++l)
+		{
+			for(GLuint c=0; c!=3; ++c)
+			{
+				bool a = rays[0].direction[c] < 0.0f;
+				bool b = rays[l].direction[c] < 0.0f;
+				if(a != b) return false;
+			}
+		}
+		return true;
+	}
+
+	// the slab test for all rays in a packet, returns true if any
+	// of the rays hits the box and the closest entry point in entry
+	static bool PacketBox(
+		const TriangleBVHNode& node,
+		const GLfloat (&origin)[3][TriangleBVH::PacketSize],
+		const GLfloat (&inv_dir)[3][TriangleBVH::PacketSize],
+		const GLfloat (&tmin)[TriangleBVH::PacketSize],
+		const GLfloat (&tmax)[TriangleBVH::PacketSize],
+		GLfloat& entry
+	)
+	{
+		const unsigned P = TriangleBVH::PacketSize;
+		GLfloat t_near[P];
+		bool hit[P];
+		for(unsigned l=0; l!=P; ++l)
+		{
+			GLfloat t_far = tmax[l];
+			t_near[l] = tmin[l];
+			for(GLuint c=0; c!=3; ++c)
+			{
+				GLfloat t0 = (node.min[c]-origin[c][l])*inv_dir[c][l];
+				GLfloat t1 = (node.max[c]-origin[c][l])*inv_dir[c][l];
+				GLfloat lo = (t0 < t1)?t0:t1;
+				GLfloat hi = (t0 < t1)?t1:t0;
+				t_near[l] = (lo > t_near[l])?lo:t_near[l];
+				t_far = (hi < t_far)?hi:t_far;
+			}
+			hit[l] = (t_near[l] <= t_far);
+		}
+		bool result = false;
+		entry = std::numeric_limits<GLfloat>::max();
+		for(unsigned l=0; l!=P; ++l)
+		{
+			if(hit[l] && (entry > t_near[l])) entry = t_near[l];
+			result |= hit[l];
+		}
+		return result;
+	}
+
+	// the Moller-Trumbore ray/triangle intersection test,
+	// returns true if the triangle is hit in [tmin, tmax)
+	static bool Triangle(
+		const TriangleBVHTriangle& tri,
+		const GLfloat* o,
+		const GLfloat* d,
+		GLfloat tmin,
+		GLfloat tmax,
+		GLfloat& t,
+		GLfloat& u,
+		GLfloat& v
+	)
+	{
+		const GLfloat* e1 = tri.e1;
+		const GLfloat* e2 = tri.e2;
+		GLfloat p[3] = {
+			d[1]*e2[2]-d[2]*e2[1],
+			d[2]*e2[0]-d[0]*e2[2],
+			d[0]*e2[1]-d[1]*e2[0]
+		};
+		GLfloat det = e1[0]*p[0]+e1[1]*p[1]+e1[2]*p[2];
+		if(det == 0.0f) return false;
+		GLfloat inv_det = 1.0f/det;
+		GLfloat s[3] = {
+			o[0]-tri.v0[0],
+			o[1]-tri.v0[1],
+			o[2]-tri.v0[2]
+		};
+		u = (s[0]*p[0]+s[1]*p[1]+s[2]*p[2])*inv_det;
+		if((u < 0.0f) || (u > 1.0f)) return false;
+		GLfloat q[3] = {
+			s[1]*e1[2]-s[2]*e1[1],
+			s[2]*e1[0]-s[0]*e1[2],
+			s[0]*e1[1]-s[1]*e1[0]
+		};
+		v = (d[0]*q[0]+d[1]*q[1]+d[2]*q[2])*inv_det;
+		if((v < 0.0f) || (u+v > 1.0f)) return false;
+		t = (e2[0]*q[0]+e2[1]*q[1]+e2[2]*q[2])*inv_det;
+		return (t >= tmin) && (t < tmax);
+	}
+};
+
+OGLPLUS_LIB_FUNC
+bool TriangleBVH::_intersect(
+	const TriangleBVHRay& ray,
+	TriangleBVHHit& hit,
+	bool any_hit
+) const
+{
+	hit.face = TriangleBVHHit::NoFace();
+	hit.u = hit.v = 0.0f;
+	hit.distance = ray.max_distance;
+	if(_triangles.empty()) return false;
+
+	const GLfloat* o = ray.origin;
+	const GLfloat* d = ray.direction;
+	GLfloat inv_dir[3];
+	for(GLuint c=0; c!=3; ++c) inv_dir[c] = 1.0f/d[c];
+
+	// stack of the nodes to be visited and of their entry distances
+	GLuint stack_nodes[64];
+	GLfloat stack_entries[64];
+	GLuint top = 0;
+
+	GLfloat entry;
+	if(!TriangleBVHTest::Box(
+		_nodes[0], o, inv_dir,
+		ray.min_distance, ray.max_distance,
+		entry
+	)) return false;
+
+	GLuint index = 0;
+	while(true)
+	{
+		const TriangleBVHNode& node = _nodes[index];
+		if(node.count != 0)
+		{
+			const TriangleBVHTriangle* tri = &_triangles[node.offset];
+			for(GLuint i=0; i!=node.count; ++i, ++tri)
+			{
+				GLfloat t, u, v;
+				if(TriangleBVHTest::Triangle(
+					*tri, o, d,
+					ray.min_distance, hit.distance,
+					t, u, v
+				))
+				{
+					hit.face = tri->face;
+					hit.u = u;
+					hit.v = v;
+					hit.distance = t;
+					if(any_hit) return true;
+				}
+			}
+		}
+		else
+		{
+			GLuint first = index+1, second = node.offset;
+			GLfloat first_entry, second_entry;
+			bool first_hit = TriangleBVHTest::Box(
+				_nodes[first], o, inv_dir,
+				ray.min_distance, hit.distance,
+				first_entry
+			);
+			bool second_hit = TriangleBVHTest::Box(
+				_nodes[second], o, inv_dir,
+				ray.min_distance, hit.distance,
+				second_entry
+			);
+			if(first_hit && second_hit)
+			{
+				if(first_entry > second_entry)
+				{
+					std::swap(first, second);
+					std::swap(first_entry, second_entry);
+				}
+				assert(top < 64);
+				stack_nodes[top] = second;
+				stack_entries[top] = second_entry;
+				++top;
+				index = first;
+				continue;
+			}
+			else if(first_hit)
+			{
+				index = first;
+				continue;
+			}
+			else if(second_hit)
+			{
+				index = second;
+				continue;
+			}
+		}
+		// pop the next node which can still contain a closer hit
+		while(true)
+		{
+			if(top == 0) return hit.Hit();
+			--top;
+			if(stack_entries[top] <= hit.distance)
+			{
+				index = stack_nodes[top];
+				break;
+			}
+		}
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void TriangleBVH::_intersect_packet(
+	const TriangleBVHRay* rays,
+	unsigned count,
+	TriangleBVHHit* hits,
+	bool any_hit
+) const
+{
+	assert(count <= PacketSize);
+	const unsigned P = PacketSize;
+	const GLfloat max_distance = std::numeric_limits<GLfloat>::max();
+
+	// the rays in structure-of-arrays layout; the inactive lanes
+	// have an empty range so they never hit anything
+	GLfloat o[3][P], d[3][P], inv_dir[3][P];
+	GLfloat tmin[P], tmax[P], u[P], v[P];
+	GLuint face[P];
+	for(unsigned l=0; l!=P; ++l)
+	{
+		const TriangleBVHRay& ray = rays[l<count?l:0];
+		for(GLuint c=0; c!=3; ++c)
+		{
+			o[c][l] = ray.origin[c];
+			d[c][l] = ray.direction[c];
+			inv_dir[c][l] = 1.0f/ray.direction[c];
+		}
+		tmin[l] = ray.min_distance;
+		tmax[l] = (l<count)?ray.max_distance:-max_distance;
+		u[l] = v[l] = 0.0f;
+		face[l] = TriangleBVHHit::NoFace();
+	}
+	unsigned active = count;
+
+	GLuint stack[64];
+	GLuint top = 0;
+	GLfloat entry;
+	if(_triangles.empty() || !TriangleBVHTest::PacketBox(
+		_nodes[0], o, inv_dir, tmin, tmax,
+		entry
+	)) active = 0;
+
+	GLuint index = 0;
+	while(active != 0)
+	{
+		const TriangleBVHNode& node = _nodes[index];
+		if(node.count != 0)
+		{
+			const TriangleBVHTriangle* tri = &_triangles[node.offset];
+			for(GLuint i=0; i!=node.count; ++i, ++tri)
+			{
+				const GLfloat* e1 = tri->e1;
+				const GLfloat* e2 = tri->e2;
+				bool hit[P];
+				GLfloat t[P], tu[P], tv[P];
+				// the Moller-Trumbore test for all rays in the packet
+				// without branches so that it can be vectorized
+				for(unsigned l=0; l!=P; ++l)
+				{
+					GLfloat px = d[1][l]*e2[2]-d[2][l]*e2[1];
+					GLfloat py = d[2][l]*e2[0]-d[0][l]*e2[2];
+					GLfloat pz = d[0][l]*e2[1]-d[1][l]*e2[0];
+					GLfloat det = e1[0]*px+e1[1]*py+e1[2]*pz;
+					GLfloat inv_det = 1.0f/det;
+					GLfloat sx = o[0][l]-tri->v0[0];
+					GLfloat sy = o[1][l]-tri->v0[1];
+					GLfloat sz = o[2][l]-tri->v0[2];
+					tu[l] = (sx*px+sy*py+sz*pz)*inv_det;
+					GLfloat qx = sy*e1[2]-sz*e1[1];
+					GLfloat qy = sz*e1[0]-sx*e1[2];
+					GLfloat qz = sx*e1[1]-sy*e1[0];
+					tv[l] = (d[0][l]*qx+d[1][l]*qy+d[2][l]*qz)*inv_det;
+					t[l] = (e2[0]*qx+e2[1]*qy+e2[2]*qz)*inv_det;
+					hit[l] =(det != 0.0f) &
+						(tu[l] >= 0.0f) &
+						(tv[l] >= 0.0f) &
+						(tu[l]+tv[l] <= 1.0f) &
+						(t[l] >= tmin[l]) &
+						(t[l] < tmax[l]);
+				}
+				for(unsigned l=0; l!=P; ++l)
+				{
+					if(!hit[l]) continue;
+					face[l] = tri->face;
+					u[l] = tu[l];
+					v[l] = tv[l];
+					if(any_hit)
+					{
+						// deactivate the lane
+						hits[l].distance = t[l];
+						tmax[l] = -max_distance;
+						--active;
+					}
+					else tmax[l] = t[l];
+				}
+			}
+		}
+		else
+		{
+			GLuint first = index+1, second = node.offset;
+			GLfloat first_entry, second_entry;
+			bool first_hit = TriangleBVHTest::PacketBox(
+				_nodes[first], o, inv_dir, tmin, tmax,
+				first_entry
+			);
+			bool second_hit = TriangleBVHTest::PacketBox(
+				_nodes[second], o, inv_dir, tmin, tmax,
+				second_entry
+			);
+			if(first_hit && second_hit)
+			{
+				if(first_entry > second_entry)
+					std::swap(first, second);
+				assert(top < 64);
+				stack[top++] = second;
+				index = first;
+				continue;
+			}
+			else if(first_hit)
+			{
+				index = first;
+				continue;
+			}
+			else if(second_hit)
+			{
+				index = second;
+				continue;
+			}
+		}
+		// pop the next node still hit by some of the rays
+		bool found = false;
+		while(!found && (top != 0))
+		{
+			index = stack[--top];
+			found = TriangleBVHTest::PacketBox(
+				_nodes[index], o, inv_dir, tmin, tmax,
+				entry
+			);
+		}
+		if(!found) break;
+	}
+
+	for(unsigned l=0; l!=count; ++l)
+	{
+		hits[l].face = face[l];
+		hits[l].u = u[l];
+		hits[l].v = v[l];
+		if(!any_hit || (face[l] == TriangleBVHHit::NoFace()))
+			hits[l].distance = tmax[l];
+	}
+}
+
+OGLPLUS_LIB_FUNC
+bool TriangleBVH::Intersect(
+	const TriangleBVHRay& ray,
+	TriangleBVHHit& hit
+) const
+{
+	return _intersect(ray, hit, false);
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t TriangleBVH::Intersect(
+	const TriangleBVHRay* rays,
+	std::size_t count,
+	TriangleBVHHit* hits,
+	bool packets
+) const
+{
+	std::size_t result = 0;
+	for(std::size_t r=0; r<count; r+=PacketSize)
+	{
+		unsigned n = unsigned(std::min<std::size_t>(count-r, PacketSize));
+		if(packets && TriangleBVHTest::Coherent(rays+r, n))
+		{
+			_intersect_packet(rays+r, n, hits+r, false);
+		}
+		else
+		{
+			for(unsigned l=0; l!=n; ++l)
+				_intersect(rays[r+l], hits[r+l], false);
+		}
+		for(unsigned l=0; l!=n; ++l)
+			if(hits[r+l].Hit()) ++result;
+	}
+	return result;
+}
+
+OGLPLUS_LIB_FUNC
+bool TriangleBVH::Occluded(const TriangleBVHRay& ray) const
+{
+	TriangleBVHHit hit;
+	return _intersect(ray, hit, true);
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t TriangleBVH::Occluded(
+	const TriangleBVHRay* rays,
+	std::size_t count,
+	bool* occluded,
+	bool packets
+) const
+{
+	std::size_t result = 0;
+	TriangleBVHHit hits[PacketSize];
+	for(std::size_t r=0; r<count; r+=PacketSize)
+	{
+		unsigned n = unsigned(std::min<std::size_t>(count-r, PacketSize));
+		if(packets && TriangleBVHTest::Coherent(rays+r, n))
+		{
+			_intersect_packet(rays+r, n, hits, true);
+		}
+		else
+		{
+			for(unsigned l=0; l!=n; ++l)
+				_intersect(rays[r+l], hits[l], true);
+		}
+		for(unsigned l=0; l!=n; ++l)
+		{
+			occluded[r+l] = hits[l].Hit();
+			if(occluded[r+l]) ++result;
+		}
+	}
+	return result;
+}
+
+} // shapes
+} // oglplus
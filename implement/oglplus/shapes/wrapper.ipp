@@ -9,9 +9,192 @@
  *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
  */
 
+#include <oglplus/auxiliary/quantize.hpp>
+#include <cstring>
+
 namespace oglplus {
 namespace shapes {
 
+OGLPLUS_LIB_FUNC
+GLsizei ShapeWrapperBase::_choose_format(
+	const String& name,
+	GLuint npv,
+	bool quantized,
+	_attrib_format& format
+)
+{
+	format.type = DataType::Float;
+	format.normalized = false;
+	format.values = npv;
+	if(quantized)
+	{
+		if((name == "Position") || (name == "TexCoord"))
+		{
+			format.type = DataType::HalfFloat;
+			// keep the attributes aligned to four bytes
+			return GLsizei(((npv+1)/2)*2*sizeof(GLushort));
+		}
+#if GL_VERSION_3_3 || GL_ARB_vertex_type_2_10_10_10_rev
+		if((npv <= 4) && (
+			(name == "Normal") ||
+			(name == "Tangent") ||
+			(name == "Bitangent")
+		))
+		{
+			format.type = DataType::Int2_10_10_10_Rev;
+			format.normalized = true;
+			format.values = 4;
+			return GLsizei(sizeof(GLuint));
+		}
+#endif
+		if(name == "Material")
+		{
+			format.type = DataType::UnsignedByte;
+			return GLsizei(((npv+3)/4)*4);
+		}
+	}
+	return GLsizei(npv*sizeof(GLfloat));
+}
+
+OGLPLUS_LIB_FUNC
+void ShapeWrapperBase::_pack_values(
+	const _attrib_values& values,
+	GLuint npv,
+	const _attrib_format& format,
+	GLubyte* dest
+)
+{
+	const std::size_t n = values.size/npv;
+	for(std::size_t v=0; v!=n; ++v)
+	{
+		const GLfloat* src = values.data+v*npv;
+		GLubyte* dst = dest+format.offset+v*format.stride;
+		if(format.type == DataType::HalfFloat)
+		{
+			GLushort tmp[2];
+			for(GLuint c=0; c!=npv; ++c)
+			{
+				tmp[c%2] = aux::FloatToHalf(src[c]);
+				if(c%2 == 1 || c+1 == npv)
+				{
+					std::memcpy(
+						dst+(c/2)*sizeof(tmp),
+						tmp,
+						(c%2+1)*sizeof(GLushort)
+					);
+				}
+			}
+		}
+#if GL_VERSION_3_3 || GL_ARB_vertex_type_2_10_10_10_rev
+		else if(format.type == DataType::Int2_10_10_10_Rev)
+		{
+			GLfloat c[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+			for(GLuint i=0; i!=npv; ++i) c[i] = src[i];
+			GLuint tmp = aux::PackInt2_10_10_10Rev(
+				c[0], c[1], c[2], c[3]
+			);
+			std::memcpy(dst, &tmp, sizeof(tmp));
+		}
+#endif
+		else if(format.type == DataType::UnsignedByte)
+		{
+			for(GLuint c=0; c!=npv; ++c)
+			{
+				GLfloat val = src[c];
+				if(val < 0.0f) val = 0.0f;
+				if(val > 255.0f) val = 255.0f;
+				dst[c] = GLubyte(val+0.5f);
+			}
+		}
+		else std::memcpy(dst, src, npv*sizeof(GLfloat));
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void ShapeWrapperBase::_upload(
+	const std::vector<_attrib_values>& values,
+	const ShapeWrapperLayout& layout
+)
+{
+	const std::size_t n = _names.size();
+	assert(values.size() == n);
+	assert(_formats.size() == n);
+
+	std::vector<GLsizei> sizes(n, 0);
+	std::size_t vertex_count = 0;
+	GLsizei stride = 0;
+	for(std::size_t i=0; i!=n; ++i)
+	{
+		if(_npvs[i] == 0) continue;
+		sizes[i] = _choose_format(
+			_names[i],
+			_npvs[i],
+			layout.IsQuantized(),
+			_formats[i]
+		);
+		if(layout.IsInterleaved())
+		{
+			_formats[i].buffer = 0;
+			_formats[i].offset = stride;
+			stride += sizes[i];
+			std::size_t count = values[i].size/_npvs[i];
+			if(vertex_count < count)
+				vertex_count = count;
+		}
+		else
+		{
+			_formats[i].buffer = GLuint(i);
+			_formats[i].offset = 0;
+			_formats[i].stride = sizes[i];
+		}
+	}
+
+	if(layout.IsInterleaved())
+	{
+		if(stride == 0) return;
+		std::vector<GLubyte> packed(vertex_count*stride, 0);
+		for(std::size_t i=0; i!=n; ++i)
+		{
+			if(_npvs[i] == 0) continue;
+			_formats[i].stride = stride;
+			_pack_values(values[i], _npvs[i], _formats[i], packed.data());
+		}
+		_vbos[0].Bind(Buffer::Target::Array);
+		Buffer::Data(Buffer::Target::Array, packed);
+	}
+	else
+	{
+		std::vector<GLubyte> packed;
+		for(std::size_t i=0; i!=n; ++i)
+		{
+			if(_npvs[i] == 0) continue;
+			_vbos[i].Bind(Buffer::Target::Array);
+			if(_formats[i].type == DataType::Float)
+			{
+				Buffer::Data(
+					Buffer::Target::Array,
+					GLsizei(values[i].size),
+					values[i].data
+				);
+			}
+			else
+			{
+				packed.assign(
+					(values[i].size/_npvs[i])*sizes[i],
+					0
+				);
+				_pack_values(
+					values[i],
+					_npvs[i],
+					_formats[i],
+					packed.data()
+				);
+				Buffer::Data(Buffer::Target::Array, packed);
+			}
+		}
+	}
+}
+
 OGLPLUS_LIB_FUNC
 VertexArray ShapeWrapperBase::VAOForProgram(const ProgramOps& prog) const
 {
@@ -25,9 +208,16 @@ VertexArray ShapeWrapperBase::VAOForProgram(const ProgramOps& prog) const
 		{
 			try
 			{
-				_vbos[i].Bind(Buffer::Target::Array);
+				const _attrib_format& fmt = _formats[i];
+				_vbos[fmt.buffer].Bind(Buffer::Target::Array);
 				VertexAttribArray attr(prog, _names[i]);
-				attr.Setup<GLfloat>(_npvs[i]);
+				attr.Pointer(
+					fmt.values,
+					fmt.type,
+					fmt.normalized,
+					fmt.stride,
+					(const GLvoid*)fmt.offset
+				);
 				attr.Enable();
 			}
 			catch(Error&){ }
@@ -37,8 +227,7 @@ VertexArray ShapeWrapperBase::VAOForProgram(const ProgramOps& prog) const
 	assert((i+1) == _npvs.size());
 	if(_npvs[i] != 0)
 	{
-		assert((i+1) == _vbos.size());
-		_vbos[i].Bind(Buffer::Target::ElementArray);
+		_vbos[_vbos.size()-1].Bind(Buffer::Target::ElementArray);
 	}
 	return std::move(vao);
 }
@@ -0,0 +1,221 @@
+/**
+ *  @file oglplus/streaming_buffer.ipp
+ *  @brief Implementation of StreamingBuffer
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#if !OGLPLUS_NO_CHRONO
+#include <chrono>
+#else
+#include <ctime>
+#endif
+
+namespace oglplus {
+
+#if GL_VERSION_3_2 || GL_ARB_sync
+
+OGLPLUS_LIB_FUNC
+bool StreamingBuffer::_storage_available(void)
+{
+#if GL_VERSION_4_4 || GL_ARB_buffer_storage
+	GLint major = context::StringQueries::MajorVersion();
+	GLint minor = context::StringQueries::MinorVersion();
+	if((major > 4) || ((major == 4) && (minor >= 4)))
+		return true;
+	return OGLPLUS_HAS_GL_EXT(ARB, buffer_storage);
+#else
+	return false;
+#endif
+}
+
+OGLPLUS_LIB_FUNC
+StreamingBuffer::StreamingBuffer(
+	BufferTarget target,
+	GLsizeiptr region_size,
+	GLuint region_count,
+	bool allow_persistent
+): _target(target)
+ , _region_size(region_size)
+ , _region_count(region_count)
+ , _current(0)
+ , _used(0)
+ , _persistent(allow_persistent && _storage_available())
+ , _in_frame(false)
+ , _base(nullptr)
+ , _region_ptr(nullptr)
+ , _fences(region_count)
+ , _last_wait(0.0)
+ , _total_wait(0.0)
+ , _wait_count(0)
+{
+	assert(_region_size > 0);
+	assert(_region_count > 0);
+	_init_storage();
+}
+
+OGLPLUS_LIB_FUNC
+void StreamingBuffer::_init_storage(void)
+{
+	_buffer.Bind(_target);
+	GLsizeiptr total_size = _region_size * _region_count;
+#if GL_VERSION_4_4 || GL_ARB_buffer_storage
+	if(_persistent)
+	{
+		const GLbitfield flags =
+			GL_MAP_WRITE_BIT|
+			GL_MAP_PERSISTENT_BIT|
+			GL_MAP_COHERENT_BIT;
+
+		OGLPLUS_GLFUNC(BufferStorage)(
+			GLenum(_target),
+			total_size,
+			nullptr,
+			flags
+		);
+		OGLPLUS_CHECK(OGLPLUS_ERROR_INFO(BufferStorage));
+
+		_base = static_cast<GLubyte*>(OGLPLUS_GLFUNC(MapBufferRange)(
+			GLenum(_target),
+			0,
+			total_size,
+			flags
+		));
+		OGLPLUS_CHECK(OGLPLUS_ERROR_INFO(MapBufferRange));
+		return;
+	}
+#endif
+	OGLPLUS_GLFUNC(BufferData)(
+		GLenum(_target),
+		total_size,
+		nullptr,
+		GL_STREAM_DRAW
+	);
+	OGLPLUS_CHECK(OGLPLUS_ERROR_INFO(BufferData));
+}
+
+OGLPLUS_LIB_FUNC
+void StreamingBuffer::_map_region(void)
+{
+	_buffer.Bind(_target);
+	_region_ptr = static_cast<GLubyte*>(OGLPLUS_GLFUNC(MapBufferRange)(
+		GLenum(_target),
+		RegionOffset(),
+		_region_size,
+		GL_MAP_WRITE_BIT|
+		GL_MAP_UNSYNCHRONIZED_BIT|
+		GL_MAP_INVALIDATE_RANGE_BIT|
+		GL_MAP_FLUSH_EXPLICIT_BIT
+	));
+	OGLPLUS_CHECK(OGLPLUS_ERROR_INFO(MapBufferRange));
+}
+
+OGLPLUS_LIB_FUNC
+void StreamingBuffer::_unmap_region(void)
+{
+	_buffer.Bind(_target);
+	if(_used > 0)
+	{
+		OGLPLUS_GLFUNC(FlushMappedBufferRange)(
+			GLenum(_target),
+			0,
+			_used
+		);
+		OGLPLUS_VERIFY(OGLPLUS_ERROR_INFO(FlushMappedBufferRange));
+	}
+	OGLPLUS_GLFUNC(UnmapBuffer)(GLenum(_target));
+	OGLPLUS_VERIFY(OGLPLUS_ERROR_INFO(UnmapBuffer));
+	_region_ptr = nullptr;
+}
+
+OGLPLUS_LIB_FUNC
+void StreamingBuffer::_wait_for_region(void)
+{
+	_last_wait = 0.0;
+
+	std::unique_ptr<Sync>& fence = _fences[_current];
+	if(!fence) return;
+
+	// poll first, the fence of a region used
+	// several frames ago is usually already signaled
+	SyncWaitResult result = fence->ClientWait(0);
+	if(result == SyncWaitResult::TimeoutExpired)
+	{
+#if !OGLPLUS_NO_CHRONO
+		typedef std::chrono::steady_clock clock;
+		clock::time_point start = clock::now();
+#else
+		std::clock_t start = std::clock();
+#endif
+		// make sure that the fence gets to the GPU
+		OGLPLUS_GLFUNC(Flush)();
+		do { result = fence->ClientWait(1000000); }
+		while(result == SyncWaitResult::TimeoutExpired);
+#if !OGLPLUS_NO_CHRONO
+		_last_wait = std::chrono::duration<double>(
+			clock::now() - start
+		).count();
+#else
+		_last_wait = double(std::clock()-start)/double(CLOCKS_PER_SEC);
+#endif
+		_total_wait += _last_wait;
+		++_wait_count;
+	}
+	fence.reset();
+}
+
+OGLPLUS_LIB_FUNC
+void StreamingBuffer::BeginFrame(void)
+{
+	assert(!_in_frame);
+	_wait_for_region();
+	if(_persistent)
+	{
+		assert(_base != nullptr);
+		_region_ptr = _base + RegionOffset();
+	}
+	else _map_region();
+	_used = 0;
+	_in_frame = true;
+}
+
+OGLPLUS_LIB_FUNC
+void StreamingBuffer::EndFrame(void)
+{
+	assert(_in_frame);
+	if(!_persistent) _unmap_region();
+	_fences[_current].reset(new Sync());
+	_current = (_current + 1) % _region_count;
+	_in_frame = false;
+}
+
+OGLPLUS_LIB_FUNC
+StreamingBuffer::Allocation
+StreamingBuffer::Allocate(GLsizeiptr size, GLsizeiptr alignment)
+{
+	assert(_in_frame);
+	assert(_region_ptr != nullptr);
+	assert(alignment > 0);
+
+	// align the absolute offset in the buffer, not just
+	// the offset in the region, since that is what GL sees
+	GLintptr region_offs = RegionOffset();
+	GLintptr abs_offs = region_offs + _used;
+	abs_offs = ((abs_offs + alignment - 1) / alignment) * alignment;
+	GLsizeiptr offs = abs_offs - region_offs;
+
+	if(offs + size > _region_size)
+	{
+		return Allocation(nullptr, 0, 0);
+	}
+	_used = offs + size;
+	return Allocation(_region_ptr + offs, abs_offs, size);
+}
+
+#endif // sync
+
+} // namespace oglplus
@@ -11,92 +11,42 @@
 
 #include <oglplus/images/load.hpp>
 
+#include <stdexcept>
+
 namespace oglplus {
 namespace text {
 
 OGLPLUS_LIB_FUNC
-oglplus::images::Image BitmapGlyphFontEssence::_load_page_bitmap(GLint page)
+std::string BitmapGlyphFontEssence::_find_page_file(GLint page) const
 {
-	return images::LoadByName(
+	return FindResourcePath(
 		"fonts",
 		_font_name + aux::FilesysPathSep() +
 		BitmapGlyphPageName(_parent, page),
-		true,
-		true
+		BitmapGlyphPageFile::Extension()
 	);
 }
 
 OGLPLUS_LIB_FUNC
-void BitmapGlyphFontEssence::_check_input(std::istream& input)
-{
-	assert(!input.fail());
-	if(input.eof())
-		throw std::runtime_error("Unexpected EOF in .bgm file");
-	if(input.bad())
-		throw std::runtime_error("Error reading .bgm file");
-}
-
-OGLPLUS_LIB_FUNC
-void BitmapGlyphFontEssence::_unexpected_char(char)
-{
-	throw std::runtime_error("Unexpected character in .bgm file");
-}
-
-OGLPLUS_LIB_FUNC
-void BitmapGlyphFontEssence::_load_single_glyph(
-	std::istream& input,
-	char* line,
-	const size_t linelen,
-	GLfloat* values,
-	const size_t n_values
-)
+oglplus::images::Image BitmapGlyphFontEssence::_load_page_bitmap(GLint page)
 {
-	// read the code-point of the glyph
-	_check_input(input);
-	unsigned cp;
-	input >> cp;
-	// eat the newline
-	_check_input(input);
-	input.getline(line, linelen);
-	// skip the hex code line
-	_check_input(input);
-	input.getline(line, linelen);
-	// skip the code point's quoted utf-8 sequence
-	char c;
-	_check_input(input);
-	input.get(c);
-	_check_input(input);
-	if(c != '\'') _unexpected_char(c);
-	do { input.get(c); _check_input(input); }
-	while(c != '\'');
-	input.getline(line, linelen);
-	//
-	// read the n metric values
-	for(unsigned v=0; v!=n_values; ++v)
+	std::string path = _find_page_file(page);
+	if(!path.empty())
 	{
-		// read the value
-		GLfloat value;
-		_check_input(input);
-		input >> value;
-		// store the value
-		values[v] = value;
-		// eat the rest of the line
-		input.getline(line, linelen);
+		return BitmapGlyphPageFile(path).MakeImage();
 	}
-	// skip the separating line
-	_check_input(input);
-	input.getline(line, linelen);
+	return images::LoadByName(
+		"fonts",
+		_font_name + aux::FilesysPathSep() +
+		BitmapGlyphPageName(_parent, page),
+		true,
+		true
+	);
 }
 
 OGLPLUS_LIB_FUNC
 std::vector<GLfloat> BitmapGlyphFontEssence::_load_page_metric(GLint page)
 {
-	ResourceFile input(
-		"fonts",
-		_font_name + aux::FilesysPathSep() +
-		BitmapGlyphPageName(_parent, page),
-		".bgm"
-	);
 	// 4 values * 3
 	//
 	// x - logical rectangle left bearing
@@ -115,23 +65,56 @@ std::vector<GLfloat> BitmapGlyphFontEssence::_load_page_metric(GLint page)
 	// w - Glyph height in normalized texture space
 	unsigned values_per_glyph = 4*3;
 	unsigned glyphs_per_page = BitmapGlyphGlyphsPerPage(_parent);
-	std::vector<GLfloat> metrics(glyphs_per_page*values_per_glyph);
 
-	const size_t linelen = 63;
-	char line[linelen+1];
-	for(unsigned g=0; g!=glyphs_per_page; ++g)
+	std::string path = _find_page_file(page);
+	if(!path.empty())
 	{
-		_load_single_glyph(
-			input,
-			line,
-			linelen,
-			metrics.data()+g*values_per_glyph,
-			values_per_glyph
-		);
+		BitmapGlyphPageFile page_file(path);
+		if(page_file.GlyphCount() != glyphs_per_page)
+			throw std::runtime_error("Wrong glyph count in .bgp file");
+		return page_file.MakeMetrics();
 	}
+
+	ResourceFile input(
+		"fonts",
+		_font_name + aux::FilesysPathSep() +
+		BitmapGlyphPageName(_parent, page),
+		".bgm"
+	);
+	std::vector<GLfloat> metrics(glyphs_per_page*values_per_glyph);
+	BitmapGlyphReadTextMetrics(input, metrics.data(), glyphs_per_page);
 	return metrics;
 }
 
+OGLPLUS_LIB_FUNC
+bool BitmapGlyphFontEssence::_load_page_file(GLint frame, GLint page)
+{
+	std::string path = _find_page_file(page);
+	if(path.empty()) return false;
+
+	BitmapGlyphPageFile page_file(path);
+	if(page_file.GlyphCount() != BitmapGlyphGlyphsPerPage(_parent))
+		throw std::runtime_error("Wrong glyph count in .bgp file");
+	// the bitmap is uploaded with the dimensions of the storage,
+	// so the page file must match them (the size of the bitmap data
+	// for its own dimensions is checked by the page file)
+	if(	(page_file.Width() != _page_storage.Width()) ||
+		(page_file.Height() != _page_storage.Height())
+	) throw std::runtime_error("Wrong bitmap size in .bgp file");
+	if(page_file.InternalFormat() != _page_storage.InternalFormat())
+		throw std::runtime_error("Wrong bitmap format in .bgp file");
+	// the bitmap and the metrics are uploaded directly
+	// from the mapped file
+	_page_storage.LoadPage(
+		frame,
+		page_file.Format(),
+		page_file.Type(),
+		page_file.Bitmap(),
+		page_file.Metrics()
+	);
+	return true;
+}
+
 OGLPLUS_LIB_FUNC
 GLfloat BitmapGlyphFontEssence::QueryXOffsets(
 	const CodePoint* cps,
@@ -18,10 +18,9 @@ BitmapGlyphLayoutStorage::BitmapGlyphLayoutStorage(
 	GLsizei capacity,
 	GLsizei alloc_unit
 ): _parent(parent)
- , _list_head(0u)
- , _free(capacity)
  , _capacity(capacity)
  , _alloc_unit(alloc_unit)
+ , _allocator(std::size_t(capacity))
 {
 	assert(_alloc_unit % 2 == 0);
 
@@ -34,14 +33,6 @@ BitmapGlyphLayoutStorage::BitmapGlyphLayoutStorage(
 			(GLuint*)nullptr
 		);
 
-		GLuint _linked_list[2] = {GLuint(_capacity), _list_nil()};
-		Buffer::SubData(
-			Buffer::Target::Array,
-			_list_head,
-			sizeof(_linked_list)/sizeof(_linked_list[0]),
-			_linked_list
-		);
-
 		VertexAttribSlot location(0);
 		VertexAttribArray attr(location);
 		attr.Setup<GLuint>();
@@ -73,104 +64,20 @@ bool BitmapGlyphLayoutStorage::Allocate(BitmapGlyphLayoutData& layout_data)
 	// of the allocation unit
 	GLuint pad = required % _alloc_unit;
 	if(pad != 0) required += _alloc_unit - pad;
-	// do a quick initial check if the allocation
-	// can be satisfied
-	if(required > _free) return false;
-	//
-	// now traverse the linked list (stored in the free
-	// space in _code_points) to find the best chunk
-	_code_points.Bind(Buffer::Target::Array);
-	Buffer::TypedMap<GLuint> map(
-		Buffer::Target::Array,
-		BufferMapAccess::ReadWrite
-	);
-	//
-	// the position in the linked list
-	GLuint list_pos = _list_head;
-	// the best position in the linked list
-	GLuint best_pos = _list_nil();
-	// previous position before the best one
-	GLuint prev_pos = _list_nil();
-	// a temporary list pointer
-	GLuint temp_pos = _list_nil();
-	// best difference between the request and available space
-	GLint min_diff = GLint(_capacity);
-	while(list_pos != _list_nil())
-	{
-		// available space in the current chunk
-		GLuint available = map.At(list_pos);
-		// the difference between the request
-		// and the current chunk
-		GLint diff = available - required;
-		// if we have an ideal fit
-		if(diff == 0)
-		{
-			prev_pos = temp_pos;
-			best_pos = list_pos;
-			min_diff = 0;
-			break;
-		}
-		// if it fits but not ideally
-		else if(diff > 0)
-		{
-			// if it is a better fit than the previous
-			if(min_diff > diff)
-			{
-				// remember it
-				prev_pos = temp_pos;
-				best_pos = list_pos;
-				min_diff = diff;
-			}
-		}
-		// remember the previous list element
-		temp_pos = list_pos;
-		// try the next chunk
-		list_pos = map.At(list_pos+1);
-	}
-	assert(min_diff >= 0);
-	//
-	// if we haven't found a suitable chunk
-	// report failure
-	if(best_pos == _list_nil()) return false;
 
-	// otherwise ...
-	// the next element
-	GLuint next_pos;
-	// if there is some free space in the chunk left
-	if(min_diff > 0)
-	{
-		// insert a new list element
-		next_pos = best_pos + required;
-		map.At(next_pos) = min_diff;
-		map.At(next_pos+1) = map.At(best_pos+1);
-	}
-	// if it fits perfectly
-	else
-	{
-		// find the next element
-		next_pos = map.At(best_pos+1);
-	}
-	//
-	// if this was the first element in the list
-	if(prev_pos == _list_nil())
-	{
-		// update the head
-		_list_head = next_pos;
-	}
-	else
-	{
-		// update the previous element
-		map.At(prev_pos+1) = next_pos;
-	}
-	_free -= required;
-	assert(_list_head != _list_nil() || _free == 0);
+	// find the best fitting free chunk
+	std::size_t offset = 0;
+	if(!_allocator.Allocate(std::size_t(required), offset))
+		return false;
 
 	// update the layout data
-	layout_data._offset = GLint(best_pos);
+	layout_data._offset = GLint(offset);
 	layout_data._length = GLsizei(0);
 	layout_data._capacity = GLsizei(required);
 	layout_data._storage = this;
 	layout_data._width = 0.0f;
+
+	_layouts[layout_data._offset] = &layout_data;
 	// success
 	return true;
 }
@@ -181,95 +88,13 @@ void BitmapGlyphLayoutStorage::Deallocate(BitmapGlyphLayoutData& layout_data)
 	assert(layout_data._offset >= 0);
 	assert(layout_data._offset < _capacity);
 	assert(layout_data._storage == this);
+	assert(_layouts.find(layout_data._offset) != _layouts.end());
 
-	const GLuint old_pos = GLuint(layout_data._offset);
-	const GLuint returned = GLuint(layout_data._capacity);
-	//
-	_code_points.Bind(Buffer::Target::Array);
-	Buffer::TypedMap<GLuint> map(
-		Buffer::Target::Array,
-		BufferMapAccess::ReadWrite
+	_layouts.erase(layout_data._offset);
+	_allocator.Deallocate(
+		std::size_t(layout_data._offset),
+		std::size_t(layout_data._capacity)
 	);
-	// if the storage is completelly full
-	if(_list_head == _list_nil())
-	{
-		assert(_free == 0);
-		map.At(old_pos) = returned;
-		map.At(old_pos+1) = _list_nil();
-		_list_head = old_pos;
-	}
-	else
-	{
-		GLuint next_pos = _list_head;
-		GLuint prev_pos = _list_nil();
-		// go through the list until you find
-		// the next free chunk after the one
-		// that is currently being freed
-		while(next_pos < old_pos && next_pos != _list_nil())
-		{
-			prev_pos = next_pos;
-			next_pos = map.At(next_pos+1);
-		}
-		// whether it is adjacent to the next element
-		bool adj_to_next =
-			(old_pos + returned == next_pos) &&
-			(next_pos != _list_nil());
-		// if there is no previous element
-		if(prev_pos == _list_nil())
-		{
-			// if the freed is adjacent to the next
-			if(adj_to_next)
-			{
-				// merge them
-				GLuint next_size = map.At(next_pos);
-				map.At(old_pos) = returned + next_size;
-				map.At(old_pos+1) = map.At(next_pos+1);
-			}
-			else
-			{
-				// otherwise insert new element
-				map.At(old_pos) = returned;
-				map.At(old_pos+1) = next_pos;
-			}
-			_list_head = old_pos;
-		}
-		else
-		{
-			GLuint prev_size = map.At(prev_pos);
-			// whether it is adjacent to the previous element
-			bool adj_to_prev = prev_pos+prev_size == old_pos;
-			//
-			// if the freed is adjacent to both
-			// the previous and the next free chunk
-			if(adj_to_prev && adj_to_next)
-			{
-				GLuint next_size = map.At(next_pos);
-				map.At(prev_pos) =
-					prev_size +
-					returned +
-					next_size;
-				map.At(prev_pos+1) = map.At(next_pos+1);
-			}
-			else if(adj_to_prev)
-			{
-				map.At(prev_pos) = prev_size + returned;
-			}
-			else if(adj_to_next)
-			{
-				GLuint next_size = map.At(next_pos);
-				map.At(old_pos) = returned + next_size;
-				map.At(old_pos+1) = map.At(next_pos+1);
-			}
-			else
-			{
-				map.At(prev_pos+1) = old_pos;
-				map.At(old_pos) = returned;
-				map.At(old_pos+1) = next_pos;
-			}
-		}
-	}
-
-	_free += returned;
 
 	layout_data._offset = -1;
 	layout_data._length = 0;
@@ -278,6 +103,102 @@ void BitmapGlyphLayoutStorage::Deallocate(BitmapGlyphLayoutData& layout_data)
 	layout_data._width = 0.0f;
 }
 
+OGLPLUS_LIB_FUNC
+void BitmapGlyphLayoutStorage::Relocate(BitmapGlyphLayoutData& layout_data)
+{
+	assert(layout_data._storage == this);
+	assert(_layouts.find(layout_data._offset) != _layouts.end());
+	_layouts[layout_data._offset] = &layout_data;
+}
+
+OGLPLUS_LIB_FUNC
+void BitmapGlyphLayoutStorage::_move_data(
+	Buffer& buffer,
+	const std::vector<_data_move>& moves
+)
+{
+#if GL_VERSION_3_1 || GL_ARB_copy_buffer
+	assert(!moves.empty());
+	// both the code points and x-offsets are 4 bytes long
+	const GLuint unit = sizeof(GLuint);
+	const GLuint begin = moves.front().old_offset;
+	const GLuint end = moves.back().old_offset + moves.back().size;
+	assert(begin < end);
+
+	// the source and destination ranges may overlap
+	// so the moved part goes through a temporary buffer
+	Buffer temp;
+	temp.Bind(Buffer::Target::CopyWrite);
+	Buffer::Data(
+		Buffer::Target::CopyWrite,
+		end - begin,
+		(GLuint*)nullptr,
+		BufferUsage::StreamCopy
+	);
+	buffer.Bind(Buffer::Target::CopyRead);
+	Buffer::CopySubData(
+		Buffer::Target::CopyRead,
+		Buffer::Target::CopyWrite,
+		begin*unit,
+		0,
+		(end - begin)*unit
+	);
+
+	temp.Bind(Buffer::Target::CopyRead);
+	buffer.Bind(Buffer::Target::CopyWrite);
+	for(auto i=moves.begin(), e=moves.end(); i!=e; ++i)
+	{
+		Buffer::CopySubData(
+			Buffer::Target::CopyRead,
+			Buffer::Target::CopyWrite,
+			(i->old_offset - begin)*unit,
+			i->new_offset*unit,
+			i->size*unit
+		);
+	}
+#else
+	OGLPLUS_FAKE_USE(buffer);
+	OGLPLUS_FAKE_USE(moves);
+	assert(!
+		"CopyBufferSubData required, "
+		"but not supported by the used version of OpenGL!"
+	);
+#endif
+}
+
+OGLPLUS_LIB_FUNC
+GLsizei BitmapGlyphLayoutStorage::Compact(void)
+{
+	std::vector<_data_move> moves;
+	_data_mover mover = { &moves };
+	_allocator.Compact(mover);
+
+	if(moves.empty()) return 0;
+
+	_move_data(_code_points, moves);
+	_move_data(_x_offsets, moves);
+
+	// update the offsets of the moved layouts
+	std::map<GLint, BitmapGlyphLayoutData*> layouts;
+	auto m = moves.begin();
+	GLsizei moved = 0;
+	for(auto i=_layouts.begin(), e=_layouts.end(); i!=e; ++i)
+	{
+		GLuint offset = GLuint(i->first);
+		while((m != moves.end()) && (m->old_offset + m->size <= offset))
+			++m;
+		if((m != moves.end()) && (m->old_offset <= offset))
+		{
+			offset = offset - m->old_offset + m->new_offset;
+			moved += i->second->_capacity;
+		}
+		i->second->_offset = GLint(offset);
+		layouts[GLint(offset)] = i->second;
+	}
+	_layouts.swap(layouts);
+	return moved;
+}
+
 OGLPLUS_LIB_FUNC
 void BitmapGlyphLayoutStorage::Initialize(
 	BitmapGlyphLayoutData& layout_data,
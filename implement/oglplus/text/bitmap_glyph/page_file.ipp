@@ -0,0 +1,407 @@
+/**
+ *  @file oglplus/text/bitmap_glyph/page_file.ipp
+ *  @brief Implementation of the bitmap glyph page files
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <stdexcept>
+#include <cstring>
+#include <cstdint>
+#include <cassert>
+
+namespace oglplus {
+namespace text {
+
+OGLPLUS_LIB_FUNC
+void BitmapGlyphCheckTextInput(std::istream& input)
+{
+	assert(!input.fail());
+	if(input.eof())
+		throw std::runtime_error("Unexpected EOF in .bgm file");
+	if(input.bad())
+		throw std::runtime_error("Error reading .bgm file");
+}
+
+OGLPLUS_LIB_FUNC
+void BitmapGlyphReadTextMetrics(
+	std::istream& input,
+	GLfloat* metrics,
+	unsigned glyph_count
+)
+{
+	const unsigned values_per_glyph = 4*3;
+	const std::size_t linelen = 63;
+	char line[linelen+1];
+	for(unsigned g=0; g!=glyph_count; ++g)
+	{
+		// read the code-point of the glyph
+		BitmapGlyphCheckTextInput(input);
+		unsigned cp;
+		input >> cp;
+		// eat the newline
+		BitmapGlyphCheckTextInput(input);
+		input.getline(line, linelen);
+		// skip the hex code line
+		BitmapGlyphCheckTextInput(input);
+		input.getline(line, linelen);
+		// skip the code point's quoted utf-8 sequence
+		char c;
+		BitmapGlyphCheckTextInput(input);
+		input.get(c);
+		BitmapGlyphCheckTextInput(input);
+		if(c != '\'')
+		{
+			throw std::runtime_error(
+				"Unexpected character in .bgm file"
+			);
+		}
+		do { input.get(c); BitmapGlyphCheckTextInput(input); }
+		while(c != '\'');
+		input.getline(line, linelen);
+		//
+		// read the n metric values
+		for(unsigned v=0; v!=values_per_glyph; ++v)
+		{
+			// read the value
+			GLfloat value;
+			BitmapGlyphCheckTextInput(input);
+			input >> value;
+			// store the value
+			*metrics++ = value;
+			// eat the rest of the line
+			input.getline(line, linelen);
+		}
+		// skip the separating line
+		BitmapGlyphCheckTextInput(input);
+		input.getline(line, linelen);
+	}
+}
+
+OGLPLUS_LIB_FUNC
+std::size_t BitmapGlyphPageFile::_type_size(GLenum type)
+{
+	switch(type)
+	{
+		case GL_UNSIGNED_BYTE: return sizeof(GLubyte);
+		case GL_FLOAT: return sizeof(GLfloat);
+		default:;
+	}
+	return 0;
+}
+
+OGLPLUS_LIB_FUNC
+GLuint BitmapGlyphPageFile::_format_channels(GLenum format)
+{
+	switch(format)
+	{
+		case GL_RED: return 1;
+		case GL_RG: return 2;
+		case GL_RGB:
+		case GL_BGR: return 3;
+		case GL_RGBA:
+		case GL_BGRA: return 4;
+		default:;
+	}
+	return 0;
+}
+
+OGLPLUS_LIB_FUNC
+const BitmapGlyphPageFileHeader& BitmapGlyphPageFile::_check(void) const
+{
+	if(_file.Size() < sizeof(BitmapGlyphPageFileHeader))
+		throw std::runtime_error("Truncated .bgp file");
+
+	const BitmapGlyphPageFileHeader& header =
+		*reinterpret_cast<const BitmapGlyphPageFileHeader*>(
+			_file.Data()
+		);
+	if(std::memcmp(header.magic, "OGLpBGP", 8) != 0)
+		throw std::runtime_error("Not a .bgp file");
+	if(header.byte_order != 0x01020304)
+		throw std::runtime_error("Wrong byte order of .bgp file");
+	if(header.version != 1)
+		throw std::runtime_error("Unsupported .bgp file version");
+
+	if(header.values_per_glyph != 4*3)
+		throw std::runtime_error("Wrong glyph metric count in .bgp file");
+	if(header.compression > 1)
+		throw std::runtime_error("Unsupported .bgp compression");
+
+	// the sizes are computed in 64 bits so that the values
+	// from a corrupted header cannot make them overflow
+	const std::uint64_t metric_end = std::uint64_t(header.metric_offset)+
+		std::uint64_t(header.glyph_count)*
+		std::uint64_t(header.values_per_glyph)*
+		sizeof(GLfloat);
+	const std::uint64_t bitmap_end =
+		std::uint64_t(header.bitmap_offset)+
+		std::uint64_t(header.bitmap_size);
+	if((metric_end > _file.Size()) || (bitmap_end > _file.Size()))
+		throw std::runtime_error("Truncated .bgp file");
+	if(header.metric_offset % 16 != 0)
+		throw std::runtime_error("Misaligned .bgp metric block");
+
+	const std::size_t elem_size = _type_size(header.type);
+	if(elem_size == 0)
+		throw std::runtime_error("Unsupported .bgp bitmap data type");
+	if(header.channels != _format_channels(header.format))
+		throw std::runtime_error("Wrong channel count in .bgp file");
+
+	// the bitmap must hold all pixels of the page
+	const std::uint64_t pixel_size =
+		std::uint64_t(header.width)*
+		std::uint64_t(header.height)*
+		std::uint64_t(header.channels)*
+		elem_size;
+	const std::uint64_t bitmap_size = header.compression?
+		header.bitmap_raw_size:
+		header.bitmap_size;
+	if(bitmap_size < pixel_size)
+		throw std::runtime_error("Truncated .bgp bitmap data");
+	return header;
+}
+
+OGLPLUS_LIB_FUNC
+BitmapGlyphPageFile::BitmapGlyphPageFile(const std::string& path)
+ : _file(path)
+ , _header(&_check())
+{ }
+
+// The bitmap is compressed with a simple byte-oriented run-length
+// encoding: a control byte c < 128 is followed by c+1 literal bytes,
+// a control byte c >= 128 is followed by a single byte that is
+// repeated c-125 times. Glyph pages consist mostly of runs of zeros
+// so this is usually enough and the decompression is very cheap.
+OGLPLUS_LIB_FUNC
+void BitmapGlyphPageFile::_pack(
+	const GLubyte* data,
+	std::size_t size,
+	std::vector<GLubyte>& packed
+)
+{
+	packed.clear();
+	std::size_t i = 0;
+	while(i != size)
+	{
+		std::size_t run = 1;
+		while((i+run != size) && (run != 130) && (data[i+run] == data[i]))
+			++run;
+		if(run >= 3)
+		{
+			packed.push_back(GLubyte(run+125));
+			packed.push_back(data[i]);
+			i += run;
+		}
+		else
+		{
+			std::size_t lit = 0;
+			while((i+lit != size) && (lit != 128))
+			{
+				// stop before a run of at least three bytes
+				if(	(i+lit+2 < size) &&
+					(data[i+lit] == data[i+lit+1]) &&
+					(data[i+lit] == data[i+lit+2])
+				) break;
+				++lit;
+			}
+			assert(lit > 0);
+			packed.push_back(GLubyte(lit-1));
+			packed.insert(packed.end(), data+i, data+i+lit);
+			i += lit;
+		}
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void BitmapGlyphPageFile::_unpack(
+	const GLubyte* packed,
+	std::size_t packed_size,
+	GLubyte* data,
+	std::size_t size
+)
+{
+	const GLubyte* end = packed+packed_size;
+	GLubyte* const data_end = data+size;
+	while((packed != end) && (data != data_end))
+	{
+		GLubyte ctl = *packed++;
+		if(ctl < 128)
+		{
+			std::size_t lit = std::size_t(ctl)+1;
+			if(	(std::size_t(end-packed) < lit) ||
+				(std::size_t(data_end-data) < lit)
+			) break;
+			std::memcpy(data, packed, lit);
+			packed += lit;
+			data += lit;
+		}
+		else
+		{
+			std::size_t run = std::size_t(ctl)-125;
+			if(	(packed == end) ||
+				(std::size_t(data_end-data) < run)
+			) break;
+			std::memset(data, *packed++, run);
+			data += run;
+		}
+	}
+	if(data != data_end)
+		throw std::runtime_error("Corrupted .bgp bitmap data");
+}
+
+OGLPLUS_LIB_FUNC
+const GLvoid* BitmapGlyphPageFile::Bitmap(void) const
+{
+	const GLubyte* stored = _file.Data()+_header->bitmap_offset;
+	if(!Compressed()) return stored;
+
+	if(_unpacked.empty())
+	{
+		_unpacked.resize(_header->bitmap_raw_size);
+		_unpack(
+			stored,
+			_header->bitmap_size,
+			_unpacked.data(),
+			_unpacked.size()
+		);
+	}
+	return _unpacked.data();
+}
+
+OGLPLUS_LIB_FUNC
+images::Image BitmapGlyphPageFile::MakeImage(void) const
+{
+	if(Type() == PixelDataType::UnsignedByte)
+	{
+		return images::Image(
+			Width(),
+			Height(),
+			1,
+			GLsizei(_header->channels),
+			static_cast<const GLubyte*>(Bitmap()),
+			Format(),
+			InternalFormat()
+		);
+	}
+	if(Type() == PixelDataType::Float)
+	{
+		return images::Image(
+			Width(),
+			Height(),
+			1,
+			GLsizei(_header->channels),
+			static_cast<const GLfloat*>(Bitmap()),
+			Format(),
+			InternalFormat()
+		);
+	}
+	throw std::runtime_error("Unsupported .bgp bitmap data type");
+}
+
+OGLPLUS_LIB_FUNC
+void BitmapGlyphPageFile::Write(
+	std::ostream& output,
+	GLuint width,
+	GLuint height,
+	GLuint channels,
+	GLenum format,
+	GLenum internal_format,
+	GLenum type,
+	const GLvoid* bitmap,
+	std::size_t bitmap_size,
+	const GLfloat* metrics,
+	GLuint glyph_count,
+	bool compress
+)
+{
+	const GLubyte* data = static_cast<const GLubyte*>(bitmap);
+	std::vector<GLubyte> packed;
+	if(compress)
+	{
+		_pack(data, bitmap_size, packed);
+		// store the data uncompressed if it does not help
+		if(packed.size() < bitmap_size) data = packed.data();
+		else compress = false;
+	}
+
+	BitmapGlyphPageFileHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, "OGLpBGP", 8);
+	header.byte_order = 0x01020304;
+	header.version = 1;
+	header.glyph_count = glyph_count;
+	header.values_per_glyph = 4*3;
+	header.width = width;
+	header.height = height;
+	header.channels = channels;
+	header.format = format;
+	header.internal_format = internal_format;
+	header.type = type;
+	header.compression = compress?1:0;
+	header.metric_offset = _align(GLuint(sizeof(header)));
+	header.bitmap_offset = _align(
+		header.metric_offset+
+		glyph_count*header.values_per_glyph*sizeof(GLfloat)
+	);
+	header.bitmap_size = GLuint(compress?packed.size():bitmap_size);
+	header.bitmap_raw_size = GLuint(bitmap_size);
+
+	const char padding[16] = {0};
+	output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	output.write(padding, header.metric_offset-sizeof(header));
+	output.write(
+		reinterpret_cast<const char*>(metrics),
+		glyph_count*header.values_per_glyph*sizeof(GLfloat)
+	);
+	output.write(
+		padding,
+		header.bitmap_offset-header.metric_offset-
+		glyph_count*header.values_per_glyph*sizeof(GLfloat)
+	);
+	output.write(
+		reinterpret_cast<const char*>(data),
+		header.bitmap_size
+	);
+	if(!output.good())
+		throw std::runtime_error("Error writing .bgp file");
+}
+
+OGLPLUS_LIB_FUNC
+void BitmapGlyphPageFile::Write(
+	std::ostream& output,
+	const images::Image& bitmap,
+	const GLfloat* metrics,
+	GLuint glyph_count,
+	bool compress
+)
+{
+	std::size_t elem_size = 0;
+	if(bitmap.Type() == PixelDataType::UnsignedByte)
+		elem_size = sizeof(GLubyte);
+	else if(bitmap.Type() == PixelDataType::Float)
+		elem_size = sizeof(GLfloat);
+	else throw std::runtime_error("Unsupported .bgp bitmap data type");
+
+	Write(
+		output,
+		GLuint(bitmap.Width()),
+		GLuint(bitmap.Height()),
+		GLuint(bitmap.Channels()),
+		GLenum(bitmap.Format()),
+		GLenum(bitmap.InternalFormat()),
+		GLenum(bitmap.Type()),
+		bitmap.RawData(),
+		bitmap.Width()*bitmap.Height()*bitmap.Channels()*elem_size,
+		metrics,
+		glyph_count,
+		compress
+	);
+}
+
+} // namespace text
+} // namespace oglplus
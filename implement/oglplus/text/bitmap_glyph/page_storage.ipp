@@ -101,10 +101,29 @@ void BitmapGlyphPageStorage::LoadPage(
 	const std::vector<GLfloat>& metrics
 )
 {
-	// TODO add a parameter indicating how many rows
-	// of the image are really used and add InvalidateTexImage
 	assert(image.Width() == _width);
 	assert(image.Height() == _height);
+	assert(metrics.size() >= _glyphs_per_page*_vects_per_glyph*4);
+	LoadPage(
+		frame,
+		image.Format(),
+		image.Type(),
+		image.RawData(),
+		metrics.data()
+	);
+}
+
+OGLPLUS_LIB_FUNC
+void BitmapGlyphPageStorage::LoadPage(
+	const GLint frame,
+	PixelDataFormat format,
+	PixelDataType type,
+	const GLvoid* bitmap,
+	const GLfloat* metrics
+)
+{
+	// TODO add a parameter indicating how many rows
+	// of the image are really used and add InvalidateTexImage
 	// load the bitmap image
 	Texture::Active(_bitmap_tex_unit);
 	Texture::SubImage3D(
@@ -114,9 +133,9 @@ void BitmapGlyphPageStorage::LoadPage(
 		_width,
 		_height,
 		1,
-		image.Format(),
-		image.Type(),
-		image.RawData()
+		format,
+		type,
+		bitmap
 	);
 	//
 	Texture::GenerateMipmap(Texture::Target::_2DArray);
@@ -130,9 +149,12 @@ void BitmapGlyphPageStorage::LoadPage(
 		_glyphs_per_page*_vects_per_glyph, 1,
 		PixelDataFormat::RGBA,
 		PixelDataType::Float,
-		metrics.data()
+		metrics
+	);
+	_metrics[frame].assign(
+		metrics,
+		metrics+_glyphs_per_page*_vects_per_glyph*4
 	);
-	_metrics[frame] = metrics;
 }
 
 OGLPLUS_LIB_FUNC
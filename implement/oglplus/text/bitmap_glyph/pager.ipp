@@ -12,14 +12,37 @@
 namespace oglplus {
 namespace text {
 
+OGLPLUS_LIB_FUNC
+void BitmapGlyphPager::_lru_unlink(GLint frame)
+{
+	GLint prev = _lru_prev[frame];
+	GLint next = _lru_next[frame];
+
+	if(prev != _lru_nil()) _lru_next[prev] = next;
+	else _lru_head = next;
+
+	if(next != _lru_nil()) _lru_prev[next] = prev;
+	else _lru_tail = prev;
+
+	_lru_prev[frame] = _lru_nil();
+	_lru_next[frame] = _lru_nil();
+}
+
+OGLPLUS_LIB_FUNC
+void BitmapGlyphPager::_lru_push_front(GLint frame)
+{
+	_lru_prev[frame] = _lru_nil();
+	_lru_next[frame] = _lru_head;
+
+	if(_lru_head != _lru_nil()) _lru_prev[_lru_head] = frame;
+	else _lru_tail = frame;
+
+	_lru_head = frame;
+}
+
 OGLPLUS_LIB_FUNC
 bool BitmapGlyphPager::_frames_consistent(void) const
 {
-	_gpu_page_map.Bind(Buffer::Target::Uniform);
-	Buffer::TypedMap<gpu_frame_t> page_frame_map(
-		Buffer::Target::Uniform,
-		BufferMapAccess::Read
-	);
 	const std::size_t n = _frames.size();
 	for(std::size_t i=0; i!=n; ++i)
 	{
@@ -29,7 +52,7 @@ bool BitmapGlyphPager::_frames_consistent(void) const
 			for(std::size_t j=0; j!=i; ++j)
 				if(page == _frames[j])
 					return false;
-			gpu_frame_t frame = page_frame_map.At(page);
+			gpu_frame_t frame = _page_map[std::size_t(page)];
 			if(frame != gpu_frame_t(i))
 				return false;
 		}
@@ -53,26 +76,18 @@ void BitmapGlyphPager::_replace_page(GLint frame, GLint page)
 	GLint previous = _frames[frame];
 	// assign the new page to the frame
 	_frames[frame] = page;
-	// update the age of the other frames
-	Update();
-	// initialize the age of the frame
-	_ages[frame] = _init_age();
+	// the frame is now the most recently used one
+	_touch_frame(frame);
 	//
-	// we'll need to update the page map on gpu
-	_gpu_page_map.Bind(Buffer::Target::Uniform);
-	Buffer::TypedMap<gpu_frame_t> page_frame_map(
-		Buffer::Target::Uniform,
-		BufferMapAccess::Write
-	);
+	// update the CPU copy of the page map, the GPU copy
+	// is updated lazily by Flush
 	if(previous >= 0)
 	{
-		// remove the previous page from active list
-		_active_pages.erase(previous);
-		page_frame_map.At(previous) = _invalid_gpu_frame();
-		// add the new page into the active list
+		_page_map[std::size_t(previous)] = _invalid_gpu_frame();
+		_mark_dirty(std::size_t(previous));
 	}
-	_active_pages[page] = frame;
-	page_frame_map.At(page) = gpu_frame_t(frame);
+	_page_map[std::size_t(page)] = gpu_frame_t(frame);
+	_mark_dirty(std::size_t(page));
 }
 
 OGLPLUS_LIB_FUNC
@@ -82,16 +97,29 @@ BitmapGlyphPager::BitmapGlyphPager(
 	GLsizei frame_count
 ): _parent(parent)
  , _frames(frame_count, GLint(-1))
- , _ages(frame_count, _zero_age())
+ , _lru_prev(frame_count, _lru_nil())
+ , _lru_next(frame_count, _lru_nil())
+ , _lru_head(_lru_nil())
+ , _lru_tail(_lru_nil())
+ , _page_map(
+	BitmapGlyphPlaneCount(_parent)*
+	BitmapGlyphPagesPerPlane(_parent),
+	_invalid_gpu_frame()
+), _dirty_begin(_page_map.size())
+ , _dirty_end(0)
  , _pg_map_tex_unit(pg_map_tex_unit)
 {
+	// the empty frames are all initially in the list
+	// ordered so that the first frame is used first
+	for(GLint f=0; f!=GLint(frame_count); ++f)
+		_lru_push_front(f);
+
 	_gpu_page_map.Bind(Buffer::Target::Uniform);
-	std::vector<gpu_frame_t> data(
-		BitmapGlyphPlaneCount(_parent)*
-		BitmapGlyphPagesPerPlane(_parent),
-		_invalid_gpu_frame()
+	Buffer::Data(
+		Buffer::Target::Uniform,
+		_page_map,
+		BufferUsage::DynamicDraw
 	);
-	Buffer::Data(Buffer::Target::Uniform, data);
 
 	Texture::Active(_pg_map_tex_unit);
 	_page_map_tex.Bind(Texture::Target::Buffer);
@@ -105,26 +133,19 @@ BitmapGlyphPager::BitmapGlyphPager(
 }
 
 OGLPLUS_LIB_FUNC
-GLint BitmapGlyphPager::FindFrame(void)
+void BitmapGlyphPager::Flush(void) const
 {
-	assert(_is_ok());
-
-	const std::size_t n = _frames.size();
+	if(_dirty_begin >= _dirty_end) return;
 
-	for(std::size_t i=0; i!=n; ++i)
-		if(_frames[i] < 0) return GLint(i);
-
-	age_t min = _full_age();
-	std::size_t m = 0;
-	for(std::size_t i=0; i!=n; ++i)
-	{
-		if(min > _ages[i])
-		{
-			min = _ages[i];
-			m = i;
-		}
-	}
-	return GLint(m);
+	_gpu_page_map.Bind(Buffer::Target::Uniform);
+	Buffer::SubData(
+		Buffer::Target::Uniform,
+		GLintptr(_dirty_begin),
+		GLsizei(_dirty_end - _dirty_begin),
+		_page_map.data() + _dirty_begin
+	);
+	_dirty_begin = _page_map.size();
+	_dirty_end = 0;
 }
 
 OGLPLUS_LIB_FUNC
@@ -132,9 +153,9 @@ bool BitmapGlyphPager::UsePage(GLint page)
 {
 	assert(_is_ok());
 
-	auto pos = _active_pages.find(page);
+	GLint frame = FrameOfPage(page);
 	// if this is a page miss
-	if(pos == _active_pages.end())
+	if(frame < 0)
 	{
 		assert(!_page_in_frames(page));
 		return false;
@@ -144,20 +165,11 @@ bool BitmapGlyphPager::UsePage(GLint page)
 	{
 		assert(_page_in_frames(page));
 		// note frame usage
-		_touch_frame(pos->second);
+		_touch_frame(frame);
 	}
 	return true;
 }
 
-OGLPLUS_LIB_FUNC
-GLint BitmapGlyphPager::FrameOfPage(GLint page) const
-{
-	auto pos = _active_pages.find(page);
-	if(pos != _active_pages.end())
-		return pos->second;
-	else return GLint(-1);
-}
-
 } // namespace text
 } // namespace oglplus
 
@@ -157,7 +157,7 @@ BitmapGlyphRenderer::BitmapGlyphRenderer(
 	_program.AttachShader(pixel_color_shader);
 
 	FragmentShader fs(ObjectDesc("BitmapGlyphRenderer - Fragment"));
-	fs.Source(StrLit(
+	const GLchar* fs_source[2] = {
 		"#version 330\n"
 		"uniform sampler2DArray oglpBitmap;"
 
@@ -178,19 +178,44 @@ BitmapGlyphRenderer::BitmapGlyphRenderer(
 		"	float LayoutWidth"
 		");"
 
+		"vec4 GlyphTexel(vec3 TexCoord);"
+
 		"void main(void)"
 		"{"
 		"       fragColor = PixelColor("
-		"		texture(oglpBitmap, geomTexCoord),"
+		"		GlyphTexel(geomTexCoord),"
 		"		geomGlyphPos.xyz,"
 		"		geomGlyphPos.w,"
 		"		geomGlyphCoord.xy,"
 		"		geomGlyphCoord.zw,"
 		"		oglpLayoutWidth"
 		"	);"
-		"}"
-
-	));
+		"}",
+
+		nullptr
+	};
+	if(BitmapGlyphDistanceFieldSpread(_parent) != 0)
+	{
+		// reconstruct the coverage from the distance field,
+		// the width of the edge is one pixel on the screen
+		fs_source[1] =
+			"vec4 GlyphTexel(vec3 TexCoord)"
+			"{"
+			"	float d = texture(oglpBitmap, TexCoord).r;"
+			"	float w = max(fwidth(d)*0.7, 1.0/255.0);"
+			"	float c = smoothstep(0.5-w, 0.5+w, d);"
+			"	return vec4(c, 0.0, 0.0, 1.0);"
+			"}";
+	}
+	else
+	{
+		fs_source[1] =
+			"vec4 GlyphTexel(vec3 TexCoord)"
+			"{"
+			"	return texture(oglpBitmap, TexCoord);"
+			"}";
+	}
+	fs.Source(fs_source, 2);
 	fs.Compile();
 	_program.AttachShader(fs);
 
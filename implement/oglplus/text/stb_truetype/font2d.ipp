@@ -10,6 +10,8 @@
  */
 
 #include <algorithm>
+#include <utility>
+#include <cmath>
 #include <stdexcept>
 #define STB_TRUETYPE_IMPLEMENTATION
 #include <stb_truetype.h>
@@ -17,6 +19,151 @@
 namespace oglplus {
 namespace text {
 
+OGLPLUS_LIB_FUNC
+void STBTTFont2DGlyph::_get_outline(
+	float scale,
+	float xoffs,
+	float yoffs,
+	std::vector<float>& segments
+) const
+{
+	segments.clear();
+	::stbtt_vertex* vertices = nullptr;
+	int n = ::stbtt_GetGlyphShape(_font, _index, &vertices);
+
+	// the outline is flattened into line segments (x0, y0, x1, y1)
+	// in the pixel space of the frame, with the y axis pointing down
+	float px = 0.0f, py = 0.0f;
+	for(int i=0; i!=n; ++i)
+	{
+		const ::stbtt_vertex& v = vertices[i];
+		float x = xoffs + v.x*scale;
+		float y = yoffs - v.y*scale;
+		if(v.type == STBTT_vline)
+		{
+			segments.push_back(px);
+			segments.push_back(py);
+			segments.push_back(x);
+			segments.push_back(y);
+		}
+		else if(v.type == STBTT_vcurve)
+		{
+			float cx = xoffs + v.cx*scale;
+			float cy = yoffs - v.cy*scale;
+			// the number of subdivisions is based on the length
+			// of the control polygon (roughly one per two pixels)
+			float len =
+				std::sqrt((cx-px)*(cx-px)+(cy-py)*(cy-py))+
+				std::sqrt((x-cx)*(x-cx)+(y-cy)*(y-cy));
+			int steps = int(len*0.5f)+1;
+			if(steps > 16) steps = 16;
+			float ox = px, oy = py;
+			for(int s=1; s<=steps; ++s)
+			{
+				float t = float(s)/float(steps);
+				float it = 1.0f - t;
+				float nx = it*it*px + 2*it*t*cx + t*t*x;
+				float ny = it*it*py + 2*it*t*cy + t*t*y;
+				segments.push_back(ox);
+				segments.push_back(oy);
+				segments.push_back(nx);
+				segments.push_back(ny);
+				ox = nx;
+				oy = ny;
+			}
+		}
+		px = x;
+		py = y;
+	}
+	if(vertices) ::stbtt_FreeShape(_font, vertices);
+}
+
+OGLPLUS_LIB_FUNC
+void STBTTFont2DGlyph::RenderDistanceField(
+	unsigned char* start,
+	int frame_width,
+	int frame_height,
+	int stride,
+	float scale,
+	float spread
+) const
+{
+	assert(spread > 0.0f);
+	int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+	::stbtt_GetGlyphBox(_font, _index, &x0, &y0, &x1, &y1);
+
+	std::vector<float> segs;
+	_get_outline(scale, spread-x0*scale, spread+y1*scale, segs);
+	const std::size_t seg_count = segs.size()/4;
+
+	// the intersections of the current row with the outline
+	// and their winding direction
+	std::vector<std::pair<float, int>> crossings;
+	// the indices of segments that are closer than spread to the row
+	std::vector<std::size_t> near_segs;
+
+	const float inv_spread = 1.0f/spread;
+	for(int j=0; j!=frame_height; ++j)
+	{
+		const float yc = j+0.5f;
+		crossings.clear();
+		near_segs.clear();
+		for(std::size_t s=0; s!=seg_count; ++s)
+		{
+			const float* p = segs.data()+s*4;
+			if((p[1] <= yc) != (p[3] <= yc))
+			{
+				float t = (yc-p[1])/(p[3]-p[1]);
+				crossings.push_back(std::make_pair(
+					p[0]+t*(p[2]-p[0]),
+					(p[3] > p[1])?1:-1
+				));
+			}
+			if(	(std::min(p[1], p[3])-spread <= yc) &&
+				(std::max(p[1], p[3])+spread >= yc)
+			) near_segs.push_back(s);
+		}
+		std::sort(crossings.begin(), crossings.end());
+
+		unsigned char* row = start + j*stride;
+		std::size_t next_crossing = 0;
+		int winding = 0;
+		for(int i=0; i!=frame_width; ++i)
+		{
+			const float xc = i+0.5f;
+			while(	(next_crossing < crossings.size()) &&
+				(crossings[next_crossing].first < xc)
+			) winding += crossings[next_crossing++].second;
+
+			float min_dist2 = spread*spread;
+			for(std::size_t k=0; k!=near_segs.size(); ++k)
+			{
+				const float* p = segs.data()+near_segs[k]*4;
+				if(std::min(p[0], p[2])-spread > xc) continue;
+				if(std::max(p[0], p[2])+spread < xc) continue;
+
+				float dx = p[2]-p[0], dy = p[3]-p[1];
+				float l2 = dx*dx+dy*dy;
+				float t = 0.0f;
+				if(l2 > 0.0f)
+				{
+					t = ((xc-p[0])*dx+(yc-p[1])*dy)/l2;
+					if(t < 0.0f) t = 0.0f;
+					else if(t > 1.0f) t = 1.0f;
+				}
+				float ex = p[0]+t*dx-xc, ey = p[1]+t*dy-yc;
+				float d2 = ex*ex+ey*ey;
+				if(min_dist2 > d2) min_dist2 = d2;
+			}
+			float dist = std::sqrt(min_dist2)*inv_spread;
+			if(winding == 0) dist = -dist;
+			row[i] = (unsigned char)(
+				(0.5f+0.5f*dist)*255.0f+0.5f
+			);
+		}
+	}
+}
+
 OGLPLUS_LIB_FUNC
 void STBTTFont2D::_load_font(const unsigned char* ttf_buffer)
 {
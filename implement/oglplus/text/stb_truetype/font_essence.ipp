@@ -9,9 +9,164 @@
  *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
  */
 
+#include <map>
+#include <cmath>
+#include <stdexcept>
+
 namespace oglplus {
 namespace text {
 
+OGLPLUS_LIB_FUNC
+void STBTTFontEssence::_df_renderer::operator()(void) const
+{
+	while(true)
+	{
+		std::size_t i;
+		{
+#if !OGLPLUS_NO_THREADS
+			std::lock_guard<std::mutex> lock(*mutex);
+#endif
+			i = (*next)++;
+		}
+		if(i >= glyphs->size()) break;
+
+		const _df_glyph& g = (*glyphs)[i];
+		g.glyph.RenderDistanceField(
+			bmp_data+tex_side*g.yoffs+g.xoffs,
+			g.width,
+			g.height,
+			tex_side,
+			scale,
+			spread
+		);
+	}
+}
+
+OGLPLUS_LIB_FUNC
+void STBTTFontEssence::_do_make_page_distance_field_and_metric(
+	GLint page,
+	unsigned char* bmp_data,
+	float* metric
+) const
+{
+	float scale = _tt_font.ScaleForPixelHeight(_font_resolution);
+
+	const GLuint px = _font_resolution;
+	const GLuint ts = _tex_side;
+	const int pad = int(_spread);
+	const float inv_px = 1.0f/float(px);
+	const float inv_ts = 1.0f/float(ts);
+
+	unsigned glyphs_per_page = BitmapGlyphGlyphsPerPage(_parent);
+
+	// the distinct glyphs on the page and their positions
+	std::vector<_df_glyph> glyphs;
+	glyphs.reserve(glyphs_per_page);
+	// maps the glyph index to the position in glyphs
+	std::map<int, std::size_t> glyph_pos;
+
+	int xoffs = 0;
+	int yoffs = 0;
+	int row_height = 0;
+	int x0, y0, x1, y1, lb, width, asc, dsc, lg;
+	for(unsigned g=0; g!=glyphs_per_page; ++g)
+	{
+		CodePoint code_point = CodePoint(glyphs_per_page*page+g);
+		auto glyph = _tt_font.GetGlyph(code_point);
+
+		glyph.GetBitmapBox(1, 1, x0, y0, x1, y1);
+		glyph.GetVMetrics(asc, dsc, lg);
+		glyph.GetHMetrics(lb, width);
+
+		auto pos = glyph_pos.find(glyph.Index());
+		if(pos == glyph_pos.end())
+		{
+			_df_glyph dfg = {
+				glyph,
+				xoffs,
+				yoffs,
+				int(std::ceil((x1-x0)*scale))+2*pad,
+				int(std::ceil((y1-y0)*scale))+2*pad
+			};
+			if(xoffs+dfg.width > int(ts))
+			{
+				xoffs = 0;
+				yoffs += row_height;
+				row_height = 0;
+				dfg.xoffs = xoffs;
+				dfg.yoffs = yoffs;
+			}
+			if(row_height < dfg.height)
+				row_height = dfg.height;
+			xoffs += dfg.width;
+
+			if(
+				(dfg.xoffs+dfg.width > int(ts)) ||
+				(dfg.yoffs+dfg.height > int(ts))
+			)
+			{
+				throw std::runtime_error(
+					"Distance field glyphs do not fit "
+					"into the font page texture"
+				);
+			}
+
+			pos = glyph_pos.insert(
+				std::make_pair(glyph.Index(), glyphs.size())
+			).first;
+			glyphs.push_back(dfg);
+		}
+		if(metric)
+		{
+			const _df_glyph& dfg = glyphs[pos->second];
+			float* p = metric+12*g;
+			// logical rectangle metrics
+			p[ 0] = lb*scale*inv_px;
+			p[ 1] = (lb+width)*scale*inv_px;
+			p[ 2] = asc*scale*inv_px;
+			p[ 3] = -dsc*scale*inv_px;
+			// ink rectangle metrics
+			p[ 4] = x0*scale*inv_px;
+			p[ 5] = x1*scale*inv_px;
+			p[ 6] =-y0*scale*inv_px;
+			p[ 7] = y1*scale*inv_px;
+			// texture-space rectangle (without the padding)
+			p[ 8] = (dfg.xoffs+pad)*inv_ts;
+			p[ 9] = (dfg.yoffs+pad-y0*scale)*inv_ts;
+			p[10] = ((x1-x0)*scale)*inv_ts;
+			p[11] = ((y0-y1)*scale)*inv_ts;
+		}
+	}
+
+	if(bmp_data)
+	{
+		std::size_t next = 0;
+		_df_renderer renderer;
+		renderer.glyphs = &glyphs;
+		renderer.bmp_data = bmp_data;
+		renderer.tex_side = ts;
+		renderer.scale = scale;
+		renderer.spread = float(_spread);
+		renderer.next = &next;
+#if !OGLPLUS_NO_THREADS
+		std::mutex mutex;
+		renderer.mutex = &mutex;
+
+		std::size_t n = std::thread::hardware_concurrency();
+		if(n > glyphs.size()) n = glyphs.size();
+
+		std::vector<std::thread> workers;
+		for(std::size_t t=1; t<n; ++t)
+			workers.push_back(std::thread(renderer));
+		renderer();
+		for(std::size_t t=0; t!=workers.size(); ++t)
+			workers[t].join();
+#else
+		renderer();
+#endif
+	}
+}
+
 OGLPLUS_LIB_FUNC
 void STBTTFontEssence::_do_make_page_bitmap_and_metric(
 	GLint page,
@@ -19,6 +174,16 @@ void STBTTFontEssence::_do_make_page_bitmap_and_metric(
 	float* metric
 ) const
 {
+	if(_spread != 0)
+	{
+		_do_make_page_distance_field_and_metric(
+			page,
+			bmp_data,
+			metric
+		);
+		return;
+	}
+
 	float scale = _tt_font.ScaleForPixelHeight(_font_resolution);
 
 	const GLuint px = _font_resolution;
@@ -118,6 +283,7 @@ void STBTTFontEssence::_do_load_pages(
 		// check if the page is active
 		if(!_pager.UsePage(page))
 		{
+			OGLPLUS_CPU_TRACE_SCOPE("STBTruetype::PageFault");
 			// if not let the pager find
 			// a frame for the new page
 			auto frame = _pager.FindFrame();
@@ -153,6 +319,8 @@ void STBTTFontEssence::_do_load_pages(
 			_pager.SwapPageIn(frame, page);
 		}
 	}
+	// upload the changes in the page map at once
+	_pager.Flush();
 }
 
 OGLPLUS_LIB_FUNC
@@ -168,7 +336,11 @@ STBTTFontEssence::STBTTFontEssence(
 ): _parent(parent)
  , _tt_font(ResourceFile("fonts", font_name, ".ttf"))
  , _font_resolution(pixel_height)
- , _tex_side(BitmapGlyphDefaultPageTexSide(parent, _font_resolution))
+ , _spread(BitmapGlyphDistanceFieldSpread(parent))
+ , _tex_side(BitmapGlyphDefaultPageTexSide(
+	parent,
+	_font_resolution+2*_spread
+))
  , _pager(
 	parent,
 	pg_map_tex_unit,
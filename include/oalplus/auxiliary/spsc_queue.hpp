@@ -0,0 +1,84 @@
+/**
+ *  .file oalplus/auxiliary/spsc_queue.hpp
+ *  .brief Bounded lock-free single-producer single-consumer queue
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2012-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OALPLUS_AUX_SPSC_QUEUE_1311201030_HPP
+#define OALPLUS_AUX_SPSC_QUEUE_1311201030_HPP
+
+#include <atomic>
+#include <vector>
+#include <cstddef>
+
+namespace oalplus {
+namespace aux {
+
+// A fixed-capacity ring buffer which can be used without locking by
+// exactly one thread calling Push and exactly one thread calling Pop
+template <typename T>
+class SPSCQueue
+{
+private:
+	// one slot is always left empty to tell a full queue from an empty one
+	std::vector<T> _items;
+	std::atomic<std::size_t> _head;
+	std::atomic<std::size_t> _tail;
+
+	std::size_t _next(std::size_t pos) const
+	{
+		return (pos+1 == _items.size())?0:pos+1;
+	}
+public:
+	SPSCQueue(std::size_t capacity)
+	 : _items(capacity+1)
+	 , _head(0)
+	 , _tail(0)
+	{ }
+
+	std::size_t Capacity(void) const
+	{
+		return _items.size()-1;
+	}
+
+	// Called by the producer, returns false if the queue is full
+	bool Push(const T& item)
+	{
+		const std::size_t tail = _tail.load(std::memory_order_relaxed);
+		const std::size_t next = _next(tail);
+		if(next == _head.load(std::memory_order_acquire))
+			return false;
+		_items[tail] = item;
+		_tail.store(next, std::memory_order_release);
+		return true;
+	}
+
+	// Called by the consumer, returns false if the queue is empty
+	bool Pop(T& item)
+	{
+		const std::size_t head = _head.load(std::memory_order_relaxed);
+		if(head == _tail.load(std::memory_order_acquire))
+			return false;
+		item = _items[head];
+		_head.store(_next(head), std::memory_order_release);
+		return true;
+	}
+
+	// The result is only a hint if called by other threads
+	bool Empty(void) const
+	{
+		return	_head.load(std::memory_order_acquire) ==
+			_tail.load(std::memory_order_acquire);
+	}
+};
+
+} // namespace aux
+} // namespace oalplus
+
+#endif // include guard
@@ -302,6 +302,71 @@ public:
 		OALPLUS_VERIFY(OALPLUS_ERROR_INFO(al,SourceUnqueueBuffers));
 	}
 
+	/// Enqueues a single buffer to the source
+	/**
+	 *  @alsymbols
+	 *  @alfunref{SourceQueueBuffers}
+	 */
+	void QueueBuffer(const BufferOps& buffer)
+	{
+		ALuint name = FriendOf<BufferOps>::GetName(buffer);
+		OALPLUS_ALFUNC(al,SourceQueueBuffers)(_name, 1, &name);
+		OALPLUS_VERIFY(OALPLUS_ERROR_INFO(al,SourceQueueBuffers));
+	}
+
+	/// Removes the oldest processed buffer from the sources queue
+	/** The buffers are processed in the order in which they were
+	 *  enqueued, so the removed buffer is the @p buffer enqueued
+	 *  before all other buffers that are still in the queue.
+	 *
+	 *  @alsymbols
+	 *  @alfunref{SourceUnqueueBuffers}
+	 */
+	void UnqueueBuffer(const BufferOps& buffer)
+	{
+		ALuint name = 0;
+		OALPLUS_ALFUNC(al,SourceUnqueueBuffers)(_name, 1, &name);
+		OALPLUS_VERIFY(OALPLUS_ERROR_INFO(al,SourceUnqueueBuffers));
+		assert(name == FriendOf<BufferOps>::GetName(buffer));
+		OALPLUS_FAKE_USE(buffer);
+	}
+
+	/// Returns the number of buffers in the sources queue
+	/**
+	 *  @alsymbols
+	 *  @alfunref{GetSourceiv}
+	 *  @aldefref{BUFFERS_QUEUED}
+	 */
+	ALint BuffersQueued(void) const
+	{
+		ALint result = 0;
+		OALPLUS_ALFUNC(al,GetSourceiv)(
+			_name,
+			AL_BUFFERS_QUEUED,
+			&result
+		);
+		OALPLUS_VERIFY(OALPLUS_ERROR_INFO(al,GetSourceiv));
+		return result;
+	}
+
+	/// Returns the number of queued buffers which were already played
+	/**
+	 *  @alsymbols
+	 *  @alfunref{GetSourceiv}
+	 *  @aldefref{BUFFERS_PROCESSED}
+	 */
+	ALint BuffersProcessed(void) const
+	{
+		ALint result = 0;
+		OALPLUS_ALFUNC(al,GetSourceiv)(
+			_name,
+			AL_BUFFERS_PROCESSED,
+			&result
+		);
+		OALPLUS_VERIFY(OALPLUS_ERROR_INFO(al,GetSourceiv));
+		return result;
+	}
+
 	/// Sets the value of gain
 	/**
 	 *  @alsymbols
@@ -0,0 +1,388 @@
+/**
+ *  @file oalplus/streaming_source.hpp
+ *  @brief Source playing audio streamed through a queue of small buffers
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2012-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OALPLUS_STREAMING_SOURCE_1311201100_HPP
+#define OALPLUS_STREAMING_SOURCE_1311201100_HPP
+
+#include <oalplus/config.hpp>
+#include <oalplus/data_format.hpp>
+#include <oalplus/source_state.hpp>
+#include <oalplus/buffer.hpp>
+#include <oalplus/source.hpp>
+#include <oalplus/auxiliary/spsc_queue.hpp>
+
+#include <memory>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+
+#if !OGLPLUS_NO_THREADS
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
+namespace oalplus {
+
+/// Interface for the producers of PCM data played by StreamingSource
+/**
+ *  If OGLPLUS_NO_THREADS is not set, then Decode and Rewind are called
+ *  from the decoding thread of the StreamingSource, not from the thread
+ *  which created it.
+ *
+ *  @see StreamingSource
+ */
+struct StreamingSourceDecoder
+{
+	virtual ~StreamingSourceDecoder(void) { }
+
+	/// The format of the produced data
+	virtual DataFormat Format(void) const = 0;
+
+	/// The sampling frequency of the produced data
+	virtual ALsizei Frequency(void) const = 0;
+
+	/// Writes up to @p size bytes of PCM data into @p buffer
+	/** Returns the number of bytes written, which should be a multiple
+	 *  of the size of a sample frame. Zero means the end of the stream.
+	 */
+	virtual std::size_t Decode(ALubyte* buffer, std::size_t size) = 0;
+
+	/// Restarts the stream from the beginning, used for looping
+	/** Returns false if the stream cannot be restarted.
+	 */
+	virtual bool Rewind(void)
+	{
+		return false;
+	}
+};
+
+/// A source which plays a long stream of audio data using a few buffers
+/** StreamingSource keeps a small ring of buffers queued on a source.
+ *  The data is produced by a StreamingSourceDecoder in a background
+ *  thread into a fixed number of memory chunks which are passed to and
+ *  from the thread calling Update through a pair of lock-free queues.
+ *  Update unqueues the processed buffers and refills them with
+ *  the decoded chunks. This way only a couple of chunks of the stream
+ *  are held in memory at any time, instead of the whole clip.
+ *
+ *  If the source plays all its queued buffers before Update refills
+ *  them (i.e. the decoder or the calls to Update are too slow) the
+ *  playback stops; the next Update restarts it and counts it as an
+ *  underrun.
+ *
+ *  If OGLPLUS_NO_THREADS is set then the data is decoded in Update.
+ *
+ *  Example of usage:
+ *  @code
+ *  StreamingSource stream(std::unique_ptr<StreamingSourceDecoder>(
+ *    new MyOggDecoder("ambient.ogg")
+ *  ));
+ *  stream.Play();
+ *  // ... in the main loop:
+ *  stream.Update();
+ *  @endcode
+ */
+class StreamingSource
+{
+private:
+	std::unique_ptr<StreamingSourceDecoder> _decoder;
+	const DataFormat _format;
+	const ALsizei _frequency;
+	const bool _looping;
+
+	oalplus::Source _source;
+
+	// the ring of buffers, _queued buffers starting at _head
+	// are queued on the source in this order
+	std::vector<oalplus::Buffer> _buffers;
+	std::size_t _head;
+	std::size_t _queued;
+
+	struct _chunk
+	{
+		std::vector<ALubyte> data;
+		std::size_t size;
+	};
+	std::vector<std::unique_ptr<_chunk>> _chunks;
+	// the chunks to be decoded, passed to the decoder
+	aux::SPSCQueue<_chunk*> _free;
+	// the decoded chunks, passed from the decoder
+	aux::SPSCQueue<_chunk*> _decoded;
+
+	// set by the decoder after passing on the end of the stream
+	bool _decoder_done;
+
+	bool _end_of_stream;
+	bool _playing;
+	bool _started;
+	std::size_t _underruns;
+
+#if !OGLPLUS_NO_THREADS
+	std::atomic<bool> _stop;
+	std::mutex _wake_mutex;
+	std::condition_variable _wake_cv;
+	std::thread _decode_thread;
+
+	void _decode_loop(void)
+	{
+		while(!_stop.load())
+		{
+			if(_decode_chunk()) continue;
+			std::unique_lock<std::mutex> lock(_wake_mutex);
+			while((_decoder_done || _free.Empty()) && !_stop.load())
+				_wake_cv.wait(lock);
+		}
+	}
+
+	void _wake_decoder(void)
+	{
+		std::lock_guard<std::mutex> lock(_wake_mutex);
+		_wake_cv.notify_one();
+	}
+#else
+	void _wake_decoder(void)
+	{
+		while(_decode_chunk());
+	}
+#endif
+
+	// decodes a single free chunk, returns false if there is none;
+	// an empty chunk is passed on at the end of the stream
+	bool _decode_chunk(void)
+	{
+		_chunk* chunk = nullptr;
+		if(_decoder_done || !_free.Pop(chunk)) return false;
+		assert(chunk);
+		chunk->size = _decoder->Decode(
+			chunk->data.data(),
+			chunk->data.size()
+		);
+		if((chunk->size == 0) && _looping && _decoder->Rewind())
+		{
+			chunk->size = _decoder->Decode(
+				chunk->data.data(),
+				chunk->data.size()
+			);
+		}
+		bool pushed = _decoded.Push(chunk);
+		assert(pushed);
+		OALPLUS_FAKE_USE(pushed);
+		// stop decoding at the end of the stream
+		_decoder_done = (chunk->size == 0);
+		return !_decoder_done;
+	}
+
+	void _unqueue_processed(void)
+	{
+		ALint processed = _source.BuffersProcessed();
+		while((processed-- > 0) && (_queued > 0))
+		{
+			_source.UnqueueBuffer(_buffers[_head]);
+			_head = (_head+1) % _buffers.size();
+			--_queued;
+		}
+	}
+
+	void _queue_decoded(void)
+	{
+		_chunk* chunk = nullptr;
+		bool recycled = false;
+		while(
+			!_end_of_stream &&
+			(_queued < _buffers.size()) &&
+			_decoded.Pop(chunk)
+		)
+		{
+			assert(chunk);
+			if(chunk->size == 0)
+			{
+				_end_of_stream = true;
+				break;
+			}
+			std::size_t i = (_head+_queued) % _buffers.size();
+			_buffers[i].Data(
+				_format,
+				chunk->data.data(),
+				ALsizei(chunk->size),
+				_frequency
+			);
+			_source.QueueBuffer(_buffers[i]);
+			++_queued;
+
+			bool pushed = _free.Push(chunk);
+			assert(pushed);
+			OALPLUS_FAKE_USE(pushed);
+			recycled = true;
+		}
+		if(recycled) _wake_decoder();
+	}
+public:
+	/// Creates a streaming source playing the data from @p decoder
+	/**
+	 *  @param decoder the producer of the played data.
+	 *  @param buffer_count the number of buffers queued on the source.
+	 *  @param buffer_size the size of every buffer in bytes.
+	 *  @param looping if true then the decoder is rewound at the end
+	 *    of the stream.
+	 */
+	StreamingSource(
+		std::unique_ptr<StreamingSourceDecoder> decoder,
+		std::size_t buffer_count = 4,
+		std::size_t buffer_size = 32*1024,
+		bool looping = false
+	): _decoder(std::move(decoder))
+	 , _format(_decoder->Format())
+	 , _frequency(_decoder->Frequency())
+	 , _looping(looping)
+	 , _head(0)
+	 , _queued(0)
+	 , _free(buffer_count+2)
+	 , _decoded(buffer_count+2)
+	 , _decoder_done(false)
+	 , _end_of_stream(false)
+	 , _playing(false)
+	 , _started(false)
+	 , _underruns(0)
+#if !OGLPLUS_NO_THREADS
+	 , _stop(false)
+#endif
+	{
+		assert(buffer_count > 0);
+		assert(buffer_size > 0);
+		_buffers.reserve(buffer_count);
+		for(std::size_t i=0; i!=buffer_count; ++i)
+			_buffers.push_back(oalplus::Buffer());
+
+		// a couple of chunks more than there are buffers
+		// so that the decoder can run ahead of the playback
+		for(std::size_t i=0; i!=buffer_count+2; ++i)
+		{
+			_chunks.push_back(std::unique_ptr<_chunk>(new _chunk));
+			_chunks.back()->data.resize(buffer_size);
+			_chunks.back()->size = 0;
+			_free.Push(_chunks.back().get());
+		}
+#if !OGLPLUS_NO_THREADS
+		_decode_thread = std::thread(
+			&StreamingSource::_decode_loop,
+			this
+		);
+#else
+		_wake_decoder();
+#endif
+	}
+
+#if !OGLPLUS_NO_DELETED_FUNCTIONS
+	StreamingSource(const StreamingSource&) = delete;
+#else
+private:
+	StreamingSource(const StreamingSource&);
+public:
+#endif
+
+	~StreamingSource(void)
+	{
+#if !OGLPLUS_NO_THREADS
+		_stop.store(true);
+		_wake_decoder();
+		_decode_thread.join();
+#endif
+		try
+		{
+			_source.Stop();
+			_source.DetachBuffers();
+		}
+		catch(...) { }
+	}
+
+	/// The underlying source, for setting its position, gain, etc.
+	oalplus::Source& Source(void)
+	{
+		return _source;
+	}
+
+	/// The underlying source
+	const oalplus::Source& Source(void) const
+	{
+		return _source;
+	}
+
+	/// Starts or resumes the playback
+	void Play(void)
+	{
+		_playing = true;
+		if(_source.State() == SourceState::Paused)
+		{
+			_source.Play();
+			_started = true;
+		}
+		Update();
+	}
+
+	/// Pauses the playback
+	void Pause(void)
+	{
+		_playing = false;
+		_started = false;
+		_source.Pause();
+	}
+
+	/// Refills the processed buffers, should be called periodically
+	/** The interval between the calls should be shorter than the time
+	 *  it takes to play all the buffers but one.
+	 */
+	void Update(void)
+	{
+		_unqueue_processed();
+		_queue_decoded();
+
+		if(_playing && (_source.State() != SourceState::Playing))
+		{
+			if(_queued > 0)
+			{
+				// the source ran out of data and stopped
+				if(_started) ++_underruns;
+				_source.Play();
+				_started = true;
+			}
+			else if(_end_of_stream)
+			{
+				_playing = false;
+				_started = false;
+			}
+		}
+	}
+
+	/// Returns true if the whole stream was played
+	bool Finished(void) const
+	{
+		return _end_of_stream && (_queued == 0) && !_playing;
+	}
+
+	/// Returns the number of times the source ran out of data
+	std::size_t Underruns(void) const
+	{
+		return _underruns;
+	}
+
+	/// Returns the number of buffers currently queued on the source
+	std::size_t QueuedBuffers(void) const
+	{
+		return _queued;
+	}
+};
+
+} // namespace oalplus
+
+#endif // include guard
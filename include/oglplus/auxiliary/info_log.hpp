@@ -14,6 +14,7 @@
 #define OGLPLUS_AUX_INFO_LOG_1107121519_HPP
 
 #include <oglplus/config.hpp>
+#include <oglplus/glfunc.hpp>
 #include <oglplus/error.hpp>
 #include <oglplus/string.hpp>
 
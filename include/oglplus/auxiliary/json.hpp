@@ -0,0 +1,50 @@
+/**
+ *  @file oglplus/auxiliary/json.hpp
+ *  @brief Helpers for writing JSON output
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_AUX_JSON_1311221032_HPP
+#define OGLPLUS_AUX_JSON_1311221032_HPP
+
+#include <oglplus/config_compiler.hpp>
+#include <oglplus/config_basic.hpp>
+
+#include <string>
+#include <ostream>
+#include <cstring>
+#include <cstddef>
+
+namespace oglplus {
+namespace aux {
+
+// Writes the specified characters as a quoted JSON string, escaping
+// the quotes, backslashes and control characters. The other characters
+// (including UTF-8 sequences) are written unchanged.
+void WriteJSONString(std::ostream& output, const char* str, std::size_t size);
+
+// Writes a null-terminated string (a null pointer as an empty string)
+inline void WriteJSONString(std::ostream& output, const char* str)
+{
+	WriteJSONString(output, str, str?std::strlen(str):0);
+}
+
+inline void WriteJSONString(std::ostream& output, const std::string& str)
+{
+	WriteJSONString(output, str.data(), str.size());
+}
+
+} // namespace aux
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/auxiliary/json.ipp>
+#endif
+
+#endif // include guard
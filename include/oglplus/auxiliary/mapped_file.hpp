@@ -0,0 +1,86 @@
+/**
+ *  @file oglplus/auxiliary/mapped_file.hpp
+ *  @brief Read-only memory-mapped file
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_AUX_MAPPED_FILE_1311061430_HPP
+#define OGLPLUS_AUX_MAPPED_FILE_1311061430_HPP
+
+#include <oglplus/config_compiler.hpp>
+#include <oglplus/config_basic.hpp>
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+namespace oglplus {
+namespace aux {
+
+// Maps the whole content of a file into the address space of the process
+// for reading. On systems where mapping is not supported (or if it fails)
+// the content of the file is read into a memory buffer instead, so the
+// data is always accessible through Data() and Size().
+class MappedFile
+{
+private:
+	const unsigned char* _data;
+	std::size_t _size;
+	bool _mapped;
+	std::vector<unsigned char> _buffer;
+
+	void _map(const std::string& path);
+	void _read(const std::string& path);
+	void _unmap(void);
+public:
+	// Opens and maps the file, throws std::runtime_error on failure
+	MappedFile(const std::string& path);
+
+	MappedFile(MappedFile&& tmp);
+
+#if !OGLPLUS_NO_DELETED_FUNCTIONS
+	MappedFile(const MappedFile&) = delete;
+#else
+private:
+	MappedFile(const MappedFile&);
+public:
+#endif
+
+	~MappedFile(void)
+	{
+		_unmap();
+	}
+
+	// Returns true if the file is really memory-mapped
+	bool Mapped(void) const
+	{
+		return _mapped;
+	}
+
+	// The pointer to the beginning of the file content
+	const unsigned char* Data(void) const
+	{
+		return _data;
+	}
+
+	// The size of the file content in bytes
+	std::size_t Size(void) const
+	{
+		return _size;
+	}
+};
+
+} // namespace aux
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/auxiliary/mapped_file.ipp>
+#endif
+
+#endif // include guard
@@ -0,0 +1,51 @@
+/**
+ *  @file oglplus/auxiliary/output_iter.hpp
+ *  @brief Helpers for writing of values through output iterators
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_AUX_OUTPUT_ITER_1311121015_HPP
+#define OGLPLUS_AUX_OUTPUT_ITER_1311121015_HPP
+
+#include <iterator>
+
+namespace oglplus {
+namespace aux {
+
+// The type of the values that should be written through an output
+// iterator. The standard insert iterators have void as their value
+// type, so the value type of the container is used for them.
+template <typename Iterator>
+struct OutputIterValue
+{
+	typedef typename std::iterator_traits<Iterator>::value_type type;
+};
+
+template <class Container>
+struct OutputIterValue<std::back_insert_iterator<Container> >
+{
+	typedef typename Container::value_type type;
+};
+
+template <class Container>
+struct OutputIterValue<std::front_insert_iterator<Container> >
+{
+	typedef typename Container::value_type type;
+};
+
+template <class Container>
+struct OutputIterValue<std::insert_iterator<Container> >
+{
+	typedef typename Container::value_type type;
+};
+
+} // namespace aux
+} // namespace oglplus
+
+#endif // include guard
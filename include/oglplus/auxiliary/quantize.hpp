@@ -0,0 +1,126 @@
+/**
+ *  @file oglplus/auxiliary/quantize.hpp
+ *  @brief Helper functions for packing of vertex attribute values
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_AUX_QUANTIZE_1311071010_HPP
+#define OGLPLUS_AUX_QUANTIZE_1311071010_HPP
+
+#include <oglplus/config_compiler.hpp>
+
+#include <cstring>
+#include <cmath>
+
+namespace oglplus {
+namespace aux {
+
+// Converts a single precision float to a half precision float
+// (IEEE 754 binary16) with rounding to the nearest even value
+inline GLushort FloatToHalf(GLfloat value)
+{
+	GLuint f;
+	std::memcpy(&f, &value, sizeof(f));
+
+	const GLuint sign = (f >> 16) & 0x8000;
+	const GLint  expo = GLint((f >> 23) & 0xFF) - 127 + 15;
+	GLuint mant = f & 0x007FFFFF;
+
+	// NaN and infinity
+	if(((f >> 23) & 0xFF) == 0xFF)
+	{
+		return GLushort(sign | 0x7C00 | (mant?0x0200:0x0000));
+	}
+	// overflow
+	if(expo >= 0x1F)
+	{
+		return GLushort(sign | 0x7C00);
+	}
+	// normalized half
+	if(expo > 0)
+	{
+		GLuint h = sign | (GLuint(expo) << 10) | (mant >> 13);
+		// round to nearest even (may carry into the exponent)
+		GLuint rest = mant & 0x1FFF;
+		if((rest > 0x1000) || ((rest == 0x1000) && (h & 1))) ++h;
+		return GLushort(h);
+	}
+	// too small even for a denormalized half
+	if(expo < -10)
+	{
+		return GLushort(sign);
+	}
+	// denormalized half
+	mant |= 0x00800000;
+	const GLuint shift = GLuint(14 - expo);
+	GLuint h = sign | (mant >> shift);
+	GLuint rest = mant & ((1u << shift) - 1);
+	GLuint halfway = 1u << (shift - 1);
+	if((rest > halfway) || ((rest == halfway) && (h & 1))) ++h;
+	return GLushort(h);
+}
+
+// Converts a half precision float to a single precision float
+inline GLfloat HalfToFloat(GLushort value)
+{
+	const GLuint sign = GLuint(value & 0x8000) << 16;
+	GLuint expo = (value >> 10) & 0x1F;
+	GLuint mant = value & 0x03FF;
+	GLuint f;
+
+	if(expo == 0x1F)
+	{
+		f = sign | 0x7F800000 | (mant << 13);
+	}
+	else if(expo != 0)
+	{
+		f = sign | ((expo + 127 - 15) << 23) | (mant << 13);
+	}
+	else if(mant != 0)
+	{
+		// denormalized half, normalize it
+		expo = 127 - 15 + 1;
+		while(!(mant & 0x0400))
+		{
+			mant <<= 1;
+			--expo;
+		}
+		f = sign | (expo << 23) | ((mant & 0x03FF) << 13);
+	}
+	else f = sign;
+
+	GLfloat result;
+	std::memcpy(&result, &f, sizeof(result));
+	return result;
+}
+
+// Converts a value in the [-1, 1] range to a signed normalized integer
+// with the specified number of bits
+inline GLint FloatToSNorm(GLfloat value, unsigned bits)
+{
+	const GLfloat scale = GLfloat((1 << (bits-1)) - 1);
+	if(value >  1.0f) value =  1.0f;
+	if(value < -1.0f) value = -1.0f;
+	return GLint(std::floor(value*scale + 0.5f));
+}
+
+// Packs four values in the [-1, 1] range into the INT_2_10_10_10_REV
+// format (x in the lowest 10 bits, w in the highest 2 bits)
+inline GLuint PackInt2_10_10_10Rev(GLfloat x, GLfloat y, GLfloat z, GLfloat w)
+{
+	return	((GLuint(FloatToSNorm(x, 10)) & 0x3FF) <<  0)|
+		((GLuint(FloatToSNorm(y, 10)) & 0x3FF) << 10)|
+		((GLuint(FloatToSNorm(z, 10)) & 0x3FF) << 20)|
+		((GLuint(FloatToSNorm(w,  2)) & 0x003) << 30);
+}
+
+} // namespace aux
+} // namespace oglplus
+
+#endif // include guard
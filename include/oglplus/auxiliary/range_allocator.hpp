@@ -0,0 +1,229 @@
+/**
+ *  @file oglplus/auxiliary/range_allocator.hpp
+ *  @brief CPU-side best-fit allocator of ranges in a linear storage
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_AUX_RANGE_ALLOCATOR_1311051020_HPP
+#define OGLPLUS_AUX_RANGE_ALLOCATOR_1311051020_HPP
+
+#include <map>
+#include <set>
+#include <utility>
+#include <cassert>
+#include <cstddef>
+
+namespace oglplus {
+namespace aux {
+
+// Manages the free ranges in some linear storage (typically a buffer
+// object) without touching the storage itself. The free ranges are
+// indexed both by their offset (for merging of adjacent ranges on
+// deallocation) and by their size (for best-fit allocation), so both
+// allocation and deallocation are logarithmic in the number of free
+// ranges.
+class RangeAllocator
+{
+public:
+	typedef std::size_t size_type;
+private:
+	size_type _capacity;
+	size_type _free;
+
+	// offset -> size
+	typedef std::map<size_type, size_type> _by_offset_map;
+	_by_offset_map _by_offset;
+
+	// (size, offset), ranges of equal size are ordered by offset
+	typedef std::pair<size_type, size_type> _size_offs;
+	typedef std::set<_size_offs> _by_size_set;
+	_by_size_set _by_size;
+
+	void _insert(size_type offset, size_type size)
+	{
+		assert(size > 0);
+		_by_offset[offset] = size;
+		_by_size.insert(_size_offs(size, offset));
+	}
+
+	void _erase(_by_offset_map::iterator pos)
+	{
+		_by_size.erase(_size_offs(pos->second, pos->first));
+		_by_offset.erase(pos);
+	}
+public:
+	RangeAllocator(size_type capacity)
+	 : _capacity(capacity)
+	 , _free(capacity)
+	{
+		if(_capacity > 0) _insert(0, _capacity);
+	}
+
+	// The total size of the managed storage
+	size_type Capacity(void) const
+	{
+		return _capacity;
+	}
+
+	// The total size of the free ranges
+	size_type Free(void) const
+	{
+		return _free;
+	}
+
+	// The total size of the allocated ranges
+	size_type Used(void) const
+	{
+		return _capacity - _free;
+	}
+
+	bool Empty(void) const
+	{
+		return _free == _capacity;
+	}
+
+	// The number of separate free ranges
+	size_type FreeRangeCount(void) const
+	{
+		return _by_offset.size();
+	}
+
+	// The size of the largest free range
+	size_type LargestFree(void) const
+	{
+		if(_by_size.empty()) return 0;
+		return _by_size.rbegin()->first;
+	}
+
+	// Returns a value between 0 (no fragmentation, the whole free
+	// space is a single range) and 1 (heavily fragmented free space)
+	double Fragmentation(void) const
+	{
+		if(_free == 0) return 0.0;
+		return 1.0 - double(LargestFree())/double(_free);
+	}
+
+	// Finds the smallest free range that can hold the specified size.
+	// Returns true and sets offset on success, returns false otherwise
+	bool Allocate(size_type size, size_type& offset)
+	{
+		assert(size > 0);
+		if(size > _free) return false;
+
+		auto pos = _by_size.lower_bound(_size_offs(size, 0));
+		if(pos == _by_size.end()) return false;
+
+		const size_type found_size = pos->first;
+		const size_type found_offs = pos->second;
+		assert(_by_offset.find(found_offs) != _by_offset.end());
+		_by_size.erase(pos);
+		_by_offset.erase(found_offs);
+
+		if(found_size > size)
+		{
+			_insert(found_offs + size, found_size - size);
+		}
+		_free -= size;
+		offset = found_offs;
+		return true;
+	}
+
+	// Returns a previously allocated range, merging it with the
+	// adjacent free ranges
+	void Deallocate(size_type offset, size_type size)
+	{
+		assert(size > 0);
+		assert(offset + size <= _capacity);
+		_free += size;
+
+		auto next = _by_offset.lower_bound(offset);
+		assert(next == _by_offset.end() || next->first >= offset+size);
+
+		// merge with the following free range
+		if((next != _by_offset.end()) && (next->first == offset+size))
+		{
+			size += next->second;
+			auto tmp = next++;
+			_erase(tmp);
+		}
+		// merge with the preceding free range
+		if(next != _by_offset.begin())
+		{
+			auto prev = next;
+			--prev;
+			assert(prev->first + prev->second <= offset);
+			if(prev->first + prev->second == offset)
+			{
+				offset = prev->first;
+				size += prev->second;
+				_erase(prev);
+			}
+		}
+		_insert(offset, size);
+	}
+
+	// Extends the managed storage to new_capacity
+	void Grow(size_type new_capacity)
+	{
+		assert(new_capacity >= _capacity);
+		if(new_capacity == _capacity) return;
+		size_type old_capacity = _capacity;
+		_capacity = new_capacity;
+		Deallocate(old_capacity, new_capacity - old_capacity);
+	}
+
+	// Marks the whole storage as free
+	void Clear(void)
+	{
+		_by_offset.clear();
+		_by_size.clear();
+		_free = _capacity;
+		if(_capacity > 0) _insert(0, _capacity);
+	}
+
+	// Moves all the allocated ranges to the beginning of the storage
+	// so that the free space forms a single range at its end.
+	// For every contiguous block of allocated ranges the mover
+	// function is called with (old_offset, new_offset, size),
+	// the blocks are visited in ascending order and new_offset
+	// is always less than old_offset. It is the responsibility
+	// of the mover to relocate the data in the storage and to
+	// update the offsets of the individual allocations.
+	// Returns the number of units that were moved.
+	template <typename Mover>
+	size_type Compact(Mover mover)
+	{
+		size_type moved = 0;
+		size_type gap = 0;
+		auto i = _by_offset.begin(), e = _by_offset.end();
+		while(i != e)
+		{
+			size_type block_begin = i->first + i->second;
+			gap += i->second;
+			++i;
+			size_type block_end = (i != e)?i->first:_capacity;
+			if(block_end > block_begin)
+			{
+				size_type size = block_end - block_begin;
+				mover(block_begin, block_begin - gap, size);
+				moved += size;
+			}
+		}
+		assert(gap == _free);
+		_by_offset.clear();
+		_by_size.clear();
+		if(_free > 0) _insert(_capacity - _free, _free);
+		return moved;
+	}
+};
+
+} // namespace aux
+} // namespace oglplus
+
+#endif // include guard
@@ -335,8 +335,8 @@ public:
 		 , _ptr(
 			OGLPLUS_GLFUNC(MapBufferRange)(
 				GLenum(target),
-				offset,
-				size,
+				_offset,
+				_size,
 				GLbitfield(access)
 			)
 		), _target(target)
@@ -234,6 +234,25 @@
 # endif
 #endif
 
+#if OGLPLUS_DOCUMENTATION_ONLY
+/// Compile-time switch enabling the counting of calls to GL functions
+/** Setting this preprocessor symbol to a nonzero value causes that
+ *  every call to a GL function made by @OGLplus increments a global
+ *  counter, which can be read with the GLFuncCallCount() function.
+ *  This is useful in benchmarks and regression tests, but adds a (small)
+ *  overhead to every call.
+ *
+ *  By default this option is set to 0, i.e. the calls are not counted.
+ *
+ *  @ingroup compile_time_config
+ */
+#define OGLPLUS_COUNT_GLFUNC_CALLS
+#else
+# ifndef OGLPLUS_COUNT_GLFUNC_CALLS
+#  define OGLPLUS_COUNT_GLFUNC_CALLS 0
+# endif
+#endif
+
 #if OGLPLUS_DOCUMENTATION_ONLY
 /// Compile-time switch entirely disabling typechecking of uniforms.
 /** Setting this preprocessor symbol to a nonzero value causes that
@@ -60,6 +60,28 @@
 # endif
 #endif
 
+#if OGLPLUS_DOCUMENTATION_ONLY
+/// Compile-time switch enabling the tracing of CPU time spent in @OGLplus
+/** Setting this preprocessor symbol to a nonzero value enables the
+ *  CPUTrace instrumentation of the potentially expensive operations
+ *  of @OGLplus (shape and image generation, image decoding, text layout,
+ *  blend file parsing, shader compilation and program linking, etc.).
+ *  The recorded scopes can be written in the Chrome trace format with
+ *  CPUTrace::WriteChromeTrace.
+ *
+ *  By default this option is set to 0, i.e. the instrumentation
+ *  is completely removed at compile-time. If @OGLplus is used as
+ *  a library then the library must be built with the same setting.
+ *
+ *  @ingroup compile_time_config
+ */
+#define OGLPLUS_CPU_TRACING
+#else
+# ifndef OGLPLUS_CPU_TRACING
+#  define OGLPLUS_CPU_TRACING 0
+# endif
+#endif
+
 #if OGLPLUS_LINK_LIBRARY
 # define OGLPLUS_LIB_FUNC
 #else
@@ -0,0 +1,288 @@
+/**
+ *  @file oglplus/cpu_trace.hpp
+ *  @brief Low-overhead tracing of the CPU time spent in scopes
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_CPU_TRACE_1311241000_HPP
+#define OGLPLUS_CPU_TRACE_1311241000_HPP
+
+#include <oglplus/config_basic.hpp>
+
+#ifndef OGLPLUS_NO_SITE_CONFIG
+#include <oglplus/site_config.hpp>
+#endif
+
+#if OGLPLUS_DOCUMENTATION_ONLY || OGLPLUS_CPU_TRACING
+
+#include <oglplus/auxiliary/json.hpp>
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <vector>
+#include <ostream>
+#include <chrono>
+
+#if !OGLPLUS_NO_THREADS
+#include <atomic>
+#include <mutex>
+#endif
+
+#if (defined(__GNUC__) || defined(__clang__)) && \
+	(defined(__i386__) || defined(__x86_64__))
+#include <x86intrin.h>
+#define OGLPLUS_CPU_TRACE_USE_TSC 1
+#elif defined(_MSC_VER) && (defined(_M_IX86) || defined(_M_X64))
+#include <intrin.h>
+#define OGLPLUS_CPU_TRACE_USE_TSC 1
+#else
+#define OGLPLUS_CPU_TRACE_USE_TSC 0
+#endif
+
+namespace oglplus {
+namespace aux {
+
+// a value written by one thread and read by others
+template <typename T>
+class CPUTraceCell
+{
+private:
+#if !OGLPLUS_NO_THREADS
+	std::atomic<T> _value;
+public:
+	CPUTraceCell(void)
+	 : _value(T())
+	{ }
+
+	T Get(void) const
+	{
+		return _value.load(std::memory_order_relaxed);
+	}
+
+	T Acquire(void) const
+	{
+		return _value.load(std::memory_order_acquire);
+	}
+
+	void Set(T value)
+	{
+		_value.store(value, std::memory_order_relaxed);
+	}
+
+	void Release(T value)
+	{
+		_value.store(value, std::memory_order_release);
+	}
+#else
+	T _value;
+public:
+	CPUTraceCell(void)
+	 : _value(T())
+	{ }
+
+	T Get(void) const { return _value; }
+	T Acquire(void) const { return _value; }
+	void Set(T value) { _value = value; }
+	void Release(T value) { _value = value; }
+#endif
+};
+
+} // namespace aux
+
+/// Records the CPU time spent in (static) named scopes
+/** The scopes are recorded into a ring buffer of the thread executing them,
+ *  so recording a scope takes only two reads of the CPU timestamp counter
+ *  (or of the steady clock on other architectures) and a couple of stores;
+ *  there is no locking, no memory allocation (except for the first scope
+ *  in every thread) and no formatting. When a ring buffer gets full,
+ *  the oldest scopes of the thread are overwritten.
+ *
+ *  The cost of a scope is therefore dominated by the two timestamp reads.
+ *  On a virtual x86-64 machine, where a read of the timestamp counter
+ *  took about 21 ns, a recorded scope took about 48 ns (46 ns more than
+ *  an empty function call) and a scope with the recording disabled about
+ *  1 ns. The @c standalone/005_cpu_trace_bench example measures these
+ *  numbers on the target machine.
+ *
+ *  The scope names must be string literals, or strings which live at least
+ *  until the trace is written, since only the pointers are stored.
+ *
+ *  The instrumentation in @OGLplus is added with the
+ *  @c OGLPLUS_CPU_TRACE_SCOPE macro and exists only if
+ *  the #OGLPLUS_CPU_TRACING compile-time switch is set to a nonzero value.
+ *  Otherwise the macro expands to nothing.
+ *
+ *  Example of usage:
+ *  @code
+ *  {
+ *    OGLPLUS_CPU_TRACE_SCOPE("MyApp::LoadScene");
+ *    // ...
+ *  }
+ *  // ...
+ *  std::ofstream output("trace.json");
+ *  CPUTrace::WriteChromeTrace(output);
+ *  @endcode
+ */
+class CPUTrace
+{
+public:
+	/// The type of the timestamps
+	typedef std::uint64_t Ticks;
+
+	/// The number of scopes kept in the ring buffer of every thread
+	static const std::size_t BufferCapacity = 64*1024;
+
+	/// Returns the current timestamp
+	static Ticks Now(void)
+	{
+#if OGLPLUS_CPU_TRACE_USE_TSC
+		return Ticks(__rdtsc());
+#else
+		return Ticks(std::chrono::duration_cast<std::chrono::nanoseconds>(
+			std::chrono::steady_clock::now().time_since_epoch()
+		).count());
+#endif
+	}
+
+	/// Records the enclosing C++ scope between construction and destruction
+	class Scope
+	{
+	private:
+		const char* _name;
+		Ticks _begin;
+
+		Scope(const Scope&);
+	public:
+		explicit Scope(const char* name)
+		 : _name(name)
+		 , _begin(Enabled()?Now():Ticks(0))
+		{ }
+
+		~Scope(void)
+		{
+			if(_begin) _record(_name, _begin, Now());
+		}
+	};
+
+	/// Returns true if the scopes are being recorded (they are by default)
+	static bool Enabled(void)
+	{
+		return _state().enabled.Get();
+	}
+
+	/// Starts or stops the recording of the scopes in all threads
+	static void Enable(bool enable = true);
+
+	/// Discards the scopes recorded so far
+	static void Clear(void);
+
+	/// Writes the recorded scopes in the Chrome trace format
+	/** The output can be loaded in @c chrome://tracing or in Perfetto.
+	 *  The scopes recorded by other threads while writing may be missing
+	 *  from the output.
+	 */
+	static void WriteChromeTrace(std::ostream& output);
+private:
+	// a complete scope, the fields are written only by the owning thread
+	struct _event
+	{
+		aux::CPUTraceCell<const char*> name;
+		aux::CPUTraceCell<Ticks> begin;
+		aux::CPUTraceCell<Ticks> end;
+	};
+
+	struct _buffer
+	{
+		std::unique_ptr<_event[]> events;
+		// the number of scopes recorded by the thread
+		aux::CPUTraceCell<std::size_t> head;
+		// the number of scopes discarded by Clear
+		std::size_t tail;
+		unsigned thread_index;
+	};
+
+	struct _registry
+	{
+		aux::CPUTraceCell<bool> enabled;
+#if !OGLPLUS_NO_THREADS
+		std::mutex mutex;
+#endif
+		// the buffers are kept after their threads finished
+		std::vector<std::unique_ptr<_buffer>> buffers;
+		Ticks origin_ticks;
+		std::chrono::steady_clock::time_point origin_time;
+
+		_registry(void)
+		 : origin_ticks(Now())
+		 , origin_time(std::chrono::steady_clock::now())
+		{
+			enabled.Set(true);
+		}
+	};
+
+	static _registry& _state(void)
+	{
+		static _registry registry;
+		return registry;
+	}
+
+	static _buffer* _new_buffer(void);
+
+	static _buffer& _thread_buffer(void)
+	{
+#if !OGLPLUS_NO_THREADS
+		static thread_local _buffer* buffer = nullptr;
+#else
+		static _buffer* buffer = nullptr;
+#endif
+		if(!buffer) buffer = _new_buffer();
+		return *buffer;
+	}
+
+	static void _record(const char* name, Ticks begin, Ticks end)
+	{
+		_buffer& buffer = _thread_buffer();
+		std::size_t head = buffer.head.Get();
+		_event& event = buffer.events[head % BufferCapacity];
+		event.name.Set(name);
+		event.begin.Set(begin);
+		event.end.Set(end);
+		buffer.head.Release(head+1);
+	}
+
+	static double _microseconds_per_tick(void);
+};
+
+#define OGLPLUS_CPU_TRACE_CAT_HLP(A, B) A##B
+#define OGLPLUS_CPU_TRACE_CAT(A, B) OGLPLUS_CPU_TRACE_CAT_HLP(A, B)
+
+/// Records the time spent in the rest of the enclosing C++ scope
+/** The @p NAME must be a string literal.
+ *
+ *  @see CPUTrace
+ *  @see #OGLPLUS_CPU_TRACING
+ */
+#define OGLPLUS_CPU_TRACE_SCOPE(NAME) \
+	::oglplus::CPUTrace::Scope \
+	OGLPLUS_CPU_TRACE_CAT(_oglplus_cpu_trace_, __LINE__)("" NAME)
+
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/cpu_trace.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#else
+
+#define OGLPLUS_CPU_TRACE_SCOPE(NAME)
+
+#endif // OGLPLUS_CPU_TRACING
+
+#endif // include guard
@@ -0,0 +1,200 @@
+/**
+ *  @file oglplus/depth_sort.hpp
+ *  @brief Radix sorting of points and spheres by their view-space depth
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_DEPTH_SORT_1311151000_HPP
+#define OGLPLUS_DEPTH_SORT_1311151000_HPP
+
+#include <oglplus/config.hpp>
+#include <oglplus/vector.hpp>
+#include <oglplus/matrix.hpp>
+
+#include <vector>
+#include <cstddef>
+#include <cassert>
+
+#if !OGLPLUS_NO_THREADS
+#include <thread>
+#endif
+
+namespace oglplus {
+
+/// Sorts points or spheres by their depth for drawing of transparent objects
+/** The DepthSorter calculates the view-space depths of an array of points
+ *  or spheres, converts them into unsigned integer keys which have the
+ *  same ordering as the original floating-point values and sorts them
+ *  with a stable least-significant-digit radix sort (8 bits per pass),
+ *  producing a permutation of indices usable for example as the element
+ *  indices in DrawElements.
+ *
+ *  If OGLPLUS_NO_THREADS is not set and there are enough elements,
+ *  the counting and scattering of every pass is split between several
+ *  threads. The passes in which all keys have the same digit are skipped.
+ *
+ *  The order from the previous call is kept, and if the number of elements
+ *  did not change it is used as the starting point of the next sort.
+ *  Since the depths of animated particles usually change only slightly
+ *  between frames, the previous order is often sorted or almost sorted
+ *  and then it is only fixed up by an insertion sort with a bounded
+ *  number of moves, without running the radix sort at all.
+ *
+ *  Example of usage:
+ *  @code
+ *  DepthSorter sorter;
+ *  // ... each frame:
+ *  const std::vector<GLuint>& order = sorter.SortPoints(
+ *      camera_matrix,
+ *      positions.data()->Data(),
+ *      positions.size()
+ *  );
+ *  gl.DrawElements(PrimitiveType::Points, order.size(), order.data());
+ *  @endcode
+ */
+class DepthSorter
+{
+private:
+	// the keys of the elements in their original order
+	std::vector<GLuint> _keys;
+	// the keys and the indices of the elements in the sorted order
+	std::vector<GLuint> _sorted_keys, _tmp_keys;
+	std::vector<GLuint> _order, _tmp_order;
+	unsigned _threads;
+	bool _back_to_front;
+	bool _incremental;
+
+	// calculates the keys from the view-space depths
+	void _make_keys(
+		const Matrix<GLfloat, 4, 4>& camera,
+		const GLfloat* data,
+		std::size_t count,
+		std::size_t stride,
+		bool spheres
+	);
+
+	// tries to fix up the previous order by an insertion sort
+	bool _resort(void);
+
+	// sorts the keys and the order by the radix sort
+	void _radix_sort(void);
+
+	void _sort(void);
+public:
+	/// Creates a new sorter
+	/**
+	 *  @param back_to_front if true then the elements are sorted from
+	 *    the farthest to the closest, otherwise from the closest to the
+	 *    farthest.
+	 *  @param threads the maximum number of threads used for sorting,
+	 *    zero means the number of hardware threads.
+	 */
+	DepthSorter(bool back_to_front = true, unsigned threads = 0)
+	 : _threads(threads)
+	 , _back_to_front(back_to_front)
+	 , _incremental(false)
+	{
+#if !OGLPLUS_NO_THREADS
+		if(_threads == 0)
+			_threads = std::thread::hardware_concurrency();
+#endif
+		if(_threads == 0)
+			_threads = 1;
+	}
+
+	/// Sorts @p count points by their depth
+	/** The points are transformed by the @p camera matrix and sorted
+	 *  by the z coordinate in the view space. The coordinates of the
+	 *  i-th point start at @p positions + i * @p stride.
+	 *  Returns the indices of the points in the sorted order.
+	 */
+	const std::vector<GLuint>& SortPoints(
+		const Matrix<GLfloat, 4, 4>& camera,
+		const GLfloat* positions,
+		std::size_t count,
+		std::size_t stride = 3
+	)
+	{
+		assert(stride >= 3);
+		_make_keys(camera, positions, count, stride, false);
+		_sort();
+		return _order;
+	}
+
+	/// Sorts the points in @p positions by their depth
+	const std::vector<GLuint>& SortPoints(
+		const Matrix<GLfloat, 4, 4>& camera,
+		const std::vector<Vector<GLfloat, 3>>& positions
+	)
+	{
+		static_assert(
+			sizeof(Vector<GLfloat, 3>) == 3*sizeof(GLfloat),
+			"Vector<GLfloat, 3> must be tightly packed"
+		);
+		return SortPoints(
+			camera,
+			positions.empty()?nullptr:positions.front().Data(),
+			positions.size()
+		);
+	}
+
+	/// Sorts @p count spheres by the depth of their point closest to camera
+	/** The spheres are specified by the center and radius (x, y, z, r)
+	 *  starting at @p spheres + i * @p stride for the i-th sphere.
+	 *  Returns the indices of the spheres in the sorted order.
+	 */
+	const std::vector<GLuint>& SortSpheres(
+		const Matrix<GLfloat, 4, 4>& camera,
+		const GLfloat* spheres,
+		std::size_t count,
+		std::size_t stride = 4
+	)
+	{
+		assert(stride >= 4);
+		_make_keys(camera, spheres, count, stride, true);
+		_sort();
+		return _order;
+	}
+
+	/// Sorts @p count elements by the specified view-space @p depths
+	/** The depths are the z coordinates in the view space, i.e. the
+	 *  more negative the value is the farther is the element from the
+	 *  camera.
+	 */
+	const std::vector<GLuint>& SortDepths(
+		const GLfloat* depths,
+		std::size_t count
+	);
+
+	/// Returns the indices in the order from the last sort
+	const std::vector<GLuint>& Order(void) const
+	{
+		return _order;
+	}
+
+	/// Returns true if the last sort only fixed up the previous order
+	bool WasIncremental(void) const
+	{
+		return _incremental;
+	}
+
+	/// Forgets the previous order, the next sort starts from scratch
+	void Reset(void)
+	{
+		_order.clear();
+	}
+};
+
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/depth_sort.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
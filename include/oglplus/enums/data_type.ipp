@@ -30,7 +30,11 @@ UnsignedByte,
 /// UNSIGNED_SHORT
 UnsignedShort,
 /// UNSIGNED_INT
-UnsignedInt
+UnsignedInt,
+/// INT_2_10_10_10_REV
+Int2_10_10_10_Rev,
+/// UNSIGNED_INT_2_10_10_10_REV
+UnsignedInt2_10_10_10_Rev
 
 #else // !OGLPLUS_DOCUMENTATION_ONLY
 
@@ -27,6 +27,16 @@
 #include <unordered_set>
 #include <iostream>
 
+#if !OGLPLUS_NO_THREADS
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#endif
+
 namespace oglplus {
 
 /// Debug output severity enumeration
@@ -175,6 +185,7 @@ public:
 	 *  @see KHR_debug_Unique
 	 *  @see KHR_debug_Tree
 	 *  @see KHR_debug_ToXML
+	 *  @see KHR_debug_Async
 	 */
 	typedef std::function<void (const CallbackData&)> Callback;
 
@@ -538,6 +549,173 @@ typedef KHR_debug_CallbackWithEssence<KHR_debug_ToXMLEssence>
 	KHR_debug_ToXML;
 #endif
 
+#if !OGLPLUS_NO_THREADS
+
+class KHR_debug_AsyncEssence
+{
+private:
+	typedef KHR_debug::Callback Callback;
+	Callback _callback;
+
+	// a bounded multi-producer queue with per-slot sequence numbers,
+	// the text of the message in slot i is stored at i*(_max_length+1)
+	struct _slot
+	{
+		std::atomic<std::size_t> seq;
+		DebugSource source;
+		DebugType type;
+		GLuint id;
+		DebugSeverity severity;
+		GLsizei length;
+	};
+	std::size_t _mask;
+	std::size_t _max_length;
+	std::unique_ptr<_slot[]> _slots;
+	std::vector<GLchar> _text;
+	std::atomic<std::size_t> _enqueue_pos;
+	std::size_t _dequeue_pos;
+
+	// open-addressed set of the hashes of the already seen messages
+	std::size_t _seen_mask;
+	std::unique_ptr<std::atomic<std::uint64_t>[]> _seen;
+
+	unsigned _max_per_second;
+	std::chrono::steady_clock::time_point _window_start;
+	unsigned _window_count;
+	unsigned long _window_limited;
+
+	std::atomic<unsigned long> _received;
+	std::atomic<unsigned long> _repeated;
+	std::atomic<unsigned long> _dropped;
+	std::atomic<unsigned long> _limited;
+
+	std::mutex _mutex;
+	std::condition_variable _cv;
+	bool _stop;
+	std::thread _thread;
+
+	static std::size_t _pow2(std::size_t n);
+	static std::uint64_t _hash(
+		const KHR_debug::CallbackData& data,
+		std::size_t length
+	);
+
+	bool _first_time(std::uint64_t hash);
+	bool _push(const KHR_debug::CallbackData& data, std::size_t length);
+	void _forward(const KHR_debug::CallbackData& data);
+	void _report_limited(void);
+	void _drain(void);
+	void _run(void);
+
+	KHR_debug_AsyncEssence(const KHR_debug_AsyncEssence&);
+public:
+	KHR_debug_AsyncEssence(
+		const Callback& callback,
+		std::size_t ring_size,
+		std::size_t max_length,
+		std::size_t dedup_size,
+		unsigned max_per_second
+	);
+	~KHR_debug_AsyncEssence(void);
+
+	void Call(const KHR_debug::CallbackData& data);
+
+	unsigned long Received(void) const { return _received.load(); }
+	unsigned long Repeated(void) const { return _repeated.load(); }
+	unsigned long Dropped(void) const { return _dropped.load(); }
+	unsigned long Limited(void) const { return _limited.load(); }
+};
+
+/// Filter for KHR_debug passing the messages to another thread
+/** An implementation of KHR_debug::Callback which does not format or write
+ *  anything in the (driver) thread calling it. It copies every message
+ *  which was not seen before (same source, type, id, severity and text)
+ *  into a preallocated lock-free ring, without allocating memory
+ *  or taking locks. A background thread passes the messages from the ring
+ *  to another callback, for example KHR_debug_Tree or KHR_debug_ToXML,
+ *  at most @c max_per_second of them every second. The messages over
+ *  the limit or not fitting into a full ring are counted and discarded;
+ *  the number of discarded messages is periodically reported through
+ *  the other callback.
+ *
+ *  Example of usage:
+ *  @code
+ *  KHR_debug::LogSink sink(KHR_debug_Async(KHR_debug_Tree(std::cerr)));
+ *  @endcode
+ *
+ *  @ingroup gl_extensions
+ */
+class KHR_debug_Async
+{
+private:
+	std::shared_ptr<KHR_debug_AsyncEssence> essence;
+public:
+	typedef KHR_debug::Callback Callback;
+
+	/// Construction takes the callback called from the background thread
+	/**
+	 *  @param callback the callback formatting or writing the messages.
+	 *  @param ring_size the number of messages which can be queued.
+	 *  @param max_length the maximum length of a message, the longer
+	 *    messages are truncated.
+	 *  @param dedup_size the number of distinct messages remembered
+	 *    for the removal of duplicates, zero disables it.
+	 *  @param max_per_second the maximum number of messages passed
+	 *    to @p callback per second, zero means unlimited.
+	 */
+	KHR_debug_Async(
+		const Callback& callback,
+		std::size_t ring_size = 256,
+		std::size_t max_length = 512,
+		std::size_t dedup_size = 4096,
+		unsigned max_per_second = 50
+	): essence(std::make_shared<KHR_debug_AsyncEssence>(
+		callback,
+		ring_size,
+		max_length,
+		dedup_size,
+		max_per_second
+	))
+	{ }
+
+	void operator()(const KHR_debug::CallbackData& data)
+	{
+		essence->Call(data);
+	}
+
+	/// Conversion to Callback type for the KHR_debug ext wrapper
+	operator Callback (void) const
+	{
+		return Callback(*this);
+	}
+
+	/// The number of messages received from the GL
+	unsigned long Received(void) const
+	{
+		return essence->Received();
+	}
+
+	/// The number of repeated messages which were discarded
+	unsigned long Repeated(void) const
+	{
+		return essence->Repeated();
+	}
+
+	/// The number of messages discarded because the ring was full
+	unsigned long Dropped(void) const
+	{
+		return essence->Dropped();
+	}
+
+	/// The number of messages discarded by the rate limit
+	unsigned long Limited(void) const
+	{
+		return essence->Limited();
+	}
+};
+
+#endif // !OGLPLUS_NO_THREADS
+
 #endif // KHR_debug
 
 } // namespace oglplus
@@ -0,0 +1,287 @@
+/**
+ *  @file oglplus/frame_capture.hpp
+ *  @brief Asynchronous capture of rendered frames through pixel-pack buffers
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_FRAME_CAPTURE_1311211000_HPP
+#define OGLPLUS_FRAME_CAPTURE_1311211000_HPP
+
+#include <oglplus/config.hpp>
+#include <oglplus/glfunc.hpp>
+#include <oglplus/error.hpp>
+#include <oglplus/buffer.hpp>
+#include <oglplus/sync.hpp>
+#include <oglplus/pixel_data.hpp>
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <exception>
+#include <cassert>
+
+#if !OGLPLUS_NO_THREADS
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#endif
+
+namespace oglplus {
+
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_3_2 || GL_ARB_sync
+
+/// Reads back rendered frames without stalling the rendering
+/** The FrameCapture reads the pixels of the current read framebuffer
+ *  into one of several (by default three) regions of a pixel-pack buffer
+ *  and fences the region with a Sync object. The pixels are copied out
+ *  of the buffer only after the GPU has signaled the fence, usually
+ *  a couple of frames later, and handed to a writer which runs in one
+ *  or more separate threads. The rendering thread waits only if all
+ *  regions of the ring are still in flight, or if the writers fall
+ *  behind by more frames than there are regions.
+ *
+ *  If OGLPLUS_NO_THREADS is set then the writer is called directly
+ *  from Capture or Finish.
+ *
+ *  Example of usage:
+ *  @code
+ *  FrameCapture capture(width, height, [](const FrameCapture::Frame& f)
+ *  {
+ *    // encode and save f.Pixels() ...
+ *    return true;
+ *  });
+ *  // ... each frame, after rendering and before swapping the buffers:
+ *  if(!capture.Capture()) break;
+ *  // ... at the end:
+ *  capture.Finish();
+ *  @endcode
+ *
+ *  @glvoereq{3,2,ARB,sync}
+ */
+class FrameCapture
+{
+public:
+	/// A captured frame passed to the writer
+	/** The pixels are tightly packed unsigned bytes, with the rows
+	 *  ordered from bottom to top like in ReadPixels.
+	 */
+	class Frame
+	{
+	private:
+		GLuint _number;
+		GLsizei _width;
+		GLsizei _height;
+		PixelDataFormat _format;
+		GLuint _channels;
+		std::vector<GLubyte> _pixels;
+
+		friend class FrameCapture;
+	public:
+		/// The zero-based sequential number of the frame
+		GLuint Number(void) const
+		{
+			return _number;
+		}
+
+		/// The width of the frame in pixels
+		GLsizei Width(void) const
+		{
+			return _width;
+		}
+
+		/// The height of the frame in pixels
+		GLsizei Height(void) const
+		{
+			return _height;
+		}
+
+		/// The format of the pixels
+		PixelDataFormat Format(void) const
+		{
+			return _format;
+		}
+
+		/// The number of bytes per pixel
+		GLuint Channels(void) const
+		{
+			return _channels;
+		}
+
+		/// The pixel data
+		const std::vector<GLubyte>& Pixels(void) const
+		{
+			return _pixels;
+		}
+	};
+
+	/// The function saving the captured frames
+	/** If the writer returns false then the capture stops and
+	 *  the frames still in flight are discarded. If there are several
+	 *  writer threads, then the writer is called concurrently and
+	 *  the frames may be written out of order.
+	 */
+	typedef std::function<bool (const Frame&)> Writer;
+private:
+	Buffer _buffer;
+	GLsizei _width;
+	GLsizei _height;
+	PixelDataFormat _format;
+	GLuint _channels;
+	GLsizeiptr _frame_size;
+	GLuint _ring_size;
+	Writer _writer;
+
+	// the regions of the buffer, _pending of them starting at _head
+	// are waiting for the GPU in the order in which they were read
+	std::vector<std::unique_ptr<Sync>> _fences;
+	std::vector<GLuint> _numbers;
+	GLuint _head;
+	GLuint _pending;
+	GLuint _captured;
+
+	// the copies handed to the writer, recycled through _free
+	std::vector<std::unique_ptr<Frame>> _frames;
+	std::deque<Frame*> _free;
+	std::deque<Frame*> _queued;
+	GLuint _writing;
+	bool _stopped;
+	std::exception_ptr _error;
+
+	double _total_wait;
+	GLuint _stall_count;
+
+#if !OGLPLUS_NO_THREADS
+	mutable std::mutex _mutex;
+	std::condition_variable _cv;
+	bool _quit;
+	std::vector<std::thread> _threads;
+
+	void _write_loop(void);
+#endif
+
+	static GLuint _channel_count(PixelDataFormat format);
+	static double _time(void);
+
+	bool _write(const Frame& frame, std::exception_ptr& error);
+	void _submit(Frame* frame);
+	Frame* _acquire_frame(void);
+	void _wait_for_oldest(void);
+	void _retrieve_oldest(void);
+	void _wait_for_writers(void);
+public:
+	/// Creates a capture of frames with the specified size and format
+	/**
+	 *  @param width the width of the captured frames.
+	 *  @param height the height of the captured frames.
+	 *  @param writer the function saving the captured frames.
+	 *  @param format the format of the captured pixels.
+	 *  @param ring_size the number of frames which can be in flight.
+	 *  @param writer_threads the number of threads calling the writer.
+	 *
+	 *  @throws Error
+	 */
+	FrameCapture(
+		GLsizei width,
+		GLsizei height,
+		Writer writer,
+		PixelDataFormat format = PixelDataFormat::RGBA,
+		GLuint ring_size = 3,
+		GLuint writer_threads = 1
+	);
+
+#if !OGLPLUS_NO_DELETED_FUNCTIONS
+	FrameCapture(const FrameCapture&) = delete;
+#else
+private:
+	FrameCapture(const FrameCapture&);
+public:
+#endif
+
+	/// Waits for the frames handed to the writers
+	/** The frames which were not retrieved by Finish are discarded.
+	 */
+	~FrameCapture(void);
+
+	/// Returns the width of the captured frames
+	GLsizei Width(void) const
+	{
+		return _width;
+	}
+
+	/// Returns the height of the captured frames
+	GLsizei Height(void) const
+	{
+		return _height;
+	}
+
+	/// Returns the format of the captured pixels
+	PixelDataFormat Format(void) const
+	{
+		return _format;
+	}
+
+	/// Returns the number of frames which can be in flight
+	GLuint RingSize(void) const
+	{
+		return _ring_size;
+	}
+
+	/// Reads the current frame and passes the finished ones to the writer
+	/** The pixels of the current read framebuffer are read into
+	 *  the next free region of the ring; this should be done after
+	 *  the frame is rendered and before the buffers are swapped.
+	 *  The regions whose fences have been signaled are copied and
+	 *  handed to the writer. If the ring is full the function waits
+	 *  for the oldest region.
+	 *
+	 *  Returns false if the capture was stopped by the writer.
+	 *
+	 *  @throws Error
+	 */
+	bool Capture(void);
+
+	/// Passes all pending frames to the writer and waits until written
+	/** Rethrows the exception thrown by the writer, if any.
+	 *
+	 *  @throws Error
+	 */
+	void Finish(void);
+
+	/// Returns true if the capture was stopped by the writer
+	bool Stopped(void) const;
+
+	/// Returns the number of frames captured so far
+	GLuint CapturedFrames(void) const
+	{
+		return _captured;
+	}
+
+	/// Returns the number of times Capture or Finish had to wait
+	GLuint StallCount(void) const
+	{
+		return _stall_count;
+	}
+
+	/// Returns the time (in seconds) spent waiting in total
+	double TotalWaitTime(void) const
+	{
+		return _total_wait;
+	}
+};
+
+#endif // sync
+
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/frame_capture.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
@@ -19,6 +19,10 @@
 #include <oglplus/error.hpp>
 #endif
 
+#if OGLPLUS_COUNT_GLFUNC_CALLS && !OGLPLUS_NO_THREADS
+#include <atomic>
+#endif
+
 namespace oglplus {
 
 #if !OGLPLUS_NO_VARIADIC_TEMPLATES && !OGLPLUS_NO_GLFUNC_CHECKS
@@ -41,21 +45,86 @@ inline auto _checked_glfunc(
 	return *ppfn;
 }
 
-#ifndef OGLPLUS_GLFUNC
-#define OGLPLUS_GLFUNC(FUNCNAME) \
+#define OGLPLUS_UNCOUNTED_GLFUNC(FUNCNAME) \
 	::oglplus::_checked_glfunc( \
 		&::gl##FUNCNAME, \
 		OGLPLUS_ERROR_INFO(FUNCNAME) \
 	)
+#else
+#define OGLPLUS_UNCOUNTED_GLFUNC(FUNCNAME) \
+	::gl##FUNCNAME
+#endif
+
+#if OGLPLUS_DOCUMENTATION_ONLY || OGLPLUS_COUNT_GLFUNC_CALLS
+
+namespace aux {
+
+#if !OGLPLUS_NO_THREADS
+typedef std::atomic<unsigned long> GLFuncCallCounter;
+#else
+typedef unsigned long GLFuncCallCounter;
 #endif
+
+inline GLFuncCallCounter& GLFuncCalls(void)
+{
+	static GLFuncCallCounter counter(0);
+	return counter;
+}
+
+template <typename FuncPtr>
+inline FuncPtr _counted_glfunc(FuncPtr pfn)
+{
+#if !OGLPLUS_NO_THREADS
+	GLFuncCalls().fetch_add(1, std::memory_order_relaxed);
 #else
+	++GLFuncCalls();
+#endif
+	return pfn;
+}
+
+} // namespace aux
+
+/// Returns the number of GL functions called by OGLplus so far
+/** This function is available only if #OGLPLUS_COUNT_GLFUNC_CALLS
+ *  is set to a nonzero value. The GL functions called directly
+ *  by the application are not counted.
+ */
+inline unsigned long GLFuncCallCount(void)
+{
+	return aux::GLFuncCalls();
+}
+
+// Every use of OGLPLUS_GLFUNC is counted as one call, so the pointers
+// to GL functions which are passed to other functions and called there
+// any number of times are got with OGLPLUS_UNCOUNTED_GLFUNC and each
+// of their calls is counted with OGLPLUS_GLFUNC_PTR
 #ifndef OGLPLUS_GLFUNC
 #define OGLPLUS_GLFUNC(FUNCNAME) \
-	::gl##FUNCNAME
+	::oglplus::aux::_counted_glfunc(OGLPLUS_UNCOUNTED_GLFUNC(FUNCNAME))
 #endif
+#define OGLPLUS_GLFUNC_PTR(PFN) \
+	::oglplus::aux::_counted_glfunc(PFN)
+#else
+#ifndef OGLPLUS_GLFUNC
+#define OGLPLUS_GLFUNC(FUNCNAME) OGLPLUS_UNCOUNTED_GLFUNC(FUNCNAME)
+#endif
+#define OGLPLUS_GLFUNC_PTR(PFN) PFN
 #endif
 
+/// Returns true if the OGLplus library counts the calls to GL functions
+/** If @OGLplus is used as a separately built library (i.e. if
+ *  #OGLPLUS_LINK_LIBRARY is set) then the GL functions called by the
+ *  functions implemented in the library are counted only if the library
+ *  was built with a nonzero #OGLPLUS_COUNT_GLFUNC_CALLS. This function
+ *  returns the value which the library was built with (or the value used
+ *  by the application if the library is not built separately).
+ */
+bool GLFuncCallsCountedByLibrary(void);
 
 } // namespace oglplus
 
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/glfunc.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
 #endif // include guard
@@ -0,0 +1,296 @@
+/**
+ *  @file oglplus/gpu_profiler.hpp
+ *  @brief Frame profiler measuring nested scopes with GPU timestamp queries
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_GPU_PROFILER_1311231000_HPP
+#define OGLPLUS_GPU_PROFILER_1311231000_HPP
+
+#include <oglplus/config.hpp>
+#include <oglplus/glfunc.hpp>
+#include <oglplus/error.hpp>
+#include <oglplus/extension.hpp>
+#include <oglplus/context/string_queries.hpp>
+#include <oglplus/query.hpp>
+#include <oglplus/ext/KHR_debug.hpp>
+#include <oglplus/auxiliary/json.hpp>
+
+#include <vector>
+#include <deque>
+#include <string>
+#include <ostream>
+#include <cassert>
+
+namespace oglplus {
+
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_3_3 || GL_ARB_timer_query
+
+/// Measures the GPU time of nested scopes in every frame
+/** The GPUProfiler records a pair of @c TIMESTAMP queries at the beginning
+ *  and at the end of every frame and of every scope inside of it. The scopes
+ *  can be nested; every distinct path of scope names gets its own statistics
+ *  (the number of samples, the total, minimal, maximal and last duration).
+ *
+ *  The results of a frame are harvested in BeginFrame only after
+ *  @c latency more frames were started and only if the GPU has already
+ *  finished the frame, so the profiler never waits for the GPU. If the GPU
+ *  gets too far behind, the oldest frames are dropped. The query objects
+ *  are allocated in batches and recycled.
+ *
+ *  If the @c KHR_debug extension is available then the scopes also push
+ *  and pop debug groups, so they are visible in GL debuggers.
+ *
+ *  The recently harvested scopes can be written as a Chrome trace
+ *  (loadable in @c chrome://tracing) and the statistics as JSON.
+ *
+ *  Example of usage:
+ *  @code
+ *  GPUProfiler profiler;
+ *  // ... each frame:
+ *  profiler.BeginFrame();
+ *  {
+ *    GPUProfiler::Scope scope(profiler, "Shadows");
+ *    // render the shadow maps ...
+ *  }
+ *  {
+ *    GPUProfiler::Scope scope(profiler, "Scene");
+ *    // render the scene ...
+ *  }
+ *  profiler.EndFrame();
+ *  @endcode
+ *
+ *  @glvoereq{3,3,ARB,timer_query}
+ */
+class GPUProfiler
+{
+public:
+	/// The statistics of a single scope
+	struct ScopeStats
+	{
+		/// The name of the scope
+		std::string name;
+		/// The names of the enclosing scopes and of this scope
+		std::string path;
+		/// The index of the enclosing scope (the frame is its own parent)
+		GLuint parent;
+		/// The nesting depth of the scope (zero for the frame)
+		GLuint depth;
+		/// The number of harvested samples
+		unsigned long count;
+		/// The total of the harvested durations in milliseconds
+		double total_ms;
+		/// The shortest harvested duration in milliseconds
+		double min_ms;
+		/// The longest harvested duration in milliseconds
+		double max_ms;
+		/// The last harvested duration in milliseconds
+		double last_ms;
+
+		/// The mean duration in milliseconds
+		double MeanMs(void) const
+		{
+			return count?total_ms/count:0.0;
+		}
+	};
+
+	/// Measures the enclosing C++ scope between construction and destruction
+	/** If the scope was already ended, by EndScope or together with
+	 *  its frame by EndFrame, then the destructor does nothing.
+	 */
+	class Scope
+	{
+	private:
+		GPUProfiler* _profiler;
+		// the frame in which the scope was started and its record
+		GLuint _frame;
+		std::size_t _record;
+	public:
+		Scope(GPUProfiler& profiler, const char* name)
+		 : _profiler(&profiler)
+		{
+			_profiler->BeginScope(name);
+			_frame = _profiler->_frame_number-1;
+			_record = _profiler->_open.back();
+		}
+
+		Scope(Scope&& temp)
+		 : _profiler(temp._profiler)
+		 , _frame(temp._frame)
+		 , _record(temp._record)
+		{
+			temp._profiler = nullptr;
+		}
+
+		~Scope(void)
+		{
+			if(_profiler)
+			{
+				try { _profiler->_end_scope(_frame, _record); }
+				catch(...) { }
+			}
+		}
+	};
+private:
+	struct _record
+	{
+		GLuint scope;
+		GLuint begin_query;
+		GLuint end_query;
+	};
+
+	struct _frame
+	{
+		GLuint number;
+		std::vector<_record> records;
+	};
+
+	struct _event
+	{
+		GLuint scope;
+		GLuint frame;
+		GLuint64 begin;
+		GLuint64 end;
+	};
+
+	GLuint _latency;
+	std::size_t _max_events;
+	bool _debug_groups;
+
+	std::vector<ScopeStats> _scopes;
+	std::vector<std::vector<GLuint>> _children;
+
+	std::vector<GLuint> _all_queries;
+	std::vector<GLuint> _free_queries;
+
+	// the frames whose results were not harvested yet, oldest first;
+	// while in a frame, the current frame is the last one
+	std::deque<_frame> _frames;
+	std::vector<std::size_t> _open;
+	bool _in_frame;
+	GLuint _frame_number;
+
+	std::deque<_event> _events;
+	GLuint64 _trace_origin;
+	bool _has_origin;
+
+	unsigned long _harvested;
+	unsigned long _dropped;
+
+	static bool _debug_groups_available(void);
+
+	GLuint _find_scope(GLuint parent, const char* name);
+	GLuint _acquire_query(void);
+	void _release_queries(_frame& frame);
+	void _begin(GLuint scope, const char* name);
+	void _end(void);
+	void _end_scope(GLuint frame, std::size_t record);
+	void _collect(_frame& frame);
+	void _harvest(void);
+public:
+	/// Creates a new profiler
+	/**
+	 *  @param latency the number of frames after which the results
+	 *    of a frame are harvested.
+	 *  @param max_events the number of the most recently harvested
+	 *    scopes kept for WriteChromeTrace.
+	 *  @param debug_groups push and pop @c KHR_debug groups if available.
+	 */
+	GPUProfiler(
+		GLuint latency = 3,
+		std::size_t max_events = 16*1024,
+		bool debug_groups = true
+	);
+
+#if !OGLPLUS_NO_DELETED_FUNCTIONS
+	GPUProfiler(const GPUProfiler&) = delete;
+#else
+private:
+	GPUProfiler(const GPUProfiler&);
+public:
+#endif
+
+	~GPUProfiler(void);
+
+	/// Harvests the finished frames and starts a new one
+	/**
+	 *  @throws Error
+	 */
+	void BeginFrame(void);
+
+	/// Ends the current frame
+	/** The scopes started in the frame which were not ended yet
+	 *  are ended together with the frame.
+	 *
+	 *  @throws Error
+	 */
+	void EndFrame(void);
+
+	/// Starts a scope called @p name nested in the current scope
+	/** Scopes with the same name in the same enclosing scope share
+	 *  the statistics.
+	 *
+	 *  @pre must be called between BeginFrame and EndFrame.
+	 *
+	 *  @throws Error
+	 */
+	void BeginScope(const char* name);
+
+	/// Ends the innermost scope
+	/**
+	 *  @pre must be called between BeginFrame and EndFrame, after
+	 *  a matching call to BeginScope in the same frame.
+	 *
+	 *  @throws Error
+	 */
+	void EndScope(void);
+
+	/// Returns the number of frames started so far
+	GLuint FrameNumber(void) const
+	{
+		return _frame_number;
+	}
+
+	/// Returns the number of frames whose results were harvested
+	unsigned long HarvestedFrames(void) const
+	{
+		return _harvested;
+	}
+
+	/// Returns the number of frames dropped because the GPU was behind
+	unsigned long DroppedFrames(void) const
+	{
+		return _dropped;
+	}
+
+	/// Returns the statistics of the scopes, the first one is the frame
+	const std::vector<ScopeStats>& Scopes(void) const
+	{
+		return _scopes;
+	}
+
+	/// Resets the statistics and drops the recorded trace events
+	void ResetStats(void);
+
+	/// Writes the statistics of all scopes as a JSON array
+	void WriteStats(std::ostream& output) const;
+
+	/// Writes the recently harvested scopes in the Chrome trace format
+	void WriteChromeTrace(std::ostream& output) const;
+};
+
+#endif // timer query
+
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/gpu_profiler.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
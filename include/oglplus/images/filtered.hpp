@@ -145,6 +145,7 @@ public:
 		Extractor extractor
 	): Image(input.Width(), input.Height(), input.Depth(), CH, (T*)0)
 	{
+		OGLPLUS_CPU_TRACE_SCOPE("images::FilteredImage");
 		_calculate(input, filter, extractor, this->_one((T*)0));
 	}
 };
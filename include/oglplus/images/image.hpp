@@ -19,6 +19,7 @@
 #include <cstring>
 #include <oglplus/data_type.hpp>
 #include <oglplus/auxiliary/aligned_pod_array.hpp>
+#include <oglplus/cpu_trace.hpp>
 
 namespace oglplus {
 namespace images {
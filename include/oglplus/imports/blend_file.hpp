@@ -14,6 +14,7 @@
 #define OGLPLUS_IMPORTS_BLEND_FILE_1107121519_HPP
 
 #include <oglplus/imports/blend_file/utils.hpp>
+#include <oglplus/cpu_trace.hpp>
 #include <oglplus/imports/blend_file/reader_client.hpp>
 #include <oglplus/imports/blend_file/range.hpp>
 #include <oglplus/imports/blend_file/info.hpp>
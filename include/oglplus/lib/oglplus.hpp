@@ -24,6 +24,7 @@
 #endif
 
 #include <oglplus/config.hpp>
+#include <oglplus/glfunc.hpp>
 #include <oglplus/string.hpp>
 #include <oglplus/fwd.hpp>
 
@@ -34,6 +35,7 @@
 #include <oglplus/auxiliary/glsl_source.hpp>
 #include <oglplus/auxiliary/shader_data.hpp>
 #include <oglplus/auxiliary/uniform_init.hpp>
+#include <oglplus/auxiliary/json.hpp>
 
 #include <oglplus/error.hpp>
 #include <oglplus/vertex_attrib.hpp>
@@ -43,6 +45,12 @@
 #include <oglplus/shader.hpp>
 #include <oglplus/program.hpp>
 #include <oglplus/program_pipeline.hpp>
+#include <oglplus/streaming_buffer.hpp>
+#include <oglplus/frame_capture.hpp>
+#include <oglplus/gpu_profiler.hpp>
+#include <oglplus/cpu_trace.hpp>
+#include <oglplus/resource_loader.hpp>
+#include <oglplus/depth_sort.hpp>
 
 #include <oglplus/imports/blend_file.hpp>
 
@@ -57,12 +65,18 @@
 #include <oglplus/shapes/tetrahedrons.hpp>
 #include <oglplus/shapes/twisted_torus.hpp>
 #include <oglplus/shapes/wicker_torus.hpp>
+#include <oglplus/shapes/simplify.hpp>
+#include <oglplus/shapes/meshlets.hpp>
+#include <oglplus/shapes/triangle_bvh.hpp>
 
 #include <oglplus/shapes/blender_mesh.hpp>
 #include <oglplus/shapes/obj_mesh.hpp>
+#include <oglplus/shapes/mesh_file.hpp>
+#include <oglplus/shapes/cache.hpp>
 
 #include <oglplus/shapes/draw.hpp>
 #include <oglplus/shapes/wrapper.hpp>
+#include <oglplus/shapes/arena.hpp>
 #include <oglplus/shapes/analyzer.hpp>
 
 #include <oglplus/images/image.hpp>
@@ -55,6 +55,13 @@ inline bool OpenResourceFile(
 	) == 0;
 }
 
+/// Returns the path to a resource file or an empty string if not found
+std::string FindResourcePath(
+	const std::string& category,
+	const std::string& name,
+	const char* ext
+);
+
 class ResourceFile
  : public std::ifstream
 {
@@ -14,6 +14,7 @@
 #define OGLPLUS_PROGRAM_1107121519_HPP
 
 #include <oglplus/config.hpp>
+#include <oglplus/cpu_trace.hpp>
 #include <oglplus/error.hpp>
 #include <oglplus/data_type.hpp>
 #include <oglplus/object.hpp>
@@ -415,8 +416,8 @@ public:
 	{
 		assert(_name != 0);
 		return aux::GetInfoLog(
-			_name, OGLPLUS_GLFUNC(GetProgramiv),
-			OGLPLUS_GLFUNC(GetProgramInfoLog),
+			_name, OGLPLUS_UNCOUNTED_GLFUNC(GetProgramiv),
+			OGLPLUS_UNCOUNTED_GLFUNC(GetProgramInfoLog),
 			"GetProgramiv",
 			"GetProgramInfoLog"
 		);
@@ -437,6 +438,7 @@ public:
 	 */
 	const ProgramOps& Link(void) const
 	{
+		OGLPLUS_CPU_TRACE_SCOPE("Program::Link");
 		assert(_name != 0);
 		OGLPLUS_GLFUNC(LinkProgram)(_name);
 		OGLPLUS_CHECK(OGLPLUS_OBJECT_ERROR_INFO(
@@ -232,8 +232,8 @@ public:
 	{
 		assert(_name != 0);
 		return aux::GetInfoLog(
-			_name, OGLPLUS_GLFUNC(GetProgramPipelineiv),
-			OGLPLUS_GLFUNC(GetProgramPipelineInfoLog),
+			_name, OGLPLUS_UNCOUNTED_GLFUNC(GetProgramPipelineiv),
+			OGLPLUS_UNCOUNTED_GLFUNC(GetProgramPipelineInfoLog),
 			"GetProgramPipelineiv",
 			"GetProgramPipelineInfoLog"
 		);
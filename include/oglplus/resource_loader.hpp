@@ -0,0 +1,280 @@
+/**
+ *  @file oglplus/resource_loader.hpp
+ *  @brief Creation of GL objects in worker threads with shared contexts
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_RESOURCE_LOADER_1311251000_HPP
+#define OGLPLUS_RESOURCE_LOADER_1311251000_HPP
+
+#include <oglplus/config.hpp>
+#include <oglplus/glfunc.hpp>
+#include <oglplus/error.hpp>
+#include <oglplus/sync.hpp>
+#include <oglplus/buffer.hpp>
+#include <oglplus/texture.hpp>
+#include <oglplus/program.hpp>
+#include <oglplus/shader.hpp>
+#include <oglplus/string.hpp>
+#include <oglplus/images/image.hpp>
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <functional>
+#include <utility>
+#include <exception>
+#include <cassert>
+
+#if !OGLPLUS_NO_THREADS
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <future>
+#endif
+
+namespace oglplus {
+
+#if OGLPLUS_DOCUMENTATION_ONLY || \
+	(!OGLPLUS_NO_THREADS && (GL_VERSION_3_2 || GL_ARB_sync))
+
+/// Creates GL objects in worker threads with contexts sharing objects
+/** The ResourceLoader starts one or more worker threads, each of which
+ *  makes its own GL context current (the contexts are created by a function
+ *  supplied by the application and must share objects with the context
+ *  of the rendering thread). The jobs passed to Load (or to the LoadBuffer,
+ *  LoadTexture and BuildProgram shortcuts) are executed by the workers
+ *  and return the created objects through @c std::future.
+ *
+ *  After a job finishes, the worker fences its commands with a Sync object
+ *  and passes the job to the rendering thread through a lock-free queue.
+ *  The rendering thread calls Publish (for example once per frame), which
+ *  makes the futures of the jobs whose fences were already signaled ready,
+ *  without waiting for the GPU. Hence the object returned by a ready future
+ *  is complete and can be used in the rendering context (after it is bound
+ *  again there).
+ *
+ *  The jobs must create only objects that are shared between contexts
+ *  (buffers, textures, renderbuffers, shaders, programs, samplers, etc.)
+ *  and not container objects (vertex arrays, framebuffers, program
+ *  pipelines or transform feedbacks).
+ *
+ *  Example of usage:
+ *  @code
+ *  ResourceLoader loader([&](GLuint) -> std::shared_ptr<void>
+ *  {
+ *    // create a context sharing objects with the rendering context,
+ *    // make it current in this thread and return a handle keeping
+ *    // it alive ...
+ *  });
+ *  std::future<Texture> tex = loader.LoadTexture(
+ *    Texture::Target::_2D,
+ *    images::LoadTexture("stones")
+ *  );
+ *  // ... each frame:
+ *  loader.Publish();
+ *  if(tex.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+ *  {
+ *    Texture texture = tex.get();
+ *    // ...
+ *  }
+ *  @endcode
+ *
+ *  @glvoereq{3,2,ARB,sync}
+ */
+class ResourceLoader
+{
+public:
+	/// Function creating the context of a worker
+	/** The function is called in the worker thread (concurrently from all
+	 *  workers) with the index of the worker. It must make current a context
+	 *  sharing objects with the rendering context and return a handle keeping
+	 *  the context alive, which is released in the worker thread when the
+	 *  loader is destroyed.
+	 */
+	typedef std::function<std::shared_ptr<void>(GLuint)> ContextMaker;
+private:
+	struct _task
+	{
+		_task* next;
+		std::unique_ptr<Sync> fence;
+
+		_task(void)
+		 : next(nullptr)
+		{ }
+
+		virtual ~_task(void) { }
+
+		// executes the job in a worker thread,
+		// returns true if the job created an object
+		virtual bool Run(void) = 0;
+
+		// hands the result over in the rendering thread
+		virtual void Publish(void) = 0;
+	};
+
+	template <typename T>
+	struct _task_impl
+	 : _task
+	{
+		std::function<T(void)> job;
+		std::promise<T> promise;
+		std::unique_ptr<T> result;
+		std::exception_ptr error;
+
+		bool Run(void)
+		{
+			try
+			{
+				result.reset(new T(job()));
+				return true;
+			}
+			catch(...) { error = std::current_exception(); }
+			return false;
+		}
+
+		void Publish(void)
+		{
+			if(result) promise.set_value(std::move(*result));
+			else promise.set_exception(error);
+		}
+	};
+
+	ContextMaker _make_context;
+
+	std::mutex _mutex;
+	std::condition_variable _cv;
+	std::deque<_task*> _queued;
+	GLuint _started;
+	std::exception_ptr _start_error;
+	bool _quit;
+	std::vector<std::thread> _workers;
+
+	// the jobs finished by the workers, most recent first
+	std::atomic<_task*> _completed;
+	// the finished jobs waiting for their fences, oldest first
+	std::deque<_task*> _fenced;
+	// the number of jobs submitted and not published yet
+	std::atomic<std::size_t> _pending;
+
+	void _work(GLuint index);
+	void _submit(_task* task);
+	void _complete(_task* task);
+	void _collect(void);
+	void _stop(void);
+public:
+	/// Starts @p worker_count workers creating their contexts with @p maker
+	/** Waits until all workers have made their contexts current.
+	 *
+	 *  @throws the exception thrown by @p maker in any of the workers.
+	 */
+	ResourceLoader(const ContextMaker& maker, GLuint worker_count = 1);
+
+#if !OGLPLUS_NO_DELETED_FUNCTIONS
+	ResourceLoader(const ResourceLoader&) = delete;
+#else
+private:
+	ResourceLoader(const ResourceLoader&);
+public:
+#endif
+
+	/// Stops the workers
+	/** The jobs that were not finished yet are cancelled and their futures
+	 *  throw @c std::future_error (broken promise). The objects which were
+	 *  created but not published are deleted, so the rendering context
+	 *  (or another context sharing objects with it) should be current.
+	 */
+	~ResourceLoader(void);
+
+	/// Executes @p job in one of the workers
+	/** The @p job is a nullary function returning (by value) the loaded
+	 *  object, and can be called from any thread. Exceptions thrown by
+	 *  the job are passed to the future.
+	 */
+	template <typename Job>
+	std::future<decltype(std::declval<Job>()())> Load(Job job)
+	{
+		typedef decltype(std::declval<Job>()()) T;
+		std::unique_ptr<_task_impl<T>> task(new _task_impl<T>());
+		task->job = std::move(job);
+		std::future<T> result = task->promise.get_future();
+		_submit(task.get());
+		task.release();
+		return result;
+	}
+
+	/// Creates a buffer bound to @p target and uploads @p data into it
+	template <typename GLtype>
+	std::future<Buffer> LoadBuffer(
+		BufferTarget target,
+		std::vector<GLtype> data,
+		BufferUsage usage = BufferUsage::StaticDraw
+	)
+	{
+		// the data are shared, not copied, by the copies of the job
+		auto shared_data = std::make_shared<std::vector<GLtype>>(
+			std::move(data)
+		);
+		return Load([target, shared_data, usage](void) -> Buffer
+		{
+			Buffer buffer;
+			buffer.Bind(target);
+			Buffer::Data(target, *shared_data, usage);
+			return buffer;
+		});
+	}
+
+	/// Creates a two-dimensional texture from @p image
+	/** If @p mipmap is true then the mipmap levels are generated, otherwise
+	 *  the minification filter is set to linear.
+	 */
+	std::future<Texture> LoadTexture(
+		TextureTarget target,
+		images::Image image,
+		bool mipmap = true
+	);
+
+	/// Compiles the shaders from @p sources and links them into a program
+	/** The compile and link errors are passed to the future.
+	 */
+	std::future<Program> BuildProgram(
+		std::vector<std::pair<ShaderType, String>> sources
+	);
+
+	/// Hands over the objects whose loading has finished on the GPU
+	/** This function should be called in the rendering thread, for example
+	 *  once per frame. It makes the futures of the jobs whose fences were
+	 *  signaled ready; it does not wait for the GPU.
+	 *
+	 *  @returns the number of futures made ready.
+	 */
+	std::size_t Publish(void);
+
+	/// Waits until all submitted jobs are finished and publishes them
+	/** This function should be called in the rendering thread.
+	 */
+	void Finish(void);
+
+	/// Returns the number of jobs submitted but not published yet
+	std::size_t Pending(void) const
+	{
+		return _pending.load();
+	}
+};
+
+#endif // threads and sync
+
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/resource_loader.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
@@ -14,6 +14,7 @@
 #define OGLPLUS_SHADER_1107121519_HPP
 
 #include <oglplus/config.hpp>
+#include <oglplus/cpu_trace.hpp>
 #include <oglplus/fwd.hpp>
 #include <oglplus/glfunc.hpp>
 #include <oglplus/error.hpp>
@@ -280,8 +281,8 @@ public:
 	{
 		assert(_name != 0);
 		return aux::GetInfoLog(
-			_name, OGLPLUS_GLFUNC(GetShaderiv),
-			OGLPLUS_GLFUNC(GetShaderInfoLog),
+			_name, OGLPLUS_UNCOUNTED_GLFUNC(GetShaderiv),
+			OGLPLUS_UNCOUNTED_GLFUNC(GetShaderInfoLog),
 			"GetShaderiv",
 			"GetShaderInfoLog"
 		);
@@ -300,6 +301,7 @@ public:
 	 */
 	const ShaderOps& Compile(void) const
 	{
+		OGLPLUS_CPU_TRACE_SCOPE("Shader::Compile");
 		assert(_name != 0);
 		OGLPLUS_GLFUNC(CompileShader)(_name);
 		OGLPLUS_CHECK(OGLPLUS_OBJECT_ERROR_INFO(
@@ -0,0 +1,395 @@
+/**
+ *  @file oglplus/shapes/arena.hpp
+ *  @brief Shared vertex and index buffer pool for many shapes
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_SHAPES_ARENA_1311081140_HPP
+#define OGLPLUS_SHAPES_ARENA_1311081140_HPP
+
+#include <oglplus/config.hpp>
+#include <oglplus/vertex_array.hpp>
+#include <oglplus/vertex_attrib.hpp>
+#include <oglplus/buffer.hpp>
+#include <oglplus/program.hpp>
+#include <oglplus/context.hpp>
+#include <oglplus/optional.hpp>
+#include <oglplus/error.hpp>
+#include <oglplus/string.hpp>
+#include <oglplus/vector.hpp>
+#include <oglplus/auxiliary/range_allocator.hpp>
+
+#include <oglplus/shapes/draw.hpp>
+#include <oglplus/shapes/vert_attr_info.hpp>
+
+#include <vector>
+#include <cassert>
+
+namespace oglplus {
+namespace shapes {
+
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_3_2 || \
+	(GL_ARB_draw_elements_base_vertex && GL_ARB_copy_buffer)
+
+/// Packs the vertices and indices of many shapes into shared buffers
+/** The GeometryArena stores the vertex attributes of all loaded shapes
+ *  interleaved in a single vertex buffer and their (32-bit) indices
+ *  in a single element array buffer. The ranges of vertices and indices
+ *  used by the individual shapes are sub-allocated from these buffers
+ *  and returned to the free-lists when the shape is unloaded. When there
+ *  is not enough space for a new shape, the buffers are reallocated
+ *  and their contents are copied on the GPU.
+ *
+ *  The drawing instructions of the loaded shapes are rewritten so that
+ *  the element draw operations start at the shape's first index in the
+ *  shared index buffer and are drawn with the shape's base vertex.
+ *  All loaded shapes use the same primitive restart index, so they
+ *  can be drawn together with a few multi-draw calls.
+ *
+ *  All shapes in an arena share a single vertex layout, specified by the
+ *  names of the vertex attributes and their number of values per vertex,
+ *  and a single vertex array object, which is set up by UseInProgram.
+ *
+ *  Example of usage:
+ *  @code
+ *  shapes::GeometryArena arena(
+ *      {"Position", "Normal"},
+ *      {3, 3}
+ *  );
+ *  auto cube = arena.Load(shapes::Cube());
+ *  auto torus = arena.Load(shapes::Torus());
+ *  arena.UseInProgram(prog);
+ *  // ...
+ *  arena.Use();
+ *  arena.Draw(cube);
+ *  arena.Draw(std::vector<shapes::GeometryArena::ShapeHandle>{cube, torus});
+ *  @endcode
+ *
+ *  @glvoereq{3,2,ARB,draw_elements_base_vertex}
+ */
+class GeometryArena
+{
+public:
+	/// Handle of a shape loaded into the arena
+	typedef GLuint ShapeHandle;
+
+	/// Value of an invalid shape handle
+	static ShapeHandle InvalidHandle(void)
+	{
+		return ~GLuint(0);
+	}
+
+	/// The primitive restart index used by all shapes in the arena
+	static GLuint RestartIndex(void)
+	{
+		return ~GLuint(1);
+	}
+private:
+	struct _shape_entry
+	{
+		bool loaded;
+		FaceOrientation face_winding;
+		GLuint vertex_offset;
+		GLuint vertex_count;
+		GLuint index_offset;
+		GLuint index_count;
+		std::vector<DrawOperation> ops;
+		Vector<GLfloat, 4> bounding_sphere;
+	};
+
+	// a group of draw commands sharing the same state
+	struct _batch
+	{
+		FaceOrientation face_winding;
+		DrawOperation::Method method;
+		PrimitiveType mode;
+		bool restart;
+
+		std::vector<GLint> firsts;
+		std::vector<GLsizei> counts;
+		std::vector<const GLvoid*> offsets;
+		std::vector<GLint> base_vertices;
+	};
+
+	Context _gl;
+
+	// the vertex layout
+	std::vector<String> _names;
+	std::vector<GLuint> _npvs;
+	std::vector<GLuint> _attr_offsets;
+	GLuint _stride;
+
+	BufferUsage _usage;
+
+	Buffer _vbo;
+	Buffer _ibo;
+
+	aux::RangeAllocator _vertex_alloc;
+	aux::RangeAllocator _index_alloc;
+
+	std::vector<_shape_entry> _shapes;
+	std::vector<ShapeHandle> _free_handles;
+
+	// the vertex array object and the locations of the attributes
+	Optional<VertexArray> _vao;
+	std::vector<GLint> _locations;
+
+	// scratch storage for the multi-draw batches
+	mutable std::vector<_batch> _batches;
+
+	static void _reallocate(
+		Buffer& buffer,
+		GLsizeiptr old_size,
+		GLsizeiptr new_size,
+		BufferUsage usage
+	);
+
+	void _grow_vertices(GLuint needed);
+	void _grow_indices(GLuint needed);
+
+	void _setup_vao(void);
+
+	ShapeHandle _load(
+		const std::vector<std::vector<GLfloat>>& data,
+		const std::vector<GLuint>& npvs,
+		std::vector<GLuint>& indices,
+		const DrawingInstructions& instr,
+		FaceOrientation face_winding,
+		const Vector<GLfloat, 4>& bounding_sphere
+	);
+
+	const _shape_entry& _shape(ShapeHandle handle) const
+	{
+		assert(handle < _shapes.size());
+		assert(_shapes[handle].loaded);
+		return _shapes[handle];
+	}
+
+	_batch& _find_batch(
+		FaceOrientation face_winding,
+		const DrawOperation& op
+	) const;
+
+	static void _setup_restart(bool restart, bool& enabled);
+public:
+	/// Creates an arena with the specified vertex layout and capacity
+	/**
+	 *  @param names the names of the vertex attributes.
+	 *  @param values_per_vertex the number of values per vertex
+	 *    of the respective vertex attributes.
+	 *  @param vertex_capacity the initial capacity of the vertex buffer
+	 *    (in vertices).
+	 *  @param index_capacity the initial capacity of the index buffer
+	 *    (in indices).
+	 *  @param usage the usage hint for the buffers.
+	 *
+	 *  @throws Error
+	 */
+	GeometryArena(
+		const std::vector<String>& names,
+		const std::vector<GLuint>& values_per_vertex,
+		GLuint vertex_capacity = 64*1024,
+		GLuint index_capacity = 256*1024,
+		BufferUsage usage = BufferUsage::StaticDraw
+	);
+
+#if !OGLPLUS_NO_DELETED_FUNCTIONS
+	GeometryArena(const GeometryArena&) = delete;
+#else
+private:
+	GeometryArena(const GeometryArena&);
+public:
+#endif
+
+	/// Loads the shape built by the specified @p builder into the arena
+	/** Returns a handle which can be used to draw or unload the shape.
+	 *
+	 *  @throws Error
+	 */
+	template <class ShapeBuilder>
+	ShapeHandle Load(const ShapeBuilder& builder)
+	{
+		typename ShapeBuilder::VertexAttribs vert_attr_info;
+		std::vector<std::vector<GLfloat>> data(_names.size());
+		std::vector<GLuint> npvs(_names.size(), 0);
+		for(std::size_t i=0, n=_names.size(); i!=n; ++i)
+		{
+			auto getter = vert_attr_info.VertexAttribGetter(
+				data[i],
+				_names[i]
+			);
+			if(getter != nullptr)
+			{
+				npvs[i] = getter(builder, data[i]);
+			}
+		}
+		auto shape_indices = builder.Indices();
+		std::vector<GLuint> indices(
+			shape_indices.begin(),
+			shape_indices.end()
+		);
+		Vector<GLfloat, 4> bounding_sphere;
+		builder.BoundingSphere(bounding_sphere);
+
+		return _load(
+			data,
+			npvs,
+			indices,
+			builder.Instructions(),
+			builder.FaceWinding(),
+			bounding_sphere
+		);
+	}
+
+	/// Unloads the shape with the specified @p handle from the arena
+	/** The vertex and index ranges used by the shape are returned
+	 *  to the free-lists and the handle may be reused by a shape
+	 *  loaded later.
+	 */
+	void Unload(ShapeHandle handle);
+
+	/// Returns true if @p handle refers to a loaded shape
+	bool Loaded(ShapeHandle handle) const
+	{
+		return (handle < _shapes.size()) && _shapes[handle].loaded;
+	}
+
+	/// Returns the number of currently loaded shapes
+	GLuint ShapeCount(void) const
+	{
+		return GLuint(_shapes.size() - _free_handles.size());
+	}
+
+	/// Returns the capacity (in vertices) of the vertex buffer
+	GLuint VertexCapacity(void) const
+	{
+		return GLuint(_vertex_alloc.Capacity());
+	}
+
+	/// Returns the number of vertices used by the loaded shapes
+	GLuint VerticesUsed(void) const
+	{
+		return GLuint(_vertex_alloc.Used());
+	}
+
+	/// Returns the capacity (in indices) of the index buffer
+	GLuint IndexCapacity(void) const
+	{
+		return GLuint(_index_alloc.Capacity());
+	}
+
+	/// Returns the number of indices used by the loaded shapes
+	GLuint IndicesUsed(void) const
+	{
+		return GLuint(_index_alloc.Used());
+	}
+
+	/// Returns the size (in bytes) of a single vertex
+	GLsizei VertexSize(void) const
+	{
+		return GLsizei(_stride*sizeof(GLfloat));
+	}
+
+	/// Returns the shared vertex buffer
+	const Buffer& VertexBuffer(void) const
+	{
+		return _vbo;
+	}
+
+	/// Returns the shared index buffer
+	const Buffer& IndexBuffer(void) const
+	{
+		return _ibo;
+	}
+
+	/// Returns the base vertex of the shape with the specified @p handle
+	GLint BaseVertex(ShapeHandle handle) const
+	{
+		return GLint(_shape(handle).vertex_offset);
+	}
+
+	/// Returns the rewritten draw operations of a shape
+	/** The @c first member of the element draw operations is the index
+	 *  of the first element in the shared index buffer. The elements
+	 *  must be drawn with the shape's BaseVertex.
+	 */
+	const std::vector<DrawOperation>& Operations(ShapeHandle handle) const
+	{
+		return _shape(handle).ops;
+	}
+
+	/// Returns the face winding of the shape with the specified @p handle
+	FaceOrientation FaceWinding(ShapeHandle handle) const
+	{
+		return _shape(handle).face_winding;
+	}
+
+	/// Returns the bounding sphere of a shape
+	Vector<GLfloat, 4> BoundingSphere(ShapeHandle handle) const
+	{
+		return _shape(handle).bounding_sphere;
+	}
+
+	/// Sets up the arena's vertex array object for the specified program
+	/** The attributes not used by the program are not enabled.
+	 *  The VAO is updated automatically if the buffers are reallocated.
+	 */
+	void UseInProgram(const ProgramOps& prog);
+
+	/// Binds the arena's vertex array object
+	/**
+	 *  @pre UseInProgram was called.
+	 */
+	void Use(void)
+	{
+		assert(_vao.IsInitialized());
+		_vao.Bind();
+	}
+
+	/// Draws the shape with the specified @p handle
+	/**
+	 *  @pre the arena's VAO is bound.
+	 */
+	void Draw(ShapeHandle handle, GLuint inst_count = 1) const;
+
+	/// Draws the shapes with the specified handles using multi-draw calls
+	/** The draw operations of all the shapes are grouped by face winding,
+	 *  drawing method and primitive type and every group is drawn with
+	 *  a single multi-draw call. The drawing phases of the individual
+	 *  shapes are ignored.
+	 *
+	 *  @pre the arena's VAO is bound.
+	 */
+	void Draw(const std::vector<ShapeHandle>& handles) const;
+
+	/// Returns the indirect draw commands for the shapes with the @p mode
+	/** The commands have the layout of @c DrawElementsIndirectCommand
+	 *  and are generated for all element draw operations of the shapes
+	 *  specified by @p handles that use the primitive type @p mode.
+	 *  If primitive restart is used by the shapes, it must be enabled
+	 *  with the RestartIndex value when drawing the commands.
+	 */
+	std::vector<GLuint> IndirectCommands(
+		const std::vector<ShapeHandle>& handles,
+		PrimitiveType mode,
+		GLuint inst_count = 1,
+		GLuint base_inst = 0
+	) const;
+};
+
+#endif // GL_VERSION_3_2 || ARB_draw_elements_base_vertex
+
+} // shapes
+} // oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/shapes/arena.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
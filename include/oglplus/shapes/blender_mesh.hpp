@@ -14,6 +14,7 @@
 #define OGLPLUS_SHAPES_BLENDER_MESH_1206011111_HPP
 
 #include <oglplus/vector.hpp>
+#include <oglplus/cpu_trace.hpp>
 #include <oglplus/matrix.hpp>
 #include <oglplus/face_mode.hpp>
 
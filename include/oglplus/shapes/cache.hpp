@@ -0,0 +1,508 @@
+/**
+ *  @file oglplus/shapes/cache.hpp
+ *  @brief Cache of generated shape geometry shared by shape wrappers
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_SHAPES_CACHE_1311161030_HPP
+#define OGLPLUS_SHAPES_CACHE_1311161030_HPP
+
+#include <oglplus/config.hpp>
+#include <oglplus/face_mode.hpp>
+#include <oglplus/vector.hpp>
+#include <oglplus/angle.hpp>
+#include <oglplus/string.hpp>
+#include <oglplus/shapes/draw.hpp>
+#include <oglplus/shapes/vert_attr_info.hpp>
+
+#include <vector>
+#include <string>
+#include <list>
+#include <map>
+#include <memory>
+#include <typeinfo>
+#include <type_traits>
+#include <cstddef>
+#include <cassert>
+
+#if !OGLPLUS_NO_THREADS
+#include <mutex>
+#endif
+
+namespace oglplus {
+namespace shapes {
+
+/// The immutable geometry of a shape made by a builder and stored in a cache
+class CachedShapeData
+{
+private:
+	FaceOrientation _face_winding;
+	// the vertex attributes, indexed by BuilderAttribs
+	std::vector<GLfloat> _attribs[BuilderAttribs::Count];
+	GLuint _npvs[BuilderAttribs::Count];
+	std::vector<GLuint> _indices;
+	DrawingInstructions _instructions;
+	Vector<GLfloat, 4> _bounding_sphere;
+
+	friend class CachedShape;
+public:
+	/// Makes the requested attributes, indices and instructions
+	/** If the range of the attribute names is empty then all attributes
+	 *  provided by the builder are made.
+	 */
+	template <class ShapeBuilder, typename Iterator>
+	CachedShapeData(
+		const ShapeBuilder& builder,
+		Iterator names_begin,
+		Iterator names_end
+	): _face_winding(builder.FaceWinding())
+	 , _instructions(builder.Instructions())
+	{
+		BuilderAttribs::Capture(
+			builder,
+			_attribs,
+			_npvs,
+			names_begin,
+			names_end
+		);
+		auto shape_indices = builder.Indices();
+		_indices.assign(shape_indices.begin(), shape_indices.end());
+		builder.BoundingSphere(_bounding_sphere);
+	}
+
+	/// Returns the (approximate) size of the geometry in bytes
+	std::size_t ByteSize(void) const;
+};
+
+/// A shape builder returning the geometry shared through a ShapeCache
+/** CachedShape is a cheap-to-copy handle to immutable shape data. It can
+ *  be used in place of the original builder, for example with the
+ *  ShapeWrapper, which in this case uploads the vertex attributes and
+ *  indices directly from the shared data without copying them.
+ *  The data stays alive as long as any handle referencing it exists,
+ *  even if it was evicted from the cache.
+ *
+ *  The element indices are always stored as unsigned ints.
+ *
+ *  @see ShapeCache
+ */
+class CachedShape
+ : public DrawingInstructionWriter
+{
+private:
+	std::shared_ptr<const CachedShapeData> _data;
+
+	template <typename T>
+	GLuint _attrib(unsigned index, std::vector<T>& dest) const
+	{
+		dest.assign(
+			_data->_attribs[index].begin(),
+			_data->_attribs[index].end()
+		);
+		return _data->_npvs[index];
+	}
+public:
+	CachedShape(const std::shared_ptr<const CachedShapeData>& data)
+	 : _data(data)
+	{
+		assert(_data);
+	}
+
+	/// Returns the winding direction of faces
+	FaceOrientation FaceWinding(void) const
+	{
+		return _data->_face_winding;
+	}
+
+	/// Returns the values of the named vertex attribute
+	/** Returns a null pointer and zero @p values_per_vertex and
+	 *  @p value_count if the attribute was not made.
+	 */
+	const GLfloat* AttribValues(
+		const String& name,
+		GLuint& values_per_vertex,
+		GLuint& value_count
+	) const;
+
+	/// Makes the vertex positions and returns the number of values per vertex
+	template <typename T>
+	GLuint Positions(std::vector<T>& dest) const
+	{
+		return _attrib(BuilderAttribs::Position, dest);
+	}
+
+	/// Makes the vertex normals and returns the number of values per vertex
+	template <typename T>
+	GLuint Normals(std::vector<T>& dest) const
+	{
+		return _attrib(BuilderAttribs::Normal, dest);
+	}
+
+	/// Makes the vertex tangents and returns the number of values per vertex
+	template <typename T>
+	GLuint Tangents(std::vector<T>& dest) const
+	{
+		return _attrib(BuilderAttribs::Tangent, dest);
+	}
+
+	/// Makes the vertex bi-tangents and returns the number of values per vertex
+	template <typename T>
+	GLuint Bitangents(std::vector<T>& dest) const
+	{
+		return _attrib(BuilderAttribs::Bitangent, dest);
+	}
+
+	/// Makes the texture coordinates returns the number of values per vertex
+	template <typename T>
+	GLuint TexCoordinates(std::vector<T>& dest) const
+	{
+		return _attrib(BuilderAttribs::TexCoord, dest);
+	}
+
+	/// Makes the material numbers returns the number of values per vertex
+	template <typename T>
+	GLuint MaterialNumbers(std::vector<T>& dest) const
+	{
+		return _attrib(BuilderAttribs::Material, dest);
+	}
+
+#if OGLPLUS_DOCUMENTATION_ONLY
+	/// Vertex attribute information for this shape builder
+	/** CachedShape provides build functions for the following named
+	 *  vertex attributes (if they were made by the original builder):
+	 *  - "Position" the vertex positions
+	 *  - "Normal" the vertex normals
+	 *  - "Tangent" the vertex tangents
+	 *  - "Bitangent" the vertex bi-tangents
+	 *  - "TexCoord" the vertex texture coordinates
+	 *  - "Material" the vertex material numbers
+	 */
+	typedef VertexAttribsInfo<CachedShape> VertexAttribs;
+#else
+	typedef VertexAttribsInfo<
+		CachedShape,
+		std::tuple<
+			VertexPositionsTag,
+			VertexNormalsTag,
+			VertexTangentsTag,
+			VertexBitangentsTag,
+			VertexTexCoordinatesTag,
+			VertexMaterialNumbersTag
+		>
+	> VertexAttribs;
+#endif
+
+	/// Queries the bounding sphere coordinates and dimensions
+	template <typename T>
+	void BoundingSphere(Vector<T, 4>& center_and_radius) const
+	{
+		center_and_radius = Vector<T, 4>(_data->_bounding_sphere);
+	}
+
+	/// Returns the number of element indices
+	GLuint IndexCount(void) const
+	{
+		return GLuint(_data->_indices.size());
+	}
+
+	/// Returns the pointer to the shared element indices
+	const GLuint* IndexData(void) const
+	{
+		return _data->_indices.empty()?nullptr:_data->_indices.data();
+	}
+
+	/// The type of the index container returned by Indices()
+	typedef std::vector<GLuint> IndexArray;
+
+	/// Returns element indices that are used with the drawing instructions
+	const IndexArray& Indices(void) const
+	{
+		return _data->_indices;
+	}
+
+	/// Returns the instructions for rendering of faces
+	DrawingInstructions Instructions(void) const
+	{
+		return _data->_instructions;
+	}
+
+	/// Returns true if both handles refer to the same shared data
+	friend bool operator == (const CachedShape& a, const CachedShape& b)
+	{
+		return a._data == b._data;
+	}
+
+	/// Returns true if the handles refer to different shared data
+	friend bool operator != (const CachedShape& a, const CachedShape& b)
+	{
+		return a._data != b._data;
+	}
+};
+
+// helper class making the keys of the entries in a ShapeCache
+class ShapeCacheKey
+{
+private:
+	std::string _str;
+
+	template <typename T>
+	void _append_bytes(const T& value)
+	{
+		_str.append(reinterpret_cast<const char*>(&value), sizeof(T));
+	}
+public:
+	ShapeCacheKey(const std::type_info& builder_type)
+	 : _str(builder_type.name())
+	{
+		_str.push_back('\0');
+	}
+
+	// appends the type and the bytes of a number or of an enumerated value
+	template <typename T>
+	void Append(const T& value)
+	{
+		static_assert(
+			std::is_arithmetic<T>::value || std::is_enum<T>::value,
+			"Shape builder parameters must be numbers, enumerations, "
+			"angles or vectors, use ShapeCache::Lookup with an explicit "
+			"key for builders with other parameters"
+		);
+		AppendName(typeid(T).name());
+		_append_bytes(value);
+	}
+
+	// appends the type and the value of an angle
+	template <typename T>
+	void Append(const Angle<T>& angle)
+	{
+		AppendName(typeid(Angle<T>).name());
+		_append_bytes(angle.Value());
+	}
+
+	// appends the type and the components of a vector
+	template <typename T, std::size_t N>
+	void Append(const Vector<T, N>& vector)
+	{
+		AppendName(typeid(Vector<T, N>).name());
+		for(std::size_t i=0; i!=N; ++i)
+			_append_bytes(vector.At(i));
+	}
+
+	void AppendName(const String& name)
+	{
+		_str.append(name);
+		_str.push_back('\0');
+	}
+
+#if !OGLPLUS_NO_VARIADIC_TEMPLATES
+	void AppendAll(void) { }
+
+	template <typename P, typename ... R>
+	void AppendAll(const P& param, const R& ... rest)
+	{
+		Append(param);
+		AppendAll(rest...);
+	}
+#endif
+
+	const std::string& Str(void) const
+	{
+		return _str;
+	}
+};
+
+/// A size-bounded cache of the geometry made by parametric shape builders
+/** Procedural shape builders like Torus, Sphere or SpiralSphere are
+ *  deterministic functions of their constructor parameters. The cache
+ *  makes the geometry for every distinct combination of the builder type,
+ *  its parameters and the requested vertex attributes only once and
+ *  returns it as a CachedShape, sharing the immutable data between all
+ *  users.
+ *
+ *  When the total size of the cached data exceeds the limit, the least
+ *  recently used entries are evicted. The shapes still referenced by
+ *  some CachedShape are kept alive by it, but they are not reused
+ *  for new requests.
+ *
+ *  If OGLPLUS_NO_THREADS is not set then the cache can be used from
+ *  several threads; the geometry is made outside of the lock.
+ *
+ *  The builder parameters must be numbers, enumerated values, angles
+ *  or vectors, they are compared by type and bitwise, so for example
+ *  a shape requested once with @c float and once with @c double parameters
+ *  is made twice. The shapes made by builders with other parameters
+ *  can be cached with Lookup and an explicit key.
+ *
+ *  Example of usage:
+ *  @code
+ *  auto torus = shapes::ShapeCache::Default().Get<shapes::Torus>(
+ *      {"Position", "Normal"},
+ *      1.0, 0.5, 72, 48
+ *  );
+ *  shapes::ShapeWrapper shape({"Position", "Normal"}, torus, prog);
+ *  @endcode
+ */
+class ShapeCache
+{
+private:
+	typedef std::shared_ptr<const CachedShapeData> _data_ptr;
+	typedef std::list<std::string> _lru_list;
+
+	struct _entry
+	{
+		_data_ptr data;
+		std::size_t size;
+		_lru_list::iterator lru;
+	};
+
+	typedef std::map<std::string, _entry> _entry_map;
+
+	_entry_map _entries;
+	// the keys of the entries, the most recently used first
+	_lru_list _lru;
+
+	std::size_t _max_size, _size;
+	std::size_t _hits, _misses;
+
+#if !OGLPLUS_NO_THREADS
+	mutable std::mutex _mutex;
+#endif
+
+	_data_ptr _find(const std::string& key);
+
+	_data_ptr _insert(const std::string& key, const _data_ptr& data);
+
+	void _evict(void);
+
+	template <class ShapeBuilder, typename Iterator>
+	static ShapeCacheKey _key(Iterator names_begin, Iterator names_end)
+	{
+		ShapeCacheKey key(typeid(ShapeBuilder));
+		while(names_begin != names_end)
+		{
+			key.AppendName(*names_begin);
+			++names_begin;
+		}
+		key.AppendName(String());
+		return key;
+	}
+
+	ShapeCache(const ShapeCache&);
+public:
+	/// Creates a cache holding at most @p max_size bytes of geometry
+	ShapeCache(std::size_t max_size = 64*1024*1024)
+	 : _max_size(max_size)
+	 , _size(0)
+	 , _hits(0)
+	 , _misses(0)
+	{ }
+
+	/// Returns a reference to the process-wide cache
+	static ShapeCache& Default(void);
+
+	/// Returns the shape made by the builder, if it is cached
+	/** The @p key must be unique for the builder type and its parameters
+	 *  and the range of the attribute names, otherwise the geometry is
+	 *  made from @p builder and stored in the cache. This overload can
+	 *  be used if the builder is not constructible from plain values.
+	 */
+	template <class ShapeBuilder, typename Iterator>
+	CachedShape Lookup(
+		const std::string& key,
+		Iterator names_begin,
+		Iterator names_end,
+		const ShapeBuilder& builder
+	)
+	{
+		_data_ptr data = _find(key);
+		if(!data)
+		{
+			data = _insert(key, std::make_shared<CachedShapeData>(
+				builder,
+				names_begin,
+				names_end
+			));
+		}
+		return CachedShape(data);
+	}
+
+#if OGLPLUS_DOCUMENTATION_ONLY || !OGLPLUS_NO_VARIADIC_TEMPLATES
+	/// Returns the shape made by ShapeBuilder(params...) with the attributes
+	/** If the range of attribute names is empty then all attributes
+	 *  provided by the builder are made. The builder is constructed only
+	 *  if the shape is not found in the cache.
+	 */
+	template <class ShapeBuilder, typename Iterator, typename ... P>
+	CachedShape GetRange(
+		Iterator names_begin,
+		Iterator names_end,
+		const P& ... params
+	)
+	{
+		ShapeCacheKey key = _key<ShapeBuilder>(names_begin, names_end);
+		key.AppendAll(params...);
+
+		_data_ptr data = _find(key.Str());
+		if(!data)
+		{
+			ShapeBuilder builder(params...);
+			data = _insert(key.Str(), std::make_shared<CachedShapeData>(
+				builder,
+				names_begin,
+				names_end
+			));
+		}
+		return CachedShape(data);
+	}
+
+	/// Returns the shape made by ShapeBuilder(params...) with the attributes
+	template <class ShapeBuilder, typename ... P>
+	CachedShape Get(
+		const std::vector<String>& names,
+		const P& ... params
+	)
+	{
+		return GetRange<ShapeBuilder>(
+			names.begin(),
+			names.end(),
+			params...
+		);
+	}
+#endif
+
+	/// Returns the total size of the cached geometry in bytes
+	std::size_t Size(void) const;
+
+	/// Returns the maximum size of the cached geometry in bytes
+	std::size_t MaxSize(void) const;
+
+	/// Changes the maximum size and evicts the entries above the limit
+	void SetMaxSize(std::size_t max_size);
+
+	/// Returns the number of the cached shapes
+	std::size_t EntryCount(void) const;
+
+	/// Returns the number of requests for shapes found in the cache
+	std::size_t Hits(void) const;
+
+	/// Returns the number of requests for which the shape had to be made
+	std::size_t Misses(void) const;
+
+	/// Evicts all cached shapes
+	void Clear(void);
+};
+
+} // shapes
+} // oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/shapes/cache.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
@@ -204,6 +204,15 @@ private:
 		GLuint inst_count,
 		GLuint base_inst
 	) const;
+
+	void _DrawElementsNoRestart(
+		void* indices,
+		DataType index_data_type,
+		GLuint inst_count,
+		GLuint base_inst
+	) const;
+
+	friend class CompiledDrawingInstructions;
 };
 
 class DrawingInstructionWriter;
@@ -394,6 +403,316 @@ public:
 
 };
 
+/// Drawing instructions compiled into batches of multi-draw commands
+/** The constructor of this class merges consecutive drawing operations
+ *  from DrawingInstructions that have the same method, primitive type,
+ *  primitive restart index and phase into a single batch, which is then
+ *  drawn with a single @c MultiDrawArrays or @c MultiDrawElements call.
+ *  Adjacent ranges of independent primitives (points, lines, triangles)
+ *  are further coalesced into a single range. The primitive restart state
+ *  is changed only between batches that use different restart indices,
+ *  and it is disabled after the last batch.
+ *
+ *  The batches can also be drawn with @c MultiDraw*Indirect commands,
+ *  read from a buffer bound to the @c DRAW_INDIRECT_BUFFER target and
+ *  initialized with the data returned by the IndirectCommands function.
+ *
+ *  @note The elements are drawn from the currently bound element array
+ *  buffer, i.e. the indices are not taken from a client-side array.
+ *
+ *  @see DrawingInstructions
+ */
+class CompiledDrawingInstructions
+{
+public:
+	/// A batch of draw commands sharing the same state
+	struct Batch
+	{
+		/// The method to be used to draw
+		DrawOperation::Method method;
+
+		/// The primitive type to be used to draw
+		PrimitiveType mode;
+
+		/// Primitive restart index
+		GLuint restart_index;
+
+		/// The phase of the drawing process
+		GLuint phase;
+
+		/// Index of the first draw command in this batch
+		GLuint offset;
+
+		/// Number of the draw commands in this batch
+		GLsizei draw_count;
+
+		/// Offset (in bytes) of the first command in the indirect buffer
+		GLintptr indirect_offset;
+	};
+private:
+	DataType _index_type;
+	GLsizeiptr _index_size;
+
+	std::vector<Batch> _batches;
+
+	// the first elements, counts and index buffer offsets
+	// of the individual draw commands in the batches
+	std::vector<GLint> _firsts;
+	std::vector<GLsizei> _counts;
+	std::vector<const GLvoid*> _offsets;
+
+	static bool _independent(PrimitiveType mode);
+
+	bool _can_merge(const Batch& batch, const DrawOperation& op) const;
+	void _add_op(const DrawOperation& op);
+
+	void _compile(const std::vector<DrawOperation>& ops);
+
+	void _setup_restart(
+		const Batch& batch,
+		bool& enabled,
+		GLuint& index,
+		bool force
+	) const;
+
+	void _cleanup_restart(bool enabled) const;
+
+	void _draw_batch(
+		const Batch& batch,
+		GLuint inst_count,
+		GLuint base_inst
+	) const;
+
+	void _draw_batch_indirect(const Batch& batch) const;
+
+	template <typename Driver>
+	void _draw(
+		GLuint inst_count,
+		GLuint base_inst,
+		bool indirect,
+		const Driver& driver
+	) const
+	{
+		bool restart_enabled = false;
+		GLuint restart_index = DrawOperation::NoRestartIndex();
+		bool first_elements = true;
+
+		auto i=_batches.begin(),e=_batches.end();
+		bool do_draw = false;
+		for(auto b=i; b!=e; ++b)
+		{
+			if((b == i) || (b->phase != (b-1)->phase))
+			{
+				do_draw = driver(b->phase);
+			}
+			if(!do_draw) continue;
+
+			if(b->method == DrawOperation::Method::DrawElements)
+			{
+				_setup_restart(
+					*b,
+					restart_enabled,
+					restart_index,
+					first_elements
+				);
+				first_elements = false;
+			}
+			if(indirect) _draw_batch_indirect(*b);
+			else _draw_batch(*b, inst_count, base_inst);
+		}
+		_cleanup_restart(restart_enabled);
+	}
+public:
+	/// Compiles the drawing instructions of a shape
+	/** The @p index_info specifies the type of the indices in the
+	 *  element array buffer used when drawing the shape.
+	 */
+	CompiledDrawingInstructions(
+		const DrawingInstructions& instr,
+		const ElementIndexInfo& index_info
+	): _index_type(index_info.DataType())
+	 , _index_size(GLsizeiptr(index_info.Size()))
+	{
+		_compile(instr.Operations());
+	}
+
+	CompiledDrawingInstructions(CompiledDrawingInstructions&& temp)
+	 : _index_type(temp._index_type)
+	 , _index_size(temp._index_size)
+	 , _batches(std::move(temp._batches))
+	 , _firsts(std::move(temp._firsts))
+	 , _counts(std::move(temp._counts))
+	 , _offsets(std::move(temp._offsets))
+	{ }
+
+	/// Returns the compiled batches
+	const std::vector<Batch>& Batches(void) const
+	{
+		return _batches;
+	}
+
+	/// Returns the total number of draw commands in all batches
+	GLuint CommandCount(void) const
+	{
+		return GLuint(_counts.size());
+	}
+
+	/// Draws the batches with the specified instance count and base
+	/** If @p inst_count is one and @p base_inst is zero, then every batch
+	 *  is drawn with a single multi-draw call, otherwise the commands
+	 *  in a batch are drawn by separate instanced draw calls.
+	 */
+	void Draw(GLuint inst_count = 1, GLuint base_inst = 0) const
+	{
+		_draw(
+			inst_count,
+			base_inst,
+			false,
+			DrawingInstructions::DefaultDriver()
+		);
+	}
+
+	/// Draws the batches, calling the driver on every phase change
+	template <typename Driver>
+	void Draw(GLuint inst_count, GLuint base_inst, Driver driver) const
+	{
+		_draw(inst_count, base_inst, false, driver);
+	}
+
+	/// Returns the commands for the indirect drawing of the batches
+	/** The returned values should be loaded into a buffer which must
+	 *  be bound to the @c DRAW_INDIRECT_BUFFER target when calling
+	 *  DrawIndirect. The commands for DrawArrays batches have the layout
+	 *  of @c DrawArraysIndirectCommand, the commands for DrawElements
+	 *  batches the layout of @c DrawElementsIndirectCommand.
+	 */
+	std::vector<GLuint> IndirectCommands(
+		GLuint inst_count = 1,
+		GLuint base_inst = 0
+	) const;
+
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_4_3 || GL_ARB_multi_draw_indirect
+	/// Draws the batches from the currently bound indirect buffer
+	/**
+	 *  @see IndirectCommands
+	 *
+	 *  @glvoereq{4,3,ARB,multi_draw_indirect}
+	 */
+	void DrawIndirect(void) const
+	{
+		_draw(0, 0, true, DrawingInstructions::DefaultDriver());
+	}
+
+	/// Draws the batches from the bound indirect buffer using a driver
+	template <typename Driver>
+	void DrawIndirect(Driver driver) const
+	{
+		_draw(0, 0, true, driver);
+	}
+#endif
+};
+
+/// Appends the triangles drawn by the @p instructions to @p triangles
+/** The triangle lists, strips and fans (with or without primitive
+ *  restart) drawn by the specified instructions are converted into
+ *  a list of triangles, three vertex indices per triangle. Degenerate
+ *  triangles and the other primitive types are skipped. The @p indices
+ *  are the element indices used by the instructions.
+ */
+void MakeTriangleList(
+	const DrawingInstructions& instructions,
+	const std::vector<GLuint>& indices,
+	std::vector<GLuint>& triangles
+);
+
+// helper function used by MakeTriangleList
+void _MakeTriangleListRun(
+	PrimitiveType mode,
+	const std::vector<GLuint>& run,
+	std::vector<GLuint>& triangles
+);
+
+/// The standard vertex attributes which can be captured from shape builders
+/** This class is used by the classes storing the geometry made by shape
+ *  builders (Simplify, CachedShapeData, MeshFile) to get the values of all
+ *  (or of the requested) vertex attributes provided by a builder.
+ */
+class BuilderAttribs
+{
+private:
+	template <typename Iterator>
+	static bool _requested(
+		unsigned index,
+		Iterator names_begin,
+		Iterator names_end
+	)
+	{
+		if(names_begin == names_end) return true;
+		while(names_begin != names_end)
+		{
+			if(String(*names_begin) == Name(index))
+				return true;
+			++names_begin;
+		}
+		return false;
+	}
+public:
+	/// The indices of the standard attributes
+	enum { Position, Normal, Tangent, Bitangent, TexCoord, Material };
+
+	/// The number of the standard attributes
+	static const unsigned Count = 6;
+
+	/// Returns the name of the standard attribute with the specified index
+	static const GLchar* Name(unsigned index);
+
+	/// Captures the requested attributes provided by the @p builder
+	/** The values of the attribute with the index @c i are stored into
+	 *  @p values[i] and the number of values per vertex into @p npvs[i].
+	 *  The arrays must have Count elements. The values of the attributes
+	 *  which are not provided by the builder or which are not in the range
+	 *  of the attribute names are empty and their npvs are zero. If the
+	 *  range of the names is empty, then all attributes are captured.
+	 */
+	template <class ShapeBuilder, typename Iterator>
+	static void Capture(
+		const ShapeBuilder& builder,
+		std::vector<GLfloat>* values,
+		GLuint* npvs,
+		Iterator names_begin,
+		Iterator names_end
+	)
+	{
+		typename ShapeBuilder::VertexAttribs vert_attr_info;
+		for(unsigned a=0; a!=Count; ++a)
+		{
+			values[a].clear();
+			npvs[a] = 0;
+			if(!_requested(a, names_begin, names_end)) continue;
+			auto getter = vert_attr_info.VertexAttribGetter(
+				values[a],
+				Name(a)
+			);
+			if(getter != nullptr)
+			{
+				npvs[a] = getter(builder, values[a]);
+			}
+		}
+	}
+
+	/// Captures all attributes provided by the @p builder
+	template <class ShapeBuilder>
+	static void Capture(
+		const ShapeBuilder& builder,
+		std::vector<GLfloat>* values,
+		GLuint* npvs
+	)
+	{
+		const GLchar** none = nullptr;
+		Capture(builder, values, npvs, none, none);
+	}
+};
+
 // Helper base class for shape builder classes making the drawing instructions
 class DrawingInstructionWriter
 {
@@ -18,6 +18,7 @@
 #include <oglplus/face_mode.hpp>
 
 #include <oglplus/shapes/vert_attr_info.hpp>
+#include <oglplus/auxiliary/output_iter.hpp>
 
 #include <cmath>
 #include <cassert>
@@ -33,11 +34,6 @@ private:
 	Vec3f _point;
 	Vec3f _u, _v;
 	unsigned _udiv, _vdiv;
-
-	unsigned _vertex_count(void) const
-	{
-		return (_udiv+1)*2+(_vdiv-1)*2;
-	}
 public:
 	/// Creates a default grid
 	Grid(void)
@@ -120,13 +116,20 @@ public:
 		return FaceOrientation::CW;
 	}
 
-	/// Makes vertex coordinates and returns number of values per vertex
-	template <typename T>
-	GLuint Positions(std::vector<T>& dest) const
+	/// Returns the number of vertices made by the vertex attribute functions
+	GLuint VertexCount(void) const
 	{
-		unsigned k = 0, n = _vertex_count();
-		dest.resize(n * 3);
+		return (_udiv+1)*2+(_vdiv-1)*2;
+	}
 
+	/// Writes vertex coordinates through the output iterator @p dest
+	/** Writes 3*VertexCount() values (for example directly into
+	 *  a mapped buffer) and returns number of values per vertex.
+	 */
+	template <typename Iter>
+	GLuint Positions(Iter dest) const
+	{
+		typedef typename aux::OutputIterValue<Iter>::type T;
 		const Vec3f pos(_point - _u - _v);
 		const Vec3f ustep(_u * (2.0 / _udiv));
 		const Vec3f vstep(_v * (2.0 / _vdiv));
@@ -134,66 +137,80 @@ public:
 		for(unsigned i=0; i<(_udiv+1); ++i)
 		{
 			Vec3f tmp = pos+ustep*i;
-			dest[k++] = T(tmp.x());
-			dest[k++] = T(tmp.y());
-			dest[k++] = T(tmp.z());
+			*dest++ = T(tmp.x());
+			*dest++ = T(tmp.y());
+			*dest++ = T(tmp.z());
 
 			tmp += 2.0*_v;
-			dest[k++] = T(tmp.x());
-			dest[k++] = T(tmp.y());
-			dest[k++] = T(tmp.z());
+			*dest++ = T(tmp.x());
+			*dest++ = T(tmp.y());
+			*dest++ = T(tmp.z());
 		}
 
 		for(unsigned j=1; j<(_vdiv); ++j)
 		{
 			Vec3f tmp = pos+vstep*j;
-			dest[k++] = T(tmp.x());
-			dest[k++] = T(tmp.y());
-			dest[k++] = T(tmp.z());
+			*dest++ = T(tmp.x());
+			*dest++ = T(tmp.y());
+			*dest++ = T(tmp.z());
 
 			tmp += 2.0*_u;
-			dest[k++] = T(tmp.x());
-			dest[k++] = T(tmp.y());
-			dest[k++] = T(tmp.z());
+			*dest++ = T(tmp.x());
+			*dest++ = T(tmp.y());
+			*dest++ = T(tmp.z());
 		}
-		assert(k == dest.size());
 		return 3;
 	}
 
-	/// Makes texture-coorinates and returns number of values per vertex
+	/// Makes vertex coordinates and returns number of values per vertex
 	template <typename T>
-	GLuint TexCoordinates(std::vector<T>& dest) const
+	GLuint Positions(std::vector<T>& dest) const
 	{
-		unsigned k = 0, n = _vertex_count();
-		dest.resize(n * 2);
-
+		dest.resize(VertexCount() * 3);
+		return Positions(dest.begin());
+	}
 
+	/// Writes texture-coorinates through the output iterator @p dest
+	/** Writes 2*VertexCount() values (for example directly into
+	 *  a mapped buffer) and returns number of values per vertex.
+	 */
+	template <typename Iter>
+	GLuint TexCoordinates(Iter dest) const
+	{
+		typedef typename aux::OutputIterValue<Iter>::type T;
 		T ustep = T(1) / _udiv;
 		T vstep = T(1) / _vdiv;
 
 
 		for(unsigned i=0; i<(_udiv+1); ++i)
 		{
-			dest[k++] = T(ustep*i);
-			dest[k++] = T(0);
+			*dest++ = T(ustep*i);
+			*dest++ = T(0);
 
-			dest[k++] = T(ustep*i);
-			dest[k++] = T(1);
+			*dest++ = T(ustep*i);
+			*dest++ = T(1);
 		}
 
 		for(unsigned j=1; j<(_vdiv); ++j)
 		{
-			dest[k++] = T(0);
-			dest[k++] = T(vstep*j);
+			*dest++ = T(0);
+			*dest++ = T(vstep*j);
 
-			dest[k++] = T(1);
-			dest[k++] = T(vstep*j);
+			*dest++ = T(1);
+			*dest++ = T(vstep*j);
 		}
-		assert(k == dest.size());
 		// 2 values per vertex
 		return 2;
 	}
 
+	/// Makes texture-coorinates and returns number of values per vertex
+	template <typename T>
+	GLuint TexCoordinates(std::vector<T>& dest) const
+	{
+		dest.resize(VertexCount() * 2);
+		return TexCoordinates(dest.begin());
+	}
+
 #if OGLPLUS_DOCUMENTATION_ONLY
 	/// Vertex attribute information for this shape builder
 	/** Grid provides build functions for the following named
@@ -227,6 +244,41 @@ public:
 	/// The type of index container returned by Indices()
 	typedef std::vector<GLuint> IndexArray;
 
+	/// Returns the number of element indices returned by Indices()
+	GLuint IndexCount(void) const
+	{
+		return (_udiv+1)*2+(_vdiv+1)*2;
+	}
+
+	/// Writes element indices used with the drawing instructions to @p dest
+	/** Writes IndexCount() values through the output iterator @p dest.
+	 */
+	template <typename Iter>
+	void Indices(Iter dest) const
+	{
+		typedef typename aux::OutputIterValue<Iter>::type T;
+
+		for(unsigned i=0; i!=(_udiv+1); ++i)
+		{
+			*dest++ = T(i*2);
+			*dest++ = T(i*2+1);
+		}
+
+		unsigned leap = (_udiv+1)*2;
+
+		*dest++ = T(0);
+		*dest++ = T(leap-2);
+
+		for(unsigned j=0; j!=(_vdiv-1); ++j)
+		{
+			*dest++ = T(leap+j*2);
+			*dest++ = T(leap+j*2+1);
+		}
+
+		*dest++ = T(1);
+		*dest++ = T(leap-1);
+	}
+
 	/// Returns element indices that are used with the drawing instructions
 	IndexArray Indices(void) const;
 
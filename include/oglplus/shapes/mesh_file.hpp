@@ -0,0 +1,429 @@
+/**
+ *  @file oglplus/shapes/mesh_file.hpp
+ *  @brief Binary memory-mappable cache files for shape builders
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_SHAPES_MESH_FILE_1311131030_HPP
+#define OGLPLUS_SHAPES_MESH_FILE_1311131030_HPP
+
+#include <oglplus/config.hpp>
+#include <oglplus/face_mode.hpp>
+#include <oglplus/vector.hpp>
+#include <oglplus/string.hpp>
+#include <oglplus/shapes/draw.hpp>
+#include <oglplus/shapes/vert_attr_info.hpp>
+#include <oglplus/auxiliary/mapped_file.hpp>
+
+#include <vector>
+#include <string>
+#include <istream>
+#include <ostream>
+
+namespace oglplus {
+namespace shapes {
+
+// The header of a binary mesh cache (.omc) file
+//
+// The header is followed by the attribute table, the attribute value
+// streams (32-bit floats), the element indices (32-bit unsigned ints),
+// the drawing operations and the zero-terminated mesh names. All blocks
+// start at offsets aligned to 16 bytes and all values are stored in
+// the native byte order, so the files are not portable between platforms
+// with different endianness, but they can be memory-mapped and the vertex
+// data can be uploaded into buffers without any parsing.
+struct MeshFileHeader
+{
+	char magic[8];
+	GLuint byte_order;
+	GLuint version;
+
+	// 64-bit hashes of the source data and of the loading options
+	// (low and high 32 bits) used for the invalidation of the cache
+	GLuint source_hash[2];
+	GLuint options_hash[2];
+
+	GLenum face_winding;
+	GLfloat bounding_sphere[4];
+
+	GLuint attrib_count;
+	GLuint attrib_offset;
+
+	GLuint index_count;
+	GLuint index_offset;
+
+	GLuint operation_count;
+	GLuint operation_offset;
+
+	GLuint name_count;
+	GLuint name_offset;
+	// the size of the name block in bytes
+	GLuint name_size;
+};
+
+// An entry in the attribute table of a mesh cache file
+struct MeshFileAttrib
+{
+	// zero-terminated name of the vertex attribute (e.g. "Position")
+	GLchar name[16];
+	GLuint values_per_vertex;
+	GLuint value_count;
+	// the offset of the attribute values in the file
+	GLuint offset;
+	GLuint reserved;
+};
+
+// A drawing operation stored in a mesh cache file
+struct MeshFileOperation
+{
+	GLuint method;
+	GLuint mode;
+	GLuint first;
+	GLuint count;
+	GLuint restart_index;
+	GLuint phase;
+};
+
+/// A memory-mapped binary mesh cache file
+/** MeshFile stores the vertex attributes, element indices, drawing
+ *  instructions, the bounding sphere and the mesh names made by any
+ *  shape builder (for example the ObjMesh or BlenderMesh loaders or
+ *  the procedural shapes) in a compact binary file which can be loaded
+ *  much faster than the original source. The file is memory-mapped and
+ *  MeshFile implements the shape builder interface so it can be used
+ *  in place of the original builder. ShapeWrapper uploads the vertex
+ *  attributes and indices directly from the mapping.
+ *
+ *  The file also stores a hash of the source data and a hash of the
+ *  loading options, which should be compared with the current values
+ *  with the Matches or UpToDate functions before the file is used.
+ *
+ *  Example of usage:
+ *  @code
+ *  auto source_hash = shapes::MeshFile::HashFile("model.obj");
+ *  auto options_hash = shapes::MeshFile::Hash("normals,texcoords");
+ *  if(!shapes::MeshFile::UpToDate("model.omc", source_hash, options_hash))
+ *  {
+ *      std::ifstream input("model.obj");
+ *      shapes::ObjMesh mesh(input, opts);
+ *      std::ofstream output("model.omc", std::ios::binary);
+ *      shapes::MeshFile::Write(
+ *          output,
+ *          mesh,
+ *          source_hash,
+ *          options_hash,
+ *          mesh.MeshNames()
+ *      );
+ *  }
+ *  shapes::MeshFile mesh("model.omc");
+ *  shapes::ShapeWrapper shape({"Position", "Normal"}, mesh, prog);
+ *  @endcode
+ */
+class MeshFile
+ : public DrawingInstructionWriter
+{
+public:
+	/// The type of the hash values
+	typedef unsigned long long HashValue;
+private:
+	aux::MappedFile _file;
+	const MeshFileHeader* _header;
+
+	const MeshFileHeader& _check(void) const;
+
+	static GLuint _align(GLuint offset)
+	{
+		return (offset + 15) & ~GLuint(15);
+	}
+
+	static HashValue _hash(const GLuint* hash)
+	{
+		return HashValue(hash[0]) | (HashValue(hash[1]) << 32);
+	}
+
+	template <typename T>
+	GLuint _attrib(const GLchar* name, std::vector<T>& dest) const
+	{
+		GLuint npv = 0, count = 0;
+		const GLfloat* values = AttribValues(name, npv, count);
+		dest.assign(values, values+count);
+		return npv;
+	}
+
+	static void _write(
+		std::ostream& output,
+		FaceOrientation face_winding,
+		const Vector<GLfloat, 4>& bounding_sphere,
+		const std::vector<std::vector<GLfloat> >& attrib_values,
+		const std::vector<GLuint>& attrib_npvs,
+		const std::vector<GLuint>& indices,
+		const DrawingInstructions& instructions,
+		const std::vector<std::string>& mesh_names,
+		HashValue source_hash,
+		HashValue options_hash
+	);
+public:
+	static const char* Extension(void)
+	{
+		return ".omc";
+	}
+
+	/// The initial value of the hash passed to the Hash functions
+	static HashValue InitialHash(void)
+	{
+		return 14695981039346656037ULL;
+	}
+
+	/// Hashes the specified block of data (FNV-1a, 64-bit)
+	/** The @p hash can be a result of a previous call to one of the
+	 *  Hash functions to combine the hashes of several blocks of data.
+	 */
+	static HashValue Hash(
+		const void* data,
+		std::size_t size,
+		HashValue hash = InitialHash()
+	);
+
+	/// Hashes the specified string
+	static HashValue Hash(
+		const std::string& str,
+		HashValue hash = InitialHash()
+	)
+	{
+		return Hash(str.data(), str.size(), hash);
+	}
+
+	/// Hashes the contents of the input stream until the end of file
+	static HashValue Hash(std::istream& input);
+
+	/// Hashes the contents of the file with the specified path
+	static HashValue HashFile(const std::string& path);
+
+	/// Maps the mesh file with the specified path, throws on failure
+	/** Throws @c std::runtime_error also if the file is corrupted, i.e.
+	 *  if any of the blocks, drawing operations or mesh names do not fit
+	 *  into the file, the attribute values or the element indices.
+	 */
+	MeshFile(const std::string& path);
+
+	/// Returns the hash of the source data stored in the file
+	HashValue SourceHash(void) const
+	{
+		return _hash(_header->source_hash);
+	}
+
+	/// Returns the hash of the loading options stored in the file
+	HashValue OptionsHash(void) const
+	{
+		return _hash(_header->options_hash);
+	}
+
+	/// Returns true if the file was made from the specified source
+	bool Matches(HashValue source_hash, HashValue options_hash) const
+	{
+		return	(SourceHash() == source_hash) &&
+			(OptionsHash() == options_hash);
+	}
+
+	/// Returns true if a valid file exists and matches the source
+	static bool UpToDate(
+		const std::string& path,
+		HashValue source_hash,
+		HashValue options_hash
+	);
+
+	/// Returns the winding direction of faces
+	FaceOrientation FaceWinding(void) const
+	{
+		return FaceOrientation(_header->face_winding);
+	}
+
+	/// Returns the values of the named vertex attribute in the mapping
+	/** Returns a null pointer and zero @p values_per_vertex and
+	 *  @p value_count if the file does not contain the attribute.
+	 */
+	const GLfloat* AttribValues(
+		const String& name,
+		GLuint& values_per_vertex,
+		GLuint& value_count
+	) const;
+
+	/// Makes the vertex positions and returns the number of values per vertex
+	template <typename T>
+	GLuint Positions(std::vector<T>& dest) const
+	{
+		return _attrib("Position", dest);
+	}
+
+	/// Makes the vertex normals and returns the number of values per vertex
+	template <typename T>
+	GLuint Normals(std::vector<T>& dest) const
+	{
+		return _attrib("Normal", dest);
+	}
+
+	/// Makes the vertex tangents and returns the number of values per vertex
+	template <typename T>
+	GLuint Tangents(std::vector<T>& dest) const
+	{
+		return _attrib("Tangent", dest);
+	}
+
+	/// Makes the vertex bi-tangents and returns the number of values per vertex
+	template <typename T>
+	GLuint Bitangents(std::vector<T>& dest) const
+	{
+		return _attrib("Bitangent", dest);
+	}
+
+	/// Makes the texture coordinates returns the number of values per vertex
+	template <typename T>
+	GLuint TexCoordinates(std::vector<T>& dest) const
+	{
+		return _attrib("TexCoord", dest);
+	}
+
+	/// Makes the material numbers returns the number of values per vertex
+	template <typename T>
+	GLuint MaterialNumbers(std::vector<T>& dest) const
+	{
+		return _attrib("Material", dest);
+	}
+
+#if OGLPLUS_DOCUMENTATION_ONLY
+	/// Vertex attribute information for this shape builder
+	/** MeshFile provides build functions for the following named
+	 *  vertex attributes (if they were stored in the file):
+	 *  - "Position" the vertex positions
+	 *  - "Normal" the vertex normals
+	 *  - "Tangent" the vertex tangents
+	 *  - "Bitangent" the vertex bi-tangents
+	 *  - "TexCoord" the vertex texture coordinates
+	 *  - "Material" the vertex material numbers
+	 */
+	typedef VertexAttribsInfo<MeshFile> VertexAttribs;
+#else
+	typedef VertexAttribsInfo<
+		MeshFile,
+		std::tuple<
+			VertexPositionsTag,
+			VertexNormalsTag,
+			VertexTangentsTag,
+			VertexBitangentsTag,
+			VertexTexCoordinatesTag,
+			VertexMaterialNumbersTag
+		>
+	> VertexAttribs;
+#endif
+
+	/// Queries the bounding sphere coordinates and dimensions
+	template <typename T>
+	void BoundingSphere(Vector<T, 4>& center_and_radius) const
+	{
+		center_and_radius = Vector<T, 4>(
+			T(_header->bounding_sphere[0]),
+			T(_header->bounding_sphere[1]),
+			T(_header->bounding_sphere[2]),
+			T(_header->bounding_sphere[3])
+		);
+	}
+
+	/// Returns the number of element indices
+	GLuint IndexCount(void) const
+	{
+		return _header->index_count;
+	}
+
+	/// Returns the pointer to the element indices in the mapping
+	const GLuint* IndexData(void) const
+	{
+		return reinterpret_cast<const GLuint*>(
+			_file.Data()+_header->index_offset
+		);
+	}
+
+	/// The type of the index container returned by Indices()
+	typedef std::vector<GLuint> IndexArray;
+
+	/// Returns element indices that are used with the drawing instructions
+	IndexArray Indices(void) const
+	{
+		return IndexArray(IndexData(), IndexData()+IndexCount());
+	}
+
+	/// Returns the instructions for rendering of faces
+	DrawingInstructions Instructions(void) const;
+
+	/// Returns the number of named meshes
+	GLuint MeshCount(void) const
+	{
+		return _header->name_count;
+	}
+
+	/// Returns the names of the meshes
+	std::vector<std::string> MeshNames(void) const;
+
+	/// Queries the index of the mesh with the specified name
+	bool QueryMeshIndex(const std::string& name, GLuint& index) const;
+
+	/// Gets the index of the mesh with the specified name, throws on error
+	GLuint GetMeshIndex(const std::string& name) const;
+
+	/// Writes the shape made by the @p builder into a mesh file
+	/** The vertex attributes provided by the builder are stored
+	 *  as floats and the indices as unsigned ints. The @p mesh_names
+	 *  should be the names of the meshes in the order of the drawing
+	 *  operations, if the builder has any.
+	 */
+	template <class ShapeBuilder>
+	static void Write(
+		std::ostream& output,
+		const ShapeBuilder& builder,
+		HashValue source_hash,
+		HashValue options_hash,
+		const std::vector<std::string>& mesh_names =
+			std::vector<std::string>()
+	)
+	{
+		std::vector<std::vector<GLfloat> > values(BuilderAttribs::Count);
+		std::vector<GLuint> npvs(BuilderAttribs::Count);
+		BuilderAttribs::Capture(builder, values.data(), npvs.data());
+
+		auto shape_indices = builder.Indices();
+		std::vector<GLuint> indices(
+			shape_indices.begin(),
+			shape_indices.end()
+		);
+
+		Vector<GLfloat, 4> bounding_sphere;
+		builder.BoundingSphere(bounding_sphere);
+
+		_write(
+			output,
+			builder.FaceWinding(),
+			bounding_sphere,
+			values,
+			npvs,
+			indices,
+			builder.Instructions(),
+			mesh_names,
+			source_hash,
+			options_hash
+		);
+	}
+};
+
+} // shapes
+} // oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/shapes/mesh_file.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
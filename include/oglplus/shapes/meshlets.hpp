@@ -0,0 +1,275 @@
+/**
+ *  @file oglplus/shapes/meshlets.hpp
+ *  @brief Splitting of shapes into small clusters of triangles
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_SHAPES_MESHLETS_1311111020_HPP
+#define OGLPLUS_SHAPES_MESHLETS_1311111020_HPP
+
+#include <oglplus/face_mode.hpp>
+#include <oglplus/vector.hpp>
+#include <oglplus/matrix.hpp>
+#include <oglplus/shapes/draw.hpp>
+
+#include <vector>
+#include <cassert>
+
+namespace oglplus {
+namespace shapes {
+
+/// A cluster of triangles of a shape made by the Meshlets class
+/** The triangles of a meshlet are stored as local (8-bit) vertex indices
+ *  in the Meshlets::Triangles array, starting at @c 3*triangle_offset.
+ *  The local indices refer to the Meshlets::Vertices array starting
+ *  at @c vertex_offset, which contains the indices of the vertices
+ *  of the original shape.
+ *
+ *  The normal cone is specified by its (unit) axis and by the cutoff
+ *  value. All triangles of the meshlet are back-facing when viewed
+ *  from a position @c p for which
+ *  @code
+ *  Dot(center - p, cone_axis) >= cone_cutoff*Length(center - p) + radius
+ *  @endcode
+ *  The cutoff is 1 if the meshlet cannot be back-face culled.
+ */
+struct Meshlet
+{
+	/// Offset of the first vertex in the Meshlets::Vertices array
+	GLuint vertex_offset;
+	/// Number of vertices used by the meshlet
+	GLuint vertex_count;
+	/// Offset of the first triangle of the meshlet
+	GLuint triangle_offset;
+	/// Number of triangles in the meshlet
+	GLuint triangle_count;
+
+	/// The center of the bounding sphere
+	GLfloat center[3];
+	/// The radius of the bounding sphere
+	GLfloat radius;
+
+	/// The axis of the normal cone
+	GLfloat cone_axis[3];
+	/// The sine of the half-angle of the normal cone (or 1)
+	GLfloat cone_cutoff;
+};
+
+/// Splits the triangles of a shape into meshlets for fine-grained culling
+/** Meshlets takes the vertex positions, indices and drawing instructions
+ *  of the triangles of any shape builder (for example ObjMesh or
+ *  BlenderMesh) and splits them into small clusters having at most
+ *  @c max_vertices distinct vertices and @c max_triangles triangles.
+ *  The clusters are grown greedily from seed triangles ordered along
+ *  a Morton (Z-order) curve, preferring the adjacent triangles which
+ *  add the least new vertices, so the clusters are compact and the
+ *  consecutive clusters are close to each other.
+ *
+ *  Every meshlet has a bounding sphere and a normal cone, which can be
+ *  used for view frustum and back-face culling of whole clusters, either
+ *  on the CPU with the Cull function or on the GPU.
+ *
+ *  The Indices function returns the triangles of all the meshlets
+ *  as a single list of (original) vertex indices which can be drawn
+ *  instead of the original shape's indices, either whole with the
+ *  instructions returned by Instructions(), or only the visible meshlets
+ *  with the instructions returned by Instructions(visible) or with
+ *  the indirect commands returned by IndirectCommands.
+ *
+ *  Example of usage:
+ *  @code
+ *  shapes::ObjMesh mesh(input);
+ *  shapes::Meshlets meshlets(mesh);
+ *  std::vector<GLuint> visible;
+ *  meshlets.Cull(projection*camera, camera_position, visible);
+ *  shapes::DrawingInstructions instr = meshlets.Instructions(visible);
+ *  @endcode
+ */
+class Meshlets
+ : public DrawingInstructionWriter
+{
+private:
+	FaceOrientation _face_winding;
+
+	std::vector<Meshlet> _meshlets;
+	std::vector<GLuint> _vertices;
+	std::vector<GLubyte> _triangles;
+	std::vector<GLuint> _indices;
+
+	void _build(
+		const std::vector<GLfloat>& positions,
+		GLuint values_per_vertex,
+		const std::vector<GLuint>& triangles,
+		GLuint max_vertices,
+		GLuint max_triangles
+	);
+
+	// appends the ranges of triangles of consecutive meshlets to ranges
+	void _ranges(
+		const std::vector<GLuint>& meshlets,
+		std::vector<GLuint>& ranges
+	) const;
+
+	void _bounds(
+		Meshlet& meshlet,
+		const std::vector<GLfloat>& positions,
+		GLuint values_per_vertex
+	) const;
+public:
+	/// Splits the triangles of the shape built by @p builder into meshlets
+	/**
+	 *  @param builder the builder of the shape.
+	 *  @param max_vertices the maximum number of vertices of a meshlet
+	 *    (at most 256).
+	 *  @param max_triangles the maximum number of triangles of a meshlet.
+	 */
+	template <class ShapeBuilder>
+	Meshlets(
+		const ShapeBuilder& builder,
+		GLuint max_vertices = 64,
+		GLuint max_triangles = 124
+	): _face_winding(builder.FaceWinding())
+	{
+		std::vector<GLfloat> positions;
+		GLuint npv = builder.Positions(positions);
+
+		auto shape_indices = builder.Indices();
+		std::vector<GLuint> indices(
+			shape_indices.begin(),
+			shape_indices.end()
+		);
+		std::vector<GLuint> triangles;
+		MakeTriangleList(builder.Instructions(), indices, triangles);
+		_build(positions, npv, triangles, max_vertices, max_triangles);
+	}
+
+	/// Splits the specified list of @p triangles into meshlets
+	/**
+	 *  @param positions the vertex positions.
+	 *  @param values_per_vertex the number of values per vertex position
+	 *    (at least 3).
+	 *  @param triangles the list of triangles, three indices per triangle.
+	 *  @param face_winding the winding of the front faces.
+	 *  @param max_vertices the maximum number of vertices of a meshlet
+	 *    (at most 256).
+	 *  @param max_triangles the maximum number of triangles of a meshlet.
+	 */
+	Meshlets(
+		const std::vector<GLfloat>& positions,
+		GLuint values_per_vertex,
+		const std::vector<GLuint>& triangles,
+		FaceOrientation face_winding = FaceOrientation::CCW,
+		GLuint max_vertices = 64,
+		GLuint max_triangles = 124
+	): _face_winding(face_winding)
+	{
+		_build(
+			positions,
+			values_per_vertex,
+			triangles,
+			max_vertices,
+			max_triangles
+		);
+	}
+
+	/// Returns the winding direction of faces
+	FaceOrientation FaceWinding(void) const
+	{
+		return _face_winding;
+	}
+
+	/// Returns the number of meshlets
+	GLuint Count(void) const
+	{
+		return GLuint(_meshlets.size());
+	}
+
+	/// Returns the meshlet with the specified @p index
+	const Meshlet& Get(GLuint index) const
+	{
+		assert(index < _meshlets.size());
+		return _meshlets[index];
+	}
+
+	/// Returns all meshlets
+	const std::vector<Meshlet>& All(void) const
+	{
+		return _meshlets;
+	}
+
+	/// Returns the (original) vertex indices referenced by the meshlets
+	const std::vector<GLuint>& Vertices(void) const
+	{
+		return _vertices;
+	}
+
+	/// Returns the local vertex indices of the triangles of the meshlets
+	const std::vector<GLubyte>& Triangles(void) const
+	{
+		return _triangles;
+	}
+
+	/// The type of the index container returned by Indices()
+	typedef std::vector<GLuint> IndexArray;
+
+	/// Returns the triangles of all meshlets as original vertex indices
+	/** The triangles of the i-th meshlet start at the index
+	 *  @c 3*Get(i).triangle_offset.
+	 */
+	const IndexArray& Indices(void) const
+	{
+		return _indices;
+	}
+
+	/// Returns the instructions for rendering of all meshlets
+	DrawingInstructions Instructions(void) const;
+
+	/// Returns the instructions for rendering of the specified meshlets
+	/** The draw operations of consecutive meshlets are merged.
+	 */
+	DrawingInstructions Instructions(
+		const std::vector<GLuint>& meshlets
+	) const;
+
+	/// Returns the indirect draw commands for the specified meshlets
+	/** The commands have the layout of @c DrawElementsIndirectCommand,
+	 *  (five values per command) and draw triangles from the Indices.
+	 *  The draw commands of consecutive meshlets are merged.
+	 */
+	std::vector<GLuint> IndirectCommands(
+		const std::vector<GLuint>& meshlets,
+		GLuint inst_count = 1,
+		GLuint base_inst = 0
+	) const;
+
+	/// Finds the meshlets which are potentially visible by a camera
+	/** The indices of the meshlets whose bounding spheres intersect
+	 *  the view frustum specified by the @p projection_x_camera matrix
+	 *  (the product of the projection and the camera matrix) and which
+	 *  are not completely back-facing when viewed from @p camera_position
+	 *  are appended to @p visible. Returns the number of visible meshlets.
+	 *  The meshlets are expected to be in the same space as the camera,
+	 *  i.e. any model transformation must be included in the matrix
+	 *  and the camera position must be in model space.
+	 */
+	GLuint Cull(
+		const Matrix<GLfloat, 4, 4>& projection_x_camera,
+		const Vector<GLfloat, 3>& camera_position,
+		std::vector<GLuint>& visible
+	) const;
+};
+
+} // shapes
+} // oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/shapes/meshlets.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
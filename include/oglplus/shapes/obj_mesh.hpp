@@ -14,6 +14,7 @@
 #define OGLPLUS_SHAPES_OBJ_MESH_1304161247_HPP
 
 #include <oglplus/face_mode.hpp>
+#include <oglplus/cpu_trace.hpp>
 #include <oglplus/shapes/draw.hpp>
 
 #include <oglplus/shapes/vert_attr_info.hpp>
@@ -248,6 +249,12 @@ public:
 		return _mtl_names[mat_num];
 	}
 
+	/// Returns the names of the loaded meshes
+	const std::vector<std::string>& MeshNames(void) const
+	{
+		return _mesh_names;
+	}
+
 	/// Queries the index of the mesh with the specified name
 	bool QueryMeshIndex(const std::string& name, GLuint& index) const;
 
@@ -0,0 +1,256 @@
+/**
+ *  @file oglplus/shapes/simplify.hpp
+ *  @brief Quadric error metric simplification of shapes
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_SHAPES_SIMPLIFY_1311091030_HPP
+#define OGLPLUS_SHAPES_SIMPLIFY_1311091030_HPP
+
+#include <oglplus/face_mode.hpp>
+#include <oglplus/vector.hpp>
+#include <oglplus/shapes/draw.hpp>
+#include <oglplus/shapes/vert_attr_info.hpp>
+
+#include <vector>
+#include <cassert>
+
+namespace oglplus {
+namespace shapes {
+
+/// Makes several levels of detail of a shape built by another builder
+/** Simplify takes the vertex attributes, indices and drawing instructions
+ *  of the triangles of any shape builder and makes a chain of levels
+ *  of detail by repeated edge collapses, ordered by the quadric error
+ *  metric of Garland and Heckbert. Each level has approximately
+ *  @c reduction times the number of triangles of the previous level.
+ *
+ *  The vertices are collapsed into one of their neighbours (no new
+ *  vertices are made), so the values of all vertex attributes remain
+ *  valid. Vertices that share their position with other vertices having
+ *  different attribute values (i.e. vertices on texture coordinate,
+ *  normal or material seams) and vertices on the borders of the mesh
+ *  are never removed, which keeps the seams and borders intact.
+ *
+ *  Simplify is a shape builder itself: all levels share the same vertex
+ *  attribute arrays and store their indices in consecutive ranges of the
+ *  array returned by Indices(). The instructions for drawing a specific
+ *  level are returned by Instructions(level). The LODShapeWrapper class
+ *  can be used to draw the levels selected by the projected size of the
+ *  shape's bounding sphere.
+ *
+ *  Example of usage:
+ *  @code
+ *  shapes::Simplify lods(shapes::ObjMesh(input), 5, 0.5f);
+ *  shapes::LODShapeWrapper shape({"Position", "Normal"}, lods, prog);
+ *  @endcode
+ *
+ *  @see LODShapeWrapper
+ */
+class Simplify
+ : public DrawingInstructionWriter
+{
+private:
+	FaceOrientation _face_winding;
+
+	// the (welded) vertex attributes, indexed by BuilderAttribs
+	std::vector<GLfloat> _attribs[BuilderAttribs::Count];
+	GLuint _npvs[BuilderAttribs::Count];
+
+	// the indices of all levels
+	std::vector<GLuint> _indices;
+	// the offset of the first index of the i-th level in _indices
+	std::vector<GLuint> _level_offsets;
+	// the maximum geometric error of the individual levels
+	std::vector<GLfloat> _level_errors;
+
+	Vec4f _bounding_sphere;
+
+	void _weld(std::vector<GLuint>& triangles);
+
+	void _simplify(
+		std::vector<GLuint>& triangles,
+		GLuint level_count,
+		GLfloat reduction
+	);
+
+	template <typename T>
+	GLuint _get_attrib(unsigned index, std::vector<T>& dest) const
+	{
+		dest.assign(_attribs[index].begin(), _attribs[index].end());
+		return _npvs[index];
+	}
+public:
+	/// Simplifies the shape built by @p builder
+	/**
+	 *  @param builder the builder of the full-detail shape.
+	 *  @param level_count the maximum number of the levels of detail
+	 *    including the full-detail level. Less levels are made if the
+	 *    shape cannot be simplified any further.
+	 *  @param reduction the ratio of the triangle counts of two
+	 *    consecutive levels.
+	 */
+	template <class ShapeBuilder>
+	Simplify(
+		const ShapeBuilder& builder,
+		GLuint level_count = 4,
+		GLfloat reduction = 0.5f
+	): _face_winding(builder.FaceWinding())
+	{
+		assert(level_count > 0);
+		assert((reduction > 0.0f) && (reduction < 1.0f));
+
+		BuilderAttribs::Capture(builder, _attribs, _npvs);
+		builder.BoundingSphere(_bounding_sphere);
+
+		auto shape_indices = builder.Indices();
+		std::vector<GLuint> indices(
+			shape_indices.begin(),
+			shape_indices.end()
+		);
+		std::vector<GLuint> triangles;
+		MakeTriangleList(builder.Instructions(), indices, triangles);
+		_weld(triangles);
+		_simplify(triangles, level_count, reduction);
+	}
+
+	/// Returns the winding direction of faces
+	FaceOrientation FaceWinding(void) const
+	{
+		return _face_winding;
+	}
+
+	/// Makes the vertex positions and returns the number of values per vertex
+	template <typename T>
+	GLuint Positions(std::vector<T>& dest) const
+	{
+		return _get_attrib(BuilderAttribs::Position, dest);
+	}
+
+	/// Makes the vertex normals and returns the number of values per vertex
+	template <typename T>
+	GLuint Normals(std::vector<T>& dest) const
+	{
+		return _get_attrib(BuilderAttribs::Normal, dest);
+	}
+
+	/// Makes the vertex tangents and returns the number of values per vertex
+	template <typename T>
+	GLuint Tangents(std::vector<T>& dest) const
+	{
+		return _get_attrib(BuilderAttribs::Tangent, dest);
+	}
+
+	/// Makes the vertex bi-tangents and returns the number of values per vertex
+	template <typename T>
+	GLuint Bitangents(std::vector<T>& dest) const
+	{
+		return _get_attrib(BuilderAttribs::Bitangent, dest);
+	}
+
+	/// Makes the texture coordinates returns the number of values per vertex
+	template <typename T>
+	GLuint TexCoordinates(std::vector<T>& dest) const
+	{
+		return _get_attrib(BuilderAttribs::TexCoord, dest);
+	}
+
+	/// Makes the material numbers returns the number of values per vertex
+	template <typename T>
+	GLuint MaterialNumbers(std::vector<T>& dest) const
+	{
+		return _get_attrib(BuilderAttribs::Material, dest);
+	}
+
+#if OGLPLUS_DOCUMENTATION_ONLY
+	/// Vertex attribute information for this shape builder
+	/** Simplify provides build functions for the same named vertex
+	 *  attributes as the simplified shape builder:
+	 *  - "Position" the vertex positions
+	 *  - "Normal" the vertex normals
+	 *  - "Tangent" the vertex tangents
+	 *  - "Bitangent" the vertex bi-tangents
+	 *  - "TexCoord" the vertex texture coordinates
+	 *  - "Material" the vertex material numbers
+	 *
+	 *  The attributes not provided by the simplified builder are empty.
+	 */
+	typedef VertexAttribsInfo<Simplify> VertexAttribs;
+#else
+	typedef VertexAttribsInfo<
+		Simplify,
+		std::tuple<
+			VertexPositionsTag,
+			VertexNormalsTag,
+			VertexTangentsTag,
+			VertexBitangentsTag,
+			VertexTexCoordinatesTag,
+			VertexMaterialNumbersTag
+		>
+	> VertexAttribs;
+#endif
+
+	/// Queries the bounding sphere coordinates and dimensions
+	template <typename T>
+	void BoundingSphere(Vector<T, 4>& center_and_radius) const
+	{
+		center_and_radius = Vector<T, 4>(_bounding_sphere);
+	}
+
+	/// Returns the number of the levels of detail
+	GLuint LevelCount(void) const
+	{
+		return GLuint(_level_errors.size());
+	}
+
+	/// Returns the number of triangles of the specified @p level
+	GLuint TriangleCount(GLuint level) const
+	{
+		assert(level < LevelCount());
+		return (_level_offsets[level+1]-_level_offsets[level])/3;
+	}
+
+	/// Returns the maximum geometric error of the specified @p level
+	/** The error is an estimate of the maximum distance between
+	 *  the simplified and the original surface, in the units of
+	 *  the vertex positions. The error of level 0 is zero.
+	 */
+	GLfloat LevelError(GLuint level) const
+	{
+		assert(level < LevelCount());
+		return _level_errors[level];
+	}
+
+	/// The type of the index container returned by Indices()
+	typedef std::vector<GLuint> IndexArray;
+
+	/// Returns element indices of all levels of detail
+	const IndexArray& Indices(void) const
+	{
+		return _indices;
+	}
+
+	/// Returns the instructions for rendering of the specified @p level
+	DrawingInstructions Instructions(GLuint level) const;
+
+	/// Returns the instructions for rendering of the full-detail level
+	DrawingInstructions Instructions(void) const
+	{
+		return Instructions(0);
+	}
+};
+
+} // shapes
+} // oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/shapes/simplify.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
@@ -19,6 +19,7 @@
 #include <oglplus/shapes/vert_attr_info.hpp>
 
 #include <oglplus/math.hpp>
+#include <oglplus/auxiliary/output_iter.hpp>
 
 namespace oglplus {
 namespace shapes {
@@ -30,6 +31,29 @@ class Sphere
 private:
 	GLdouble _radius;
 	unsigned _sections, _rings;
+
+	template <typename Iter>
+	GLuint _make_vectors(Iter dest, GLdouble radius) const
+	{
+		typedef typename aux::OutputIterValue<Iter>::type T;
+		GLdouble r_step = (1.0 * math::Pi()) / GLdouble(_rings + 1);
+		GLdouble s_step = (2.0 * math::Pi()) / GLdouble(_sections);
+
+		for(unsigned r=0; r!=(_rings+2);++r)
+		{
+			GLdouble r_lat = std::cos(r*r_step);
+			GLdouble r_rad = std::sin(r*r_step);
+			// the sections
+			for(unsigned s=0; s!=(_sections+1);++s)
+			{
+				*dest++ = T(radius * r_rad *  std::cos(s*s_step));
+				*dest++ = T(radius * r_lat);
+				*dest++ = T(radius * r_rad * -std::sin(s*s_step));
+			}
+		}
+		// 3 values per vertex
+		return 3;
+	}
 public:
 	/// Creates a sphere with unit radius centered at the origin
 	Sphere(void)
@@ -51,30 +75,50 @@ public:
 		return FaceOrientation::CCW;
 	}
 
+	/// Returns the number of vertices made by the vertex attribute functions
+	GLuint VertexCount(void) const
+	{
+		return (_rings + 2) * (_sections + 1);
+	}
+
+	/// Writes vertex normals through the output iterator @p dest
+	/** Writes 3*VertexCount() values (for example directly into
+	 *  a mapped buffer) and returns number of values per vertex.
+	 */
+	template <typename Iter>
+	GLuint Normals(Iter dest) const
+	{
+		return _make_vectors(dest, 1.0);
+	}
+
 	/// Makes vertex normals and returns number of values per vertex
 	template <typename T>
 	GLuint Normals(std::vector<T>& dest) const
 	{
-		dest.resize(((_rings + 2) * (_sections + 1)) * 3);
-		unsigned k = 0;
-		//
-		GLdouble r_step = (1.0 * math::Pi()) / GLdouble(_rings + 1);
+		dest.resize(VertexCount() * 3);
+		return Normals(dest.begin());
+	}
+
+	/// Writes vertex tangents through the output iterator @p dest
+	/** Writes 3*VertexCount() values (for example directly into
+	 *  a mapped buffer) and returns number of values per vertex.
+	 */
+	template <typename Iter>
+	GLuint Tangents(Iter dest) const
+	{
+		typedef typename aux::OutputIterValue<Iter>::type T;
 		GLdouble s_step = (2.0 * math::Pi()) / GLdouble(_sections);
 
 		for(unsigned r=0; r!=(_rings+2);++r)
 		{
-			GLdouble r_lat = std::cos(r*r_step);
-			GLdouble r_rad = std::sin(r*r_step);
-			// the sections
 			for(unsigned s=0; s!=(_sections+1);++s)
 			{
-				dest[k++] = T(r_rad *  std::cos(s*s_step));
-				dest[k++] = T(r_lat);
-				dest[k++] = T(r_rad * -std::sin(s*s_step));
+				*dest++ = T(-std::sin(s*s_step));
+				*dest++ = T(0);
+				*dest++ = T(-std::cos(s*s_step));
 			}
 		}
 		//
-		assert(k == dest.size());
 		// 3 values per vertex
 		return 3;
 	}
@@ -83,33 +127,18 @@ public:
 	template <typename T>
 	GLuint Tangents(std::vector<T>& dest) const
 	{
-		dest.resize(((_rings + 2) * (_sections + 1)) * 3);
-		unsigned k = 0;
-		//
-		GLdouble s_step = (2.0 * math::Pi()) / GLdouble(_sections);
-
-		for(unsigned r=0; r!=(_rings+2);++r)
-		{
-			for(unsigned s=0; s!=(_sections+1);++s)
-			{
-				dest[k++] = T(-std::sin(s*s_step));
-				dest[k++] = T(0);
-				dest[k++] = T(-std::cos(s*s_step));
-			}
-		}
-		//
-		assert(k == dest.size());
-		// 3 values per vertex
-		return 3;
+		dest.resize(VertexCount() * 3);
+		return Tangents(dest.begin());
 	}
 
-	/// Makes vertex bi-tangents and returns number of values per vertex
-	template <typename T>
-	GLuint Bitangents(std::vector<T>& dest) const
+	/// Writes vertex bi-tangents through the output iterator @p dest
+	/** Writes 3*VertexCount() values (for example directly into
+	 *  a mapped buffer) and returns number of values per vertex.
+	 */
+	template <typename Iter>
+	GLuint Bitangents(Iter dest) const
 	{
-		dest.resize(((_rings + 2) * (_sections + 1)) * 3);
-		unsigned k = 0;
-		//
+		typedef typename aux::OutputIterValue<Iter>::type T;
 		GLdouble r_step = (1.0 * math::Pi()) / GLdouble(_rings + 1);
 		GLdouble s_step = (2.0 * math::Pi()) / GLdouble(_sections);
 
@@ -127,35 +156,50 @@ public:
 				GLdouble nx = -r_rad * tz;
 				GLdouble nz =  r_rad * tx;
 
-				dest[k++] = T(ny*tz-nz*ty);
-				dest[k++] = T(nz*tx-nx*tz);
-				dest[k++] = T(nx*ty-ny*tx);
+				*dest++ = T(ny*tz-nz*ty);
+				*dest++ = T(nz*tx-nx*tz);
+				*dest++ = T(nx*ty-ny*tx);
 			}
 		}
 		//
-		assert(k == dest.size());
 		// 3 values per vertex
 		return 3;
 	}
 
+	/// Makes vertex bi-tangents and returns number of values per vertex
+	template <typename T>
+	GLuint Bitangents(std::vector<T>& dest) const
+	{
+		dest.resize(VertexCount() * 3);
+		return Bitangents(dest.begin());
+	}
+
+	/// Writes vertex coordinates through the output iterator @p dest
+	/** Writes 3*VertexCount() values (for example directly into
+	 *  a mapped buffer) and returns number of values per vertex.
+	 */
+	template <typename Iter>
+	GLuint Positions(Iter dest) const
+	{
+		return _make_vectors(dest, _radius);
+	}
+
 	/// Makes vertex coordinates and returns number of values per vertex
 	template <typename T>
 	GLuint Positions(std::vector<T>& dest) const
 	{
-		GLuint n = Normals(dest);
-		if(_radius != 1.0)
-			for(auto i=dest.begin(),e=dest.end(); i!= e; ++i)
-				*i *= _radius;
-		return n;
+		dest.resize(VertexCount() * 3);
+		return Positions(dest.begin());
 	}
 
-	/// Makes texture-coorinates and returns number of values per vertex
-	template <typename T>
-	GLuint TexCoordinates(std::vector<T>& dest) const
+	/// Writes texture-coorinates through the output iterator @p dest
+	/** Writes 2*VertexCount() values (for example directly into
+	 *  a mapped buffer) and returns number of values per vertex.
+	 */
+	template <typename Iter>
+	GLuint TexCoordinates(Iter dest) const
 	{
-		dest.resize(((_rings + 2) * (_sections + 1)) * 2);
-		unsigned k = 0;
-		//
+		typedef typename aux::OutputIterValue<Iter>::type T;
 		GLdouble r_step = 1.0 / GLdouble(_rings + 1);
 		GLdouble s_step = 1.0 / GLdouble(_sections);
 		for(unsigned r=0; r!=(_rings+2);++r)
@@ -164,15 +208,22 @@ public:
 			// the sections
 			for(unsigned s=0; s!=(_sections+1);++s)
 			{
-				dest[k++] = T(s * s_step);
-				dest[k++] = T(r_lat);
+				*dest++ = T(s * s_step);
+				*dest++ = T(r_lat);
 			}
 		}
-		assert(k == dest.size());
 		// 2 values per vertex
 		return 2;
 	}
 
+	/// Makes texture-coorinates and returns number of values per vertex
+	template <typename T>
+	GLuint TexCoordinates(std::vector<T>& dest) const
+	{
+		dest.resize(VertexCount() * 2);
+		return TexCoordinates(dest.begin());
+	}
+
 #if OGLPLUS_DOCUMENTATION_ONLY
 	/// Vertex attribute information for this shape builder
 	/** Sphere provides build functions for the following named
@@ -212,6 +263,34 @@ public:
 	/// The type of index container returned by Indices()
 	typedef std::vector<GLushort> IndexArray;
 
+	/// Returns the number of element indices returned by Indices()
+	GLuint IndexCount(void) const
+	{
+		return (_rings + 1) * (2 * (_sections + 1) + 1);
+	}
+
+	/// Writes element indices used with the drawing instructions to @p dest
+	/** Writes IndexCount() values through the output iterator @p dest.
+	 */
+	template <typename Iter>
+	void Indices(Iter dest) const
+	{
+		typedef typename aux::OutputIterValue<Iter>::type T;
+		const unsigned n = IndexCount();
+		unsigned offs = 0;
+		// the triangle strips
+		for(unsigned r=0; r!=(_rings+1); ++r)
+		{
+			for(unsigned s=0; s!=(_sections+1); ++s)
+			{
+				*dest++ = T(offs + s);
+				*dest++ = T(offs + s + (_sections+1));
+			}
+			*dest++ = T(n);
+			offs += _sections + 1;
+		}
+	}
+
 	/// Returns element indices that are used with the drawing instructions
 	IndexArray Indices(void) const;
 
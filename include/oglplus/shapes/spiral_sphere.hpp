@@ -19,6 +19,7 @@
 #include <oglplus/shapes/vert_attr_info.hpp>
 
 #include <oglplus/math.hpp>
+#include <oglplus/auxiliary/output_iter.hpp>
 
 namespace oglplus {
 namespace shapes {
@@ -31,47 +32,42 @@ private:
 	const GLdouble _radius, _thickness;
 	const unsigned _bands, _divisions, _segments;
 
-	unsigned _vertex_count(void) const;
-
-	template <typename T>
+	template <typename Iter>
 	void _make_vectors(
-		std::vector<T>& dest,
-		unsigned& k,
+		Iter& dest,
 		GLdouble sign,
 		GLdouble radius
 	) const;
 
-	template <typename T>
+	template <typename Iter>
 	void _make_tangents(
-		std::vector<T>& dest,
-		unsigned& k,
+		Iter& dest,
 		GLdouble sign
 	) const;
 
-	template <typename T>
+	template <typename Iter>
 	void _make_bitangents(
-		std::vector<T>& dest,
-		unsigned& k,
+		Iter& dest,
 		GLdouble sign
 	) const;
 
-	template <typename T>
-	void _make_uv_coords(std::vector<T>& dest, unsigned& k) const;
+	template <typename Iter>
+	void _make_uv_coords(Iter& dest) const;
 
-	template <typename T>
-	void _make_side_verts(std::vector<T>& dest, unsigned& k) const;
+	template <typename Iter>
+	void _make_side_verts(Iter& dest) const;
 
-	template <typename T>
-	void _make_side_norms(std::vector<T>& dest, unsigned& k) const;
+	template <typename Iter>
+	void _make_side_norms(Iter& dest) const;
 
-	template <typename T>
-	void _make_side_tgts(std::vector<T>& dest, unsigned& k) const;
+	template <typename Iter>
+	void _make_side_tgts(Iter& dest) const;
 
-	template <typename T>
-	void _make_side_btgs(std::vector<T>& dest, unsigned& k) const;
+	template <typename Iter>
+	void _make_side_btgs(Iter& dest) const;
 
-	template <typename T>
-	void _make_side_uvs(std::vector<T>& dest, unsigned& k) const;
+	template <typename Iter>
+	void _make_side_uvs(Iter& dest) const;
 public:
 	/// Creates a default spiral sphere
 	SpiralSphere(void)
@@ -102,6 +98,16 @@ public:
 		return FaceOrientation::CCW;
 	}
 
+	/// Returns the number of vertices made by the vertex attribute functions
+	GLuint VertexCount(void) const
+	{
+		return	(_bands * 2)*
+			(_divisions + 1)*
+			(_segments + 1)+
+			(_bands * 2)*
+			(_segments + 1);
+	}
+
 	std::vector<GLfloat> _positions(void) const;
 
 	GLuint Positions(std::vector<GLfloat>& dest) const
@@ -110,13 +116,25 @@ public:
 		return 3;
 	}
 
+	/// Writes vertex coordinates through the output iterator @p dest
+	/** Writes 3*VertexCount() values (for example directly into
+	 *  a mapped buffer) and returns number of values per vertex.
+	 */
+	template <typename Iter>
+	GLuint Positions(Iter dest) const
+	{
+		_make_vectors(dest,  1.0, _radius);
+		_make_vectors(dest,  1.0, _radius + _thickness);
+		_make_side_verts(dest);
+		return 3;
+	}
+
 	/// Makes vertex coordinates and returns number of values per vertex
 	template <typename T>
 	GLuint Positions(std::vector<T>& dest) const
 	{
-		auto v = _positions();
-		dest.assign(v.begin(), v.end());
-		return 3;
+		dest.resize(VertexCount() * 3);
+		return Positions(dest.begin());
 	}
 
 	std::vector<GLfloat> _normals(void) const;
@@ -127,13 +145,25 @@ public:
 		return 3;
 	}
 
+	/// Writes vertex normals through the output iterator @p dest
+	/** Writes 3*VertexCount() values (for example directly into
+	 *  a mapped buffer) and returns number of values per vertex.
+	 */
+	template <typename Iter>
+	GLuint Normals(Iter dest) const
+	{
+		_make_vectors(dest, -1.0, 1.0);
+		_make_vectors(dest,  1.0, 1.0);
+		_make_side_norms(dest);
+		return 3;
+	}
+
 	/// Makes vertex normals and returns number of values per vertex
 	template <typename T>
 	GLuint Normals(std::vector<T>& dest) const
 	{
-		auto v = _normals();
-		dest.assign(v.begin(), v.end());
-		return 3;
+		dest.resize(VertexCount() * 3);
+		return Normals(dest.begin());
 	}
 
 	std::vector<GLfloat> _tangents(void) const;
@@ -144,13 +174,25 @@ public:
 		return 3;
 	}
 
+	/// Writes vertex tangents through the output iterator @p dest
+	/** Writes 3*VertexCount() values (for example directly into
+	 *  a mapped buffer) and returns number of values per vertex.
+	 */
+	template <typename Iter>
+	GLuint Tangents(Iter dest) const
+	{
+		_make_tangents(dest, -1.0);
+		_make_tangents(dest,  1.0);
+		_make_side_tgts(dest);
+		return 3;
+	}
+
 	/// Makes vertex tangents and returns number of values per vertex
 	template <typename T>
 	GLuint Tangents(std::vector<T>& dest) const
 	{
-		auto v = _tangents();
-		dest.assign(v.begin(), v.end());
-		return 3;
+		dest.resize(VertexCount() * 3);
+		return Tangents(dest.begin());
 	}
 
 	std::vector<GLfloat> _bitangents(void) const;
@@ -161,13 +203,25 @@ public:
 		return 3;
 	}
 
+	/// Writes vertex bi-tangents through the output iterator @p dest
+	/** Writes 3*VertexCount() values (for example directly into
+	 *  a mapped buffer) and returns number of values per vertex.
+	 */
+	template <typename Iter>
+	GLuint Bitangents(Iter dest) const
+	{
+		_make_bitangents(dest, -1.0);
+		_make_bitangents(dest,  1.0);
+		_make_side_btgs(dest);
+		return 3;
+	}
+
 	/// Makes vertex bi-tangents and returns number of values per vertex
 	template <typename T>
 	GLuint Bitangents(std::vector<T>& dest) const
 	{
-		auto v = _bitangents();
-		dest.assign(v.begin(), v.end());
-		return 3;
+		dest.resize(VertexCount() * 3);
+		return Bitangents(dest.begin());
 	}
 
 	std::vector<GLfloat> _tex_coords(void) const;
@@ -178,13 +232,25 @@ public:
 		return 2;
 	}
 
+	/// Writes texture-coorinates through the output iterator @p dest
+	/** Writes 2*VertexCount() values (for example directly into
+	 *  a mapped buffer) and returns number of values per vertex.
+	 */
+	template <typename Iter>
+	GLuint TexCoordinates(Iter dest) const
+	{
+		_make_uv_coords(dest);
+		_make_uv_coords(dest);
+		_make_side_uvs(dest);
+		return 2;
+	}
+
 	/// Makes texture-coorinates and returns number of values per vertex
 	template <typename T>
 	GLuint TexCoordinates(std::vector<T>& dest) const
 	{
-		auto v = _tex_coords();
-		dest.assign(v.begin(), v.end());
-		return 2;
+		dest.resize(VertexCount() * 2);
+		return TexCoordinates(dest.begin());
 	}
 
 #if OGLPLUS_DOCUMENTATION_ONLY
@@ -226,6 +292,104 @@ public:
 	/// The type of index container returned by Indices()
 	typedef std::vector<GLushort> IndexArray;
 
+	/// Returns the number of element indices returned by Indices()
+	GLuint IndexCount(void) const
+	{
+		return	(_bands * 2)*
+			(_divisions * 2)*
+			(_segments + 1)+
+			(_bands * 8)*
+			(_segments + 1);
+	}
+
+	/// Writes element indices used with the drawing instructions to @p dest
+	/** Writes IndexCount() values through the output iterator @p dest.
+	 */
+	template <typename Iter>
+	void Indices(Iter dest) const
+	{
+		typedef typename aux::OutputIterValue<Iter>::type T;
+		unsigned eoffs, offs = 0;
+		const unsigned edge = _segments + 1;
+		const unsigned band = edge * (_divisions + 1);
+		const unsigned surface = _bands * band;
+
+		for(unsigned n=0; n!=2; ++n)
+		{
+			unsigned edge1 = n ? edge : 0;
+			unsigned edge2 = n ? 0 : edge;
+			for(unsigned b=0; b!=_bands; ++b)
+			{
+				for(unsigned d=0; d!=_divisions; ++d)
+				{
+					for(unsigned s=0; s!=edge; ++s)
+					{
+						*dest++ = T(offs + s + edge1);
+						*dest++ = T(offs + s + edge2);
+					}
+					offs += edge;
+				}
+				offs += edge;
+			}
+		}
+
+		offs = 0;
+		eoffs = 2*surface;
+
+		for(unsigned b=0; b!=_bands; ++b)
+		{
+			for(unsigned s=0; s!=edge; ++s)
+			{
+				*dest++ = T(eoffs + s);
+				*dest++ = T(offs + s);
+			}
+			offs += band;
+			eoffs += edge * 2;
+		}
+
+		offs = _divisions * edge;
+		eoffs = 2*surface + edge;
+
+		for(unsigned b=0; b!=_bands; ++b)
+		{
+			for(unsigned s=0; s!=edge; ++s)
+			{
+				*dest++ = T(offs + s);
+				*dest++ = T(eoffs + s);
+			}
+			offs += band;
+			eoffs += edge * 2;
+		}
+
+		offs = surface;
+		eoffs = 2*surface;
+
+		for(unsigned b=0; b!=_bands; ++b)
+		{
+			for(unsigned s=0; s!=edge; ++s)
+			{
+				*dest++ = T(offs + s);
+				*dest++ = T(eoffs + s);
+			}
+			offs += band;
+			eoffs += edge * 2;
+		}
+
+		offs = surface + _divisions * edge;
+		eoffs = 2*surface + edge;
+
+		for(unsigned b=0; b!=_bands; ++b)
+		{
+			for(unsigned s=0; s!=edge; ++s)
+			{
+				*dest++ = T(eoffs + s);
+				*dest++ = T(offs + s);
+			}
+			offs += band;
+			eoffs += edge * 2;
+		}
+	}
+
 	/// Returns element indices that are used with the drawing instructions
 	IndexArray Indices(void) const;
 
@@ -233,6 +397,314 @@ public:
 	DrawingInstructions Instructions(void) const;
 };
 
+template <typename Iter>
+void SpiralSphere::_make_vectors(
+	Iter& dest,
+	GLdouble sign,
+	GLdouble radius
+) const
+{
+	typedef typename aux::OutputIterValue<Iter>::type T;
+	GLdouble b_leap = (math::Pi()) / GLdouble(_bands);
+	GLdouble b_step = b_leap / GLdouble(_divisions);
+	GLdouble s_step = (math::Pi()) / GLdouble(_segments);
+
+	GLdouble m = sign * radius;
+
+	for(unsigned b=0; b!=_bands; ++b)
+	{
+		for(unsigned d=0; d!=(_divisions+1); ++d)
+		{
+			GLdouble b_offs = 0.0;
+			for(unsigned s=0; s!=(_segments+1); ++s)
+			{
+				GLdouble b_angle =
+					2*b*b_leap + d*b_step + b_offs;
+				GLdouble cb = std::cos(b_angle);
+				GLdouble sb = std::sin(b_angle);
+
+				GLdouble s_angle = s*s_step;
+				GLdouble cs = std::cos(s_angle);
+				GLdouble ss = std::sin(s_angle);
+
+				*dest++ = T(m* ss * cb);
+				*dest++ = T(m* cs);
+				*dest++ = T(m* ss *-sb);
+				b_offs += ss * s_step;
+			}
+		}
+	}
+}
+
+template <typename Iter>
+void SpiralSphere::_make_tangents(
+	Iter& dest,
+	GLdouble sign
+) const
+{
+	typedef typename aux::OutputIterValue<Iter>::type T;
+	GLdouble b_leap = (math::Pi()) / GLdouble(_bands);
+	GLdouble b_step = b_leap / GLdouble(_divisions);
+	GLdouble s_step = (math::Pi()) / GLdouble(_segments);
+
+	GLdouble m = sign;
+
+	for(unsigned b=0; b!=_bands; ++b)
+	{
+		for(unsigned d=0; d!=(_divisions+1); ++d)
+		{
+			GLdouble b_offs = 0.0;
+			for(unsigned s=0; s!=(_segments+1); ++s)
+			{
+				GLdouble b_angle =
+					2*b*b_leap + d*b_step + b_offs;
+				GLdouble cb = std::cos(b_angle);
+				GLdouble sb = std::sin(b_angle);
+
+				GLdouble s_angle = s*s_step;
+				GLdouble ss = std::sin(s_angle);
+
+				*dest++ = T(m*-sb);
+				*dest++ = T(0);
+				*dest++ = T(m*-cb);
+				b_offs += ss * s_step;
+			}
+		}
+	}
+}
+
+template <typename Iter>
+void SpiralSphere::_make_bitangents(
+	Iter& dest,
+	GLdouble sign
+) const
+{
+	typedef typename aux::OutputIterValue<Iter>::type T;
+	GLdouble b_leap = (math::Pi()) / GLdouble(_bands);
+	GLdouble b_step = b_leap / GLdouble(_divisions);
+	GLdouble s_step = (math::Pi()) / GLdouble(_segments);
+
+	GLdouble m = sign;
+
+	for(unsigned b=0; b!=_bands; ++b)
+	{
+		for(unsigned d=0; d!=(_divisions+1); ++d)
+		{
+			GLdouble b_offs = 0.0;
+			for(unsigned s=0; s!=(_segments+1); ++s)
+			{
+				GLdouble b_angle =
+					2*b*b_leap + d*b_step + b_offs;
+				GLdouble cb = std::cos(b_angle);
+				GLdouble sb = std::sin(b_angle);
+
+				GLdouble s_angle = s*s_step;
+				GLdouble cs = std::cos(s_angle);
+				GLdouble ss = std::sin(s_angle);
+
+				GLdouble tx = m*-sb;
+				GLdouble ty = 0.0;
+				GLdouble tz = m*-cb;
+
+				GLdouble nx = m*ss* cb;
+				GLdouble ny = m*cs;
+				GLdouble nz = m*ss*-sb;
+
+				*dest++ = T(ny*tz-nz*ty);
+				*dest++ = T(nz*tx-nx*tz);
+				*dest++ = T(nx*ty-ny*tx);
+
+				b_offs += ss * s_step;
+			}
+		}
+	}
+}
+
+template <typename Iter>
+void SpiralSphere::_make_uv_coords(Iter& dest) const
+{
+	typedef typename aux::OutputIterValue<Iter>::type T;
+	GLdouble b_leap = 0.5 / GLdouble(_bands);
+	GLdouble b_step = b_leap / GLdouble(_divisions);
+	GLdouble s_step = 1.0 / GLdouble(_segments);
+
+	GLdouble u = 0.0;
+	for(unsigned b=0; b!=_bands; ++b)
+	{
+		for(unsigned d=0; d!=(_divisions+1); ++d)
+		{
+			GLdouble v = 1.0;
+			for(unsigned s=0; s!=(_segments+1); ++s)
+			{
+				*dest++ = T(u);
+				*dest++ = T(v);
+				v -= s_step;
+			}
+			u += b_step;
+		}
+		u += b_leap;
+	}
+}
+
+template <typename Iter>
+void SpiralSphere::_make_side_verts(Iter& dest) const
+{
+	typedef typename aux::OutputIterValue<Iter>::type T;
+	GLdouble b_leap = (math::Pi()) / GLdouble(_bands);
+	GLdouble b_slip = b_leap * _thickness * 0.5;
+	GLdouble s_step = (math::Pi()) / GLdouble(_segments);
+
+	GLdouble m = _radius + _thickness * 0.5;
+	GLdouble g = -1.0;
+
+	for(unsigned b=0; b!=_bands*2; ++b)
+	{
+		GLdouble b_offs = 0.0;
+		for(unsigned s=0; s!=(_segments+1); ++s)
+		{
+			GLdouble b_angle =
+				b*b_leap + b_offs + g*b_slip;
+			GLdouble cb = std::cos(b_angle);
+			GLdouble sb = std::sin(b_angle);
+
+			GLdouble s_angle = s*s_step;
+			GLdouble cs = std::cos(s_angle);
+			GLdouble ss = std::sin(s_angle);
+
+			*dest++ = T(m* ss * cb);
+			*dest++ = T(m* cs);
+			*dest++ = T(m* ss * -sb);
+			b_offs += ss * s_step;
+		}
+		g *= -1.0;
+	}
+}
+
+template <typename Iter>
+void SpiralSphere::_make_side_norms(Iter& dest) const
+{
+	typedef typename aux::OutputIterValue<Iter>::type T;
+	GLdouble b_leap = (math::Pi()) / GLdouble(_bands);
+	GLdouble s_step = (math::Pi()) / GLdouble(_segments);
+
+	GLfloat m = 1.0;
+	for(unsigned b=0; b!=_bands*2; ++b)
+	{
+		GLdouble b_offs = 0.0;
+		for(unsigned s=0; s!=(_segments+1); ++s)
+		{
+			GLdouble b_angle =
+				b*b_leap + b_offs;
+			GLdouble cb = std::cos(b_angle);
+			GLdouble sb = std::sin(b_angle);
+
+			GLdouble s_angle = s*s_step;
+			GLdouble ss = std::sin(s_angle);
+
+			*dest++ = T(m*-sb);
+			*dest++ = T(0);
+			*dest++ = T(m* cb);
+			b_offs += ss * s_step;
+		}
+		m *= -1.0;
+	}
+}
+
+template <typename Iter>
+void SpiralSphere::_make_side_tgts(Iter& dest) const
+{
+	typedef typename aux::OutputIterValue<Iter>::type T;
+	GLdouble b_leap = (math::Pi()) / GLdouble(_bands);
+	GLdouble s_step = (math::Pi()) / GLdouble(_segments);
+
+	GLfloat m = -1.0;
+	for(unsigned b=0; b!=_bands*2; ++b)
+	{
+		GLdouble b_offs = 0.0;
+		for(unsigned s=0; s!=(_segments+1); ++s)
+		{
+			GLdouble b_angle =
+				b*b_leap + b_offs;
+			GLdouble cb = std::cos(b_angle);
+			GLdouble sb = std::sin(b_angle);
+
+			GLdouble s_angle = s*s_step;
+			GLdouble cs = std::cos(s_angle);
+			GLdouble ss = std::sin(s_angle);
+
+			*dest++ = T(m*ss*-cb);
+			*dest++ = T(m*cs);
+			*dest++ = T(m*ss*-sb);
+			b_offs += ss * s_step;
+		}
+		m *= -1.0;
+	}
+}
+
+template <typename Iter>
+void SpiralSphere::_make_side_btgs(Iter& dest) const
+{
+	typedef typename aux::OutputIterValue<Iter>::type T;
+	GLdouble b_leap = (math::Pi()) / GLdouble(_bands);
+	GLdouble s_step = (math::Pi()) / GLdouble(_segments);
+
+	GLfloat m = 1.0;
+	for(unsigned b=0; b!=_bands*2; ++b)
+	{
+		GLdouble b_offs = 0.0;
+		for(unsigned s=0; s!=(_segments+1); ++s)
+		{
+			GLdouble b_angle =
+				b*b_leap + b_offs;
+			GLdouble cb = std::cos(b_angle);
+			GLdouble sb = std::sin(b_angle);
+
+			GLdouble s_angle = s*s_step;
+			GLdouble cs = std::cos(s_angle);
+			GLdouble ss = std::sin(s_angle);
+
+			GLdouble tx = m*ss*-cb;
+			GLdouble ty = m*cs;
+			GLdouble tz = m*ss*-sb;
+
+			GLdouble nx = m* sb;
+			GLdouble ny = 0.0;
+			GLdouble nz = m*-cb;
+
+			*dest++ = T(ny*tz-nz*ty);
+			*dest++ = T(nz*tx-nx*tz);
+			*dest++ = T(nx*ty-ny*tx);
+
+			b_offs += ss * s_step;
+		}
+		m *= -1.0;
+	}
+}
+
+template <typename Iter>
+void SpiralSphere::_make_side_uvs(Iter& dest) const
+{
+	typedef typename aux::OutputIterValue<Iter>::type T;
+	GLdouble b_leap = 0.5 / GLdouble(_bands);
+	GLdouble b_slip = b_leap * _thickness * 0.5;
+	GLdouble s_step = 1.0 / GLdouble(_segments);
+
+	GLdouble g = -1.0;
+
+	for(unsigned b=0; b!=_bands*2; ++b)
+	{
+		GLdouble b_offs = 0.0;
+		GLdouble v = 1.0;
+		for(unsigned s=0; s!=(_segments+1); ++s)
+		{
+			*dest++ = T(b*b_leap + b_offs + g*b_slip);
+			*dest++ = T(v);
+			v -= s_step;
+		}
+		g *= -1.0;
+	}
+}
+
 } // shapes
 } // oglplus
 
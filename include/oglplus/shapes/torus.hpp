@@ -19,6 +19,7 @@
 #include <oglplus/shapes/vert_attr_info.hpp>
 
 #include <oglplus/math.hpp>
+#include <oglplus/auxiliary/output_iter.hpp>
 
 namespace oglplus {
 namespace shapes {
@@ -53,13 +54,20 @@ public:
 		return FaceOrientation::CCW;
 	}
 
-	/// Makes vertex coordinates and returns number of values per vertex
-	template <typename T>
-	GLuint Positions(std::vector<T>& dest) const
+	/// Returns the number of vertices made by the vertex attribute functions
+	GLuint VertexCount(void) const
+	{
+		return (_rings + 1) * (_sections + 1);
+	}
+
+	/// Writes vertex coordinates through the output iterator @p dest
+	/** Writes 3*VertexCount() values (for example directly into
+	 *  a mapped buffer) and returns number of values per vertex.
+	 */
+	template <typename Iter>
+	GLuint Positions(Iter dest) const
 	{
-		dest.resize((_rings + 1) * (_sections + 1) * 3);
-		unsigned k = 0;
-		//
+		typedef typename aux::OutputIterValue<Iter>::type T;
 		GLdouble r_step = (math::TwoPi()) / GLdouble(_rings);
 		GLdouble s_step = (math::TwoPi()) / GLdouble(_sections);
 		GLdouble r1 = _radius_in;
@@ -73,22 +81,30 @@ public:
 			{
 				GLdouble vr = std::cos(s*s_step);
 				GLdouble vy = std::sin(s*s_step);
-				dest[k++] = T(vx*(r1 + r2 * (1.0 + vr)));
-				dest[k++] = T(vy*r2);
-				dest[k++] = T(vz*(r1 + r2 * (1.0 + vr)));
+				*dest++ = T(vx*(r1 + r2 * (1.0 + vr)));
+				*dest++ = T(vy*r2);
+				*dest++ = T(vz*(r1 + r2 * (1.0 + vr)));
 			}
 		}
-		assert(k == dest.size());
 		return 3;
 	}
 
-	/// Makes vertex normals and returns number of values per vertex
+	/// Makes vertex coordinates and returns number of values per vertex
 	template <typename T>
-	GLuint Normals(std::vector<T>& dest) const
+	GLuint Positions(std::vector<T>& dest) const
+	{
+		dest.resize(VertexCount() * 3);
+		return Positions(dest.begin());
+	}
+
+	/// Writes vertex normals through the output iterator @p dest
+	/** Writes 3*VertexCount() values (for example directly into
+	 *  a mapped buffer) and returns number of values per vertex.
+	 */
+	template <typename Iter>
+	GLuint Normals(Iter dest) const
 	{
-		dest.resize((_rings + 1) * (_sections + 1) * 3);
-		unsigned k = 0;
-		//
+		typedef typename aux::OutputIterValue<Iter>::type T;
 		GLdouble r_step = (math::TwoPi()) / GLdouble(_rings);
 		GLdouble s_step = (math::TwoPi()) / GLdouble(_sections);
 
@@ -100,22 +116,30 @@ public:
 			{
 				GLdouble nr = std::cos(s*s_step);
 				GLdouble ny = std::sin(s*s_step);
-				dest[k++] = T(nx*nr);
-				dest[k++] = T(ny);
-				dest[k++] = T(nz*nr);
+				*dest++ = T(nx*nr);
+				*dest++ = T(ny);
+				*dest++ = T(nz*nr);
 			}
 		}
-		assert(k == dest.size());
 		return 3;
 	}
 
-	/// Makes vertex tangents and returns number of values per vertex
+	/// Makes vertex normals and returns number of values per vertex
 	template <typename T>
-	GLuint Tangents(std::vector<T>& dest) const
+	GLuint Normals(std::vector<T>& dest) const
+	{
+		dest.resize(VertexCount() * 3);
+		return Normals(dest.begin());
+	}
+
+	/// Writes vertex tangents through the output iterator @p dest
+	/** Writes 3*VertexCount() values (for example directly into
+	 *  a mapped buffer) and returns number of values per vertex.
+	 */
+	template <typename Iter>
+	GLuint Tangents(Iter dest) const
 	{
-		dest.resize((_rings + 1) * (_sections + 1) * 3);
-		unsigned k = 0;
-		//
+		typedef typename aux::OutputIterValue<Iter>::type T;
 		GLdouble r_step = (math::TwoPi()) / GLdouble(_rings);
 
 		for(unsigned r=0; r!=(_rings+1); ++r)
@@ -124,22 +148,30 @@ public:
 			GLdouble tz = -std::cos(r*r_step);
 			for(unsigned s=0; s!=(_sections+1); ++s)
 			{
-				dest[k++] = T(tx);
-				dest[k++] = T(0);
-				dest[k++] = T(tz);
+				*dest++ = T(tx);
+				*dest++ = T(0);
+				*dest++ = T(tz);
 			}
 		}
-		assert(k == dest.size());
 		return 3;
 	}
 
-	/// Makes vertex bi-tangents and returns number of values per vertex
+	/// Makes vertex tangents and returns number of values per vertex
 	template <typename T>
-	GLuint Bitangents(std::vector<T>& dest) const
+	GLuint Tangents(std::vector<T>& dest) const
 	{
-		dest.resize((_rings + 1) * (_sections + 1) * 3);
-		unsigned k = 0;
-		//
+		dest.resize(VertexCount() * 3);
+		return Tangents(dest.begin());
+	}
+
+	/// Writes vertex bi-tangents through the output iterator @p dest
+	/** Writes 3*VertexCount() values (for example directly into
+	 *  a mapped buffer) and returns number of values per vertex.
+	 */
+	template <typename Iter>
+	GLuint Bitangents(Iter dest) const
+	{
+		typedef typename aux::OutputIterValue<Iter>::type T;
 		GLdouble r_step = (math::TwoPi()) / GLdouble(_rings);
 		GLdouble s_step = (math::TwoPi()) / GLdouble(_sections);
 
@@ -156,22 +188,30 @@ public:
 				GLdouble nx = -tz*nr;
 				GLdouble nz =  tx*nr;
 
-				dest[k++] = T(ny*tz-nz*ty);
-				dest[k++] = T(nz*tx-nx*tz);
-				dest[k++] = T(nx*ty-ny*tx);
+				*dest++ = T(ny*tz-nz*ty);
+				*dest++ = T(nz*tx-nx*tz);
+				*dest++ = T(nx*ty-ny*tx);
 			}
 		}
-		assert(k == dest.size());
 		return 3;
 	}
 
-	/// Makes texture coordinates and returns number of values per vertex
+	/// Makes vertex bi-tangents and returns number of values per vertex
 	template <typename T>
-	GLuint TexCoordinates(std::vector<T>& dest) const
+	GLuint Bitangents(std::vector<T>& dest) const
+	{
+		dest.resize(VertexCount() * 3);
+		return Bitangents(dest.begin());
+	}
+
+	/// Writes texture coordinates through the output iterator @p dest
+	/** Writes 2*VertexCount() values (for example directly into
+	 *  a mapped buffer) and returns number of values per vertex.
+	 */
+	template <typename Iter>
+	GLuint TexCoordinates(Iter dest) const
 	{
-		dest.resize((_rings + 1) * (_sections + 1) * 2);
-		unsigned k = 0;
-		//
+		typedef typename aux::OutputIterValue<Iter>::type T;
 		GLdouble r_step = 1.0 / GLdouble(_rings);
 		GLdouble s_step = 1.0 / GLdouble(_sections);
 
@@ -181,14 +221,21 @@ public:
 			for(unsigned s=0; s!=(_sections+1); ++s)
 			{
 				GLdouble v = s*s_step;
-				dest[k++] = T(u);
-				dest[k++] = T(v);
+				*dest++ = T(u);
+				*dest++ = T(v);
 			}
 		}
-		assert(k == dest.size());
 		return 2;
 	}
 
+	/// Makes texture coordinates and returns number of values per vertex
+	template <typename T>
+	GLuint TexCoordinates(std::vector<T>& dest) const
+	{
+		dest.resize(VertexCount() * 2);
+		return TexCoordinates(dest.begin());
+	}
+
 #if OGLPLUS_DOCUMENTATION_ONLY
 	/// Vertex attribute information for this shape builder
 	/** Torus provides build functions for the following named
@@ -228,6 +275,34 @@ public:
 	/// The type of index container returned by Indices()
 	typedef std::vector<GLushort> IndexArray;
 
+	/// Returns the number of element indices returned by Indices()
+	GLuint IndexCount(void) const
+	{
+		return _rings * (2 * (_sections + 1) + 1);
+	}
+
+	/// Writes element indices used with the drawing instructions to @p dest
+	/** Writes IndexCount() values through the output iterator @p dest.
+	 */
+	template <typename Iter>
+	void Indices(Iter dest) const
+	{
+		typedef typename aux::OutputIterValue<Iter>::type T;
+		const unsigned n = IndexCount();
+		unsigned offs = 0;
+		// the triangle strips
+		for(unsigned r=0; r!=(_rings); ++r)
+		{
+			for(unsigned s=0; s!=(_sections+1); ++s)
+			{
+				*dest++ = T(offs + s);
+				*dest++ = T(offs + s + (_sections+1));
+			}
+			*dest++ = T(n);
+			offs += _sections + 1;
+		}
+	}
+
 	/// Returns element indices that are used with the drawing instructions
 	IndexArray Indices(void) const;
 
@@ -0,0 +1,297 @@
+/**
+ *  @file oglplus/shapes/triangle_bvh.hpp
+ *  @brief Bounding volume hierarchy for ray casting against shape triangles
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_SHAPES_TRIANGLE_BVH_1311141105_HPP
+#define OGLPLUS_SHAPES_TRIANGLE_BVH_1311141105_HPP
+
+#include <oglplus/vector.hpp>
+#include <oglplus/matrix.hpp>
+#include <oglplus/shapes/draw.hpp>
+
+#include <vector>
+#include <limits>
+#include <cassert>
+
+namespace oglplus {
+namespace shapes {
+
+/// A ray (or a segment) cast against a TriangleBVH
+/** The points on the ray are @c origin+t*direction for the values of
+ *  the parameter @c t in the range [min_distance, max_distance].
+ *  If the direction has unit length then @c t is the distance from
+ *  the origin.
+ */
+struct TriangleBVHRay
+{
+	/// The origin of the ray
+	GLfloat origin[3];
+	/// The direction of the ray
+	GLfloat direction[3];
+	/// The minimal value of the ray parameter
+	GLfloat min_distance;
+	/// The maximal value of the ray parameter
+	GLfloat max_distance;
+};
+
+/// The result of a ray query on a TriangleBVH
+/** The hit point is @c (1-u-v)*a+u*b+v*c where @c a, @c b and @c c are
+ *  the vertices of the hit face.
+ */
+struct TriangleBVHHit
+{
+	/// The index of the hit triangle or NoFace() if nothing was hit
+	GLuint face;
+	/// The barycentric coordinates of the hit point
+	GLfloat u, v;
+	/// The value of the ray parameter at the hit point
+	GLfloat distance;
+
+	/// Special constant indicating that no face was hit
+	static GLuint NoFace(void)
+	{
+		return ~GLuint(0);
+	}
+
+	/// Returns true if a face was hit
+	bool Hit(void) const
+	{
+		return face != NoFace();
+	}
+};
+
+/// A node of a TriangleBVH
+/** The nodes are stored in depth-first order, so the first child
+ *  of an inner node immediately follows its parent.
+ */
+struct TriangleBVHNode
+{
+	/// The lower corner of the bounding box
+	GLfloat min[3];
+	/// The index of the second child or of the first triangle of a leaf
+	GLuint offset;
+	/// The upper corner of the bounding box
+	GLfloat max[3];
+	/// The number of triangles of a leaf or zero for inner nodes
+	GLuint count;
+};
+
+/// A triangle of a TriangleBVH stored in the order of the leaves
+struct TriangleBVHTriangle
+{
+	/// The first vertex of the triangle
+	GLfloat v0[3];
+	/// The first edge (b - a) of the triangle
+	GLfloat e1[3];
+	/// The second edge (c - a) of the triangle
+	GLfloat e2[3];
+	/// The index of the original triangle
+	GLuint face;
+};
+
+/// Bounding volume hierarchy for fast ray casting against shape triangles
+/** TriangleBVH takes the vertex positions, indices and drawing
+ *  instructions of the triangles of any shape builder and builds a
+ *  hierarchy of axis-aligned bounding boxes, which allows to find
+ *  the intersections of rays with the triangles on the CPU, for example
+ *  for picking of objects or for line-of-sight queries, without reading
+ *  back data from the GPU.
+ *
+ *  The hierarchy is built top-down, the triangles are split by the
+ *  surface area heuristic evaluated on a fixed number of bins along
+ *  each axis. The nodes are 32 bytes large and they are stored in
+ *  a single array in depth-first order together with the triangles
+ *  (with precomputed edges) stored in the order in which they are
+ *  referenced by the leaves.
+ *
+ *  The faces are identified by their index in the list of triangles
+ *  (three indices per triangle) made from the shape by MakeTriangleList.
+ *
+ *  Example of usage:
+ *  @code
+ *  shapes::ObjMesh mesh(input);
+ *  shapes::TriangleBVH bvh(mesh);
+ *  shapes::TriangleBVHHit hit;
+ *  if(bvh.Intersect(bvh.PickRay(projection*camera, x, y), hit))
+ *  {
+ *      std::cout << "Picked face " << hit.face << std::endl;
+ *  }
+ *  if(!bvh.Occluded(bvh.Segment(eye, target)))
+ *  {
+ *      std::cout << "The target is visible" << std::endl;
+ *  }
+ *  @endcode
+ */
+class TriangleBVH
+{
+public:
+	/// The number of rays traversed together by the packet queries
+	static const unsigned PacketSize = 4;
+private:
+	std::vector<TriangleBVHNode> _nodes;
+	std::vector<TriangleBVHTriangle> _triangles;
+
+	void _build(
+		const std::vector<GLfloat>& positions,
+		GLuint values_per_vertex,
+		const std::vector<GLuint>& triangles,
+		GLuint max_leaf_size
+	);
+
+	// finds the closest or any intersection of a single ray
+	bool _intersect(
+		const TriangleBVHRay& ray,
+		TriangleBVHHit& hit,
+		bool any_hit
+	) const;
+
+	// intersects up to PacketSize rays
+	void _intersect_packet(
+		const TriangleBVHRay* rays,
+		unsigned count,
+		TriangleBVHHit* hits,
+		bool any_hit
+	) const;
+public:
+	/// Builds the hierarchy for the triangles of the shape built by @p builder
+	/**
+	 *  @param builder the builder of the shape.
+	 *  @param max_leaf_size the maximum number of triangles in a leaf.
+	 */
+	template <class ShapeBuilder>
+	TriangleBVH(const ShapeBuilder& builder, GLuint max_leaf_size = 4)
+	{
+		std::vector<GLfloat> positions;
+		GLuint npv = builder.Positions(positions);
+
+		auto shape_indices = builder.Indices();
+		std::vector<GLuint> indices(
+			shape_indices.begin(),
+			shape_indices.end()
+		);
+		std::vector<GLuint> triangles;
+		MakeTriangleList(builder.Instructions(), indices, triangles);
+		_build(positions, npv, triangles, max_leaf_size);
+	}
+
+	/// Builds the hierarchy for the specified list of @p triangles
+	/**
+	 *  @param positions the vertex positions.
+	 *  @param values_per_vertex the number of values per vertex position
+	 *    (at least 3).
+	 *  @param triangles the list of triangles, three indices per triangle.
+	 *  @param max_leaf_size the maximum number of triangles in a leaf.
+	 */
+	TriangleBVH(
+		const std::vector<GLfloat>& positions,
+		GLuint values_per_vertex,
+		const std::vector<GLuint>& triangles,
+		GLuint max_leaf_size = 4
+	)
+	{
+		_build(positions, values_per_vertex, triangles, max_leaf_size);
+	}
+
+	/// Returns the number of triangles
+	GLuint TriangleCount(void) const
+	{
+		return GLuint(_triangles.size());
+	}
+
+	/// Returns the nodes of the hierarchy, the first one is the root
+	const std::vector<TriangleBVHNode>& Nodes(void) const
+	{
+		return _nodes;
+	}
+
+	/// Returns the triangles in the order in which they are stored
+	const std::vector<TriangleBVHTriangle>& Triangles(void) const
+	{
+		return _triangles;
+	}
+
+	/// Makes a ray with the specified origin and direction
+	static TriangleBVHRay Ray(
+		const Vector<GLfloat, 3>& origin,
+		const Vector<GLfloat, 3>& direction,
+		GLfloat max_distance = std::numeric_limits<GLfloat>::max()
+	);
+
+	/// Makes a segment between two points (the distance is in [0, 1])
+	static TriangleBVHRay Segment(
+		const Vector<GLfloat, 3>& from,
+		const Vector<GLfloat, 3>& to
+	);
+
+	/// Makes a ray going through a point on the screen
+	/** The ray starts on the near plane and ends on the far plane
+	 *  of the view frustum specified by @p projection_x_camera (the
+	 *  product of the projection and the camera matrix) and goes through
+	 *  the point with the normalized device coordinates @p x and @p y
+	 *  (in the range [-1, 1]).
+	 */
+	static TriangleBVHRay PickRay(
+		const Matrix<GLfloat, 4, 4>& projection_x_camera,
+		GLfloat x,
+		GLfloat y
+	);
+
+	/// Finds the closest intersection of the @p ray with the triangles
+	/** Returns true if a triangle was hit.
+	 */
+	bool Intersect(const TriangleBVHRay& ray, TriangleBVHHit& hit) const;
+
+	/// Finds the closest intersections of @p count rays with the triangles
+	/** Returns the number of rays which hit a triangle. The rays are
+	 *  traced one by one, unless @p packets is true, in which case
+	 *  consecutive rays going in similar directions (for example
+	 *  through adjacent pixels) are traversed together in packets
+	 *  of PacketSize rays, sharing the node fetches and bounding box
+	 *  tests. The packets are not vectorized and the traversal visits
+	 *  the nodes needed by any ray of the packet, so even for coherent
+	 *  camera rays they are slower than single rays in the
+	 *  005_triangle_bvh_bench example and should be used only if
+	 *  measured to pay off.
+	 */
+	std::size_t Intersect(
+		const TriangleBVHRay* rays,
+		std::size_t count,
+		TriangleBVHHit* hits,
+		bool packets = false
+	) const;
+
+	/// Returns true if the @p ray hits any triangle
+	/** This is faster than Intersect because the traversal stops
+	 *  at the first hit.
+	 */
+	bool Occluded(const TriangleBVHRay& ray) const;
+
+	/// Checks if @p count rays hit any triangle
+	/** The @p occluded values are set to true for the rays that hit
+	 *  some triangle. Returns the number of such rays. The @p packets
+	 *  parameter has the same meaning as in the Intersect function.
+	 */
+	std::size_t Occluded(
+		const TriangleBVHRay* rays,
+		std::size_t count,
+		bool* occluded,
+		bool packets = false
+	) const;
+};
+
+} // shapes
+} // oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/shapes/triangle_bvh.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
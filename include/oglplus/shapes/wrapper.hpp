@@ -14,6 +14,7 @@
 #define OGLPLUS_SHAPES_WRAPPER_1202020923_HPP
 
 #include <oglplus/config.hpp>
+#include <oglplus/cpu_trace.hpp>
 #include <oglplus/vertex_array.hpp>
 #include <oglplus/vertex_attrib.hpp>
 #include <oglplus/buffer.hpp>
@@ -23,18 +24,80 @@
 #include <oglplus/optional.hpp>
 #include <oglplus/error.hpp>
 #include <oglplus/string.hpp>
+#include <oglplus/data_type.hpp>
+#include <oglplus/angle.hpp>
 
 #include <oglplus/shapes/draw.hpp>
 #include <oglplus/shapes/vert_attr_info.hpp>
+#include <oglplus/shapes/mesh_file.hpp>
+#include <oglplus/shapes/cache.hpp>
 
 #include <vector>
 #include <functional>
 #include <iterator>
+#include <limits>
+#include <cstddef>
 #include <cassert>
 
 namespace oglplus {
 namespace shapes {
 
+/// Specifies how a ShapeWrapper stores the vertex attributes in buffers
+/** By default every vertex attribute is stored in a separate buffer
+ *  as 32-bit floats. The attributes can be interleaved in a single
+ *  buffer and/or quantized into smaller types:
+ *  - @c Position and @c TexCoord attributes are stored as half floats,
+ *  - @c Normal, @c Tangent and @c Bitangent attributes are stored as
+ *    normalized @c INT_2_10_10_10_REV values,
+ *  - @c Material numbers are stored as unsigned bytes,
+ *  - other attributes are stored as 32-bit floats.
+ *
+ *  Every attribute is aligned to four bytes in the vertex. The shaders
+ *  using the shape do not need to be changed, the values are converted
+ *  back to floats by the GL when they are fetched.
+ */
+class ShapeWrapperLayout
+{
+private:
+	bool _interleaved;
+	bool _quantized;
+public:
+	ShapeWrapperLayout(bool interleaved = false, bool quantized = false)
+	 : _interleaved(interleaved)
+	 , _quantized(quantized)
+	{ }
+
+	/// Every attribute in a separate buffer as floats (the default)
+	static ShapeWrapperLayout Separate(void)
+	{
+		return ShapeWrapperLayout(false, false);
+	}
+
+	/// All attributes interleaved in a single buffer as floats
+	static ShapeWrapperLayout Interleaved(void)
+	{
+		return ShapeWrapperLayout(true, false);
+	}
+
+	/// All attributes interleaved in a single buffer and quantized
+	static ShapeWrapperLayout InterleavedQuantized(void)
+	{
+		return ShapeWrapperLayout(true, true);
+	}
+
+	/// Returns true if the attributes are interleaved in a single buffer
+	bool IsInterleaved(void) const
+	{
+		return _interleaved;
+	}
+
+	/// Returns true if the attribute values are quantized
+	bool IsQuantized(void) const
+	{
+		return _quantized;
+	}
+};
+
 /// Wraps instructions and VAO+VBOs used to render a shape built by a ShapeBuilder
 class ShapeWrapperBase
 {
@@ -46,60 +109,135 @@ protected:
 	// index type properties
 	shapes::ElementIndexInfo _index_info;
 
+	// the drawing instructions merged into multi-draw batches
+	shapes::CompiledDrawingInstructions _compiled_instr;
+
 	Context _gl;
 
 	// A vertex array object for the rendered shape
 	Optional<VertexArray> _vao;
 
-	// VBOs for the shape's vertex attributes
+	// VBOs for the shape's vertex attributes, the last one
+	// stores the indices
 	Array<Buffer> _vbos;
 
+	// returns the number of VBOs needed for n attributes and the indices
+	static GLsizei _vbo_count(
+		std::ptrdiff_t n,
+		const ShapeWrapperLayout& layout
+	)
+	{
+		return layout.IsInterleaved()?2:GLsizei(n+1);
+	}
+
 	// numbers of values per vertex for the individual attributes
 	std::vector<GLuint> _npvs;
 
 	// names of the individual vertex attributes
 	std::vector<String> _names;
 
+	// the storage format of a single vertex attribute
+	struct _attrib_format
+	{
+		// index of the VBO storing the attribute
+		GLuint buffer;
+		DataType type;
+		bool normalized;
+		// number of values passed to the attribute pointer
+		GLuint values;
+		GLsizei stride;
+		GLsizeiptr offset;
+	};
+
+	// the formats of the individual vertex attributes
+	std::vector<_attrib_format> _formats;
+
 	// the origin and radius of the bounding sphere
 	Vector<GLfloat, 4> _bounding_sphere;
 
+	// chooses the storage format of an attribute and returns its size
+	static GLsizei _choose_format(
+		const String& name,
+		GLuint npv,
+		bool quantized,
+		_attrib_format& format
+	);
+
+	// the values of a single vertex attribute
+	struct _attrib_values
+	{
+		const GLfloat* data;
+		std::size_t size;
+
+		_attrib_values(void)
+		 : data(nullptr)
+		 , size(0)
+		{ }
+
+		_attrib_values(const GLfloat* d, std::size_t s)
+		 : data(d)
+		 , size(s)
+		{ }
+	};
+
+	// stores the values of a single attribute into dest
+	static void _pack_values(
+		const _attrib_values& values,
+		GLuint npv,
+		const _attrib_format& format,
+		GLubyte* dest
+	);
+
+	// converts the vertex attribute values and uploads them into the VBOs
+	void _upload(
+		const std::vector<_attrib_values>& values,
+		const ShapeWrapperLayout& layout
+	);
+
 	template <class ShapeBuilder, class ShapeIndices, typename Iterator>
 	void _init(
 		const ShapeBuilder& builder,
 		const ShapeIndices& shape_indices,
 		Iterator name,
-		Iterator end
+		Iterator end,
+		const ShapeWrapperLayout& layout
 	)
 	{
+		OGLPLUS_CPU_TRACE_SCOPE("ShapeWrapper::Generate");
 		VertexArray::Unbind();
 		typename ShapeBuilder::VertexAttribs vert_attr_info;
 		unsigned i = 0;
-		std::vector<GLfloat> data;
+		std::vector<std::vector<GLfloat>> data(_names.size());
 		while(name != end)
 		{
 			auto getter = vert_attr_info.VertexAttribGetter(
-				data,
+				data[i],
 				*name
 			);
 			if(getter != nullptr)
 			{
-				_vbos[i].Bind(Buffer::Target::Array);
-				_npvs[i] = getter(builder, data);
+				_npvs[i] = getter(builder, data[i]);
 				_names[i] = *name;
-
-				Buffer::Data(Buffer::Target::Array, data);
 			}
 			++name;
 			++i;
 		}
+		std::vector<_attrib_values> values(data.size());
+		for(std::size_t v=0; v!=data.size(); ++v)
+		{
+			values[v] = _attrib_values(
+				data[v].empty()?nullptr:data[v].data(),
+				data[v].size()
+			);
+		}
+		_upload(values, layout);
 
 		if(!shape_indices.empty())
 		{
 			assert((i+1) == _npvs.size());
-			assert((i+1) == _vbos.size());
 
 			_npvs[i] = 1;
-			_vbos[i].Bind(Buffer::Target::ElementArray);
+			_vbos[_vbos.size()-1].Bind(Buffer::Target::ElementArray);
 			Buffer::Data(
 				Buffer::Target::ElementArray,
 				shape_indices
@@ -108,46 +246,138 @@ protected:
 
 		builder.BoundingSphere(_bounding_sphere);
 	}
+
+	// uploads the attributes and indices directly from the memory
+	// of a MeshFile mapping or of a CachedShape
+	template <class StoredShape, typename Iterator>
+	void _init_stored(
+		const StoredShape& shape,
+		Iterator name,
+		Iterator end,
+		const ShapeWrapperLayout& layout
+	)
+	{
+		OGLPLUS_CPU_TRACE_SCOPE("ShapeWrapper::LoadStored");
+		VertexArray::Unbind();
+		unsigned i = 0;
+		std::vector<_attrib_values> values(_names.size());
+		while(name != end)
+		{
+			GLuint count = 0;
+			const GLfloat* data = shape.AttribValues(
+				*name,
+				_npvs[i],
+				count
+			);
+			if(data != nullptr)
+			{
+				values[i] = _attrib_values(data, count);
+				_names[i] = *name;
+			}
+			++name;
+			++i;
+		}
+		_upload(values, layout);
+
+		if(shape.IndexCount() != 0)
+		{
+			assert((i+1) == _npvs.size());
+
+			_npvs[i] = 1;
+			_vbos[_vbos.size()-1].Bind(Buffer::Target::ElementArray);
+			Buffer::Data(
+				Buffer::Target::ElementArray,
+				GLsizei(shape.IndexCount()),
+				shape.IndexData()
+			);
+		}
+
+		shape.BoundingSphere(_bounding_sphere);
+	}
 public:
 	template <typename Iterator, class ShapeBuilder>
 	ShapeWrapperBase(
 		Iterator names_begin,
 		Iterator names_end,
-		const ShapeBuilder& builder
+		const ShapeBuilder& builder,
+		const ShapeWrapperLayout& layout = ShapeWrapperLayout()
 	): _face_winding(builder.FaceWinding())
 	 , _shape_instr(builder.Instructions())
 	 , _index_info(builder)
-	 , _vbos(std::distance(names_begin, names_end)+1)
+	 , _compiled_instr(_shape_instr, _index_info)
+	 , _vbos(_vbo_count(std::distance(names_begin, names_end), layout))
 	 , _npvs(std::distance(names_begin, names_end)+1, 0)
 	 , _names(std::distance(names_begin, names_end))
+	 , _formats(std::distance(names_begin, names_end))
 	{
 		this->_init(
 			builder,
 			builder.Indices(),
 			names_begin,
-			names_end
+			names_end,
+			layout
 		);
 	}
 
+	template <typename Iterator>
+	ShapeWrapperBase(
+		Iterator names_begin,
+		Iterator names_end,
+		const MeshFile& file,
+		const ShapeWrapperLayout& layout = ShapeWrapperLayout()
+	): _face_winding(file.FaceWinding())
+	 , _shape_instr(file.Instructions())
+	 , _index_info(file)
+	 , _compiled_instr(_shape_instr, _index_info)
+	 , _vbos(_vbo_count(std::distance(names_begin, names_end), layout))
+	 , _npvs(std::distance(names_begin, names_end)+1, 0)
+	 , _names(std::distance(names_begin, names_end))
+	 , _formats(std::distance(names_begin, names_end))
+	{
+		this->_init_stored(file, names_begin, names_end, layout);
+	}
+
+	template <typename Iterator>
+	ShapeWrapperBase(
+		Iterator names_begin,
+		Iterator names_end,
+		const CachedShape& shape,
+		const ShapeWrapperLayout& layout = ShapeWrapperLayout()
+	): _face_winding(shape.FaceWinding())
+	 , _shape_instr(shape.Instructions())
+	 , _index_info(shape)
+	 , _compiled_instr(_shape_instr, _index_info)
+	 , _vbos(_vbo_count(std::distance(names_begin, names_end), layout))
+	 , _npvs(std::distance(names_begin, names_end)+1, 0)
+	 , _names(std::distance(names_begin, names_end))
+	 , _formats(std::distance(names_begin, names_end))
+	{
+		this->_init_stored(shape, names_begin, names_end, layout);
+	}
+
 	template <typename Iterator, class ShapeBuilder, class ShapeIndices>
 	ShapeWrapperBase(
 		Iterator names_begin,
 		Iterator names_end,
 		const ShapeBuilder& builder,
 		const ShapeIndices& shape_indices,
-		shapes::DrawingInstructions&& shape_instr
+		shapes::DrawingInstructions&& shape_instr,
+		const ShapeWrapperLayout& layout = ShapeWrapperLayout()
 	): _face_winding(builder.FaceWinding())
 	 , _shape_instr(std::move(shape_instr))
 	 , _index_info(builder)
-	 , _vbos(std::distance(names_begin, names_end)+1)
+	 , _compiled_instr(_shape_instr, _index_info)
+	 , _vbos(_vbo_count(std::distance(names_begin, names_end), layout))
 	 , _npvs(std::distance(names_begin, names_end)+1, 0)
 	 , _names(std::distance(names_begin, names_end))
+	 , _formats(std::distance(names_begin, names_end))
 	{
 		this->_init(
 			builder,
 			shape_indices,
 			names_begin,
-			names_end
+			names_end,
+			layout
 		);
 	}
 
@@ -155,11 +385,14 @@ public:
 	 : _face_winding(temp._face_winding)
 	 , _shape_instr(std::move(temp._shape_instr))
 	 , _index_info(temp._index_info)
+	 , _compiled_instr(std::move(temp._compiled_instr))
 	 , _gl(std::move(temp._gl))
 	 , _vao(std::move(temp._vao))
 	 , _vbos(std::move(temp._vbos))
 	 , _npvs(std::move(temp._npvs))
 	 , _names(std::move(temp._names))
+	 , _formats(std::move(temp._formats))
+	 , _bounding_sphere(temp._bounding_sphere)
 	{ }
 
 #if !OGLPLUS_NO_DELETED_FUNCTIONS
@@ -190,25 +423,25 @@ public:
 	void Draw(void) const
 	{
 		_gl.FrontFace(_face_winding);
-		_shape_instr.Draw(_index_info, 1, 0);
+		_compiled_instr.Draw(1, 0);
 	}
 
 	void Draw(GLuint inst_count) const
 	{
 		_gl.FrontFace(_face_winding);
-		_shape_instr.Draw(_index_info, inst_count, 0);
+		_compiled_instr.Draw(inst_count, 0);
 	}
 
 	void Draw(GLuint inst_count, GLuint base_inst) const
 	{
 		_gl.FrontFace(_face_winding);
-		_shape_instr.Draw(_index_info, inst_count, base_inst);
+		_compiled_instr.Draw(inst_count, base_inst);
 	}
 
 	void Draw(const std::function<bool (GLuint)>& drawing_driver) const
 	{
 		_gl.FrontFace(_face_winding);
-		_shape_instr.Draw(_index_info, 1, 0, drawing_driver);
+		_compiled_instr.Draw(1, 0, drawing_driver);
 	}
 
 	Vector<GLfloat, 4> BoundingSphere(void) const
@@ -253,6 +486,25 @@ public:
 		UseInProgram(prog);
 	}
 
+	template <typename StdRange, class ShapeBuilder>
+	ShapeWrapper(
+		const StdRange& names,
+		const ShapeBuilder& builder,
+		const ShapeWrapperLayout& layout
+	): ShapeWrapperBase(names.begin(), names.end(), builder, layout)
+	{ }
+
+	template <typename StdRange, class ShapeBuilder>
+	ShapeWrapper(
+		const StdRange& names,
+		const ShapeBuilder& builder,
+		const ShapeWrapperLayout& layout,
+		const ProgramOps& prog
+	): ShapeWrapperBase(names.begin(), names.end(), builder, layout)
+	{
+		UseInProgram(prog);
+	}
+
 #if !OGLPLUS_NO_INITIALIZER_LISTS
 	template <class ShapeBuilder>
 	ShapeWrapper(
@@ -270,6 +522,25 @@ public:
 	{
 		UseInProgram(prog);
 	}
+
+	template <class ShapeBuilder>
+	ShapeWrapper(
+		const std::initializer_list<const GLchar*>& names,
+		const ShapeBuilder& builder,
+		const ShapeWrapperLayout& layout
+	): ShapeWrapperBase(names.begin(), names.end(), builder, layout)
+	{ }
+
+	template <class ShapeBuilder>
+	ShapeWrapper(
+		const std::initializer_list<const GLchar*>& names,
+		const ShapeBuilder& builder,
+		const ShapeWrapperLayout& layout,
+		const ProgramOps& prog
+	): ShapeWrapperBase(names.begin(), names.end(), builder, layout)
+	{
+		UseInProgram(prog);
+	}
 #endif
 
 	template <class ShapeBuilder>
@@ -290,6 +561,18 @@ public:
 	{
 		UseInProgram(prog);
 	}
+
+	template <class ShapeBuilder>
+	ShapeWrapper(
+		const GLchar** names,
+		unsigned name_count,
+		const ShapeBuilder& builder,
+		const ShapeWrapperLayout& layout,
+		const ProgramOps& prog
+	): ShapeWrapperBase(names, names+name_count, builder, layout)
+	{
+		UseInProgram(prog);
+	}
 };
 
 /// Wraps instructions and VBOs and VAO used to render a shape built by a ShapeBuilder
@@ -329,6 +612,172 @@ public:
 	{
 		UseInProgram(prog);
 	}
+
+	template <typename StdRange, class ShapeBuilder>
+	ShapeWrapperWithAdjacency(
+		const StdRange& names,
+		const ShapeBuilder& builder,
+		const ShapeWrapperLayout& layout,
+		const ProgramOps& prog
+	): ShapeWrapperBase(
+		names.begin(),
+		names.end(),
+		builder,
+		builder.IndicesWithAdjacency(),
+		builder.InstructionsWithAdjacency(),
+		layout
+	)
+	{
+		UseInProgram(prog);
+	}
+};
+
+/// Wraps the VBOs, VAO and instructions of a shape with several levels of detail
+/** The LOD builder must provide, in addition to the usual shape builder
+ *  interface, the @c LevelCount(), @c LevelError(level) and
+ *  @c Instructions(level) member functions, like the Simplify builder.
+ *  The vertex attributes and the indices of all levels are stored in
+ *  the same buffers; the Draw functions inherited from ShapeWrapperBase
+ *  draw the full-detail level.
+ *
+ *  @see Simplify
+ */
+class LODShapeWrapper
+ : public ShapeWrapperBase
+{
+private:
+	std::vector<CompiledDrawingInstructions> _levels;
+	std::vector<GLfloat> _level_errors;
+
+	template <class LODBuilder>
+	void _init_levels(const LODBuilder& builder)
+	{
+		const GLuint n = builder.LevelCount();
+		_levels.reserve(n);
+		_level_errors.reserve(n);
+		for(GLuint level=0; level!=n; ++level)
+		{
+			_levels.push_back(CompiledDrawingInstructions(
+				builder.Instructions(level),
+				_index_info
+			));
+			_level_errors.push_back(builder.LevelError(level));
+		}
+	}
+public:
+	LODShapeWrapper(LODShapeWrapper&& temp)
+	 : ShapeWrapperBase(static_cast<ShapeWrapperBase&&>(temp))
+	 , _levels(std::move(temp._levels))
+	 , _level_errors(std::move(temp._level_errors))
+	{ }
+
+	template <typename StdRange, class LODBuilder>
+	LODShapeWrapper(
+		const StdRange& names,
+		const LODBuilder& builder,
+		const ShapeWrapperLayout& layout = ShapeWrapperLayout()
+	): ShapeWrapperBase(names.begin(), names.end(), builder, layout)
+	{
+		_init_levels(builder);
+	}
+
+	template <typename StdRange, class LODBuilder>
+	LODShapeWrapper(
+		const StdRange& names,
+		const LODBuilder& builder,
+		const ProgramOps& prog
+	): ShapeWrapperBase(names.begin(), names.end(), builder)
+	{
+		_init_levels(builder);
+		UseInProgram(prog);
+	}
+
+#if !OGLPLUS_NO_INITIALIZER_LISTS
+	template <class LODBuilder>
+	LODShapeWrapper(
+		const std::initializer_list<const GLchar*>& names,
+		const LODBuilder& builder,
+		const ShapeWrapperLayout& layout = ShapeWrapperLayout()
+	): ShapeWrapperBase(names.begin(), names.end(), builder, layout)
+	{
+		_init_levels(builder);
+	}
+
+	template <class LODBuilder>
+	LODShapeWrapper(
+		const std::initializer_list<const GLchar*>& names,
+		const LODBuilder& builder,
+		const ProgramOps& prog
+	): ShapeWrapperBase(names.begin(), names.end(), builder)
+	{
+		_init_levels(builder);
+		UseInProgram(prog);
+	}
+#endif
+
+	/// Returns the number of the levels of detail
+	GLuint LevelCount(void) const
+	{
+		return GLuint(_levels.size());
+	}
+
+	/// Returns the geometric error of the specified @p level
+	GLfloat LevelError(GLuint level) const
+	{
+		assert(level < _level_errors.size());
+		return _level_errors[level];
+	}
+
+	/// Returns the diameter (in pixels) of the projected bounding sphere
+	/**
+	 *  @param distance the distance of the bounding sphere's center
+	 *    from the camera.
+	 *  @param fov_y the vertical field of view of the camera.
+	 *  @param viewport_height the height of the viewport in pixels.
+	 */
+	GLfloat ProjectedDiameter(
+		GLfloat distance,
+		Angle<GLfloat> fov_y,
+		GLfloat viewport_height
+	) const
+	{
+		const GLfloat radius = BoundingSphereRadius();
+		if(distance <= radius)
+			return std::numeric_limits<GLfloat>::max();
+		return viewport_height*radius/(distance*Tan(fov_y*0.5f));
+	}
+
+	/// Selects the level of detail for the projected size of the shape
+	/** Returns the coarsest level whose geometric error projects
+	 *  to at most @p tolerance pixels when the bounding sphere of
+	 *  the shape projects to @p projected_diameter pixels.
+	 *
+	 *  @see ProjectedDiameter
+	 */
+	GLuint SelectLevel(
+		GLfloat projected_diameter,
+		GLfloat tolerance = 1.0f
+	) const
+	{
+		const GLfloat radius = BoundingSphereRadius();
+		if(radius <= GLfloat(0)) return 0;
+		const GLfloat scale = projected_diameter/(2*radius);
+		GLuint level = 0;
+		while(level+1 < _levels.size())
+		{
+			if(_level_errors[level+1]*scale > tolerance) break;
+			++level;
+		}
+		return level;
+	}
+
+	/// Draws the specified level of detail
+	void DrawLevel(GLuint level, GLuint inst_count = 1) const
+	{
+		assert(level < _levels.size());
+		_gl.FrontFace(_face_winding);
+		_levels[level].Draw(inst_count, 0);
+	}
 };
 
 } // shapes
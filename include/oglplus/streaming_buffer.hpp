@@ -0,0 +1,316 @@
+/**
+ *  @file oglplus/streaming_buffer.hpp
+ *  @brief Persistently-mapped, fenced streaming buffer
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_STREAMING_BUFFER_1311041200_HPP
+#define OGLPLUS_STREAMING_BUFFER_1311041200_HPP
+
+#include <oglplus/config.hpp>
+#include <oglplus/glfunc.hpp>
+#include <oglplus/error.hpp>
+#include <oglplus/buffer.hpp>
+#include <oglplus/sync.hpp>
+#include <oglplus/extension.hpp>
+
+#include <vector>
+#include <memory>
+#include <algorithm>
+#include <cstring>
+#include <cassert>
+
+namespace oglplus {
+
+#if OGLPLUS_DOCUMENTATION_ONLY || GL_VERSION_3_2 || GL_ARB_sync
+
+/// A ring of fenced buffer regions for per-frame dynamic data
+/** The StreamingBuffer allocates a single buffer object split into
+ *  several (by default three) equally sized regions. Every frame
+ *  writes into one region using a simple bump allocator; when the
+ *  frame is finished the region is fenced with a Sync object and
+ *  the next region is used. A region is reused only after the GPU
+ *  has signaled its fence.
+ *
+ *  If @c ARB_buffer_storage is available the buffer is created with
+ *  immutable storage and mapped once, persistently and coherently.
+ *  Otherwise the current region is mapped with @c MapBufferRange
+ *  using the unsynchronized and invalidate-range flags at the start
+ *  of every frame and unmapped at its end.
+ *
+ *  Example of usage:
+ *  @code
+ *  StreamingBuffer stream(Buffer::Target::Array, 4*1024*1024);
+ *  // ... each frame:
+ *  stream.BeginFrame();
+ *  auto vtx = stream.Push(positions.data(), positions.size());
+ *  // setup the vertex attrib pointers with vtx.Offset() ...
+ *  stream.EndFrame();
+ *  @endcode
+ *
+ *  @glvoereq{3,2,ARB,sync}
+ */
+class StreamingBuffer
+{
+public:
+	/// A chunk of memory allocated from the current region
+	class Allocation
+	{
+	private:
+		GLvoid* _ptr;
+		GLintptr _offset;
+		GLsizeiptr _size;
+
+		friend class StreamingBuffer;
+
+		Allocation(GLvoid* ptr, GLintptr offset, GLsizeiptr size)
+		 : _ptr(ptr)
+		 , _offset(offset)
+		 , _size(size)
+		{ }
+	public:
+		/// Returns true if the allocation succeeded
+		bool Valid(void) const
+		{
+			return _ptr != nullptr;
+		}
+
+		/// The pointer to the mapped memory where data can be written
+		GLvoid* Pointer(void) const
+		{
+			return _ptr;
+		}
+
+		/// The pointer to the mapped memory typed as @p T
+		template <typename T>
+		T* As(void) const
+		{
+			return static_cast<T*>(_ptr);
+		}
+
+		/// The offset (in bytes) of the allocation in the buffer
+		/** This value can be used as the offset in vertex attrib
+		 *  pointer setup, in BindRange or as the index offset
+		 *  in the drawing commands.
+		 */
+		GLintptr Offset(void) const
+		{
+			return _offset;
+		}
+
+		/// The size (in bytes) of the allocation
+		GLsizeiptr Size(void) const
+		{
+			return _size;
+		}
+	};
+private:
+	Buffer _buffer;
+	BufferTarget _target;
+	GLsizeiptr _region_size;
+	GLuint _region_count;
+	GLuint _current;
+	GLsizeiptr _used;
+	bool _persistent;
+	bool _in_frame;
+	GLubyte* _base;
+	GLubyte* _region_ptr;
+
+	std::vector<std::unique_ptr<Sync>> _fences;
+
+	double _last_wait;
+	double _total_wait;
+	GLuint _wait_count;
+
+	static bool _storage_available(void);
+
+	void _init_storage(void);
+	void _map_region(void);
+	void _unmap_region(void);
+	void _wait_for_region(void);
+public:
+	/// Creates a streaming buffer with the specified region size and count
+	/**
+	 *  @param target the target to which the buffer is bound when
+	 *    it needs to be (re)mapped.
+	 *  @param region_size the size (in bytes) of a single region.
+	 *  @param region_count the number of regions in the ring.
+	 *  @param allow_persistent if false then the map-range fallback
+	 *    is used even if buffer storage is available.
+	 *
+	 *  @throws Error
+	 */
+	StreamingBuffer(
+		BufferTarget target,
+		GLsizeiptr region_size,
+		GLuint region_count = 3,
+		bool allow_persistent = true
+	);
+
+#if !OGLPLUS_NO_DELETED_FUNCTIONS
+	StreamingBuffer(const StreamingBuffer&) = delete;
+#else
+private:
+	StreamingBuffer(const StreamingBuffer&);
+public:
+#endif
+
+	/// Returns the underlying buffer object
+	const Buffer& BufferObject(void) const
+	{
+		return _buffer;
+	}
+
+	/// Returns the target used for binding of the buffer
+	BufferTarget Target(void) const
+	{
+		return _target;
+	}
+
+	/// Binds the underlying buffer to the specified @p target
+	void Bind(BufferTarget target) const
+	{
+		_buffer.Bind(target);
+	}
+
+	/// Returns true if the buffer is mapped persistently
+	bool Persistent(void) const
+	{
+		return _persistent;
+	}
+
+	/// Returns the size (in bytes) of a single region
+	GLsizeiptr RegionSize(void) const
+	{
+		return _region_size;
+	}
+
+	/// Returns the number of regions in the ring
+	GLuint RegionCount(void) const
+	{
+		return _region_count;
+	}
+
+	/// Returns the index of the region used in the current frame
+	GLuint CurrentRegion(void) const
+	{
+		return _current;
+	}
+
+	/// Returns the offset (in bytes) of the current region in the buffer
+	GLintptr RegionOffset(void) const
+	{
+		return GLintptr(_current * _region_size);
+	}
+
+	/// Returns the number of bytes allocated in the current frame
+	GLsizeiptr Used(void) const
+	{
+		return _used;
+	}
+
+	/// Returns the number of bytes still available in the current frame
+	GLsizeiptr Available(void) const
+	{
+		return _region_size - _used;
+	}
+
+	/// Starts a new frame
+	/** Waits until the GPU finishes using the next region (if necessary),
+	 *  maps it (if the buffer is not persistently mapped) and resets
+	 *  the bump allocator.
+	 *
+	 *  @throws Error
+	 */
+	void BeginFrame(void);
+
+	/// Ends the current frame
+	/** Flushes or unmaps the current region, inserts a fence into
+	 *  the GL command stream and advances to the next region.
+	 *
+	 *  @throws Error
+	 */
+	void EndFrame(void);
+
+	/// Allocates @p size bytes from the current region
+	/** The returned offset is aligned to the specified @p alignment,
+	 *  (for example to the UNIFORM_BUFFER_OFFSET_ALIGNMENT when
+	 *  the allocation is used with BindRange on uniform buffers).
+	 *  If the current region does not have enough free space then
+	 *  an invalid allocation is returned.
+	 *
+	 *  @pre this function must be called between BeginFrame and EndFrame.
+	 */
+	Allocation Allocate(GLsizeiptr size, GLsizeiptr alignment = 4);
+
+	/// Allocates space for @p count instances of @p T and copies @p data
+	/** The allocation is aligned to the greater of @p alignment
+	 *  and the alignment of @p T.
+	 */
+	template <typename T>
+	Allocation Push(
+		const T* data,
+		std::size_t count,
+		GLsizeiptr alignment = 4
+	)
+	{
+		Allocation result = Allocate(
+			GLsizeiptr(count*sizeof(T)),
+			std::max(alignment, GLsizeiptr(alignof(T)))
+		);
+		if(result.Valid() && (count > 0))
+		{
+			std::memcpy(result.Pointer(), data, count*sizeof(T));
+		}
+		return result;
+	}
+
+	/// Allocates space for the elements of @p data and copies them
+	template <typename T>
+	Allocation Push(const std::vector<T>& data, GLsizeiptr alignment = 4)
+	{
+		return Push(data.data(), data.size(), alignment);
+	}
+
+	/// Returns the time (in seconds) spent waiting in the last BeginFrame
+	double LastWaitTime(void) const
+	{
+		return _last_wait;
+	}
+
+	/// Returns the time (in seconds) spent waiting on the fences in total
+	double TotalWaitTime(void) const
+	{
+		return _total_wait;
+	}
+
+	/// Returns the number of times BeginFrame had to wait for a fence
+	GLuint WaitCount(void) const
+	{
+		return _wait_count;
+	}
+
+	/// Resets the fence wait statistics
+	void ResetWaitStats(void)
+	{
+		_last_wait = 0.0;
+		_total_wait = 0.0;
+		_wait_count = 0;
+	}
+};
+
+#endif // sync
+
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/streaming_buffer.ipp>
+#endif // OGLPLUS_LINK_LIBRARY
+
+#endif // include guard
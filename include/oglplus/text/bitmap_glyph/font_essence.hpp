@@ -14,9 +14,11 @@
 #define OGLPLUS_TEXT_BITMAP_GLYPH_FONT_ESSENCE_HPP
 
 #include <oglplus/config.hpp>
+#include <oglplus/cpu_trace.hpp>
 #include <oglplus/text/bitmap_glyph/fwd.hpp>
 #include <oglplus/text/bitmap_glyph/page_storage.hpp>
 #include <oglplus/text/bitmap_glyph/pager.hpp>
+#include <oglplus/text/bitmap_glyph/page_file.hpp>
 
 #include <oglplus/auxiliary/filesystem.hpp>
 #include <oglplus/opt/resources.hpp>
@@ -30,22 +32,16 @@ private:
 	BitmapGlyphRenderingBase& _parent;
 	const std::string _font_name;
 
-	oglplus::images::Image _load_page_bitmap(GLint page);
-
-	static void _check_input(std::istream& input);
-
-	static void _unexpected_char(char);
+	// Returns the path to the binary page file or an empty string
+	std::string _find_page_file(GLint page) const;
 
-	static void _load_single_glyph(
-		std::istream& input,
-		char* line,
-		const size_t linelen,
-		GLfloat* values,
-		const size_t n_values
-	);
+	oglplus::images::Image _load_page_bitmap(GLint page);
 
 	std::vector<GLfloat> _load_page_metric(GLint page);
 
+	// Loads the page from a binary page file if there is one
+	bool _load_page_file(GLint frame, GLint page);
+
 	BitmapGlyphPager _pager;
 	const GLint _initial_frame;
 	BitmapGlyphPageStorage _page_storage;
@@ -66,20 +62,27 @@ private:
 			// check if the page is active
 			if(!_pager.UsePage(page))
 			{
+				OGLPLUS_CPU_TRACE_SCOPE("BitmapGlyph::PageFault");
 				// if not let the pager find
 				// a frame for the new page
 				auto frame = _pager.FindFrame();
-				// load the bitmap image
-				_page_storage.LoadPage(
-					frame,
-					_load_page_bitmap(page),
-					_load_page_metric(page)
-				);
+				// load the bitmap image and the metrics,
+				// preferably from the binary page file
+				if(!_load_page_file(frame, page))
+				{
+					_page_storage.LoadPage(
+						frame,
+						_load_page_bitmap(page),
+						_load_page_metric(page)
+					);
+				}
 				// tell the pages that the page
 				// is successfully loaded in the frame
 				_pager.SwapPageIn(frame, page);
 			}
 		}
+		// upload the changes in the page map at once
+		_pager.Flush();
 	}
 
 	struct _page_to_page
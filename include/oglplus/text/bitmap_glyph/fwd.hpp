@@ -57,6 +57,10 @@ unsigned BitmapGlyphPagesPerPlane(const BitmapGlyphRenderingBase&);
 // One plane consists of PagesPerPlane pages of GlyphsPerPage glyphs
 unsigned BitmapGlyphPlaneCount(const BitmapGlyphRenderingBase&);
 
+// Returns the spread of distance field glyph pages or zero if the pages
+// contain plain coverage bitmaps
+unsigned BitmapGlyphDistanceFieldSpread(const BitmapGlyphRenderingBase&);
+
 void BitmapGlyphAllocateLayoutData(
 	BitmapGlyphRenderingBase& parent,
 	BitmapGlyphLayoutData& layout_data
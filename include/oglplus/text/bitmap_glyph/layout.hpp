@@ -82,6 +82,7 @@ public:
 	{
 		tmp._data._storage = nullptr;
 		assert(_is_ok());
+		_data._storage->Relocate(_data);
 	}
 
 	~BitmapGlyphLayoutTpl(void)
@@ -18,9 +18,11 @@
 #include <oglplus/vertex_array.hpp>
 #include <oglplus/text/bitmap_glyph/fwd.hpp>
 #include <oglplus/text/bitmap_glyph/font.hpp>
+#include <oglplus/auxiliary/range_allocator.hpp>
 
 #include <cassert>
 #include <vector>
+#include <map>
 
 namespace oglplus {
 namespace text {
@@ -43,19 +45,53 @@ struct BitmapGlyphLayoutData
 };
 
 // Manages the codepoints for layouts that remain static
+/* The bookkeeping of the free space is done on the CPU so neither
+ * allocation nor deallocation of layout data needs to map the buffers.
+ */
 class BitmapGlyphLayoutStorage
 {
 private:
 	BitmapGlyphRenderingBase& _parent;
-	GLuint _list_head;
-	GLsizei _free;
 	const GLsizei _capacity;
 	const GLsizei _alloc_unit;
 
-	static inline GLuint _list_nil(void)
+	aux::RangeAllocator _allocator;
+
+	// the layout data allocated in this storage (by offset),
+	// used to update the offsets during compaction
+	std::map<GLint, BitmapGlyphLayoutData*> _layouts;
+
+	// a contiguous block of layout data moved during compaction
+	struct _data_move
 	{
-		return GLuint(-1);
-	}
+		GLuint old_offset;
+		GLuint new_offset;
+		GLuint size;
+	};
+
+	struct _data_mover
+	{
+		std::vector<_data_move>* _moves;
+
+		void operator()(
+			std::size_t old_offset,
+			std::size_t new_offset,
+			std::size_t size
+		) const
+		{
+			_data_move move = {
+				GLuint(old_offset),
+				GLuint(new_offset),
+				GLuint(size)
+			};
+			_moves->push_back(move);
+		}
+	};
+
+	static void _move_data(
+		Buffer& buffer,
+		const std::vector<_data_move>& moves
+	);
 
 	VertexArray _vao;
 	Buffer _code_points, _x_offsets;
@@ -81,18 +117,44 @@ public:
 
 	GLsizei Free(void) const
 	{
-		return _free;
+		return GLsizei(_allocator.Free());
 	}
 
 	bool Empty(void) const
 	{
-		return _free == _capacity;
+		return _allocator.Empty();
+	}
+
+	// the size of the largest free block
+	GLsizei LargestFree(void) const
+	{
+		return GLsizei(_allocator.LargestFree());
+	}
+
+	// the number of separate free blocks
+	GLsizei FreeBlockCount(void) const
+	{
+		return GLsizei(_allocator.FreeRangeCount());
+	}
+
+	// fragmentation of the free space (0 = none, 1 = worst)
+	GLfloat Fragmentation(void) const
+	{
+		return GLfloat(_allocator.Fragmentation());
 	}
 
 	bool Allocate(BitmapGlyphLayoutData& layout_data);
 
 	void Deallocate(BitmapGlyphLayoutData& layout_data);
 
+	// updates the address of a layout data that has been moved
+	void Relocate(BitmapGlyphLayoutData& layout_data);
+
+	// moves the allocated layouts to the start of the storage
+	// merging the free space into a single block at its end.
+	// returns the number of moved glyphs
+	GLsizei Compact(void);
+
 	void Initialize(
 		BitmapGlyphLayoutData& layout_data,
 		GLfloat width,
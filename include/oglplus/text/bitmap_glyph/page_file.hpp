@@ -0,0 +1,214 @@
+/**
+ *  @file oglplus/text/bitmap_glyph/page_file.hpp
+ *  @brief Bitmap-font-based text rendering, glyph page files
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#pragma once
+#ifndef OGLPLUS_TEXT_BITMAP_GLYPH_PAGE_FILE_HPP
+#define OGLPLUS_TEXT_BITMAP_GLYPH_PAGE_FILE_HPP
+
+#include <oglplus/config.hpp>
+#include <oglplus/vector.hpp>
+#include <oglplus/pixel_data.hpp>
+#include <oglplus/images/image.hpp>
+#include <oglplus/auxiliary/mapped_file.hpp>
+
+#include <vector>
+#include <string>
+#include <istream>
+#include <ostream>
+
+namespace oglplus {
+namespace text {
+
+// Reads the metrics of glyph_count glyphs from a textual .bgm file
+// into metrics (4*3 values per glyph)
+void BitmapGlyphReadTextMetrics(
+	std::istream& input,
+	GLfloat* metrics,
+	unsigned glyph_count
+);
+
+// The header of a binary glyph page (.bgp) file
+//
+// The header is followed by the metric block (4*3 floats per glyph,
+// in the same layout as the values read from the .bgm files) and
+// by the page bitmap. Both blocks start at offsets aligned to 16 bytes
+// and all values are stored in the native byte order, so the files
+// are not portable between platforms with different endianness, but
+// they can be memory-mapped and used without any parsing.
+struct BitmapGlyphPageFileHeader
+{
+	char magic[8];
+	GLuint byte_order;
+	GLuint version;
+
+	GLuint glyph_count;
+	GLuint values_per_glyph;
+
+	GLuint width;
+	GLuint height;
+	GLuint channels;
+	GLenum format;
+	GLenum internal_format;
+	GLenum type;
+
+	// 0 = stored, 1 = run-length encoded
+	GLuint compression;
+
+	GLuint metric_offset;
+	GLuint bitmap_offset;
+	// the size of the stored bitmap data in bytes
+	GLuint bitmap_size;
+	// the size of the (decompressed) bitmap data in bytes
+	GLuint bitmap_raw_size;
+};
+
+// A memory-mapped binary glyph page file
+class BitmapGlyphPageFile
+{
+private:
+	aux::MappedFile _file;
+	const BitmapGlyphPageFileHeader* _header;
+	mutable std::vector<GLubyte> _unpacked;
+
+	const BitmapGlyphPageFileHeader& _check(void) const;
+
+	// the size of a value of the bitmap data type, 0 if unsupported
+	static std::size_t _type_size(GLenum type);
+
+	// the number of channels of the bitmap format, 0 if unsupported
+	static GLuint _format_channels(GLenum format);
+
+	static GLuint _align(GLuint offset)
+	{
+		return (offset + 15) & ~GLuint(15);
+	}
+
+	static void _pack(
+		const GLubyte* data,
+		std::size_t size,
+		std::vector<GLubyte>& packed
+	);
+
+	static void _unpack(
+		const GLubyte* packed,
+		std::size_t packed_size,
+		GLubyte* data,
+		std::size_t size
+	);
+public:
+	static const char* Extension(void)
+	{
+		return ".bgp";
+	}
+
+	// Maps the page file with the specified path, throws on failure
+	BitmapGlyphPageFile(const std::string& path);
+
+	GLuint GlyphCount(void) const
+	{
+		return _header->glyph_count;
+	}
+
+	GLuint ValuesPerGlyph(void) const
+	{
+		return _header->values_per_glyph;
+	}
+
+	GLsizei Width(void) const
+	{
+		return GLsizei(_header->width);
+	}
+
+	GLsizei Height(void) const
+	{
+		return GLsizei(_header->height);
+	}
+
+	PixelDataFormat Format(void) const
+	{
+		return PixelDataFormat(_header->format);
+	}
+
+	PixelDataInternalFormat InternalFormat(void) const
+	{
+		return PixelDataInternalFormat(_header->internal_format);
+	}
+
+	PixelDataType Type(void) const
+	{
+		return PixelDataType(_header->type);
+	}
+
+	bool Compressed(void) const
+	{
+		return _header->compression != 0;
+	}
+
+	// Returns the pointer to the metric values in the mapped file
+	const GLfloat* Metrics(void) const
+	{
+		return reinterpret_cast<const GLfloat*>(
+			_file.Data()+_header->metric_offset
+		);
+	}
+
+	// Returns the pointer to the bitmap data
+	// If the bitmap is not compressed then the returned pointer
+	// points into the mapped file, otherwise the bitmap is first
+	// decompressed into an internal buffer
+	const GLvoid* Bitmap(void) const;
+
+	// Makes a copy of the metric values
+	std::vector<GLfloat> MakeMetrics(void) const
+	{
+		return std::vector<GLfloat>(
+			Metrics(),
+			Metrics()+GlyphCount()*ValuesPerGlyph()
+		);
+	}
+
+	// Makes an image from the page bitmap
+	images::Image MakeImage(void) const;
+
+	// Writes a binary glyph page file to the output stream
+	static void Write(
+		std::ostream& output,
+		GLuint width,
+		GLuint height,
+		GLuint channels,
+		GLenum format,
+		GLenum internal_format,
+		GLenum type,
+		const GLvoid* bitmap,
+		std::size_t bitmap_size,
+		const GLfloat* metrics,
+		GLuint glyph_count,
+		bool compress
+	);
+
+	// Writes a binary glyph page file with the specified image
+	static void Write(
+		std::ostream& output,
+		const images::Image& bitmap,
+		const GLfloat* metrics,
+		GLuint glyph_count,
+		bool compress
+	);
+};
+
+} // namespace text
+} // namespace oglplus
+
+#if !OGLPLUS_LINK_LIBRARY || defined(OGLPLUS_IMPLEMENTING_LIBRARY)
+#include <oglplus/text/bitmap_glyph/page_file.ipp>
+#endif
+
+#endif // include guard
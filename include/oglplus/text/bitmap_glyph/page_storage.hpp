@@ -69,6 +69,21 @@ public:
 		return _metric_tex_unit;
 	}
 
+	GLsizei Width(void) const
+	{
+		return _width;
+	}
+
+	GLsizei Height(void) const
+	{
+		return _height;
+	}
+
+	PixelDataInternalFormat InternalFormat(void) const
+	{
+		return _internal_format;
+	}
+
 	void Bind(void) const
 	{
 		Texture::Active(_bitmap_tex_unit);
@@ -83,6 +98,17 @@ public:
 		const std::vector<GLfloat>& metrics
 	);
 
+	// Loads the page from raw bitmap data with the dimensions
+	// and the internal format of this storage and from metrics
+	// with 4*3 values for each glyph of the page
+	void LoadPage(
+		const GLint frame,
+		PixelDataFormat format,
+		PixelDataType type,
+		const GLvoid* bitmap,
+		const GLfloat* metrics
+	);
+
 	void QueryGlyphMetrics(
 		GLint frame,
 		GLint cell,
@@ -19,7 +19,6 @@
 #include <oglplus/text/bitmap_glyph/fwd.hpp>
 
 #include <vector>
-#include <unordered_map>
 #include <cassert>
 
 namespace oglplus {
@@ -34,53 +33,62 @@ private:
 	// the frames into which pages are loaded
 	std::vector<GLint> _frames;
 
+	// the frames are kept in an intrusive doubly-linked list
+	// ordered from the most to the least recently used one
+	std::vector<GLint> _lru_prev, _lru_next;
+	GLint _lru_head, _lru_tail;
+
+	static GLint _lru_nil(void)
+	{
+		return GLint(-1);
+	}
+
+	void _lru_unlink(GLint frame);
+	void _lru_push_front(GLint frame);
+
 	// basic logical consistency check
 	bool _is_ok(void) const
 	{
-		return (_frames.size() == _ages.size()) &&
-			(_active_pages.size() <= _frames.size());
+		return	(_frames.size() == _lru_prev.size()) &&
+			(_frames.size() == _lru_next.size()) &&
+			(_lru_head != _lru_nil()) &&
+			(_lru_tail != _lru_nil());
 	}
 
-	// checks if the values in _frames and _gpu_page_map
+	// checks if the values in _frames and _page_map
 	// are consistent
 	bool _frames_consistent(void) const;
 
 	// checks if the specified page is in _frames
 	bool _page_in_frames(GLint page) const;
 
-	typedef unsigned long age_t;
-
-	static age_t _zero_age(void)
-	{
-		return age_t(0);
-	}
+	typedef GLubyte gpu_frame_t;
 
-	static age_t _full_age(void)
+	static gpu_frame_t _invalid_gpu_frame(void)
 	{
-		return ~_zero_age();
+		return ~gpu_frame_t(0);
 	}
 
-	static age_t _init_age(void)
+	// notes frame usage
+	void _touch_frame(GLint frame)
 	{
-		return ~(_full_age() >> 1);
+		if(_lru_head != frame)
+		{
+			_lru_unlink(frame);
+			_lru_push_front(frame);
+		}
 	}
 
-	std::vector<age_t> _ages;
-
-	std::unordered_map<GLint, GLint> _active_pages;
+	// CPU-side copy of the page -> frame map stored on the GPU
+	std::vector<gpu_frame_t> _page_map;
 
-	typedef GLubyte gpu_frame_t;
+	// the range of entries in _page_map not yet uploaded to the GPU
+	mutable std::size_t _dirty_begin, _dirty_end;
 
-	static gpu_frame_t _invalid_gpu_frame(void)
-	{
-		return ~gpu_frame_t(0);
-	}
-
-	// notes frame usage
-	void _touch_frame(std::size_t frame)
+	void _mark_dirty(std::size_t page)
 	{
-		_ages[frame] >>= 1;
-		_ages[frame] |= _init_age();
+		if(_dirty_begin > page) _dirty_begin = page;
+		if(_dirty_end <= page) _dirty_end = page+1;
 	}
 
 	Buffer _gpu_page_map;
@@ -97,8 +105,12 @@ public:
 		GLsizei frame_count
 	);
 
+	// uploads the modified entries of the page map to the GPU
+	void Flush(void) const;
+
 	void Bind(void) const
 	{
+		Flush();
 		Texture::Active(_pg_map_tex_unit);
 		_page_map_tex.Bind(Texture::Target::Buffer);
 	}
@@ -114,20 +126,25 @@ public:
 		return _pg_map_tex_unit;
 	}
 
-	void Update(void)
+	// finds the best frame for a new page
+	// (an empty frame or the least recently used one)
+	GLint FindFrame(void) const
 	{
 		assert(_is_ok());
-		for(auto i=_ages.begin(), e=_ages.end(); i!=e; ++i)
-			*i >>= 1;
+		return _lru_tail;
 	}
 
-	// finds the best frame for a new page
-	GLint FindFrame(void);
-
 	// Checks if a page is available for usage
 	bool UsePage(GLint page);
 
-	GLint FrameOfPage(GLint page) const;
+	GLint FrameOfPage(GLint page) const
+	{
+		assert(page >= 0 && std::size_t(page) < _page_map.size());
+		gpu_frame_t frame = _page_map[std::size_t(page)];
+		if(frame != _invalid_gpu_frame())
+			return GLint(frame);
+		else return GLint(-1);
+	}
 
 	// Swaps the specified page into a frame
 	// Use only if the page is not already swapped in
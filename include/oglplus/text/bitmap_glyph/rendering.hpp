@@ -14,6 +14,7 @@
 #define OGLPLUS_TEXT_BITMAP_GLYPH_RENDERING_HPP
 
 #include <oglplus/config.hpp>
+#include <oglplus/cpu_trace.hpp>
 
 #include <oglplus/text/bitmap_glyph/layout_storage.hpp>
 #include <oglplus/text/bitmap_glyph/layout.hpp>
@@ -51,6 +52,19 @@ struct BitmapGlyphRenderingConfig
 	/// Minimal allocation unit for a layout storage unit
 	unsigned layout_storage_unit;
 
+	/// The spread (in pixels) of signed distance field glyph pages
+	/** If this value is zero the glyph pages contain coverage
+	 *  bitmaps. Otherwise the pages contain signed distance fields
+	 *  of the glyphs and the renderer reconstructs the edges of the
+	 *  glyphs from the distance, so that a single page can be used
+	 *  for all font sizes. Fonts generated from glyph outlines
+	 *  (STBTrueTypeFont) make such pages themselves, pre-made
+	 *  page-based fonts must supply them. Making a page throws
+	 *  @c std::runtime_error if the glyphs enlarged by the spread
+	 *  do not fit into the page texture.
+	 */
+	unsigned distance_field_spread;
+
 	BitmapGlyphRenderingConfig(void)
 	 : page_frames(8)
 	 , plane_count(3)
@@ -58,6 +72,7 @@ struct BitmapGlyphRenderingConfig
 	 , glyphs_per_page(256)
 	 , layout_storage_page(1024)
 	 , layout_storage_unit(4)
+	 , distance_field_spread(0)
 	{ }
 };
 
@@ -82,6 +97,10 @@ protected:
 
 	friend unsigned BitmapGlyphGlyphsPerPage(const BitmapGlyphRenderingBase&);
 
+	friend unsigned BitmapGlyphDistanceFieldSpread(
+		const BitmapGlyphRenderingBase&
+	);
+
 	std::list<BitmapGlyphLayoutStorage> _layout_storage;
 
 	friend void BitmapGlyphAllocateLayoutData(
@@ -138,6 +157,25 @@ public:
 	{
 		return Renderer(*this, pixel_color_shader);
 	}
+
+	/// Compacts the layout storages whose free space is fragmented
+	/** Only the storages with fragmentation greater than the
+	 *  specified @p min_fragmentation are compacted. Returns
+	 *  the number of glyphs that were moved.
+	 */
+	GLsizei CompactLayoutStorage(GLfloat min_fragmentation = 0.0f)
+	{
+		GLsizei result = 0;
+		auto	i = _layout_storage.begin(),
+			e = _layout_storage.end();
+		while(i != e)
+		{
+			if(i->Fragmentation() > min_fragmentation)
+				result += i->Compact();
+			++i;
+		}
+		return result;
+	}
 };
 
 inline unsigned BitmapGlyphPageFrames(const BitmapGlyphRenderingBase& that)
@@ -163,6 +201,13 @@ inline unsigned BitmapGlyphGlyphsPerPage(const BitmapGlyphRenderingBase& that)
 	return that._config.glyphs_per_page;
 }
 
+inline unsigned BitmapGlyphDistanceFieldSpread(
+	const BitmapGlyphRenderingBase& that
+)
+{
+	return that._config.distance_field_spread;
+}
+
 inline void BitmapGlyphAllocateLayoutData(
 	BitmapGlyphRenderingBase& that,
 	BitmapGlyphLayoutData& layout_data
@@ -192,6 +237,7 @@ inline void BitmapGlyphInitializeLayoutData(
 	GLsizei length
 )
 {
+	OGLPLUS_CPU_TRACE_SCOPE("BitmapGlyph::Layout");
 	OGLPLUS_FAKE_USE(that);
 	assert(layout_data._storage);
 	BitmapGlyphLayoutStorage& _storage = *layout_data._storage;
@@ -20,6 +20,7 @@
 
 #include <vector>
 #include <istream>
+#include <cassert>
 
 namespace oglplus {
 namespace text {
@@ -56,7 +57,20 @@ private:
 	{
 		_init_index(code_point);
 	}
+
+	void _get_outline(
+		float scale,
+		float xoffs,
+		float yoffs,
+		std::vector<float>& segments
+	) const;
 public:
+	/// Returns the index of the glyph in the font
+	int Index(void) const
+	{
+		return _index;
+	}
+
 	/// Queries the horizontal glyph metrics
 	void GetHMetrics(int& left_bearing, int& width) const
 	{
@@ -193,6 +207,23 @@ public:
 			_index
 		);
 	}
+
+	/// Renders the signed distance field of the glyph into a buffer
+	/** The glyph is placed so that the top-left corner of its ink
+	 *  rectangle is at (spread, spread) in the frame. The distance
+	 *  to the outline (in pixels) is clamped to [-spread, spread]
+	 *  and mapped to [0, 255], 128 being on the outline and larger
+	 *  values inside of the glyph. The frame should therefore be
+	 *  2*spread pixels larger than the glyph bitmap box.
+	 */
+	void RenderDistanceField(
+		unsigned char* start,
+		int frame_width,
+		int frame_height,
+		int stride,
+		float scale,
+		float spread
+	) const;
 };
 
 
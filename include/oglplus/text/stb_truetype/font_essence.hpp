@@ -14,6 +14,7 @@
 #define OGLPLUS_TEXT_STB_TRUETYPE_FONT_ESSENCE_HPP
 
 #include <oglplus/config.hpp>
+#include <oglplus/cpu_trace.hpp>
 #include <oglplus/text/stb_truetype/font2d.hpp>
 #include <oglplus/text/bitmap_glyph/fwd.hpp>
 #include <oglplus/text/bitmap_glyph/page_storage.hpp>
@@ -25,6 +26,12 @@
 #include <cctype>
 #include <string>
 #include <fstream>
+#include <vector>
+
+#if !OGLPLUS_NO_THREADS
+#include <thread>
+#include <mutex>
+#endif
 
 namespace oglplus {
 namespace text {
@@ -35,8 +42,40 @@ private:
 	BitmapGlyphRenderingBase& _parent;
 	const STBTTFont2D _tt_font;
 	const GLuint _font_resolution;
+	const GLuint _spread;
 	const GLuint _tex_side;
 
+	// A glyph of a distance field page and its cell in the page bitmap
+	struct _df_glyph
+	{
+		STBTTFont2DGlyph glyph;
+		int xoffs, yoffs;
+		int width, height;
+	};
+
+	// Renders the distance fields of the glyphs into the page bitmap,
+	// the glyphs are distributed among several threads
+	struct _df_renderer
+	{
+		const std::vector<_df_glyph>* glyphs;
+		unsigned char* bmp_data;
+		GLuint tex_side;
+		float scale;
+		float spread;
+#if !OGLPLUS_NO_THREADS
+		std::mutex* mutex;
+#endif
+		std::size_t* next;
+
+		void operator()(void) const;
+	};
+
+	void _do_make_page_distance_field_and_metric(
+		GLint page,
+		unsigned char* bmp_data,
+		float* metric
+	) const;
+
 	void _do_make_page_bitmap_and_metric(
 		GLint page,
 		unsigned char* bmp_data,
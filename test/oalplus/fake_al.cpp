@@ -0,0 +1,561 @@
+/**
+ *  .file test/oalplus/fake_al.cpp
+ *  .brief Fake OpenAL implementation used by the tests
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#include "fake_al.hpp"
+
+#include <AL/alut.h>
+
+#include <map>
+#include <deque>
+#include <array>
+#include <mutex>
+#include <cstring>
+
+namespace fake_al {
+namespace {
+
+struct Buffer
+{
+	std::vector<ALubyte> data;
+	ALenum format;
+	ALsizei frequency;
+};
+
+struct Source
+{
+	ALenum state;
+	// the names of the queued buffers
+	std::deque<ALuint> queue;
+	// the number of completely played buffers in the queue
+	std::size_t current;
+	// the number of bytes played from the current buffer
+	std::size_t offset;
+	std::map<ALenum, ALint> ints;
+	std::map<ALenum, std::array<ALfloat, 3>> floats;
+	std::vector<ALubyte> played;
+
+	Source(void)
+	 : state(AL_INITIAL)
+	 , current(0)
+	 , offset(0)
+	{ }
+
+	std::size_t Processed(void) const
+	{
+		if(state == AL_STOPPED) return queue.size();
+		if(state == AL_INITIAL) return 0;
+		return current;
+	}
+};
+
+struct State
+{
+	std::mutex mutex;
+	ALenum error;
+	ALuint next_name;
+	ALuint last_source;
+	std::map<ALuint, Source> sources;
+	std::map<ALuint, Buffer> buffers;
+	std::map<ALenum, std::array<ALfloat, 3>> listener;
+
+	State(void)
+	 : error(AL_NO_ERROR)
+	 , next_name(1)
+	 , last_source(0)
+	{ }
+
+	// remembers the first error until it is queried
+	void Fail(ALenum code)
+	{
+		if(error == AL_NO_ERROR) error = code;
+	}
+
+	Source* FindSource(ALuint name)
+	{
+		auto pos = sources.find(name);
+		if(pos == sources.end())
+		{
+			Fail(AL_INVALID_NAME);
+			return nullptr;
+		}
+		return &pos->second;
+	}
+
+	bool IsQueued(ALuint buffer) const
+	{
+		for(auto i=sources.begin(), e=sources.end(); i!=e; ++i)
+		{
+			const std::deque<ALuint>& queue = i->second.queue;
+			for(auto j=queue.begin(), f=queue.end(); j!=f; ++j)
+				if(*j == buffer) return true;
+		}
+		return false;
+	}
+};
+
+State& state(void)
+{
+	static State instance;
+	return instance;
+}
+
+typedef std::lock_guard<std::mutex> Lock;
+
+} // namespace
+
+void Reset(void)
+{
+	State& s = state();
+	Lock lock(s.mutex);
+	s.error = AL_NO_ERROR;
+	s.last_source = 0;
+	s.sources.clear();
+	s.buffers.clear();
+	s.listener.clear();
+}
+
+ALuint LastSource(void)
+{
+	State& s = state();
+	Lock lock(s.mutex);
+	return s.last_source;
+}
+
+std::size_t SourceCount(void)
+{
+	State& s = state();
+	Lock lock(s.mutex);
+	return s.sources.size();
+}
+
+std::size_t BufferCount(void)
+{
+	State& s = state();
+	Lock lock(s.mutex);
+	return s.buffers.size();
+}
+
+std::size_t Render(ALuint source, std::size_t bytes)
+{
+	State& s = state();
+	Lock lock(s.mutex);
+	Source* src = s.FindSource(source);
+	if(!src) return 0;
+
+	std::size_t result = 0;
+	while((src->state == AL_PLAYING) && (bytes > 0))
+	{
+		if(src->current == src->queue.size())
+		{
+			// ran out of data
+			src->state = AL_STOPPED;
+			break;
+		}
+		const Buffer& buffer = s.buffers[src->queue[src->current]];
+		std::size_t size = buffer.data.size()-src->offset;
+		if(size > bytes) size = bytes;
+		src->played.insert(
+			src->played.end(),
+			buffer.data.begin()+src->offset,
+			buffer.data.begin()+src->offset+size
+		);
+		src->offset += size;
+		bytes -= size;
+		result += size;
+		if(src->offset == buffer.data.size())
+		{
+			++src->current;
+			src->offset = 0;
+		}
+	}
+	if(
+		(src->state == AL_PLAYING) &&
+		(src->current == src->queue.size())
+	) src->state = AL_STOPPED;
+	return result;
+}
+
+const std::vector<ALubyte>& Played(ALuint source)
+{
+	State& s = state();
+	Lock lock(s.mutex);
+	static const std::vector<ALubyte> none;
+	Source* src = s.FindSource(source);
+	return src?src->played:none;
+}
+
+} // namespace fake_al
+
+using fake_al::state;
+using fake_al::Lock;
+
+extern "C" {
+
+ALenum alGetError(void)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	ALenum result = s.error;
+	s.error = AL_NO_ERROR;
+	return result;
+}
+
+const ALchar* alGetString(ALenum param)
+{
+	switch(param)
+	{
+		case AL_VENDOR: return "OALplus";
+		case AL_VERSION: return "1.1";
+		case AL_RENDERER: return "Fake";
+		case AL_EXTENSIONS: return "";
+	}
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	s.Fail(AL_INVALID_ENUM);
+	return nullptr;
+}
+
+void alListenerf(ALenum param, ALfloat value)
+{
+	alListener3f(param, value, 0.0f, 0.0f);
+}
+
+void alListener3f(ALenum param, ALfloat v1, ALfloat v2, ALfloat v3)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	std::array<ALfloat, 3> values = {{v1, v2, v3}};
+	s.listener[param] = values;
+}
+
+void alListenerfv(ALenum param, const ALfloat* values)
+{
+	alListener3f(param, values[0], values[1], values[2]);
+}
+
+void alGetListenerfv(ALenum param, ALfloat* values)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	const std::array<ALfloat, 3>& stored = s.listener[param];
+	std::memcpy(values, stored.data(), sizeof(stored));
+}
+
+void alGenSources(ALsizei n, ALuint* sources)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	for(ALsizei i=0; i!=n; ++i)
+	{
+		sources[i] = s.next_name++;
+		s.sources[sources[i]] = fake_al::Source();
+		s.last_source = sources[i];
+	}
+}
+
+void alDeleteSources(ALsizei n, const ALuint* sources)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	for(ALsizei i=0; i!=n; ++i)
+	{
+		if(!s.FindSource(sources[i])) return;
+	}
+	for(ALsizei i=0; i!=n; ++i)
+		s.sources.erase(sources[i]);
+}
+
+ALboolean alIsSource(ALuint source)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	return s.sources.count(source)?AL_TRUE:AL_FALSE;
+}
+
+void alSourcef(ALuint source, ALenum param, ALfloat value)
+{
+	alSource3f(source, param, value, 0.0f, 0.0f);
+}
+
+void alSource3f(
+	ALuint source,
+	ALenum param,
+	ALfloat v1,
+	ALfloat v2,
+	ALfloat v3
+)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	fake_al::Source* src = s.FindSource(source);
+	if(!src) return;
+	std::array<ALfloat, 3> values = {{v1, v2, v3}};
+	src->floats[param] = values;
+}
+
+void alSourcefv(ALuint source, ALenum param, const ALfloat* values)
+{
+	alSource3f(source, param, values[0], values[1], values[2]);
+}
+
+void alSourcei(ALuint source, ALenum param, ALint value)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	fake_al::Source* src = s.FindSource(source);
+	if(!src) return;
+	if(param == AL_BUFFER)
+	{
+		if((src->state == AL_PLAYING) || (src->state == AL_PAUSED))
+		{
+			s.Fail(AL_INVALID_OPERATION);
+			return;
+		}
+		if((value != 0) && !s.buffers.count(ALuint(value)))
+		{
+			s.Fail(AL_INVALID_VALUE);
+			return;
+		}
+		src->queue.clear();
+		if(value != 0) src->queue.push_back(ALuint(value));
+		src->current = 0;
+		src->offset = 0;
+	}
+	else src->ints[param] = value;
+}
+
+void alGetSourcefv(ALuint source, ALenum param, ALfloat* values)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	fake_al::Source* src = s.FindSource(source);
+	if(!src) return;
+	const std::array<ALfloat, 3>& stored = src->floats[param];
+	std::memcpy(values, stored.data(), sizeof(stored));
+}
+
+void alGetSourceiv(ALuint source, ALenum param, ALint* values)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	fake_al::Source* src = s.FindSource(source);
+	if(!src) return;
+	switch(param)
+	{
+		case AL_SOURCE_STATE:
+			*values = src->state;
+			break;
+		case AL_BUFFERS_QUEUED:
+			*values = ALint(src->queue.size());
+			break;
+		case AL_BUFFERS_PROCESSED:
+			*values = ALint(src->Processed());
+			break;
+		default:
+			*values = src->ints[param];
+	}
+}
+
+void alSourcePlay(ALuint source)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	fake_al::Source* src = s.FindSource(source);
+	if(!src) return;
+	if(src->state == AL_PAUSED)
+	{
+		src->state = AL_PLAYING;
+		return;
+	}
+	// (re)starts from the beginning of the queue
+	src->current = 0;
+	src->offset = 0;
+	src->state = src->queue.empty()?AL_STOPPED:AL_PLAYING;
+}
+
+void alSourcePause(ALuint source)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	fake_al::Source* src = s.FindSource(source);
+	if(!src) return;
+	if(src->state == AL_PLAYING) src->state = AL_PAUSED;
+}
+
+void alSourceStop(ALuint source)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	fake_al::Source* src = s.FindSource(source);
+	if(!src) return;
+	src->state = AL_STOPPED;
+	src->offset = 0;
+}
+
+void alSourceRewind(ALuint source)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	fake_al::Source* src = s.FindSource(source);
+	if(!src) return;
+	src->state = AL_INITIAL;
+	src->current = 0;
+	src->offset = 0;
+}
+
+void alSourceQueueBuffers(ALuint source, ALsizei n, const ALuint* buffers)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	fake_al::Source* src = s.FindSource(source);
+	if(!src) return;
+	for(ALsizei i=0; i!=n; ++i)
+	{
+		if(!s.buffers.count(buffers[i]))
+		{
+			s.Fail(AL_INVALID_NAME);
+			return;
+		}
+	}
+	src->queue.insert(src->queue.end(), buffers, buffers+n);
+}
+
+void alSourceUnqueueBuffers(ALuint source, ALsizei n, ALuint* buffers)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	fake_al::Source* src = s.FindSource(source);
+	if(!src) return;
+	if((n < 0) || (std::size_t(n) > src->Processed()))
+	{
+		s.Fail(AL_INVALID_VALUE);
+		return;
+	}
+	for(ALsizei i=0; i!=n; ++i)
+	{
+		buffers[i] = src->queue.front();
+		src->queue.pop_front();
+	}
+	src->current = (src->current > std::size_t(n))?src->current-n:0;
+}
+
+void alGenBuffers(ALsizei n, ALuint* buffers)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	for(ALsizei i=0; i!=n; ++i)
+	{
+		buffers[i] = s.next_name++;
+		fake_al::Buffer& buffer = s.buffers[buffers[i]];
+		buffer.format = AL_FORMAT_MONO8;
+		buffer.frequency = 0;
+	}
+}
+
+void alDeleteBuffers(ALsizei n, const ALuint* buffers)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	for(ALsizei i=0; i!=n; ++i)
+	{
+		if(!s.buffers.count(buffers[i]))
+		{
+			s.Fail(AL_INVALID_NAME);
+			return;
+		}
+		// a buffer queued on a source cannot be deleted
+		if(s.IsQueued(buffers[i]))
+		{
+			s.Fail(AL_INVALID_OPERATION);
+			return;
+		}
+	}
+	for(ALsizei i=0; i!=n; ++i)
+		s.buffers.erase(buffers[i]);
+}
+
+ALboolean alIsBuffer(ALuint buffer)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	return s.buffers.count(buffer)?AL_TRUE:AL_FALSE;
+}
+
+void alBufferData(
+	ALuint buffer,
+	ALenum format,
+	const ALvoid* data,
+	ALsizei size,
+	ALsizei freq
+)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	auto pos = s.buffers.find(buffer);
+	if(pos == s.buffers.end())
+	{
+		s.Fail(AL_INVALID_NAME);
+		return;
+	}
+	// the data of a queued buffer cannot be replaced
+	if(s.IsQueued(buffer) || (size < 0))
+	{
+		s.Fail(s.IsQueued(buffer)?AL_INVALID_OPERATION:AL_INVALID_VALUE);
+		return;
+	}
+	const ALubyte* bytes = static_cast<const ALubyte*>(data);
+	pos->second.data.assign(bytes, bytes+size);
+	pos->second.format = format;
+	pos->second.frequency = freq;
+}
+
+void alGetBufferiv(ALuint buffer, ALenum param, ALint* values)
+{
+	fake_al::State& s = state();
+	Lock lock(s.mutex);
+	auto pos = s.buffers.find(buffer);
+	if(pos == s.buffers.end())
+	{
+		s.Fail(AL_INVALID_NAME);
+		return;
+	}
+	const fake_al::Buffer& buf = pos->second;
+	bool stereo =
+		(buf.format == AL_FORMAT_STEREO8) ||
+		(buf.format == AL_FORMAT_STEREO16);
+	bool wide =
+		(buf.format == AL_FORMAT_MONO16) ||
+		(buf.format == AL_FORMAT_STEREO16);
+	switch(param)
+	{
+		case AL_FREQUENCY: *values = buf.frequency; break;
+		case AL_SIZE: *values = ALint(buf.data.size()); break;
+		case AL_BITS: *values = wide?16:8; break;
+		case AL_CHANNELS: *values = stereo?2:1; break;
+		default: s.Fail(AL_INVALID_ENUM);
+	}
+}
+
+ALCenum alcGetError(ALCdevice*)
+{
+	return ALC_NO_ERROR;
+}
+
+const ALCchar* alcGetString(ALCdevice*, ALCenum)
+{
+	return "";
+}
+
+ALenum alutGetError(void)
+{
+	return ALUT_ERROR_NO_ERROR;
+}
+
+} // extern "C"
@@ -0,0 +1,46 @@
+/**
+ *  .file test/oalplus/fake_al.hpp
+ *  .brief Control of the fake OpenAL implementation used by the tests
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#ifndef OALPLUS_TEST_FAKE_AL_HPP
+#define OALPLUS_TEST_FAKE_AL_HPP
+
+#include <AL/al.h>
+
+#include <vector>
+#include <cstddef>
+
+// The fake OpenAL keeps the sources and buffers in memory and does not
+// play anything by itself. The tests advance the playback of a source
+// by calling Render, which appends the played bytes to the log returned
+// by Played. When a playing source runs out of queued data it stops,
+// as a real source would. Invalid calls set the AL error which is
+// then returned by alGetError.
+namespace fake_al {
+
+// destroys all sources and buffers and clears the error
+void Reset(void);
+
+// the name of the most recently generated source
+ALuint LastSource(void);
+
+// the numbers of existing sources and buffers
+std::size_t SourceCount(void);
+std::size_t BufferCount(void);
+
+// plays up to bytes of the data queued on a playing source,
+// returns the number of bytes actually played
+std::size_t Render(ALuint source, std::size_t bytes);
+
+// all the bytes played by the source so far
+const std::vector<ALubyte>& Played(ALuint source);
+
+} // namespace fake_al
+
+#endif // include guard
@@ -0,0 +1,36 @@
+/**
+ *  .file test/oalplus/fake_al/AL/alc.h
+ *  .brief The part of the ALC API used by OALplus error handling
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#ifndef AL_ALC_H
+#define AL_ALC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ALCdevice_struct ALCdevice;
+typedef char ALCchar;
+typedef int ALCenum;
+
+#define ALC_NO_ERROR                            0
+#define ALC_INVALID_DEVICE                      0xA001
+#define ALC_INVALID_CONTEXT                     0xA002
+#define ALC_INVALID_ENUM                        0xA003
+#define ALC_INVALID_VALUE                       0xA004
+#define ALC_OUT_OF_MEMORY                       0xA005
+
+ALCenum alcGetError(ALCdevice* device);
+const ALCchar* alcGetString(ALCdevice* device, ALCenum param);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // include guard
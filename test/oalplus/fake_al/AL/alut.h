@@ -0,0 +1,39 @@
+/**
+ *  .file test/oalplus/fake_al/AL/alut.h
+ *  .brief The ALUT error codes used by OALplus, for the fake OpenAL
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#ifndef AL_ALUT_H
+#define AL_ALUT_H
+
+#include <AL/al.h>
+#include <AL/alc.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define ALUT_ERROR_NO_ERROR                     0
+#define ALUT_ERROR_OUT_OF_MEMORY                0x200
+#define ALUT_ERROR_INVALID_ENUM                 0x201
+#define ALUT_ERROR_INVALID_VALUE                0x202
+#define ALUT_ERROR_INVALID_OPERATION            0x203
+#define ALUT_ERROR_NO_CURRENT_CONTEXT           0x204
+#define ALUT_ERROR_AL_ERROR_ON_ENTRY            0x205
+#define ALUT_ERROR_ALC_ERROR_ON_ENTRY           0x206
+#define ALUT_ERROR_UNSUPPORTED_FILE_TYPE        0x209
+#define ALUT_ERROR_UNSUPPORTED_FILE_SUBTYPE     0x20A
+#define ALUT_ERROR_CORRUPT_OR_TRUNCATED_DATA    0x20B
+
+ALenum alutGetError(void);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
+
+#endif // include guard
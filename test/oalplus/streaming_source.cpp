@@ -0,0 +1,302 @@
+/**
+ *  .file test/oalplus/streaming_source.cpp
+ *  .brief Test case for the StreamingSource class.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OALPLUS_StreamingSource
+#include <boost/test/unit_test.hpp>
+
+#include <oalplus/al.hpp>
+#include <oalplus/streaming_source.hpp>
+
+#include "fake_al.hpp"
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <chrono>
+
+BOOST_AUTO_TEST_SUITE(StreamingSource)
+
+using namespace oalplus;
+
+// the value of the n-th byte of the stream
+static ALubyte stream_byte(std::size_t n)
+{
+	return ALubyte((n*7+n/251)%256);
+}
+
+// produces size bytes of the stream in full chunks
+class PatternDecoder
+ : public StreamingSourceDecoder
+{
+private:
+	std::size_t _size;
+	std::size_t _pos;
+	bool _can_rewind;
+	std::atomic<unsigned>& _rewinds;
+public:
+	PatternDecoder(
+		std::size_t size,
+		bool can_rewind,
+		std::atomic<unsigned>& rewinds
+	): _size(size)
+	 , _pos(0)
+	 , _can_rewind(can_rewind)
+	 , _rewinds(rewinds)
+	{ }
+
+	DataFormat Format(void) const
+	{
+		return DataFormat::Mono8;
+	}
+
+	ALsizei Frequency(void) const
+	{
+		return 22050;
+	}
+
+	std::size_t Decode(ALubyte* buffer, std::size_t size)
+	{
+		if(size > _size-_pos) size = _size-_pos;
+		for(std::size_t i=0; i!=size; ++i)
+			buffer[i] = stream_byte(_pos+i);
+		_pos += size;
+		return size;
+	}
+
+	bool Rewind(void)
+	{
+		if(!_can_rewind) return false;
+		_pos = 0;
+		++_rewinds;
+		return true;
+	}
+};
+
+struct StreamingSourceFixture
+{
+	static const std::size_t buffer_count = 3;
+	static const std::size_t buffer_size = 1000;
+
+	std::atomic<unsigned> rewinds;
+
+	StreamingSourceFixture(void)
+	 : rewinds(0)
+	{
+		fake_al::Reset();
+	}
+
+	std::unique_ptr<StreamingSourceDecoder> Decoder(
+		std::size_t size,
+		bool can_rewind = false
+	)
+	{
+		return std::unique_ptr<StreamingSourceDecoder>(
+			new PatternDecoder(size, can_rewind, rewinds)
+		);
+	}
+
+	// updates the stream until the expected number of buffers is queued
+	// or until it is finished if no more buffers are expected; the decoder
+	// runs in another thread so it may take a few updates
+	static void Pump(oalplus::StreamingSource& stream, std::size_t expected)
+	{
+		for(unsigned i=0; i!=10000; ++i)
+		{
+			stream.Update();
+			if(expected?
+				(stream.QueuedBuffers() >= expected):
+				stream.Finished()
+			) break;
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+		BOOST_REQUIRE_EQUAL(stream.QueuedBuffers(), expected);
+	}
+
+	// the number of buffers which should be queued on a stream
+	// of the specified size after the specified number of bytes
+	// was played
+	static std::size_t Expected(std::size_t size, std::size_t played)
+	{
+		if(played == size) return 0;
+		std::size_t total = (size+buffer_size-1)/buffer_size;
+		std::size_t remaining = total-played/buffer_size;
+		return (remaining < buffer_count)?remaining:buffer_count;
+	}
+};
+
+const std::size_t StreamingSourceFixture::buffer_count;
+const std::size_t StreamingSourceFixture::buffer_size;
+
+BOOST_FIXTURE_TEST_CASE(StreamingSource_order, StreamingSourceFixture)
+{
+	const std::size_t size = 10*buffer_size+123;
+	{
+		oalplus::StreamingSource stream(
+			Decoder(size),
+			buffer_count,
+			buffer_size
+		);
+		ALuint source = fake_al::LastSource();
+		stream.Play();
+		Pump(stream, buffer_count);
+
+		// play in steps which are not aligned to the buffers
+		std::size_t played = 0;
+		while(played != size)
+		{
+			std::size_t step = fake_al::Render(source, 700);
+			BOOST_REQUIRE(step > 0);
+			played += step;
+			Pump(stream, Expected(size, played));
+		}
+		BOOST_CHECK(stream.Finished());
+		BOOST_CHECK_EQUAL(stream.Underruns(), 0u);
+		BOOST_CHECK_EQUAL(fake_al::Render(source, 1), 0u);
+
+		const std::vector<ALubyte>& output = fake_al::Played(source);
+		BOOST_REQUIRE_EQUAL(output.size(), size);
+		for(std::size_t n=0; n!=size; ++n)
+		{
+			if(output[n] != stream_byte(n))
+			{
+				BOOST_ERROR("Byte " << n << " of the stream differs");
+				break;
+			}
+		}
+	}
+	BOOST_CHECK_EQUAL(alGetError(), AL_NO_ERROR);
+	BOOST_CHECK_EQUAL(fake_al::SourceCount(), 0u);
+	BOOST_CHECK_EQUAL(fake_al::BufferCount(), 0u);
+	BOOST_CHECK_EQUAL(rewinds.load(), 0u);
+}
+
+BOOST_FIXTURE_TEST_CASE(StreamingSource_underrun, StreamingSourceFixture)
+{
+	const std::size_t size = 10*buffer_size;
+	oalplus::StreamingSource stream(
+		Decoder(size),
+		buffer_count,
+		buffer_size
+	);
+	ALuint source = fake_al::LastSource();
+	stream.Play();
+	Pump(stream, buffer_count);
+	BOOST_CHECK_EQUAL(stream.Underruns(), 0u);
+
+	// the source plays all queued buffers before the next update
+	std::size_t played = fake_al::Render(source, size);
+	BOOST_CHECK_EQUAL(played, buffer_count*buffer_size);
+	BOOST_CHECK_EQUAL(stream.Underruns(), 0u);
+
+	// the update restarts the playback and counts the underrun
+	Pump(stream, buffer_count);
+	BOOST_CHECK_EQUAL(stream.Underruns(), 1u);
+
+	// pausing does not count as an underrun
+	stream.Pause();
+	BOOST_CHECK_EQUAL(fake_al::Render(source, buffer_size), 0u);
+	Pump(stream, buffer_count);
+	stream.Play();
+
+	while(played != size)
+	{
+		std::size_t step = fake_al::Render(source, buffer_size);
+		BOOST_REQUIRE(step > 0);
+		played += step;
+		Pump(stream, Expected(size, played));
+	}
+	BOOST_CHECK(stream.Finished());
+	BOOST_CHECK_EQUAL(stream.Underruns(), 1u);
+
+	// no data was lost or repeated because of the underrun
+	const std::vector<ALubyte>& output = fake_al::Played(source);
+	BOOST_REQUIRE_EQUAL(output.size(), size);
+	for(std::size_t n=0; n!=size; ++n)
+	{
+		if(output[n] != stream_byte(n))
+		{
+			BOOST_ERROR("Byte " << n << " of the stream differs");
+			break;
+		}
+	}
+	BOOST_CHECK_EQUAL(alGetError(), AL_NO_ERROR);
+}
+
+BOOST_FIXTURE_TEST_CASE(StreamingSource_looping, StreamingSourceFixture)
+{
+	// the last chunk of every pass is shorter than a buffer
+	const std::size_t size = 2*buffer_size+500;
+	const unsigned passes = 10;
+	oalplus::StreamingSource stream(
+		Decoder(size, true),
+		buffer_count,
+		buffer_size,
+		true
+	);
+	ALuint source = fake_al::LastSource();
+	stream.Play();
+	Pump(stream, buffer_count);
+
+	std::size_t played = 0;
+	while(played < passes*size)
+	{
+		std::size_t step = fake_al::Render(source, 600);
+		BOOST_REQUIRE(step > 0);
+		played += step;
+		Pump(stream, buffer_count);
+	}
+	BOOST_CHECK(!stream.Finished());
+	BOOST_CHECK_EQUAL(stream.Underruns(), 0u);
+	BOOST_CHECK(rewinds.load() >= passes);
+
+	// the passes follow each other without gaps
+	const std::vector<ALubyte>& output = fake_al::Played(source);
+	BOOST_REQUIRE_EQUAL(output.size(), played);
+	for(std::size_t n=0; n!=played; ++n)
+	{
+		if(output[n] != stream_byte(n%size))
+		{
+			BOOST_ERROR("Byte " << n << " of the stream differs");
+			break;
+		}
+	}
+	BOOST_CHECK_EQUAL(alGetError(), AL_NO_ERROR);
+}
+
+BOOST_FIXTURE_TEST_CASE(StreamingSource_no_rewind, StreamingSourceFixture)
+{
+	// looping stops at the end if the decoder cannot rewind
+	const std::size_t size = 2*buffer_size+500;
+	oalplus::StreamingSource stream(
+		Decoder(size, false),
+		buffer_count,
+		buffer_size,
+		true
+	);
+	ALuint source = fake_al::LastSource();
+	stream.Play();
+	Pump(stream, buffer_count);
+
+	std::size_t played = 0;
+	while(played != size)
+	{
+		std::size_t step = fake_al::Render(source, 600);
+		BOOST_REQUIRE(step > 0);
+		played += step;
+		Pump(stream, Expected(size, played));
+	}
+	BOOST_CHECK(stream.Finished());
+	BOOST_CHECK_EQUAL(fake_al::Played(source).size(), size);
+	BOOST_CHECK_EQUAL(alGetError(), AL_NO_ERROR);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,189 @@
+/**
+ *  .file test/oglplus/bitmap_glyph_page_file.cpp
+ *  .brief Test case for the binary bitmap glyph page files.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_BitmapGlyphPageFile
+#include <boost/test/unit_test.hpp>
+
+#include <oglplus/gl.hpp>
+#include <oglplus/text/bitmap_glyph/page_file.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <cstddef>
+#include <cstdio>
+
+BOOST_AUTO_TEST_SUITE(BitmapGlyphPageFile)
+
+typedef oglplus::text::BitmapGlyphPageFile PageFile;
+
+static void make_page(
+	std::vector<GLubyte>& bitmap,
+	std::vector<GLfloat>& metrics,
+	GLuint side,
+	GLuint glyphs
+)
+{
+	bitmap.assign(side*side, 0x00);
+	for(GLuint y=0; y!=side/2; ++y)
+		for(GLuint x=0; x!=side; ++x)
+			bitmap[y*side+x] = GLubyte((x*7+y*3)%5 == 0?0xFF:x);
+
+	metrics.resize(glyphs*12);
+	for(std::size_t i=0; i!=metrics.size(); ++i)
+		metrics[i] = GLfloat(i)*0.25f;
+}
+
+static void check_page(
+	bool compress,
+	const std::vector<GLubyte>& bitmap,
+	const std::vector<GLfloat>& metrics,
+	GLuint side,
+	GLuint glyphs
+)
+{
+	const char* path = "test_bitmap_glyph_page.bgp";
+	{
+		std::ofstream output(path, std::ios::binary);
+		PageFile::Write(
+			output,
+			side, side, 1,
+			GL_RED, GL_R8, GL_UNSIGNED_BYTE,
+			bitmap.data(),
+			bitmap.size(),
+			metrics.data(),
+			glyphs,
+			compress
+		);
+	}
+	{
+		PageFile page(path);
+		BOOST_CHECK_EQUAL(page.GlyphCount(), glyphs);
+		BOOST_CHECK_EQUAL(page.ValuesPerGlyph(), 12u);
+		BOOST_CHECK_EQUAL(page.Width(), GLsizei(side));
+		BOOST_CHECK_EQUAL(page.Height(), GLsizei(side));
+		BOOST_CHECK(page.Format() == oglplus::PixelDataFormat::Red);
+		BOOST_CHECK(page.Type() == oglplus::PixelDataType::UnsignedByte);
+		BOOST_CHECK_EQUAL(page.Compressed(), compress);
+		BOOST_CHECK(std::memcmp(
+			page.Metrics(),
+			metrics.data(),
+			metrics.size()*sizeof(GLfloat)
+		) == 0);
+		BOOST_CHECK(std::memcmp(
+			page.Bitmap(),
+			bitmap.data(),
+			bitmap.size()
+		) == 0);
+	}
+	std::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(BitmapGlyphPageFile_stored)
+{
+	std::vector<GLubyte> bitmap;
+	std::vector<GLfloat> metrics;
+	make_page(bitmap, metrics, 64, 256);
+	check_page(false, bitmap, metrics, 64, 256);
+}
+
+BOOST_AUTO_TEST_CASE(BitmapGlyphPageFile_compressed)
+{
+	std::vector<GLubyte> bitmap;
+	std::vector<GLfloat> metrics;
+	make_page(bitmap, metrics, 128, 256);
+	check_page(true, bitmap, metrics, 128, 256);
+}
+
+BOOST_AUTO_TEST_CASE(BitmapGlyphPageFile_text_metrics)
+{
+	std::stringstream bgm;
+	for(unsigned g=0; g!=2; ++g)
+	{
+		bgm << (65+g) << std::endl;
+		bgm << "0x" << std::hex << (65+g) << std::dec << std::endl;
+		bgm << "'" << char(65+g) << "'" << std::endl;
+		for(unsigned v=0; v!=12; ++v)
+			bgm << (g*12+v)*0.5f << std::endl;
+		bgm << std::endl;
+	}
+	GLfloat metrics[24];
+	oglplus::text::BitmapGlyphReadTextMetrics(bgm, metrics, 2);
+	for(unsigned i=0; i!=24; ++i)
+		BOOST_CHECK_EQUAL(metrics[i], i*0.5f);
+}
+
+BOOST_AUTO_TEST_CASE(BitmapGlyphPageFile_invalid)
+{
+	const char* path = "test_bitmap_glyph_page.bgp";
+	{
+		std::ofstream output(path, std::ios::binary);
+		output << "This is not a glyph page file, but it is long enough"
+			" to hold the header of one. This is not a glyph page.";
+	}
+	BOOST_CHECK_THROW(PageFile page(path), std::runtime_error);
+	std::remove(path);
+}
+
+static void check_corrupted(
+	bool compress,
+	std::size_t offset,
+	GLuint value
+)
+{
+	const char* path = "test_bitmap_glyph_page.bgp";
+	std::vector<GLubyte> bitmap;
+	std::vector<GLfloat> metrics;
+	make_page(bitmap, metrics, 64, 16);
+	{
+		std::ofstream output(path, std::ios::binary);
+		PageFile::Write(
+			output,
+			64, 64, 1,
+			GL_RED, GL_R8, GL_UNSIGNED_BYTE,
+			bitmap.data(),
+			bitmap.size(),
+			metrics.data(),
+			16,
+			compress
+		);
+	}
+	{
+		std::fstream file(path, std::ios::in|std::ios::out|std::ios::binary);
+		file.seekp(std::streamoff(offset));
+		file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+	BOOST_CHECK_THROW(PageFile page(path), std::runtime_error);
+	std::remove(path);
+}
+
+BOOST_AUTO_TEST_CASE(BitmapGlyphPageFile_corrupted)
+{
+	typedef oglplus::text::BitmapGlyphPageFileHeader Header;
+	for(int c=0; c!=2; ++c)
+	{
+		bool compress = (c != 0);
+		// the bitmap data is too small for the dimensions
+		check_corrupted(compress, offsetof(Header, width), 65);
+		check_corrupted(compress, offsetof(Header, height), 4096);
+		check_corrupted(compress, offsetof(Header, channels), 2);
+		check_corrupted(compress, offsetof(Header, type), GL_FLOAT);
+		check_corrupted(compress, offsetof(Header, format), GL_RGBA);
+		// the size of the metric block overflows in 32 bits
+		check_corrupted(compress, offsetof(Header, glyph_count), 0x40000000);
+		check_corrupted(compress, offsetof(Header, values_per_glyph), 16);
+	}
+	check_corrupted(false, offsetof(Header, bitmap_size), 64*64-1);
+	check_corrupted(true, offsetof(Header, bitmap_raw_size), 64*64-1);
+	check_corrupted(false, offsetof(Header, compression), 2);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,92 @@
+/**
+ *  .file test/oglplus/compiled_drawing.cpp
+ *  .brief Test case for the CompiledDrawingInstructions class.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_CompiledDrawing
+#include <boost/test/unit_test.hpp>
+
+#include <oglplus/gl.hpp>
+#include <oglplus/all.hpp>
+#include <oglplus/shapes/spiral_sphere.hpp>
+#include <oglplus/shapes/wicker_torus.hpp>
+#include <oglplus/shapes/cube.hpp>
+
+BOOST_AUTO_TEST_SUITE(CompiledDrawing)
+
+using namespace oglplus;
+
+template <class ShapeBuilder>
+static void check_compiled(const ShapeBuilder& builder)
+{
+	shapes::DrawingInstructions instr = builder.Instructions();
+	shapes::ElementIndexInfo index_info(builder);
+	shapes::CompiledDrawingInstructions compiled(instr, index_info);
+
+	const auto& ops = instr.Operations();
+	const auto& batches = compiled.Batches();
+
+	BOOST_CHECK(!batches.empty());
+	BOOST_CHECK(batches.size() <= ops.size());
+	BOOST_CHECK(compiled.CommandCount() <= ops.size());
+
+	// every operation must be covered by exactly one batch
+	GLuint op_elements = 0;
+	for(auto i=ops.begin(), e=ops.end(); i!=e; ++i)
+		op_elements += i->count;
+
+	std::vector<GLuint> cmds = compiled.IndirectCommands(3, 1);
+	GLuint cmd_elements = 0;
+	std::size_t pos = 0;
+	for(auto b=batches.begin(), e=batches.end(); b!=e; ++b)
+	{
+		BOOST_CHECK_EQUAL(pos*sizeof(GLuint), std::size_t(b->indirect_offset));
+		bool elem = (b->method == ShapeDrawOperationMethod::DrawElements);
+		for(GLsizei c=0; c!=b->draw_count; ++c)
+		{
+			cmd_elements += cmds[pos+0];
+			BOOST_CHECK_EQUAL(cmds[pos+1], 3u);
+			BOOST_CHECK_EQUAL(cmds[pos+(elem?4:3)], 1u);
+			pos += elem?5:4;
+		}
+	}
+	BOOST_CHECK_EQUAL(pos, cmds.size());
+	BOOST_CHECK_EQUAL(op_elements, cmd_elements);
+}
+
+BOOST_AUTO_TEST_CASE(CompiledDrawing_spiral_sphere)
+{
+	shapes::SpiralSphere builder;
+	check_compiled(builder);
+
+	shapes::DrawingInstructions instr = builder.Instructions();
+	shapes::ElementIndexInfo index_info(builder);
+	shapes::CompiledDrawingInstructions compiled(instr, index_info);
+	BOOST_CHECK(instr.Operations().size() > 1);
+	BOOST_CHECK(compiled.Batches().size() < instr.Operations().size());
+}
+
+BOOST_AUTO_TEST_CASE(CompiledDrawing_wicker_torus)
+{
+	check_compiled(shapes::WickerTorus());
+}
+
+BOOST_AUTO_TEST_CASE(CompiledDrawing_cube)
+{
+	shapes::Cube builder;
+	check_compiled(builder);
+
+	shapes::DrawingInstructions instr = builder.Instructions();
+	shapes::ElementIndexInfo index_info(builder);
+	shapes::CompiledDrawingInstructions compiled(instr, index_info);
+	BOOST_CHECK_EQUAL(compiled.Batches().size(), 1u);
+	BOOST_CHECK_EQUAL(compiled.CommandCount(), 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,178 @@
+/**
+ *  .file test/oglplus/cpu_trace.cpp
+ *  .brief Test case for the CPUTrace class.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_CPUTrace
+#include <boost/test/unit_test.hpp>
+
+#define OGLPLUS_CPU_TRACING 1
+#include <oglplus/cpu_trace.hpp>
+
+#include <string>
+#include <sstream>
+#include <cstdlib>
+
+BOOST_AUTO_TEST_SUITE(CPUTracing)
+
+using namespace oglplus;
+
+static const std::size_t capacity = std::size_t(CPUTrace::BufferCapacity);
+
+static std::string write_trace(void)
+{
+	std::ostringstream output;
+	CPUTrace::WriteChromeTrace(output);
+	return output.str();
+}
+
+static std::size_t count(const std::string& str, const std::string& what)
+{
+	std::size_t result = 0;
+	std::size_t pos = str.find(what);
+	while(pos != std::string::npos)
+	{
+		++result;
+		pos = str.find(what, pos+what.size());
+	}
+	return result;
+}
+
+// returns the value of the specified numeric field
+// of the first event with the specified name
+static double field(
+	const std::string& trace,
+	const std::string& name,
+	const std::string& field
+)
+{
+	std::size_t pos = trace.find("{\"name\":\""+name+"\"");
+	BOOST_REQUIRE(pos != std::string::npos);
+	pos = trace.find("\""+field+"\":", pos);
+	BOOST_REQUIRE(pos != std::string::npos);
+	return std::atof(trace.c_str()+pos+field.size()+3);
+}
+
+static void record(const char* name, std::size_t n)
+{
+	for(std::size_t i=0; i!=n; ++i)
+	{
+		CPUTrace::Scope scope(name);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(CPUTrace_format)
+{
+	CPUTrace::Clear();
+	{
+		OGLPLUS_CPU_TRACE_SCOPE("Test::Outer");
+		volatile unsigned sink = 0;
+		for(unsigned i=0; i!=10000; ++i) sink += i;
+		{
+			OGLPLUS_CPU_TRACE_SCOPE("Test::Inner");
+			for(unsigned i=0; i!=10000; ++i) sink += i;
+		}
+	}
+	{
+		OGLPLUS_CPU_TRACE_SCOPE("Test::\"Quoted\\\"");
+	}
+	std::string trace = write_trace();
+
+	BOOST_CHECK_EQUAL(trace.find("{\"traceEvents\":["), 0u);
+	BOOST_CHECK(
+		trace.rfind("],\"displayTimeUnit\":\"ms\"}") !=
+		std::string::npos
+	);
+	BOOST_CHECK_EQUAL(count(trace, "\"ph\":\"M\""), 1u);
+	BOOST_CHECK_EQUAL(count(trace, "\"ph\":\"X\""), 3u);
+	BOOST_CHECK_EQUAL(count(trace, "\"name\":\"Test::Outer\""), 1u);
+	BOOST_CHECK_EQUAL(count(trace, "\"name\":\"Test::Inner\""), 1u);
+	BOOST_CHECK_EQUAL(
+		count(trace, "\"name\":\"Test::\\\"Quoted\\\\\\\"\""),
+		1u
+	);
+
+	// the scopes are written in the order in which they ended
+	BOOST_CHECK(
+		trace.find("Test::Inner") <
+		trace.find("Test::Outer")
+	);
+
+	double outer_ts = field(trace, "Test::Outer", "ts");
+	double outer_dur = field(trace, "Test::Outer", "dur");
+	double inner_ts = field(trace, "Test::Inner", "ts");
+	double inner_dur = field(trace, "Test::Inner", "dur");
+	BOOST_CHECK(outer_ts >= 0.0);
+	BOOST_CHECK(inner_dur >= 0.0);
+	BOOST_CHECK(inner_ts >= outer_ts);
+	BOOST_CHECK(inner_ts+inner_dur <= outer_ts+outer_dur+0.001);
+}
+
+BOOST_AUTO_TEST_CASE(CPUTrace_wrap_around)
+{
+	CPUTrace::Clear();
+	record("Test::Old", 10);
+	record("Test::New", capacity-5);
+	std::string trace = write_trace();
+
+	// only the newest BufferCapacity scopes are kept
+	BOOST_CHECK_EQUAL(count(trace, "\"name\":\"Test::Old\""), 5u);
+	BOOST_CHECK_EQUAL(
+		count(trace, "\"name\":\"Test::New\""),
+		capacity-5
+	);
+
+	record("Test::New", 2*capacity+3);
+	trace = write_trace();
+	BOOST_CHECK_EQUAL(count(trace, "\"name\":\"Test::Old\""), 0u);
+	BOOST_CHECK_EQUAL(
+		count(trace, "\"ph\":\"X\""),
+		capacity
+	);
+}
+
+BOOST_AUTO_TEST_CASE(CPUTrace_clear)
+{
+	record("Test::BeforeClear", 100);
+	CPUTrace::Clear();
+	std::string trace = write_trace();
+	BOOST_CHECK_EQUAL(count(trace, "\"ph\":\"X\""), 0u);
+	// the threads are still listed
+	BOOST_CHECK_EQUAL(count(trace, "\"ph\":\"M\""), 1u);
+
+	record("Test::AfterClear", 3);
+	trace = write_trace();
+	BOOST_CHECK_EQUAL(count(trace, "Test::BeforeClear"), 0u);
+	BOOST_CHECK_EQUAL(count(trace, "\"name\":\"Test::AfterClear\""), 3u);
+
+	// a full ring after Clear
+	CPUTrace::Clear();
+	record("Test::AfterClear", capacity+1);
+	trace = write_trace();
+	BOOST_CHECK_EQUAL(
+		count(trace, "\"ph\":\"X\""),
+		capacity
+	);
+}
+
+BOOST_AUTO_TEST_CASE(CPUTrace_enable)
+{
+	CPUTrace::Clear();
+	CPUTrace::Enable(false);
+	BOOST_CHECK(!CPUTrace::Enabled());
+	record("Test::Disabled", 10);
+	CPUTrace::Enable(true);
+	BOOST_CHECK(CPUTrace::Enabled());
+	record("Test::Enabled", 1);
+	std::string trace = write_trace();
+	BOOST_CHECK_EQUAL(count(trace, "Test::Disabled"), 0u);
+	BOOST_CHECK_EQUAL(count(trace, "\"name\":\"Test::Enabled\""), 1u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,180 @@
+/**
+ *  .file test/oglplus/depth_sort.cpp
+ *  .brief Test case for the DepthSorter class.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_DepthSort
+#include <boost/test/unit_test.hpp>
+
+#include <oglplus/gl.hpp>
+#include <oglplus/all.hpp>
+#include <oglplus/depth_sort.hpp>
+
+#include <vector>
+#include <algorithm>
+#include <cstdlib>
+
+BOOST_AUTO_TEST_SUITE(DepthSort)
+
+using namespace oglplus;
+
+static GLfloat random_value(GLfloat min, GLfloat max)
+{
+	return min+(max-min)*GLfloat(std::rand())/GLfloat(RAND_MAX);
+}
+
+static std::vector<GLfloat> random_points(std::size_t count, GLuint npv)
+{
+	std::vector<GLfloat> result(count*npv);
+	for(std::size_t i=0; i!=result.size(); ++i)
+		result[i] = random_value(-10.0f, 10.0f);
+	return result;
+}
+
+// checks that the order is a permutation sorted by the depths
+static void check_order(
+	const std::vector<GLuint>& order,
+	const std::vector<GLfloat>& depths,
+	bool back_to_front
+)
+{
+	BOOST_CHECK_EQUAL(order.size(), depths.size());
+	std::vector<bool> seen(depths.size(), false);
+	for(std::size_t i=0; i!=order.size(); ++i)
+	{
+		BOOST_REQUIRE(order[i] < depths.size());
+		BOOST_CHECK(!seen[order[i]]);
+		seen[order[i]] = true;
+		if(i == 0) continue;
+		GLfloat a = depths[order[i-1]], b = depths[order[i]];
+		if(back_to_front) BOOST_CHECK(a <= b);
+		else BOOST_CHECK(a >= b);
+	}
+}
+
+static std::vector<GLfloat> view_depths(
+	const Mat4f& camera,
+	const std::vector<GLfloat>& data,
+	GLuint npv,
+	bool spheres
+)
+{
+	std::vector<GLfloat> result(data.size()/npv);
+	for(std::size_t i=0; i!=result.size(); ++i)
+	{
+		const GLfloat* p = data.data()+i*npv;
+		result[i] = (camera*Vec4f(p[0], p[1], p[2], 1.0f)).z();
+		if(spheres) result[i] += p[3];
+	}
+	return result;
+}
+
+BOOST_AUTO_TEST_CASE(DepthSort_points)
+{
+	std::srand(1234);
+	Mat4f camera = CamMatrixf::LookingAt(Vec3f(5, 7, 20), Vec3f(1, 0, 0));
+	std::size_t counts[] = {0, 1, 2, 100, 5000, 300000};
+	for(std::size_t c=0; c!=sizeof(counts)/sizeof(counts[0]); ++c)
+	{
+		std::vector<GLfloat> points = random_points(counts[c], 3);
+		std::vector<GLfloat> depths = view_depths(camera, points, 3, false);
+
+		DepthSorter back_to_front;
+		back_to_front.SortPoints(camera, points.data(), counts[c]);
+		check_order(back_to_front.Order(), depths, true);
+
+		DepthSorter front_to_back(false, 3);
+		front_to_back.SortPoints(camera, points.data(), counts[c]);
+		check_order(front_to_back.Order(), depths, false);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(DepthSort_spheres)
+{
+	std::srand(2345);
+	Mat4f camera = CamMatrixf::LookingAt(Vec3f(-9, 3, 1), Vec3f(0, 1, 0));
+	std::vector<GLfloat> spheres = random_points(1000, 5);
+	for(std::size_t i=0; i!=1000; ++i)
+		spheres[i*5+3] = std::abs(spheres[i*5+3]);
+	DepthSorter sorter;
+	sorter.SortSpheres(camera, spheres.data(), 1000, 5);
+	check_order(sorter.Order(), view_depths(camera, spheres, 5, true), true);
+}
+
+BOOST_AUTO_TEST_CASE(DepthSort_stable)
+{
+	// equal depths keep the order of the elements
+	std::vector<GLfloat> depths(200000);
+	for(std::size_t i=0; i!=depths.size(); ++i)
+		depths[i] = GLfloat(i % 7)-3.0f;
+	DepthSorter sorter(true, 4);
+	const std::vector<GLuint>& order =
+		sorter.SortDepths(depths.data(), depths.size());
+	check_order(order, depths, true);
+	for(std::size_t i=1; i!=order.size(); ++i)
+	{
+		if(depths[order[i-1]] == depths[order[i]])
+			BOOST_CHECK(order[i-1] < order[i]);
+	}
+}
+
+BOOST_AUTO_TEST_CASE(DepthSort_incremental)
+{
+	std::srand(3456);
+	std::vector<Vec3f> points(100000);
+	for(std::size_t i=0; i!=points.size(); ++i)
+	{
+		points[i] = Vec3f(
+			random_value(-10.0f, 10.0f),
+			random_value(-10.0f, 10.0f),
+			random_value(-10.0f, 10.0f)
+		);
+	}
+	Mat4f camera = CamMatrixf::Orbiting(
+		Vec3f(),
+		30.0f,
+		Degrees(30),
+		Degrees(15)
+	);
+	DepthSorter sorter;
+	for(GLuint frame=0; frame!=5; ++frame)
+	{
+		// move some of the points a little
+		for(GLuint i=0; i!=100; ++i)
+		{
+			std::size_t p = std::size_t(std::rand()) % points.size();
+			points[p] += Vec3f(0.0f, 0.0f, random_value(-0.1f, 0.1f));
+		}
+		sorter.SortPoints(camera, points);
+
+		std::vector<GLfloat> depths(points.size());
+		for(std::size_t i=0; i!=points.size(); ++i)
+			depths[i] = (camera*Vec4f(points[i], 1.0f)).z();
+		check_order(sorter.Order(), depths, true);
+		BOOST_CHECK_EQUAL(sorter.WasIncremental(), frame != 0);
+	}
+
+	// a large change of the view falls back to the full sort
+	camera = CamMatrixf::Orbiting(
+		Vec3f(),
+		30.0f,
+		Degrees(180),
+		Degrees(15)
+	);
+	sorter.SortPoints(camera, points);
+	BOOST_CHECK(!sorter.WasIncremental());
+
+	// as does a change of the number of elements
+	points.pop_back();
+	sorter.SortPoints(camera, points);
+	BOOST_CHECK(!sorter.WasIncremental());
+	BOOST_CHECK_EQUAL(sorter.Order().size(), points.size());
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,138 @@
+/**
+ *  .file test/oglplus/gpu_profiler.cpp
+ *  .brief Test case for the GPUProfiler class.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_GPUProfiler
+#include <boost/test/unit_test.hpp>
+
+#include <oglplus/gl.hpp>
+#include <oglplus/gpu_profiler.hpp>
+
+#include "fixture.hpp"
+
+#include <memory>
+#include <string>
+
+BOOST_GLOBAL_FIXTURE(OGLplusTestFixture);
+
+BOOST_AUTO_TEST_SUITE(GPUProfiler)
+
+// returns the number of harvested samples of the scope with the given path
+static unsigned long count_samples(
+	const oglplus::GPUProfiler& profiler,
+	const std::string& path
+)
+{
+	for(auto& stats: profiler.Scopes())
+	{
+		if(stats.path == path) return stats.count;
+	}
+	return 0;
+}
+
+// runs empty frames until all the previous frames are harvested
+static void harvest(oglplus::GPUProfiler& profiler, unsigned long frames)
+{
+	for(unsigned i=0; i!=1000; ++i)
+	{
+		if(profiler.HarvestedFrames()+profiler.DroppedFrames() >= frames)
+			break;
+		glFinish();
+		profiler.BeginFrame();
+		profiler.EndFrame();
+	}
+	BOOST_REQUIRE_EQUAL(profiler.DroppedFrames(), 0u);
+	BOOST_REQUIRE(profiler.HarvestedFrames() >= frames);
+}
+
+BOOST_AUTO_TEST_CASE(GPUProfiler_scopes)
+{
+	oglplus::GPUProfiler profiler(1);
+	profiler.BeginFrame();
+	{
+		oglplus::GPUProfiler::Scope outer(profiler, "Outer");
+		oglplus::GPUProfiler::Scope inner(profiler, "Inner");
+	}
+	profiler.BeginScope("Explicit");
+	profiler.EndScope();
+	profiler.EndFrame();
+	harvest(profiler, 1);
+
+	const std::string frame = profiler.Scopes().front().path;
+	BOOST_CHECK_EQUAL(count_samples(profiler, frame+"/Outer"), 1u);
+	BOOST_CHECK_EQUAL(count_samples(profiler, frame+"/Outer/Inner"), 1u);
+	BOOST_CHECK_EQUAL(count_samples(profiler, frame+"/Explicit"), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(GPUProfiler_scope_outlives_frame)
+{
+	oglplus::GPUProfiler profiler(1);
+	std::unique_ptr<oglplus::GPUProfiler::Scope> outer;
+	std::unique_ptr<oglplus::GPUProfiler::Scope> nested;
+
+	profiler.BeginFrame();
+	outer.reset(new oglplus::GPUProfiler::Scope(profiler, "Outer"));
+	nested.reset(new oglplus::GPUProfiler::Scope(profiler, "Nested"));
+	// ends the open scopes together with the frame
+	profiler.EndFrame();
+	// the scopes of the ended frame do not end anything
+	nested.reset();
+
+	profiler.BeginFrame();
+	{
+		oglplus::GPUProfiler::Scope next(profiler, "Next");
+		// must end neither the scope of this frame nor the frame
+		outer.reset();
+		oglplus::GPUProfiler::Scope inner(profiler, "Inner");
+	}
+	profiler.EndFrame();
+
+	// the scopes were ended after the last frame
+	profiler.BeginFrame();
+	outer.reset(new oglplus::GPUProfiler::Scope(profiler, "Outer"));
+	profiler.EndFrame();
+	outer.reset();
+	harvest(profiler, 3);
+
+	const std::string frame = profiler.Scopes().front().path;
+	BOOST_CHECK(profiler.Scopes().front().count >= 3u);
+	BOOST_CHECK_EQUAL(count_samples(profiler, frame+"/Outer"), 2u);
+	BOOST_CHECK_EQUAL(count_samples(profiler, frame+"/Outer/Nested"), 1u);
+	BOOST_CHECK_EQUAL(count_samples(profiler, frame+"/Next"), 1u);
+	BOOST_CHECK_EQUAL(count_samples(profiler, frame+"/Next/Inner"), 1u);
+	BOOST_CHECK_EQUAL(count_samples(profiler, frame+"/Inner"), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(GPUProfiler_scope_ended_early)
+{
+	oglplus::GPUProfiler profiler(1);
+	profiler.BeginFrame();
+	{
+		oglplus::GPUProfiler::Scope first(profiler, "First");
+		// ends the first scope explicitly
+		profiler.EndScope();
+		// the destructor of first must not end the second scope
+		profiler.BeginScope("Second");
+	}
+	{
+		oglplus::GPUProfiler::Scope third(profiler, "Third");
+	}
+	profiler.EndScope();
+	profiler.EndFrame();
+	harvest(profiler, 1);
+
+	const std::string frame = profiler.Scopes().front().path;
+	BOOST_CHECK_EQUAL(count_samples(profiler, frame+"/First"), 1u);
+	BOOST_CHECK_EQUAL(count_samples(profiler, frame+"/Second"), 1u);
+	BOOST_CHECK_EQUAL(count_samples(profiler, frame+"/Second/Third"), 1u);
+	BOOST_CHECK_EQUAL(count_samples(profiler, frame+"/Third"), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
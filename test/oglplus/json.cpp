@@ -0,0 +1,60 @@
+/**
+ *  .file test/oglplus/json.cpp
+ *  .brief Test case for the JSON output helpers.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_JSON
+#include <boost/test/unit_test.hpp>
+
+#include <oglplus/auxiliary/json.hpp>
+
+#include <sstream>
+#include <string>
+
+BOOST_AUTO_TEST_SUITE(JSON)
+
+static std::string json_string(const std::string& str)
+{
+	std::stringstream output;
+	oglplus::aux::WriteJSONString(output, str);
+	return output.str();
+}
+
+BOOST_AUTO_TEST_CASE(JSON_plain_string)
+{
+	BOOST_CHECK_EQUAL(json_string(""), "\"\"");
+	BOOST_CHECK_EQUAL(json_string("Frame/Scene"), "\"Frame/Scene\"");
+	// UTF-8 sequences are written unchanged
+	BOOST_CHECK_EQUAL(json_string("\xc5\xa1"), "\"\xc5\xa1\"");
+}
+
+BOOST_AUTO_TEST_CASE(JSON_escaped_string)
+{
+	BOOST_CHECK_EQUAL(json_string("a\"b\\c"), "\"a\\\"b\\\\c\"");
+	BOOST_CHECK_EQUAL(
+		json_string("\b\f\n\r\t"),
+		"\"\\b\\f\\n\\r\\t\""
+	);
+	// the other control characters are escaped by their code
+	BOOST_CHECK_EQUAL(json_string("\x01\x1f"), "\"\\u0001\\u001f\"");
+	BOOST_CHECK_EQUAL(
+		json_string(std::string("a\0b", 3)),
+		"\"a\\u0000b\""
+	);
+}
+
+BOOST_AUTO_TEST_CASE(JSON_c_string)
+{
+	std::stringstream output;
+	oglplus::aux::WriteJSONString(output, "x\ty");
+	oglplus::aux::WriteJSONString(output, (const char*)nullptr);
+	BOOST_CHECK_EQUAL(output.str(), "\"x\\ty\"\"\"");
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,190 @@
+/**
+ *  .file test/oglplus/khr_debug_async.cpp
+ *  .brief Test case for the KHR_debug_Async debug output filter.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_KHR_debug_Async
+#include <boost/test/unit_test.hpp>
+
+#include <oglplus/gl.hpp>
+#include <oglplus/all.hpp>
+#include <oglplus/ext/KHR_debug.hpp>
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdio>
+
+BOOST_AUTO_TEST_SUITE(KHR_debug_Async)
+
+using namespace oglplus;
+
+#if GL_KHR_debug && !OGLPLUS_NO_THREADS
+
+// collects the messages passed on by the background thread
+struct AsyncDebugLog
+{
+	std::mutex mutex;
+	std::condition_variable cv;
+	std::vector<std::string> messages;
+	// if set, the callback blocks until it is cleared
+	bool blocked;
+
+	AsyncDebugLog(void)
+	 : blocked(false)
+	{ }
+
+	KHR_debug::Callback Callback(void)
+	{
+		return [this](const KHR_debug::CallbackData& data)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			messages.push_back(std::string(data.message, data.length));
+			cv.notify_all();
+			while(blocked) cv.wait(lock);
+		};
+	}
+
+	void WaitFor(std::size_t count)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		while(messages.size() < count) cv.wait(lock);
+	}
+
+	void Unblock(void)
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		blocked = false;
+		cv.notify_all();
+	}
+};
+
+static void send_message(
+	KHR_debug_AsyncEssence& async,
+	GLuint id,
+	const char* text
+)
+{
+	KHR_debug::CallbackData data;
+	data.source = DebugSource::Application;
+	data.type = DebugType::Other;
+	data.id = id;
+	data.severity = DebugSeverity::Low;
+	data.length = -1;
+	data.message = text;
+	async.Call(data);
+}
+
+static void send_numbered(KHR_debug_AsyncEssence& async, GLuint n)
+{
+	char text[32];
+	std::snprintf(text, sizeof(text), "message %u", n);
+	send_message(async, n, text);
+}
+
+BOOST_AUTO_TEST_CASE(KHR_debug_Async_drop)
+{
+	AsyncDebugLog log;
+	log.blocked = true;
+	{
+		KHR_debug_AsyncEssence async(log.Callback(), 4, 64, 0, 0);
+
+		// the background thread blocks in the callback on the first
+		// message, whose slot stays taken until the callback returns
+		send_numbered(async, 0);
+		log.WaitFor(1);
+
+		for(GLuint n=1; n!=11; ++n)
+			send_numbered(async, n);
+
+		BOOST_CHECK_EQUAL(async.Received(), 11ul);
+		BOOST_CHECK_EQUAL(async.Dropped(), 7ul);
+		BOOST_CHECK_EQUAL(async.Repeated(), 0ul);
+
+		log.Unblock();
+	}
+	BOOST_REQUIRE_EQUAL(log.messages.size(), 4u);
+	BOOST_CHECK_EQUAL(log.messages[0], "message 0");
+	BOOST_CHECK_EQUAL(log.messages[1], "message 1");
+	BOOST_CHECK_EQUAL(log.messages[2], "message 2");
+	BOOST_CHECK_EQUAL(log.messages[3], "message 3");
+}
+
+BOOST_AUTO_TEST_CASE(KHR_debug_Async_dedup)
+{
+	AsyncDebugLog log;
+	{
+		KHR_debug_AsyncEssence async(log.Callback(), 16, 64, 64, 0);
+
+		for(unsigned i=0; i!=5; ++i)
+			send_message(async, 1, "repeated message");
+		// the same text with another id is a different message
+		send_message(async, 2, "repeated message");
+		// and so is another text with the same id
+		send_message(async, 1, "another message");
+		send_message(async, 1, "another message");
+
+		BOOST_CHECK_EQUAL(async.Received(), 8ul);
+		BOOST_CHECK_EQUAL(async.Repeated(), 5ul);
+		BOOST_CHECK_EQUAL(async.Dropped(), 0ul);
+	}
+	BOOST_REQUIRE_EQUAL(log.messages.size(), 3u);
+	BOOST_CHECK_EQUAL(log.messages[0], "repeated message");
+	BOOST_CHECK_EQUAL(log.messages[1], "repeated message");
+	BOOST_CHECK_EQUAL(log.messages[2], "another message");
+}
+
+BOOST_AUTO_TEST_CASE(KHR_debug_Async_rate_limit)
+{
+	AsyncDebugLog log;
+	{
+		KHR_debug_AsyncEssence async(log.Callback(), 16, 64, 0, 3);
+
+		for(GLuint n=0; n!=10; ++n)
+			send_numbered(async, n);
+		// wait until the background thread has drained the ring
+		while(async.Limited() < 7) std::this_thread::yield();
+		BOOST_CHECK_EQUAL(async.Limited(), 7ul);
+	}
+	// the summary is reported on destruction at the latest
+	BOOST_REQUIRE_EQUAL(log.messages.size(), 4u);
+	BOOST_CHECK_EQUAL(log.messages[0], "message 0");
+	BOOST_CHECK_EQUAL(log.messages[1], "message 1");
+	BOOST_CHECK_EQUAL(log.messages[2], "message 2");
+	BOOST_CHECK_EQUAL(
+		log.messages[3],
+		"7 debug message(s) discarded by the rate limit"
+	);
+}
+
+BOOST_AUTO_TEST_CASE(KHR_debug_Async_drain)
+{
+	AsyncDebugLog log;
+	const GLuint count = 200;
+	{
+		KHR_debug_AsyncEssence async(log.Callback(), 256, 64, 0, 0);
+		for(GLuint n=0; n!=count; ++n)
+			send_numbered(async, n);
+		BOOST_CHECK_EQUAL(async.Dropped(), 0ul);
+		// destroyed without waiting for the background thread
+	}
+	BOOST_REQUIRE_EQUAL(log.messages.size(), std::size_t(count));
+	for(GLuint n=0; n!=count; ++n)
+	{
+		char text[32];
+		std::snprintf(text, sizeof(text), "message %u", n);
+		BOOST_CHECK_EQUAL(log.messages[n], text);
+	}
+}
+
+#endif // GL_KHR_debug && !OGLPLUS_NO_THREADS
+
+BOOST_AUTO_TEST_SUITE_END()
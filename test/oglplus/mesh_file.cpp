@@ -0,0 +1,272 @@
+/**
+ *  .file test/oglplus/mesh_file.cpp
+ *  .brief Test case for the binary mesh cache files.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_MeshFile
+#include <boost/test/unit_test.hpp>
+
+#include <oglplus/gl.hpp>
+#include <oglplus/all.hpp>
+#include <oglplus/shapes/mesh_file.hpp>
+#include <oglplus/shapes/obj_mesh.hpp>
+#include <oglplus/shapes/sphere.hpp>
+#include <oglplus/shapes/cube.hpp>
+
+#include <fstream>
+#include <sstream>
+#include <cstddef>
+#include <cstdio>
+
+BOOST_AUTO_TEST_SUITE(MeshFile)
+
+using namespace oglplus;
+
+static const char* mesh_path = "test_mesh_file.omc";
+
+template <typename T>
+static void check_attrib(
+	const std::vector<T>& expected,
+	GLuint expected_npv,
+	const shapes::MeshFile& file,
+	GLuint (shapes::MeshFile::*getter)(std::vector<GLfloat>&) const
+)
+{
+	std::vector<GLfloat> actual;
+	BOOST_CHECK_EQUAL((file.*getter)(actual), expected_npv);
+	BOOST_CHECK_EQUAL(actual.size(), expected.size());
+	for(std::size_t i=0; i!=actual.size(); ++i)
+		BOOST_CHECK_EQUAL(actual[i], GLfloat(expected[i]));
+}
+
+template <class ShapeBuilder>
+static void check_mesh_file(const ShapeBuilder& builder)
+{
+	{
+		std::ofstream output(mesh_path, std::ios::binary);
+		shapes::MeshFile::Write(output, builder, 123, 456);
+	}
+	shapes::MeshFile file(mesh_path);
+	BOOST_CHECK(file.Matches(123, 456));
+	BOOST_CHECK(!file.Matches(123, 457));
+	BOOST_CHECK(!file.Matches(124, 456));
+	BOOST_CHECK(file.FaceWinding() == builder.FaceWinding());
+
+	std::vector<GLfloat> values;
+	GLuint npv;
+	npv = builder.Positions(values);
+	check_attrib(values, npv, file, &shapes::MeshFile::Positions);
+	npv = builder.Normals(values);
+	check_attrib(values, npv, file, &shapes::MeshFile::Normals);
+	npv = builder.TexCoordinates(values);
+	check_attrib(values, npv, file, &shapes::MeshFile::TexCoordinates);
+
+	// the attributes not provided by the builder are missing
+	BOOST_CHECK_EQUAL(file.MaterialNumbers(values), 0u);
+	BOOST_CHECK(values.empty());
+	GLuint count = 0;
+	BOOST_CHECK(file.AttribValues("Material", npv, count) == nullptr);
+	BOOST_CHECK(file.AttribValues("Position", npv, count) != nullptr);
+	BOOST_CHECK_EQUAL(npv, 3u);
+
+	auto expected_indices = builder.Indices();
+	auto indices = file.Indices();
+	BOOST_CHECK_EQUAL(indices.size(), expected_indices.size());
+	BOOST_CHECK_EQUAL(file.IndexCount(), expected_indices.size());
+	BOOST_CHECK(std::equal(
+		indices.begin(),
+		indices.end(),
+		expected_indices.begin()
+	));
+
+	auto expected_instr = builder.Instructions();
+	auto instr = file.Instructions();
+	const auto& expected_ops = expected_instr.Operations();
+	const auto& ops = instr.Operations();
+	BOOST_CHECK_EQUAL(ops.size(), expected_ops.size());
+	for(std::size_t o=0; o!=ops.size(); ++o)
+	{
+		BOOST_CHECK(ops[o].method == expected_ops[o].method);
+		BOOST_CHECK(ops[o].mode == expected_ops[o].mode);
+		BOOST_CHECK_EQUAL(ops[o].first, expected_ops[o].first);
+		BOOST_CHECK_EQUAL(ops[o].count, expected_ops[o].count);
+		BOOST_CHECK_EQUAL(
+			ops[o].restart_index,
+			expected_ops[o].restart_index
+		);
+		BOOST_CHECK_EQUAL(ops[o].phase, expected_ops[o].phase);
+	}
+
+	Vec4f expected_bs, bs;
+	builder.BoundingSphere(expected_bs);
+	file.BoundingSphere(bs);
+	BOOST_CHECK(expected_bs == bs);
+	BOOST_CHECK_EQUAL(file.MeshCount(), 0u);
+}
+
+BOOST_AUTO_TEST_CASE(MeshFile_sphere)
+{
+	check_mesh_file(shapes::Sphere(1.5, 36, 18));
+	std::remove(mesh_path);
+}
+
+BOOST_AUTO_TEST_CASE(MeshFile_cube)
+{
+	check_mesh_file(shapes::Cube(1.0, 2.0, 3.0));
+	std::remove(mesh_path);
+}
+
+BOOST_AUTO_TEST_CASE(MeshFile_obj_mesh)
+{
+	std::string obj =
+		"o first\n"
+		"v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+		"f 1 2 3\n"
+		"o second\n"
+		"v 0 0 1\nv 1 0 1\nv 0 1 1\n"
+		"f 4 5 6\n";
+	std::stringstream input(obj);
+	auto options = shapes::ObjMesh::LoadingOptions(false);
+	shapes::ObjMesh mesh(input, options);
+
+	std::stringstream source(obj);
+	auto source_hash = shapes::MeshFile::Hash(source);
+	BOOST_CHECK_EQUAL(source_hash, shapes::MeshFile::Hash(obj));
+	auto options_hash = shapes::MeshFile::Hash("nothing");
+	{
+		std::ofstream output(mesh_path, std::ios::binary);
+		shapes::MeshFile::Write(
+			output,
+			mesh,
+			source_hash,
+			options_hash,
+			mesh.MeshNames()
+		);
+	}
+	BOOST_CHECK(shapes::MeshFile::UpToDate(
+		mesh_path,
+		source_hash,
+		options_hash
+	));
+	BOOST_CHECK(!shapes::MeshFile::UpToDate(
+		mesh_path,
+		shapes::MeshFile::Hash(obj+"\n"),
+		options_hash
+	));
+	BOOST_CHECK(shapes::MeshFile::HashFile(mesh_path) != source_hash);
+
+	shapes::MeshFile file(mesh_path);
+	BOOST_CHECK_EQUAL(file.MeshCount(), 2u);
+	BOOST_CHECK(file.MeshNames() == mesh.MeshNames());
+	BOOST_CHECK_EQUAL(file.GetMeshIndex("second"), 1u);
+	GLuint index;
+	BOOST_CHECK(!file.QueryMeshIndex("third", index));
+	BOOST_CHECK_THROW(file.GetMeshIndex("third"), std::runtime_error);
+
+	std::vector<GLfloat> positions;
+	BOOST_CHECK_EQUAL(file.Positions(positions), 3u);
+	BOOST_CHECK_EQUAL(positions.size(), 3u*6u);
+	BOOST_CHECK_EQUAL(file.Instructions().Operations().size(), 2u);
+	std::remove(mesh_path);
+}
+
+BOOST_AUTO_TEST_CASE(MeshFile_invalid)
+{
+	BOOST_CHECK(!shapes::MeshFile::UpToDate("no_such_file.omc", 0, 0));
+	{
+		std::ofstream output(mesh_path, std::ios::binary);
+		output << "This is not a mesh cache file, but it is long enough"
+			" to hold the header of one. This is not a mesh cache.";
+	}
+	BOOST_CHECK_THROW(shapes::MeshFile file(mesh_path), std::runtime_error);
+	BOOST_CHECK(!shapes::MeshFile::UpToDate(mesh_path, 0, 0));
+
+	// a truncated file
+	{
+		std::ofstream output(mesh_path, std::ios::binary);
+		shapes::MeshFile::Write(output, shapes::Cube(), 1, 2);
+	}
+	std::string data;
+	{
+		std::ifstream input(mesh_path, std::ios::binary);
+		input.seekg(0, std::ios::end);
+		data.resize(std::size_t(input.tellg())-4);
+		input.seekg(0, std::ios::beg);
+		input.read(&data[0], data.size());
+	}
+	{
+		std::ofstream output(mesh_path, std::ios::binary);
+		output.write(data.data(), data.size());
+	}
+	BOOST_CHECK_THROW(shapes::MeshFile file(mesh_path), std::runtime_error);
+	std::remove(mesh_path);
+}
+
+// writes a mesh with names, changes a value at the offset and checks
+// that the file is rejected
+static void check_corrupted(
+	std::size_t offset,
+	GLuint value,
+	bool operation = false
+)
+{
+	std::string obj =
+		"o first\n"
+		"v 0 0 0\nv 1 0 0\nv 0 1 0\n"
+		"f 1 2 3\n"
+		"o second\n"
+		"v 0 0 1\nv 1 0 1\nv 0 1 1\n"
+		"f 4 5 6\n";
+	std::stringstream input(obj);
+	auto options = shapes::ObjMesh::LoadingOptions(false);
+	shapes::ObjMesh mesh(input, options);
+	{
+		std::ofstream output(mesh_path, std::ios::binary);
+		shapes::MeshFile::Write(output, mesh, 1, 2, mesh.MeshNames());
+	}
+	{
+		std::fstream file(
+			mesh_path,
+			std::ios::in|std::ios::out|std::ios::binary
+		);
+		shapes::MeshFileHeader header;
+		file.read(reinterpret_cast<char*>(&header), sizeof(header));
+		// the offset is relative to the second operation
+		if(operation)
+		{
+			offset += header.operation_offset+
+				sizeof(shapes::MeshFileOperation);
+		}
+		file.seekp(std::streamoff(offset));
+		file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	}
+	BOOST_CHECK_THROW(shapes::MeshFile file(mesh_path), std::runtime_error);
+	std::remove(mesh_path);
+}
+
+BOOST_AUTO_TEST_CASE(MeshFile_corrupted)
+{
+	typedef shapes::MeshFileHeader Header;
+	typedef shapes::MeshFileOperation Operation;
+	// the operation draws past the vertices
+	check_corrupted(offsetof(Operation, first), 4, true);
+	check_corrupted(offsetof(Operation, count), 4, true);
+	// the operation draws past the indices (the mesh has none)
+	check_corrupted(offsetof(Operation, method), 1, true);
+	// the end of the operation overflows in 32 bits
+	check_corrupted(offsetof(Operation, first), 0xFFFFFFFF, true);
+	check_corrupted(offsetof(Operation, method), 2, true);
+	// there are fewer names than the count or they are not terminated
+	check_corrupted(offsetof(Header, name_count), 3);
+	check_corrupted(offsetof(Header, name_size), 8);
+	// the size of the index block overflows in 32 bits
+	check_corrupted(offsetof(Header, index_count), 0x40000000);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,159 @@
+/**
+ *  .file test/oglplus/meshlets.cpp
+ *  .brief Test case for the shapes::Meshlets class.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_Meshlets
+#include <boost/test/unit_test.hpp>
+
+#include <oglplus/gl.hpp>
+#include <oglplus/all.hpp>
+#include <oglplus/shapes/meshlets.hpp>
+#include <oglplus/shapes/sphere.hpp>
+#include <oglplus/shapes/torus.hpp>
+
+#include <algorithm>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(Meshlets)
+
+using namespace oglplus;
+
+template <class ShapeBuilder>
+static void check_meshlets(const ShapeBuilder& builder)
+{
+	shapes::Meshlets meshlets(builder, 64, 124);
+	BOOST_CHECK(meshlets.Count() > 0);
+
+	std::vector<GLfloat> positions;
+	GLuint npv = builder.Positions(positions);
+
+	// every triangle of the shape is in exactly one meshlet
+	auto shape_indices = builder.Indices();
+	std::vector<GLuint> indices(shape_indices.begin(), shape_indices.end());
+	std::vector<GLuint> triangles;
+	shapes::MakeTriangleList(builder.Instructions(), indices, triangles);
+
+	const auto& meshlet_indices = meshlets.Indices();
+	BOOST_CHECK_EQUAL(meshlet_indices.size(), triangles.size());
+
+	std::vector<std::vector<GLuint> > expected, actual;
+	for(std::size_t t=0; t<triangles.size(); t+=3)
+	{
+		expected.push_back(std::vector<GLuint>(
+			triangles.begin()+t,
+			triangles.begin()+t+3
+		));
+		actual.push_back(std::vector<GLuint>(
+			meshlet_indices.begin()+t,
+			meshlet_indices.begin()+t+3
+		));
+	}
+	std::sort(expected.begin(), expected.end());
+	std::sort(actual.begin(), actual.end());
+	BOOST_CHECK(expected == actual);
+
+	GLuint triangle_offset = 0;
+	for(GLuint i=0; i!=meshlets.Count(); ++i)
+	{
+		const shapes::Meshlet& m = meshlets.Get(i);
+		BOOST_CHECK(m.vertex_count <= 64);
+		BOOST_CHECK(m.triangle_count <= 124);
+		BOOST_CHECK(m.triangle_count > 0);
+		BOOST_CHECK_EQUAL(m.triangle_offset, triangle_offset);
+		triangle_offset += m.triangle_count;
+
+		for(GLuint t=0; t!=m.triangle_count*3; ++t)
+		{
+			GLuint l = meshlets.Triangles()[m.triangle_offset*3+t];
+			BOOST_CHECK(l < m.vertex_count);
+			GLuint v = meshlets.Vertices()[m.vertex_offset+l];
+			BOOST_CHECK_EQUAL(v, meshlet_indices[m.triangle_offset*3+t]);
+
+			// the vertex is inside of the bounding sphere
+			GLfloat d = 0.0f;
+			for(GLuint c=0; c!=3; ++c)
+			{
+				GLfloat x = positions[v*npv+c]-m.center[c];
+				d += x*x;
+			}
+			BOOST_CHECK(std::sqrt(d) <= m.radius*1.001f+1e-5f);
+		}
+	}
+	BOOST_CHECK_EQUAL(triangle_offset*3, meshlet_indices.size());
+
+	// all meshlets are drawn by a single operation
+	BOOST_CHECK_EQUAL(meshlets.Instructions().Operations().size(), 1u);
+	std::vector<GLuint> all(meshlets.Count());
+	for(GLuint i=0; i!=meshlets.Count(); ++i) all[i] = i;
+	BOOST_CHECK_EQUAL(meshlets.Instructions(all).Operations().size(), 1u);
+	BOOST_CHECK_EQUAL(meshlets.IndirectCommands(all).size(), 5u);
+}
+
+BOOST_AUTO_TEST_CASE(Meshlets_sphere)
+{
+	check_meshlets(shapes::Sphere(1.0, 72, 48));
+}
+
+BOOST_AUTO_TEST_CASE(Meshlets_torus)
+{
+	check_meshlets(shapes::Torus(1.0, 0.5, 72, 48));
+}
+
+BOOST_AUTO_TEST_CASE(Meshlets_culling)
+{
+	shapes::Sphere sphere(1.0, 72, 48);
+	shapes::Meshlets meshlets(sphere);
+
+	std::vector<GLfloat> positions;
+	GLuint npv = sphere.Positions(positions);
+
+	Vec3f camera_position(0.0f, 0.0f, 4.0f);
+	Mat4f camera =
+		CamMatrixf::PerspectiveX(Degrees(60), 1.0f, 1.0f, 100.0f)*
+		CamMatrixf::LookingAt(camera_position, Vec3f());
+
+	std::vector<GLuint> visible;
+	GLuint count = meshlets.Cull(camera, camera_position, visible);
+	BOOST_CHECK_EQUAL(count, visible.size());
+	BOOST_CHECK(count > 0);
+	// about a half of the sphere is facing away from the camera
+	BOOST_CHECK(count < meshlets.Count()*3/4);
+
+	// the culled meshlets are really back-facing
+	std::vector<bool> is_visible(meshlets.Count(), false);
+	for(auto i=visible.begin(), e=visible.end(); i!=e; ++i)
+		is_visible[*i] = true;
+	const auto& indices = meshlets.Indices();
+	for(GLuint i=0; i!=meshlets.Count(); ++i)
+	{
+		if(is_visible[i]) continue;
+		const shapes::Meshlet& m = meshlets.Get(i);
+		for(GLuint t=0; t!=m.triangle_count; ++t)
+		{
+			Vec3f p[3];
+			for(GLuint k=0; k!=3; ++k)
+			{
+				GLuint v = indices[(m.triangle_offset+t)*3+k];
+				p[k] = Vec3f(positions.data()+v*npv, 3);
+			}
+			Vec3f n = Cross(p[1]-p[0], p[2]-p[0]);
+			BOOST_CHECK(Dot(p[0]-camera_position, n) >= -1e-5f);
+		}
+	}
+
+	// nothing is visible if the camera looks away
+	visible.clear();
+	Mat4f away =
+		CamMatrixf::PerspectiveX(Degrees(60), 1.0f, 1.0f, 100.0f)*
+		CamMatrixf::LookingAt(camera_position, Vec3f(0.0f, 0.0f, 8.0f));
+	BOOST_CHECK_EQUAL(meshlets.Cull(away, camera_position, visible), 0u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
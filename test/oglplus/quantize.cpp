@@ -0,0 +1,66 @@
+/**
+ *  .file test/oglplus/quantize.cpp
+ *  .brief Test case for the vertex attribute quantization functions.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_Quantize
+#include <boost/test/unit_test.hpp>
+
+#include <oglplus/gl.hpp>
+#include <oglplus/auxiliary/quantize.hpp>
+
+#include <cmath>
+
+BOOST_AUTO_TEST_SUITE(Quantize)
+
+using namespace oglplus::aux;
+
+BOOST_AUTO_TEST_CASE(Quantize_half_exact)
+{
+	const GLfloat values[] = {
+		0.0f, 1.0f, -1.0f, 0.5f, -2.5f, 1024.0f, 65504.0f
+	};
+	for(GLfloat v : values)
+	{
+		BOOST_CHECK_EQUAL(HalfToFloat(FloatToHalf(v)), v);
+	}
+	BOOST_CHECK_EQUAL(FloatToHalf(1.0f), 0x3C00);
+	BOOST_CHECK_EQUAL(FloatToHalf(-2.0f), 0xC000);
+}
+
+BOOST_AUTO_TEST_CASE(Quantize_half_rounding)
+{
+	for(GLfloat v = -8.0f; v <= 8.0f; v += 0.0137f)
+	{
+		GLfloat r = HalfToFloat(FloatToHalf(v));
+		BOOST_CHECK(std::fabs(r - v) <= std::fabs(v)/1024.0f + 1e-7f);
+	}
+	// overflow to infinity and underflow to zero
+	BOOST_CHECK_EQUAL(FloatToHalf(1e6f), 0x7C00);
+	BOOST_CHECK_EQUAL(FloatToHalf(1e-9f), 0x0000);
+	// denormalized values
+	GLfloat d = HalfToFloat(FloatToHalf(1e-5f));
+	BOOST_CHECK(std::fabs(d - 1e-5f) < 1e-7f);
+}
+
+BOOST_AUTO_TEST_CASE(Quantize_2_10_10_10)
+{
+	BOOST_CHECK_EQUAL(FloatToSNorm( 1.0f, 10),  511);
+	BOOST_CHECK_EQUAL(FloatToSNorm(-1.0f, 10), -511);
+	BOOST_CHECK_EQUAL(FloatToSNorm( 2.0f, 10),  511);
+	BOOST_CHECK_EQUAL(FloatToSNorm( 0.0f, 10),  0);
+
+	BOOST_CHECK_EQUAL(PackInt2_10_10_10Rev(0, 0, 0, 0), 0u);
+	BOOST_CHECK_EQUAL(
+		PackInt2_10_10_10Rev(1.0f, -1.0f, 0.0f, 1.0f),
+		0x400805FFu
+	);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
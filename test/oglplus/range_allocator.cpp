@@ -0,0 +1,131 @@
+/**
+ *  .file test/oglplus/range_allocator.cpp
+ *  .brief Test case for the RangeAllocator class.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_RangeAllocator
+#include <boost/test/unit_test.hpp>
+
+#include <oglplus/auxiliary/range_allocator.hpp>
+
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(RangeAllocator)
+
+typedef oglplus::aux::RangeAllocator Allocator;
+
+BOOST_AUTO_TEST_CASE(RangeAllocator_allocate)
+{
+	Allocator alloc(100);
+	std::size_t a = 0, b = 0, c = 0;
+
+	BOOST_CHECK(alloc.Allocate(10, a));
+	BOOST_CHECK(alloc.Allocate(20, b));
+	BOOST_CHECK(alloc.Allocate(70, c));
+	BOOST_CHECK_EQUAL(a, 0u);
+	BOOST_CHECK_EQUAL(b, 10u);
+	BOOST_CHECK_EQUAL(c, 30u);
+	BOOST_CHECK_EQUAL(alloc.Free(), 0u);
+
+	std::size_t d = 0;
+	BOOST_CHECK(!alloc.Allocate(1, d));
+}
+
+BOOST_AUTO_TEST_CASE(RangeAllocator_best_fit)
+{
+	Allocator alloc(100);
+	std::size_t o[5];
+	for(std::size_t i=0; i!=5; ++i)
+		BOOST_CHECK(alloc.Allocate(20, o[i]));
+	// leave free holes of size 20 at 20 and 60
+	alloc.Deallocate(o[1], 20);
+	alloc.Deallocate(o[3], 20);
+	BOOST_CHECK_EQUAL(alloc.FreeRangeCount(), 2u);
+	BOOST_CHECK_EQUAL(alloc.LargestFree(), 20u);
+	BOOST_CHECK_CLOSE(alloc.Fragmentation(), 0.5, 0.0001);
+
+	std::size_t x = 0;
+	BOOST_CHECK(!alloc.Allocate(30, x));
+	BOOST_CHECK(alloc.Allocate(15, x));
+	BOOST_CHECK_EQUAL(x, 20u);
+	std::size_t y = 0;
+	BOOST_CHECK(alloc.Allocate(20, y));
+	BOOST_CHECK_EQUAL(y, 60u);
+}
+
+BOOST_AUTO_TEST_CASE(RangeAllocator_merge)
+{
+	Allocator alloc(90);
+	std::size_t a = 0, b = 0, c = 0;
+	alloc.Allocate(30, a);
+	alloc.Allocate(30, b);
+	alloc.Allocate(30, c);
+
+	alloc.Deallocate(a, 30);
+	alloc.Deallocate(c, 30);
+	BOOST_CHECK_EQUAL(alloc.FreeRangeCount(), 2u);
+	alloc.Deallocate(b, 30);
+	BOOST_CHECK_EQUAL(alloc.FreeRangeCount(), 1u);
+	BOOST_CHECK_EQUAL(alloc.LargestFree(), 90u);
+	BOOST_CHECK(alloc.Empty());
+}
+
+struct TestMover
+{
+	std::vector<std::size_t>* moves;
+
+	void operator()(std::size_t o, std::size_t n, std::size_t s) const
+	{
+		moves->push_back(o);
+		moves->push_back(n);
+		moves->push_back(s);
+	}
+};
+
+BOOST_AUTO_TEST_CASE(RangeAllocator_compact)
+{
+	Allocator alloc(100);
+	std::size_t o[5];
+	for(std::size_t i=0; i!=5; ++i)
+		alloc.Allocate(20, o[i]);
+	alloc.Deallocate(o[1], 20);
+	alloc.Deallocate(o[3], 20);
+
+	std::vector<std::size_t> moves;
+	TestMover mover = { &moves };
+	BOOST_CHECK_EQUAL(alloc.Compact(mover), 40u);
+	BOOST_CHECK_EQUAL(moves.size(), 6u);
+	// 40-60 -> 20-40
+	BOOST_CHECK_EQUAL(moves[0], 40u);
+	BOOST_CHECK_EQUAL(moves[1], 20u);
+	BOOST_CHECK_EQUAL(moves[2], 20u);
+	// 80-100 -> 40-60
+	BOOST_CHECK_EQUAL(moves[3], 80u);
+	BOOST_CHECK_EQUAL(moves[4], 40u);
+	BOOST_CHECK_EQUAL(moves[5], 20u);
+
+	BOOST_CHECK_EQUAL(alloc.FreeRangeCount(), 1u);
+	BOOST_CHECK_EQUAL(alloc.LargestFree(), 40u);
+	std::size_t x = 0;
+	BOOST_CHECK(alloc.Allocate(40, x));
+	BOOST_CHECK_EQUAL(x, 60u);
+}
+
+BOOST_AUTO_TEST_CASE(RangeAllocator_grow)
+{
+	Allocator alloc(10);
+	std::size_t a = 0;
+	alloc.Allocate(5, a);
+	alloc.Grow(20);
+	BOOST_CHECK_EQUAL(alloc.Capacity(), 20u);
+	BOOST_CHECK_EQUAL(alloc.FreeRangeCount(), 1u);
+	BOOST_CHECK_EQUAL(alloc.LargestFree(), 15u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
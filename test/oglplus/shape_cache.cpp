@@ -0,0 +1,140 @@
+/**
+ *  .file test/oglplus/shape_cache.cpp
+ *  .brief Test case for the shapes::ShapeCache class.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_ShapeCache
+#include <boost/test/unit_test.hpp>
+
+#include <oglplus/gl.hpp>
+#include <oglplus/all.hpp>
+#include <oglplus/shapes/cache.hpp>
+#include <oglplus/shapes/torus.hpp>
+#include <oglplus/shapes/sphere.hpp>
+#include <oglplus/shapes/plane.hpp>
+
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(ShapeCache)
+
+using namespace oglplus;
+
+BOOST_AUTO_TEST_CASE(ShapeCache_sharing)
+{
+	shapes::ShapeCache cache;
+	std::vector<String> names;
+	names.push_back("Position");
+	names.push_back("Normal");
+
+	auto a = cache.Get<shapes::Torus>(names, 1.0, 0.5, 36, 24);
+	auto b = cache.Get<shapes::Torus>(names, 1.0, 0.5, 36, 24);
+	BOOST_CHECK(a == b);
+	BOOST_CHECK_EQUAL(cache.Hits(), 1u);
+	BOOST_CHECK_EQUAL(cache.Misses(), 1u);
+
+	// different parameters, attributes or builders are different shapes
+	BOOST_CHECK(a != cache.Get<shapes::Torus>(names, 1.0, 0.5, 36, 12));
+	BOOST_CHECK(a != cache.Get<shapes::Torus>(names, 1.0, 0.5, 36.0, 24));
+	BOOST_CHECK(a != cache.Get<shapes::Sphere>(names, 1.0, 36, 24));
+	names.pop_back();
+	BOOST_CHECK(a != cache.Get<shapes::Torus>(names, 1.0, 0.5, 36, 24));
+	BOOST_CHECK_EQUAL(cache.EntryCount(), 5u);
+
+	// the cached shape provides the same data as the builder
+	shapes::Torus torus(1.0, 0.5, 36, 24);
+	std::vector<GLfloat> expected, actual;
+	BOOST_CHECK_EQUAL(a.Positions(actual), torus.Positions(expected));
+	BOOST_CHECK(actual == expected);
+	BOOST_CHECK_EQUAL(a.Normals(actual), torus.Normals(expected));
+	BOOST_CHECK(actual == expected);
+	// the attributes which were not requested are not made
+	BOOST_CHECK_EQUAL(a.TexCoordinates(actual), 0u);
+	BOOST_CHECK(actual.empty());
+	GLuint npv = 1, count = 1;
+	BOOST_CHECK(a.AttribValues("TexCoord", npv, count) == nullptr);
+	BOOST_CHECK_EQUAL(npv, 0u);
+	BOOST_CHECK(a.AttribValues("Position", npv, count) != nullptr);
+	BOOST_CHECK_EQUAL(npv, torus.Positions(expected));
+	BOOST_CHECK_EQUAL(count, expected.size());
+
+	auto indices = torus.Indices();
+	BOOST_CHECK_EQUAL(a.IndexCount(), indices.size());
+	BOOST_CHECK(std::equal(indices.begin(), indices.end(), a.IndexData()));
+	BOOST_CHECK_EQUAL(
+		a.Instructions().Operations().size(),
+		torus.Instructions().Operations().size()
+	);
+	Vec4f expected_bs, bs;
+	torus.BoundingSphere(expected_bs);
+	a.BoundingSphere(bs);
+	BOOST_CHECK(expected_bs == bs);
+	BOOST_CHECK(a.FaceWinding() == torus.FaceWinding());
+
+	cache.Clear();
+	BOOST_CHECK_EQUAL(cache.EntryCount(), 0u);
+	BOOST_CHECK_EQUAL(cache.Size(), 0u);
+	// the shared data outlives the cache entry
+	BOOST_CHECK_EQUAL(a.Positions(actual), 3u);
+	BOOST_CHECK(actual == expected);
+}
+
+BOOST_AUTO_TEST_CASE(ShapeCache_eviction)
+{
+	shapes::ShapeCache cache;
+	std::vector<String> all;
+	auto first = cache.Get<shapes::Sphere>(all, 1.0, 18, 12);
+	std::size_t size = cache.Size();
+	BOOST_CHECK(size > 0);
+
+	// room for two shapes of the same size
+	cache.SetMaxSize(size*2+size/2);
+	cache.Get<shapes::Sphere>(all, 2.0, 18, 12);
+	BOOST_CHECK_EQUAL(cache.EntryCount(), 2u);
+	// touch the first one, so the second is the least recently used
+	BOOST_CHECK(first == cache.Get<shapes::Sphere>(all, 1.0, 18, 12));
+	cache.Get<shapes::Sphere>(all, 3.0, 18, 12);
+	BOOST_CHECK_EQUAL(cache.EntryCount(), 2u);
+	BOOST_CHECK(cache.Size() <= cache.MaxSize());
+
+	std::size_t misses = cache.Misses();
+	BOOST_CHECK(first == cache.Get<shapes::Sphere>(all, 1.0, 18, 12));
+	BOOST_CHECK_EQUAL(cache.Misses(), misses);
+	cache.Get<shapes::Sphere>(all, 2.0, 18, 12);
+	BOOST_CHECK_EQUAL(cache.Misses(), misses+1);
+
+	cache.SetMaxSize(0);
+	BOOST_CHECK_EQUAL(cache.EntryCount(), 1u);
+}
+
+BOOST_AUTO_TEST_CASE(ShapeCache_keys)
+{
+	typedef shapes::ShapeCacheKey Key;
+	Key a(typeid(shapes::Plane)), b(typeid(shapes::Plane));
+	a.Append(Degrees(30.0f));
+	b.Append(Degrees(30.0f));
+	BOOST_CHECK(a.Str() == b.Str());
+	a.Append(Vec3f(1, 2, 3));
+	b.Append(Vec3f(1, 2, 4));
+	BOOST_CHECK(a.Str() != b.Str());
+
+	// angles and vectors differ from their plain values
+	Key c(typeid(shapes::Plane)), d(typeid(shapes::Plane));
+	c.Append(Radians(1.0f));
+	d.Append(1.0f);
+	BOOST_CHECK(c.Str() != d.Str());
+
+	shapes::ShapeCache cache;
+	std::vector<String> names(1, "Position");
+	auto p = cache.Get<shapes::Plane>(names, Vec3f(1, 0, 0), Vec3f(0, 0, 1));
+	BOOST_CHECK(p == cache.Get<shapes::Plane>(names, Vec3f(1,0,0), Vec3f(0,0,1)));
+	BOOST_CHECK(p != cache.Get<shapes::Plane>(names, Vec3f(2,0,0), Vec3f(0,0,1)));
+	BOOST_CHECK_EQUAL(cache.EntryCount(), 2u);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,106 @@
+/**
+ *  .file test/oglplus/shape_output_iter.cpp
+ *  .brief Test case for the output iterator overloads of shape builders.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_ShapeOutputIter
+#include <boost/test/unit_test.hpp>
+
+#include <oglplus/gl.hpp>
+#include <oglplus/all.hpp>
+#include <oglplus/shapes/torus.hpp>
+#include <oglplus/shapes/sphere.hpp>
+#include <oglplus/shapes/grid.hpp>
+#include <oglplus/shapes/spiral_sphere.hpp>
+
+#include <iterator>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(ShapeOutputIter)
+
+using namespace oglplus;
+
+template <class ShapeBuilder>
+static void check_attrib(
+	const ShapeBuilder& builder,
+	GLuint (ShapeBuilder::*vec_fn)(std::vector<GLfloat>&) const,
+	GLuint (ShapeBuilder::*ptr_fn)(GLfloat*) const,
+	GLuint npv
+)
+{
+	std::vector<GLfloat> expected;
+	BOOST_CHECK_EQUAL((builder.*vec_fn)(expected), npv);
+	BOOST_CHECK_EQUAL(expected.size(), builder.VertexCount()*npv);
+
+	// one extra value to detect writes past the end
+	std::vector<GLfloat> storage(builder.VertexCount()*npv+1, -123.0f);
+	BOOST_CHECK_EQUAL((builder.*ptr_fn)(storage.data()), npv);
+	BOOST_CHECK_EQUAL(storage.back(), -123.0f);
+	storage.pop_back();
+	BOOST_CHECK(storage == expected);
+}
+
+template <class ShapeBuilder>
+static void check_indices(const ShapeBuilder& builder)
+{
+	auto expected = builder.Indices();
+	BOOST_CHECK_EQUAL(expected.size(), builder.IndexCount());
+
+	std::vector<GLuint> actual;
+	builder.Indices(std::back_inserter(actual));
+	BOOST_CHECK_EQUAL(actual.size(), expected.size());
+	BOOST_CHECK(std::equal(actual.begin(), actual.end(), expected.begin()));
+}
+
+BOOST_AUTO_TEST_CASE(ShapeOutputIter_torus)
+{
+	typedef shapes::Torus S;
+	S shape(1.0, 0.5, 48, 24);
+	check_attrib<S>(shape, &S::Positions, &S::Positions, 3);
+	check_attrib<S>(shape, &S::Normals, &S::Normals, 3);
+	check_attrib<S>(shape, &S::Tangents, &S::Tangents, 3);
+	check_attrib<S>(shape, &S::Bitangents, &S::Bitangents, 3);
+	check_attrib<S>(shape, &S::TexCoordinates, &S::TexCoordinates, 2);
+	check_indices(shape);
+}
+
+BOOST_AUTO_TEST_CASE(ShapeOutputIter_sphere)
+{
+	typedef shapes::Sphere S;
+	S shape(2.0, 36, 18);
+	check_attrib<S>(shape, &S::Positions, &S::Positions, 3);
+	check_attrib<S>(shape, &S::Normals, &S::Normals, 3);
+	check_attrib<S>(shape, &S::Tangents, &S::Tangents, 3);
+	check_attrib<S>(shape, &S::Bitangents, &S::Bitangents, 3);
+	check_attrib<S>(shape, &S::TexCoordinates, &S::TexCoordinates, 2);
+	check_indices(shape);
+}
+
+BOOST_AUTO_TEST_CASE(ShapeOutputIter_grid)
+{
+	typedef shapes::Grid S;
+	S shape(Vec3f(), Vec3f(1, 0, 0), Vec3f(0, 0, 1), 8, 6);
+	check_attrib<S>(shape, &S::Positions, &S::Positions, 3);
+	check_attrib<S>(shape, &S::TexCoordinates, &S::TexCoordinates, 2);
+	check_indices(shape);
+}
+
+BOOST_AUTO_TEST_CASE(ShapeOutputIter_spiral_sphere)
+{
+	typedef shapes::SpiralSphere S;
+	S shape;
+	check_attrib<S>(shape, &S::Positions, &S::Positions, 3);
+	check_attrib<S>(shape, &S::Normals, &S::Normals, 3);
+	check_attrib<S>(shape, &S::Tangents, &S::Tangents, 3);
+	check_attrib<S>(shape, &S::Bitangents, &S::Bitangents, 3);
+	check_attrib<S>(shape, &S::TexCoordinates, &S::TexCoordinates, 2);
+	check_indices(shape);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
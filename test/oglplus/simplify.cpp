@@ -0,0 +1,112 @@
+/**
+ *  .file test/oglplus/simplify.cpp
+ *  .brief Test case for the shapes::Simplify class.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_Simplify
+#include <boost/test/unit_test.hpp>
+
+#include <oglplus/gl.hpp>
+#include <oglplus/all.hpp>
+#include <oglplus/shapes/simplify.hpp>
+#include <oglplus/shapes/cube.hpp>
+#include <oglplus/shapes/sphere.hpp>
+#include <oglplus/shapes/torus.hpp>
+
+#include <set>
+#include <vector>
+
+BOOST_AUTO_TEST_SUITE(Simplify)
+
+using namespace oglplus;
+
+static void check_levels(const shapes::Simplify& lods)
+{
+	std::vector<GLfloat> positions;
+	GLuint npv = lods.Positions(positions);
+	BOOST_CHECK_EQUAL(npv, 3u);
+	const std::size_t vertex_count = positions.size()/npv;
+
+	const auto& indices = lods.Indices();
+	for(auto i=indices.begin(), e=indices.end(); i!=e; ++i)
+	{
+		BOOST_CHECK(*i < vertex_count);
+	}
+	GLuint total = 0;
+	for(GLuint l=0; l!=lods.LevelCount(); ++l)
+	{
+		shapes::DrawingInstructions instr = lods.Instructions(l);
+		BOOST_CHECK_EQUAL(instr.Operations().size(), 1u);
+		BOOST_CHECK_EQUAL(instr.Operations()[0].first, total);
+		BOOST_CHECK_EQUAL(
+			instr.Operations()[0].count,
+			lods.TriangleCount(l)*3
+		);
+		total += lods.TriangleCount(l)*3;
+		if(l > 0)
+		{
+			BOOST_CHECK(lods.TriangleCount(l) < lods.TriangleCount(l-1));
+			BOOST_CHECK(lods.LevelError(l) >= lods.LevelError(l-1));
+		}
+	}
+	BOOST_CHECK_EQUAL(total, indices.size());
+	BOOST_CHECK_EQUAL(lods.LevelError(0), 0.0f);
+}
+
+BOOST_AUTO_TEST_CASE(Simplify_torus)
+{
+	shapes::Torus torus(1.0, 0.5, 48, 24);
+	shapes::Simplify lods(torus, 4, 0.5f);
+	BOOST_CHECK_EQUAL(lods.LevelCount(), 4u);
+	BOOST_CHECK_EQUAL(lods.TriangleCount(0), 48u*24u*2u);
+	BOOST_CHECK(lods.TriangleCount(3) <= lods.TriangleCount(0)/8+1);
+	check_levels(lods);
+}
+
+BOOST_AUTO_TEST_CASE(Simplify_seams)
+{
+	shapes::Sphere sphere(1.0, 36, 18);
+	shapes::Simplify lods(sphere, 5, 0.5f);
+	check_levels(lods);
+
+	// the vertices on the texture coordinate seam must be kept
+	std::vector<GLfloat> positions, texcoords;
+	lods.Positions(positions);
+	GLuint tc_npv = lods.TexCoordinates(texcoords);
+	BOOST_REQUIRE(tc_npv >= 2);
+
+	const GLuint last = lods.LevelCount()-1;
+	const auto& indices = lods.Indices();
+	shapes::DrawingInstructions instr = lods.Instructions(last);
+	std::set<GLuint> used(
+		indices.begin()+instr.Operations()[0].first,
+		indices.end()
+	);
+	const std::size_t vertex_count = positions.size()/3;
+	for(std::size_t v=0; v!=vertex_count; ++v)
+	{
+		const GLfloat u = texcoords[v*tc_npv];
+		if((u == 0.0f) || (u == 1.0f))
+		{
+			BOOST_CHECK(used.count(GLuint(v)) == 1);
+		}
+	}
+}
+
+BOOST_AUTO_TEST_CASE(Simplify_cube)
+{
+	// the cube has seams everywhere and cannot be simplified
+	shapes::Cube cube;
+	shapes::Simplify lods(cube, 3, 0.5f);
+	BOOST_CHECK_EQUAL(lods.LevelCount(), 1u);
+	BOOST_CHECK_EQUAL(lods.TriangleCount(0), 12u);
+	check_levels(lods);
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,242 @@
+/**
+ *  .file test/oglplus/triangle_bvh.cpp
+ *  .brief Test case for the shapes::TriangleBVH class.
+ *
+ *  .author Matus Chochlik
+ *
+ *  Copyright 2011-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+#define BOOST_TEST_DYN_LINK
+#define BOOST_TEST_MODULE OGLPLUS_TriangleBVH
+#include <boost/test/unit_test.hpp>
+
+#include <oglplus/gl.hpp>
+#include <oglplus/all.hpp>
+#include <oglplus/shapes/triangle_bvh.hpp>
+#include <oglplus/shapes/torus.hpp>
+#include <oglplus/shapes/cube.hpp>
+
+#include <vector>
+#include <cstdlib>
+
+BOOST_AUTO_TEST_SUITE(TriangleBVH)
+
+using namespace oglplus;
+
+static GLfloat random_value(GLfloat min, GLfloat max)
+{
+	return min+(max-min)*GLfloat(std::rand())/GLfloat(RAND_MAX);
+}
+
+// finds the closest hit by testing all triangles
+static shapes::TriangleBVHHit brute_force(
+	const std::vector<GLfloat>& positions,
+	GLuint npv,
+	const std::vector<GLuint>& triangles,
+	const shapes::TriangleBVHRay& ray
+)
+{
+	shapes::TriangleBVHHit hit;
+	hit.face = shapes::TriangleBVHHit::NoFace();
+	hit.distance = ray.max_distance;
+	Vec3f o(ray.origin, 3), d(ray.direction, 3);
+	for(GLuint t=0; t!=triangles.size()/3; ++t)
+	{
+		Vec3f a(positions.data()+triangles[t*3+0]*npv, 3);
+		Vec3f b(positions.data()+triangles[t*3+1]*npv, 3);
+		Vec3f c(positions.data()+triangles[t*3+2]*npv, 3);
+		Vec3f e1 = b-a, e2 = c-a;
+		Vec3f p = Cross(d, e2);
+		GLfloat det = Dot(e1, p);
+		if(det == 0.0f) continue;
+		Vec3f s = o-a;
+		GLfloat u = Dot(s, p)/det;
+		if((u < 0.0f) || (u > 1.0f)) continue;
+		Vec3f q = Cross(s, e1);
+		GLfloat v = Dot(d, q)/det;
+		if((v < 0.0f) || (u+v > 1.0f)) continue;
+		GLfloat dist = Dot(e2, q)/det;
+		if((dist >= ray.min_distance) && (dist < hit.distance))
+		{
+			hit.face = t;
+			hit.u = u;
+			hit.v = v;
+			hit.distance = dist;
+		}
+	}
+	return hit;
+}
+
+template <class ShapeBuilder>
+static void check_bvh(const ShapeBuilder& builder, GLuint max_leaf_size)
+{
+	shapes::TriangleBVH bvh(builder, max_leaf_size);
+
+	std::vector<GLfloat> positions;
+	GLuint npv = builder.Positions(positions);
+	auto shape_indices = builder.Indices();
+	std::vector<GLuint> indices(shape_indices.begin(), shape_indices.end());
+	std::vector<GLuint> triangles;
+	shapes::MakeTriangleList(builder.Instructions(), indices, triangles);
+	BOOST_CHECK_EQUAL(bvh.TriangleCount(), triangles.size()/3);
+
+	// every triangle is referenced by exactly one leaf
+	std::vector<GLuint> refs(bvh.TriangleCount(), 0);
+	const auto& nodes = bvh.Nodes();
+	for(auto n=nodes.begin(), e=nodes.end(); n!=e; ++n)
+	{
+		if(n->count == 0)
+		{
+			BOOST_CHECK(n->offset < nodes.size());
+			continue;
+		}
+		BOOST_CHECK(n->count <= max_leaf_size);
+		for(GLuint t=n->offset; t!=n->offset+n->count; ++t)
+			++refs[bvh.Triangles()[t].face];
+	}
+	for(auto r=refs.begin(), e=refs.end(); r!=e; ++r)
+		BOOST_CHECK_EQUAL(*r, 1u);
+
+	std::srand(12345);
+	std::vector<shapes::TriangleBVHRay> rays;
+	for(GLuint i=0; i!=500; ++i)
+	{
+		Vec3f from(
+			random_value(-3.0f, 3.0f),
+			random_value(-3.0f, 3.0f),
+			random_value(-3.0f, 3.0f)
+		);
+		Vec3f to(
+			random_value(-1.0f, 1.0f),
+			random_value(-0.5f, 0.5f),
+			random_value(-1.0f, 1.0f)
+		);
+		if(i % 2 == 0)
+			rays.push_back(bvh.Ray(from, Normalized(to-from)));
+		else rays.push_back(bvh.Segment(from, to));
+	}
+
+	std::vector<shapes::TriangleBVHHit> hits(rays.size());
+	std::size_t hit_count = bvh.Intersect(rays.data(), rays.size(), hits.data());
+	std::size_t occluded_count = 0;
+	for(std::size_t i=0; i!=rays.size(); ++i)
+	{
+		shapes::TriangleBVHHit expected =
+			brute_force(positions, npv, triangles, rays[i]);
+		shapes::TriangleBVHHit hit;
+		BOOST_CHECK_EQUAL(bvh.Intersect(rays[i], hit), expected.Hit());
+		BOOST_CHECK_EQUAL(hits[i].Hit(), expected.Hit());
+		BOOST_CHECK_EQUAL(bvh.Occluded(rays[i]), expected.Hit());
+		if(expected.Hit())
+		{
+			++occluded_count;
+			BOOST_CHECK_CLOSE(hit.distance, expected.distance, 0.01f);
+			BOOST_CHECK_CLOSE(hits[i].distance, expected.distance, 0.01f);
+			BOOST_CHECK_EQUAL(hits[i].face, hit.face);
+			BOOST_CHECK_EQUAL(hits[i].u, hit.u);
+			BOOST_CHECK_EQUAL(hits[i].v, hit.v);
+		}
+	}
+	BOOST_CHECK_EQUAL(hit_count, occluded_count);
+	BOOST_CHECK(occluded_count > 0);
+
+	bool* flags = new bool[rays.size()];
+	BOOST_CHECK_EQUAL(
+		bvh.Occluded(rays.data(), rays.size(), flags),
+		occluded_count
+	);
+	for(std::size_t i=0; i!=rays.size(); ++i)
+		BOOST_CHECK_EQUAL(flags[i], hits[i].Hit());
+	delete[] flags;
+
+	// coherent rays from a common origin traversed in packets
+	// give the same results as single rays
+	std::vector<shapes::TriangleBVHRay> coherent;
+	for(GLuint y=0; y!=16; ++y)
+	{
+		for(GLuint x=0; x!=16; ++x)
+		{
+			Vec3f to(
+				GLfloat(x)/8.0f-1.0f,
+				GLfloat(y)/8.0f-1.0f,
+				0.0f
+			);
+			coherent.push_back(bvh.Segment(Vec3f(0.1f, 0.2f, 3.0f), to));
+		}
+	}
+	std::vector<shapes::TriangleBVHHit> packet_hits(coherent.size());
+	std::vector<shapes::TriangleBVHHit> single_hits(coherent.size());
+	BOOST_CHECK_EQUAL(
+		bvh.Intersect(
+			coherent.data(),
+			coherent.size(),
+			packet_hits.data(),
+			true
+		),
+		bvh.Intersect(
+			coherent.data(),
+			coherent.size(),
+			single_hits.data()
+		)
+	);
+	bool* packet_flags = new bool[coherent.size()];
+	bvh.Occluded(coherent.data(), coherent.size(), packet_flags, true);
+	for(std::size_t i=0; i!=coherent.size(); ++i)
+	{
+		BOOST_CHECK_EQUAL(packet_hits[i].Hit(), single_hits[i].Hit());
+		BOOST_CHECK_EQUAL(packet_flags[i], single_hits[i].Hit());
+		if(single_hits[i].Hit())
+		{
+			BOOST_CHECK_EQUAL(packet_hits[i].face, single_hits[i].face);
+			BOOST_CHECK_CLOSE(
+				packet_hits[i].distance,
+				single_hits[i].distance,
+				0.01f
+			);
+		}
+	}
+	delete[] packet_flags;
+}
+
+BOOST_AUTO_TEST_CASE(TriangleBVH_torus)
+{
+	check_bvh(shapes::Torus(1.0, 0.5, 36, 24), 4);
+}
+
+BOOST_AUTO_TEST_CASE(TriangleBVH_torus_leaf_1)
+{
+	check_bvh(shapes::Torus(1.0, 0.5, 18, 12), 1);
+}
+
+BOOST_AUTO_TEST_CASE(TriangleBVH_cube)
+{
+	check_bvh(shapes::Cube(), 4);
+}
+
+BOOST_AUTO_TEST_CASE(TriangleBVH_picking)
+{
+	shapes::Cube cube;
+	shapes::TriangleBVH bvh(cube);
+	Mat4f camera =
+		CamMatrixf::PerspectiveX(Degrees(60), 1.0f, 1.0f, 100.0f)*
+		CamMatrixf::LookingAt(Vec3f(0.0f, 0.0f, 4.0f), Vec3f());
+
+	shapes::TriangleBVHHit hit;
+	BOOST_CHECK(bvh.Intersect(bvh.PickRay(camera, 0.0f, 0.0f), hit));
+	// the front face of the cube is at z = 0.5
+	auto ray = bvh.PickRay(camera, 0.0f, 0.0f);
+	GLfloat z = ray.origin[2]+ray.direction[2]*hit.distance;
+	BOOST_CHECK_CLOSE(z, 0.5f, 0.01f);
+
+	BOOST_CHECK(!bvh.Intersect(bvh.PickRay(camera, 0.9f, 0.9f), hit));
+	BOOST_CHECK(!hit.Hit());
+
+	// the line of sight through the cube is blocked
+	BOOST_CHECK(bvh.Occluded(bvh.Segment(Vec3f(0, 0, 2), Vec3f(0, 0,-2))));
+	BOOST_CHECK(!bvh.Occluded(bvh.Segment(Vec3f(0, 0, 2), Vec3f(0, 0, 1))));
+	BOOST_CHECK(!bvh.Occluded(bvh.Segment(Vec3f(1, 0, 2), Vec3f(1, 0,-2))));
+}
+
+BOOST_AUTO_TEST_SUITE_END()
@@ -0,0 +1,83 @@
+/**
+ *  .file tools/convert_bitmap_font.cpp
+ *  .brief Tool converting bitmap font pages (.bgm + .png) to .bgp files
+ *
+ *  @author Matus Chochlik
+ *
+ *  Copyright 2010-2013 Matus Chochlik. Distributed under the Boost
+ *  Software License, Version 1.0. (See accompanying file
+ *  LICENSE_1_0.txt or copy at http://www.boost.org/LICENSE_1_0.txt)
+ */
+
+#include <oglplus/gl.hpp>
+#include <oglplus/all.hpp>
+#include <oglplus/text/bitmap_glyph/page_file.hpp>
+#include <oglplus/images/png.hpp>
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <vector>
+
+int main(int argc, const char* argv[])
+{
+	if(argc < 2)
+	{
+		std::cerr
+			<< "Usage: " << argv[0]
+			<< " <page> [<output>] [--compress] [--glyphs <N>]"
+			<< std::endl
+			<< "  reads <page>.bgm and <page>.png and writes"
+			<< " <output> (<page>.bgp by default)"
+			<< std::endl;
+		return 1;
+	}
+	std::string page = argv[1];
+	std::string output = page + ".bgp";
+	bool compress = false;
+	unsigned glyph_count = 256;
+
+	for(int a=2; a<argc; ++a)
+	{
+		if(std::strcmp(argv[a], "--compress") == 0)
+			compress = true;
+		else if((std::strcmp(argv[a], "--glyphs") == 0) && (a+1<argc))
+			glyph_count = unsigned(std::atoi(argv[++a]));
+		else output = argv[a];
+	}
+
+	try
+	{
+		std::ifstream bgm((page+".bgm").c_str());
+		if(!bgm.good())
+		{
+			std::cerr << "Unable to open " << page << ".bgm" << std::endl;
+			return 2;
+		}
+		std::vector<GLfloat> metrics(glyph_count*4*3);
+		oglplus::text::BitmapGlyphReadTextMetrics(
+			bgm,
+			metrics.data(),
+			glyph_count
+		);
+
+		// the same orientation as when the fonts load the .png pages
+		oglplus::images::PNG bitmap((page+".png").c_str(), true, true);
+
+		std::ofstream bgp(output.c_str(), std::ios::binary);
+		oglplus::text::BitmapGlyphPageFile::Write(
+			bgp,
+			bitmap,
+			metrics.data(),
+			glyph_count,
+			compress
+		);
+	}
+	catch(std::exception& error)
+	{
+		std::cerr << "Error: " << error.what() << std::endl;
+		return 3;
+	}
+	return 0;
+}
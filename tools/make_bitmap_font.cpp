@@ -15,10 +15,14 @@
 #include <cstdlib>
 #include <cassert>
 #include <cstring>
+#include <vector>
 
 #include <pango/pangocairo.h>
 
+#include <oglplus/gl.hpp>
+#include <oglplus/all.hpp>
 #include <oglplus/auxiliary/utf8/conversion.hpp>
+#include <oglplus/text/bitmap_glyph/page_file.hpp>
 
 void render_glyph(
 	cairo_t* cr,
@@ -31,7 +35,8 @@ void render_glyph(
 	const double tex_size,
 	const int ascent,
 	const int descent,
-	std::ostream& bfm_out
+	std::ostream& bfm_out,
+	std::vector<float>& metrics
 )
 {
 	PangoLayout *layout = pango_cairo_create_layout(cr);
@@ -64,40 +69,46 @@ void render_glyph(
 		<< std::endl;
 	// the utf-8 sequence
 	bfm_out << "'" << str << "'" << std::endl;
-	//
-	// vertex[0] logical rectangle metrics
-	//
-	// Left bearing (x)
-	bfm_out << PANGO_LBEARING(log_rect)/font_size << std::endl;
-	// Right bearing (x+width)
-	bfm_out << PANGO_RBEARING(log_rect)/font_size << std::endl;
-	// Ascent
-	bfm_out << (baseline-log_rect.y)/font_size << std::endl;
-	// Descent
-	bfm_out << (log_rect.height+log_rect.y-baseline)/font_size << std::endl;
-	//
-	// vertex[1] ink rectangle metrics
-	//
-	// Left bearing (x)
-	bfm_out << PANGO_LBEARING(ink_rect)/font_size << std::endl;
-	// Right bearing (x+width)
-	bfm_out << PANGO_RBEARING(ink_rect)/font_size << std::endl;
-	// Ascent
-	bfm_out << (baseline-ink_rect.y)/font_size << std::endl;
-	// Descent
-	bfm_out << (ink_rect.y+ink_rect.height-baseline)/font_size << std::endl;
-	//
-	// vertex[2] texture coordinates
-	//
-	// Origin X
-	bfm_out << (cell_x*cell_size+ink_rect.x*inv_ps)/tex_size << std::endl;
-	// Origin Y
-	bfm_out << 1.0-(cell_y*cell_size+baseline*inv_ps)/tex_size << std::endl;
-	// Width
-	bfm_out << ((ink_rect.width)*inv_ps)/tex_size << std::endl;
-	// Height
-	bfm_out << ((ink_rect.height)*inv_ps)/tex_size << std::endl;
-
+	const float values[12] = {
+		//
+		// vertex[0] logical rectangle metrics
+		//
+		// Left bearing (x)
+		float(PANGO_LBEARING(log_rect)/font_size),
+		// Right bearing (x+width)
+		float(PANGO_RBEARING(log_rect)/font_size),
+		// Ascent
+		float((baseline-log_rect.y)/font_size),
+		// Descent
+		float((log_rect.height+log_rect.y-baseline)/font_size),
+		//
+		// vertex[1] ink rectangle metrics
+		//
+		// Left bearing (x)
+		float(PANGO_LBEARING(ink_rect)/font_size),
+		// Right bearing (x+width)
+		float(PANGO_RBEARING(ink_rect)/font_size),
+		// Ascent
+		float((baseline-ink_rect.y)/font_size),
+		// Descent
+		float((ink_rect.y+ink_rect.height-baseline)/font_size),
+		//
+		// vertex[2] texture coordinates
+		//
+		// Origin X
+		float((cell_x*cell_size+ink_rect.x*inv_ps)/tex_size),
+		// Origin Y
+		float(1.0-(cell_y*cell_size+baseline*inv_ps)/tex_size),
+		// Width
+		float(((ink_rect.width)*inv_ps)/tex_size),
+		// Height
+		float(((ink_rect.height)*inv_ps)/tex_size)
+	};
+	for(unsigned v=0; v!=12; ++v)
+	{
+		bfm_out << values[v] << std::endl;
+		metrics.push_back(values[v]);
+	}
 
 	// separating newline
 	bfm_out << std::endl;
@@ -140,6 +151,9 @@ int main(int argc, const char* argv[])
 
 	// The Bitmap Font Metrics file
 	std::ofstream bfm((argc>5) ? argv[5] : "out.bfm");
+	// The metric values for the binary glyph page file
+	std::vector<float> metrics;
+	metrics.reserve(256*12);
 	unsigned step = tex_side / 16;
 	for(unsigned y=0; y!=16; ++y)
 	{
@@ -155,7 +169,8 @@ int main(int argc, const char* argv[])
 				tex_side,
 				pango_font_metrics_get_ascent(font_metrics),
 				pango_font_metrics_get_descent(font_metrics),
-				bfm
+				bfm,
+				metrics
 			);
 		}
 	}
@@ -171,6 +186,40 @@ int main(int argc, const char* argv[])
 		surface,
 		(argc>4) ? argv[4] : "out.png"
 	);
+
+	// The binary glyph page file containing both the bitmap
+	// and the metrics, which can be loaded without any parsing
+	if(argc>6)
+	{
+		cairo_surface_flush(surface);
+		const unsigned char* data = cairo_image_surface_get_data(surface);
+		const int stride = cairo_image_surface_get_stride(surface);
+		// the rows are stored bottom-up like when the .png is loaded
+		std::vector<unsigned char> bitmap(tex_side*tex_side);
+		for(size_t r=0; r!=tex_side; ++r)
+		{
+			std::memcpy(
+				bitmap.data()+r*tex_side,
+				data+(tex_side-r-1)*stride,
+				tex_side
+			);
+		}
+		std::ofstream bgp(argv[6], std::ios::binary);
+		oglplus::text::BitmapGlyphPageFile::Write(
+			bgp,
+			tex_side,
+			tex_side,
+			1,
+			GL_RED,
+			GL_R8,
+			GL_UNSIGNED_BYTE,
+			bitmap.data(),
+			bitmap.size(),
+			metrics.data(),
+			256,
+			(argc>7) && (std::strcmp(argv[7], "compress") == 0)
+		);
+	}
 	cairo_surface_destroy(surface);
 
 	return 0;